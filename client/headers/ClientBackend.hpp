@@ -10,8 +10,12 @@
 // logger
 #include "Logger.hpp"
 
+// shared server connection
+#include "Connection.hpp"
+
 // std
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <iostream>
 #include <fstream>
@@ -24,6 +28,7 @@
 #include <memory>
 #include <stdexcept>
 #include <filesystem>
+#include <unordered_map>
 
 namespace backend {
 
@@ -34,13 +39,36 @@ public:
     ClientBackend(const std::string& ip, unsigned short port);
     ~ClientBackend();
     
+    // another pane session over the same connection, with its own cwd on the server
+    std::unique_ptr<ClientBackend> openChannel();
+    
     std::string GetPath() const;
     void SetPath(std::string& new_path);
     
     std::string sendCommand(const std::string& command);
+    // output is handed to onOutput piece by piece while the command still runs on the server
+    void sendCommandStreaming(const std::string& command, const Connection::ChunkHandler& onOutput);
+    
+    // pipelining: submit returns at once with the request id, await blocks for that response
+    uint32_t submitCommand(const std::string& command);
+    std::string awaitResponse(uint32_t requestId);
+    
+    // whole batch in one round trip, responses come back in command order
+    std::vector<std::string> sendBatch(const std::vector<std::string>& commands);
+    
+    // terminal mode: after the first resize this session's commands run on a pseudo-terminal,
+    // their output is raw terminal bytes (encoded ScreenUpdates with screen set) and
+    // sendTerminalInput feeds the running one
+    void resizeTerminal(unsigned short rows, unsigned short columns, bool screen = false);
+    void sendTerminalInput(std::string_view keys);
+    
+    // "<kind> <path>" lines for the paths this session watches (watch <path>), empty when nothing changed
+    std::string takeWatchEvents();
 private:
-    int clientSocket;
-    std::mutex backendMutex; // for protecting the socket access
+    ClientBackend(std::shared_ptr<Connection> connection, uint16_t channel);
+    
+    std::shared_ptr<Connection> connection;
+    uint16_t channel;
     mutable std::mutex pathMutex;
     logs::Logger logger;
     std::string currentPath;
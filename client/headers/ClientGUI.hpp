@@ -8,6 +8,8 @@
 #pragma once
 
 #include "./ClientBackend.hpp"
+#include "./RemoteDocument.hpp"
+#include "./FileTransfer.hpp"
 #include "./Logger.hpp"
 
 // SFML
@@ -23,6 +25,12 @@
 #include <stdexcept>
 #include <filesystem>
 #include <thread>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <functional>
+#include <chrono>
+#include <future>
 
 namespace gui {
 
@@ -38,6 +46,14 @@ struct NanoCursor {
 };
 
 
+// a get or put runs on its own thread, the render loop shows its progress like it reports a nano save
+struct RunningTransfer {
+    std::string label;                   // the command, its progress line starts with it
+    std::future<std::string> result;     // the line to show once the file moved or failed
+    std::atomic<uint64_t> done{0};
+    std::atomic<uint64_t> total{0};
+};
+
 enum class SplitType {
     NONE,
     HORIZONTAL,
@@ -56,6 +72,7 @@ struct Pane {
     std::vector<std::string> commandHistory;
     size_t currentHistoryIndex = -1;
     std::unique_ptr<backend::ClientBackend> backend;
+    std::unique_ptr<RunningTransfer> transfer;   // uses backend, reset it before the pane goes away
     sf::Text inputText;
     sf::Text outputText;
     sf::RectangleShape cursor;
@@ -87,6 +104,7 @@ private:
     
     // terminal
     std::vector<std::string> terminalLines;
+    std::unique_ptr<RunningTransfer> transfer;   // get or put of the default terminal
     sf::RectangleShape scrollBar;
     int scrollPosition = 0;
     const size_t MAX_VISIBLE_LINES = 30;
@@ -103,7 +121,7 @@ private:
     
     // editor member text for nano
     editorMode currentMode = editorMode::NORMAL;
-    std::vector<std::string> editorLines;
+    std::unique_ptr<backend::RemoteDocument> document;  // the file being edited, paged in from the server
     std::string currentEditingFile;
     NanoCursor nanoCursor = {0, 0, 0};
     std::string savedMessage;
@@ -126,17 +144,43 @@ private:
     
     // Process input methods
     void processInput(sf::Event event);
+    bool isStreamedCommand(const std::string& command) const;
+    // nano, get and put are carried out here, the server only answers the requests they make
+    bool isClientCommand(const std::string& command) const;
+    // get <remote> [local] and put <local> [remote] on a thread of their own, one at a time per pane
+    void startTransfer(backend::ClientBackend& session, const std::string& command, std::unique_ptr<RunningTransfer>& running,
+                       const std::function<void(const std::string&)>& addLine);
+    // moves the progress line of a running transfer along, shows its result once it is done;
+    // true when it changed a line in place and the view needs an update
+    bool showTransferProgress(std::unique_ptr<RunningTransfer>& running, std::vector<std::string>& lines,
+                              const std::function<void(const std::string&)>& addLine);
+    // runs on the transfer's thread, the line to show once the file moved or failed
+    std::string transferFile(backend::ClientBackend& session, const std::string& command,
+                             const backend::FileTransfer::Progress& progress);
+    // output line by line while the command runs, the window stays responsive and Ctrl+C interrupts it
+    void streamCommandOutput(backend::ClientBackend& session, const std::string& command,
+                             const std::function<void(const std::string&)>& addLine);
+    // full screen programs run on a server side pseudo-terminal, keys go to them as they are typed
+    // and the screen the server keeps for them is mirrored onto the last lines of the view
+    bool isTerminalCommand(const std::string& command) const;
+    void runTerminalCommand(backend::ClientBackend& session, const std::string& command,
+                            std::vector<std::string>& lines);
+    static std::string stripTerminalControls(const std::string& output);
+    // changes under watched paths, shown as lines of the pane that watches them
+    void showWatchEvents();
     void handleSpecialInput(sf::Event event);
     void renderDefaultTerminal();
     void handleScrolling(sf::Event event);
     void processNormalModeInput(sf::Event event);
     
     // editor mode methods
-    void enterNanoEditorMode(const std::string& fileContent, const std::string& fileName);
+    void enterNanoEditorMode(std::unique_ptr<backend::RemoteDocument> document, const std::string& fileName);
     std::vector<std::string> splitFileContent(const std::string& content);
     std::vector<std::string> wrapLines(const std::string& originalLine, float maxWid);
     void processNanoInput(sf::Event event);
     void saveNanoFile();
+    // reports a save that finished uploading
+    void finishNanoSave();
     void exitNanoEditorMode();
     void refreshNanoDisplay();
     std::mutex ModeMutex; // for opening nano when I'm in pane mode
@@ -0,0 +1,106 @@
+//
+//  Connection.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// logger
+#include "Logger.hpp"
+
+// wire protocol
+#include "../../common/headers/Protocol.hpp"
+#include "../../common/headers/Compression.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <memory>
+#include <cstdint>
+
+namespace backend {
+
+// The one TCP connection every pane shares. Panes talk on their own channel,
+// request ids are unique per connection so a response is matched by id alone.
+// One waiting caller at a time reads the socket, it parks the responses of the
+// others and wakes them; the reader role passes on when its own response is in.
+class Connection {
+public:
+    // takes streamed response bytes while the command is still running
+    using ChunkHandler = std::function<void(std::string_view chunk)>;
+
+    Connection(const std::string& ip, unsigned short port);
+    ~Connection();
+
+    // deactivate copy constructors and assign operator
+    Connection(const Connection&) = delete;
+    Connection& operator = (const Connection&) = delete;
+
+    uint16_t openChannel();
+    void closeChannel(uint16_t channel);
+
+    uint32_t submit(uint16_t channel, const std::string& command);
+
+    // terminal mode of a channel: the first resize switches it, keys go to the command running there
+    void resizeTerminal(uint16_t channel, const protocol::WindowSize& size);
+    void sendKeys(uint16_t channel, std::string_view keys);
+    // with onChunk the response is handed over frame by frame as it arrives and nothing is returned
+    std::string await(uint32_t requestId, const ChunkHandler& onChunk = {});
+
+    // WATCH_EVENT lines the server pushed to the channel since the last call; reads what already
+    // arrived without blocking, or leaves it to the caller that is waiting for a response
+    std::string takeWatchEvents(uint16_t channel);
+
+    int socket() const { return this -> clientSocket; }
+
+private:
+    // a response parked for another caller, with the channel it belongs to
+    struct Parked {
+        uint16_t channel = 0;
+        std::string body;
+    };
+
+    int clientSocket;
+    logs::Logger logger;
+
+    std::mutex sendMutex;    // outgoing frames, ids and channel numbers
+    uint32_t nextRequestId = 1;
+    uint16_t nextChannel = 1;
+
+    std::mutex receiveMutex; // the parked frames below, never held across a recv
+    std::condition_variable arrived;  // the reader parked something or gave up reading
+    bool reading = false;    // a caller reads the socket, parser and the streams are its alone meanwhile
+    protocol::FrameParser parser;
+    std::unordered_map<uint32_t, Parked> partial;          // responses still missing frames
+    std::unordered_map<uint32_t, Parked> completed;        // responses that arrived before anyone awaited them
+    std::unordered_map<uint16_t, uint32_t> consumed;       // response bytes read but not yet granted back
+    std::unordered_map<uint16_t, std::string> watchEvents; // pushed changes the panes did not take yet
+    std::unordered_map<uint16_t, std::unique_ptr<protocol::FrameDecompressor>> decompressors;  // per channel stream
+    std::string inflated;                                  // backs the payload of the last compressed frame
+
+    std::mutex retiredMutex;        // closeChannel runs without the socket, the reader frees what they left
+    std::vector<uint16_t> retired;  // closed since the reader last looked
+    std::unordered_set<uint16_t> closedChannels;   // their late frames are dropped until the number is reused
+
+    // reads until the response of requestId is parked, or streamed to its end (true); the lock is let go
+    // around recv and onChunk
+    bool readUntil(uint32_t requestId, const ChunkHandler& onChunk, std::unique_lock<std::mutex>& lock);
+    // inflates a FLAG_COMPRESSED payload in place; false for a leftover of a channel closed meanwhile
+    bool decode(protocol::Frame& frame);
+    // frees what the channels closed since the last call parked; true when channel is one of the closed
+    bool isClosed(uint16_t channel);
+    // keeps a frame nobody is streaming for until its owner asks
+    void park(const protocol::Frame& frame);
+    void grantWindow(uint16_t channel, uint32_t bytes);
+    void flushWindowUpdates(uint32_t threshold);
+};
+
+}
@@ -0,0 +1,83 @@
+//
+//  FileTransfer.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// session the transfer starts from, its connection carries the chunks
+#include "ClientBackend.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <cstdint>
+
+namespace backend {
+
+// Files copied between this machine and the server: `get <remote> [local]` and
+// `put <local> [remote]`. A file moves in CHUNK pieces spread over STREAMS
+// channels of the connection, each with a flow control window of its own, with
+// IN_FLIGHT requests per channel, so a large file keeps the link busy instead
+// of waiting on one response at a time. Every chunk travels with its XXH64
+// checksum and is sent again when it does not match. The copy is written to a
+// partial file and renamed to its name once complete; running the same
+// transfer again compares the checksums of what the partial file holds with
+// the source and resumes at the first chunk that differs. A directory arrives
+// as <local>.tar.gz the server builds while it sends it, followed by a
+// TREE_RESULT_SIZE line of how many entries it could not read.
+class FileTransfer {
+public:
+    static constexpr size_t CHUNK = 512 * 1024;   // a put chunk and its request line stay under MAX_PAYLOAD
+    static constexpr size_t STREAMS = 4;
+    static constexpr size_t IN_FLIGHT = 4;        // chunk requests per stream
+    static constexpr int ATTEMPTS = 3;            // sends of one chunk before the transfer gives up
+    static constexpr size_t TREE_RESULT_SIZE = 21;   // "SKIPPED " and 12 digits and a line break after an archive
+
+    // bytes in place so far and in total, after every chunk
+    using Progress = std::function<void(uint64_t done, uint64_t total)>;
+
+    explicit FileTransfer(ClientBackend& session);
+
+    // deactivate copy constructors and assign operator
+    FileTransfer(const FileTransfer&) = delete;
+    FileTransfer& operator = (const FileTransfer&) = delete;
+
+    // remote paths are relative to the session's directory, local ones to this process's;
+    // empty on success, otherwise the error, the partial file stays for the next attempt
+    std::string get(const std::string& remote, const std::string& local, const Progress& progress = {});
+    std::string put(const std::string& local, const std::string& remote, const Progress& progress = {});
+
+    // bytes the last transfer actually moved, what it resumed from is not counted
+    uint64_t transferred() const { return this -> moved; }
+    // where the last get put its file
+    const std::string& localCopy() const { return this -> saved; }
+    // what the user should know about a transfer that still succeeded, e.g. an incomplete archive
+    const std::string& warning() const { return this -> caution; }
+
+private:
+    using Request = std::function<std::string(uint64_t chunk)>;
+    // empty when the response completes the chunk, otherwise why it has to be sent again
+    using Check = std::function<std::string(uint64_t chunk, const std::string& response)>;
+
+    ClientBackend& session;
+    uint64_t moved = 0;
+    std::string saved;
+    std::string caution;
+
+    std::string remotePath(const std::string& remote) const;
+    // the whole archive in one streamed response, its size is only known once it is complete
+    std::string getTree(const std::string& path, const std::string& local, const Progress& progress);
+    // how many leading whole chunks are the same here and on the server, by their checksums;
+    // what resumes a transfer, whichever side holds the partial copy
+    uint64_t verifiedChunks(int localFd, uint64_t localSize, uint64_t remoteSize, const std::string& sumsRequest);
+    // chunks [first, count) over the streams, every one until its check passes or ATTEMPTS ran out
+    std::string pump(uint64_t first, uint64_t count, uint64_t total, const Request& request, const Check& check,
+                     const Progress& progress);
+};
+
+}
@@ -8,25 +8,134 @@
 #pragma once
 
 // std
-#include <fstream>
 #include <string>
 #include <mutex>
+#include <atomic>
+#include <thread>
+#include <memory>
+#include <condition_variable>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
 #include <iostream>
 #include <filesystem>
-#include <ctime>
+#include <string_view>
+
+// the lowest level compiled in, a number of logs::Level; release builds leave DEBUG out
+#ifndef REMMUX_LOG_LEVEL
+#ifdef NDEBUG
+#define REMMUX_LOG_LEVEL 1
+#else
+#define REMMUX_LOG_LEVEL 0
+#endif
+#endif
+
+// LOG_DEBUG(logger, "(Class::method) text " + value): below the compiled level the
+// statement is gone from the binary, below the runtime level the message is never
+// built; the tag is written by the logger, not concatenated at the call site
+#define REMMUX_LOG(logger, level, message)                                   \
+    do {                                                                     \
+        if constexpr ((level) >= logs::COMPILED_LEVEL) {                     \
+            if (logs::Logger::enabled(level)) {                              \
+                (logger).log((level), (message));                            \
+            }                                                                \
+        }                                                                    \
+    } while (0)
+
+#define LOG_DEBUG(logger, message) REMMUX_LOG(logger, logs::Level::DEBUG, message)
+#define LOG_INFO(logger, message) REMMUX_LOG(logger, logs::Level::INFO, message)
+#define LOG_WARN(logger, message) REMMUX_LOG(logger, logs::Level::WARN, message)
+#define LOG_ERROR(logger, message) REMMUX_LOG(logger, logs::Level::ERROR, message)
+#define LOG_SECURITY(logger, message) REMMUX_LOG(logger, logs::Level::SECURITY, message)
+#define LOG_CRITICAL(logger, message) REMMUX_LOG(logger, logs::Level::CRITICAL, message)
 
 namespace logs {
 
+enum class Level : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    SECURITY,
+    CRITICAL
+};
+
+constexpr Level COMPILED_LEVEL = static_cast<Level>(REMMUX_LOG_LEVEL);
+// the runtime threshold until setLevel, DEBUG lines only when asked for even where they are compiled in
+constexpr Level DEFAULT_LEVEL = COMPILED_LEVEL > Level::INFO ? COMPILED_LEVEL : Level::INFO;
+
+// Appends "[time][LEVEL]message" lines to logs/<file>. In ASYNC mode log() only moves
+// the message and the second it was logged at into a ring that every thread
+// pushes to without a lock; a flusher thread formats the timestamps and writes
+// what collected with one write() every FLUSH_INTERVAL, or as soon as a
+// producer sees the ring half full. A producer that finds it full anyway gives
+// the flusher FULL_RETRIES turns of its CPU, then drops the message and counts
+// it; the caller never waits for the disk.
+// SYNC mode writes every line before log() returns.
 class Logger {
-private:
-    std::string logFilePath;
-    std::ofstream logFile;
-    std::mutex logMutex;
-    
 public:
-    Logger(const std::string& filePath);
+    enum class Mode {
+        SYNC,
+        ASYNC
+    };
+
+    static constexpr size_t RING_CAPACITY = 16384;   // messages, a power of two
+    static constexpr auto FLUSH_INTERVAL = std::chrono::milliseconds(20);
+    static constexpr int FULL_RETRIES = 64;
+
+    Logger(const std::string& filePath, Mode mode = Mode::ASYNC);
     ~Logger();
-    void log(const std::string& message);
+
+    // deactivate copy constructors and assign operator
+    Logger(const Logger&) = delete;
+    Logger& operator = (const Logger&) = delete;
+
+    void log(Level level, const std::string& message);
+    void log(Level level, std::string&& message);
+
+    // one threshold for every logger of the process, lines below it are skipped before they are built
+    static bool enabled(Level level) { return level >= threshold.load(std::memory_order_relaxed); }
+    static void setLevel(Level level) { threshold.store(level, std::memory_order_relaxed); }
+    // "debug", "info", "warn", "error", "security" or "critical"; false for anything else
+    static bool parseLevel(std::string_view name, Level& level);
+
+private:
+    // one message in the ring, sequence says whose turn the slot is (Vyukov's bounded queue)
+    struct Slot {
+        std::atomic<uint64_t> sequence{0};
+        std::time_t time = 0;
+        Level level = Level::DEBUG;
+        std::string message;
+    };
+
+    static inline std::atomic<Level> threshold{DEFAULT_LEVEL};
+
+    std::string logFilePath;
+    int logFd = -1;
+    Mode mode;
+    std::mutex logMutex;          // SYNC writes
+
+    std::unique_ptr<Slot[]> ring;
+    alignas(64) std::atomic<uint64_t> head{0};      // next slot a producer claims
+    alignas(64) std::atomic<uint64_t> tail{0};      // next slot the flusher takes, only it moves it
+    std::atomic<uint64_t> dropped{0};
+
+    std::thread flusher;
+    std::mutex flusherMutex;
+    std::condition_variable flusherWake;
+    bool stopping = false;
+
+    // the formatted stamp of the last second a line was written in
+    std::time_t stampSecond = -1;
+    char stamp[24] = {};
+
+    void push(Level level, std::string&& message);
+    void wakeFlusher();
+    void flushLoop();
+    // everything in the ring to the file, in as few writes as it takes
+    void drain(std::string& batch);
+    void appendLine(std::string& batch, std::time_t time, Level level, const std::string& message);
+    void writeOut(const std::string& batch);
 };
 
 }
@@ -0,0 +1,134 @@
+//
+//  RemoteDocument.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// session the file is read through
+#include "ClientBackend.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <memory>
+#include <future>
+#include <cstdint>
+
+namespace backend {
+
+// A file on the server as the editor sees it: lines fetched a page at a time
+// with `nano --lines=<first>,<count>`, so opening a huge log only waits for the
+// first screen. Pages near the viewport are requested ahead of the scrolling
+// and pipelined on the session; pages far from it are dropped again unless
+// they were edited. The length of the file is learned while it is paged
+// through, lineCount() grows until complete().
+//
+// Saving sends the server only what changed: every page knows the bytes it
+// came from, so unedited pages and the part of the file never paged in are
+// copied on the server from the original and only edited pages are uploaded,
+// in SAVE_CHUNK pieces with SAVE_WINDOW of them in flight. The server writes
+// them into a temporary file and renames it over the original once complete.
+class RemoteDocument {
+public:
+    static constexpr size_t PAGE_LINES = 256;
+    static constexpr size_t PREFETCH_PAGES = 2;   // past the viewport, in both directions
+    static constexpr size_t KEPT_PAGES = 32;      // unedited pages loaded at most
+    static constexpr size_t SAVE_CHUNK = 256 * 1024;
+    static constexpr size_t SAVE_WINDOW = 8;
+    RemoteDocument(ClientBackend& session, std::string path);
+    ~RemoteDocument();
+
+    // deactivate copy constructors and assign operator
+    RemoteDocument(const RemoteDocument&) = delete;
+    RemoteDocument& operator = (const RemoteDocument&) = delete;
+
+    // loads the first page: empty on success, "NEW_FILE" for a new or empty file, otherwise the server's error
+    std::string open();
+
+    // lines known so far, all of them once complete()
+    size_t lineCount() const { return this -> knownLines; }
+    bool complete() const { return this -> reachedEnd; }
+    // true when the line exists, loading pages up to it when they are not known yet
+    bool hasLine(size_t index);
+
+    // the line, its page is loaded first when needed
+    const std::string& line(size_t index);
+    // the same line to change in place, its page is saved with the next save
+    std::string& editLine(size_t index);
+    void insertLine(size_t index, std::string text);
+    void eraseLine(size_t index);
+
+    // lines [first, first + count) are on screen: loads them, requests the pages around them
+    // and lets go of the pages far away
+    void show(size_t first, size_t count);
+
+    // every line, newline terminated, loading the whole file
+    std::string text();
+
+    // starts writing the document back to the server, the upload runs on a thread of its own
+    // and editing goes on meanwhile; empty when it started, otherwise why it could not
+    std::string save();
+    bool saving() const { return this -> upload.valid(); }
+    // true once the running save ended, with its result: empty when the file was replaced
+    bool saveFinished(std::string& result);
+
+private:
+    struct Page {
+        size_t firstLine = 0;      // in the file on the server
+        size_t fileLines = PAGE_LINES;   // lines it covers there, what a request asks for
+        size_t lines = 0;          // now, edits included
+        std::vector<std::string> text;
+        bool loaded = false;
+        bool edited = false;
+        uint64_t edits = 0;        // counts changes, a save only clears the ones it wrote
+        bool placed = false;       // offset and length are known
+        uint64_t offset = 0;       // its bytes in the file on the server
+        uint64_t length = 0;
+        uint32_t pending = 0;      // request in flight for it, 0 for none
+    };
+
+    // what a save writes, taken on the editor's thread and uploaded on another
+    struct SavePlan {
+        struct Piece {
+            uint64_t at = 0;       // in the new file
+            uint64_t from = 0;     // in the original, for a copied piece
+            uint64_t length = 0;
+            std::string bytes;     // the content of an uploaded piece
+            bool copied = false;
+        };
+        std::string base;          // version of the original the copies refer to, "new" for none
+        std::vector<Piece> pieces;
+        uint64_t size = 0;
+        std::vector<Page> placed;  // where each page ends up, text left out
+        std::string version;       // of the saved file, set by the upload
+    };
+
+    ClientBackend& session;
+    std::string path;
+    std::vector<Page> pages;       // in file order, the ones known so far
+    size_t knownLines = 0;
+    bool reachedEnd = false;
+    std::string version;           // of the file the pages came from, empty for a new file
+    uint64_t fileSize = 0;
+    bool stale = false;            // a page came from a newer version, the pages do not add up to one file
+    std::shared_ptr<SavePlan> plan;
+    std::future<std::string> upload;
+
+    static std::string send(ClientBackend& session, const std::string& path, SavePlan& plan);
+    // waits for the running save and moves the pages to where it put them
+    std::string finishSave();
+
+    // the page holding the line and the line's index in it
+    size_t locate(size_t index, size_t& offset);
+    void request(size_t page);
+    void load(size_t page);
+    // reads the next unknown page of the file, false once there is none
+    bool discover();
+    bool apply(size_t page, const std::string& response);
+    void touch(size_t page);
+};
+
+}
@@ -7,7 +7,20 @@
 
 #include "./headers/Client.hpp"
 
-int main() {
+// usage: runner_client.out [--log-level=debug|info|warn|error|security|critical]
+int main(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        logs::Level logLevel = logs::DEFAULT_LEVEL;
+        if (arg.rfind("--log-level=", 0) == 0 && logs::Logger::parseLevel(arg.substr(12), logLevel)) {
+            logs::Logger::setLevel(logLevel);
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n';
+            std::cerr << "Usage: " << argv[0] << " [--log-level=debug|info|warn|error|security|critical]\n";
+            return 1;
+        }
+    }
+
     try {
         client::Client client("127.0.0.1", 8080);
         client.run();
@@ -9,69 +9,102 @@
 
 namespace backend {
 
-ClientBackend::ClientBackend(const std::string& ip, unsigned short port) : logger("./client_backend.log") {
+ClientBackend::ClientBackend(const std::string& ip, unsigned short port)
+: connection(std::make_shared<Connection>(ip, port)), channel(0), logger("./client_backend.log") {
     
-    this -> clientSocket = socket(AF_INET, SOCK_STREAM, 0);
-    
-    if(-1 == this -> clientSocket) {
-        logger.log("[ERROR](ClientBackend::ClientBackend) Failed to create client socket.");
-        throw "Failed to create client socket.";
-    }
-    
-    sockaddr_in serverAddr{};
-    serverAddr.sin_family = AF_INET;
-    serverAddr.sin_port = htons(port);
-    if (inet_pton(AF_INET, ip.c_str(), &serverAddr.sin_addr) <= 0) {
-        close(clientSocket);
-        this -> logger.log("[ERROR](ClientBackend::ClientBackend) Invalid server address.");
-        throw "Invalid server address.";
-    }
-    if (connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == -1){
-        close(clientSocket);
-        this -> logger.log("[ERROR](ClientBackend::ClientBackend) Failed to connect to server.");
-        throw "Failed to connect to server.";
-    }
+    LOG_DEBUG(this -> logger, "(ClientBackend::ClientBackend) Client with id " + std::to_string(this -> connection -> socket()) + " connected to server at " + ip + ":" + std::to_string(port));
+}
+
+ClientBackend::ClientBackend(std::shared_ptr<Connection> connection, uint16_t channel)
+: connection(std::move(connection)), channel(channel), logger("./client_backend.log") {
     
-    this -> logger.log("[DEBUG](ClientBackend::ClientBackend) Client with id " + std::to_string(clientSocket) + " connected to server at " + ip + ":" + std::to_string(port));
+    LOG_DEBUG(this -> logger, "(ClientBackend::ClientBackend) Pane session opened on channel " + std::to_string(channel) + ".");
 }
 
 ClientBackend::~ClientBackend()
 {
-    this -> logger.log("[DEBUG](ClientBackend::~ClientBackend) Socket with id " + std::to_string(this -> clientSocket) + " closed and ClientBackend destroyed with.");
-    close(this -> clientSocket);
-    
+    // channel 0 lives as long as the connection, the others end with their pane
+    if (this -> channel != 0) {
+        this -> connection -> closeChannel(this -> channel);
+    }
+    LOG_DEBUG(this -> logger, "(ClientBackend::~ClientBackend) Channel " + std::to_string(this -> channel) + " closed and ClientBackend destroyed.");
+}
+
+std::unique_ptr<ClientBackend> ClientBackend::openChannel() {
+    uint16_t newChannel = this -> connection -> openChannel();
+    return std::unique_ptr<ClientBackend>(new ClientBackend(this -> connection, newChannel));
 }
 
 std::string ClientBackend::sendCommand(const std::string &command) {
-    std::lock_guard<std::mutex> lock(this -> backendMutex); // Protect access to the socket
+    return awaitResponse(submitCommand(command));
+}
+
+void ClientBackend::sendCommandStreaming(const std::string &command, const Connection::ChunkHandler &onOutput) {
+    uint32_t requestId = submitCommand(command);
     
-    logger.log("[DEBUG](ClientBackend::sendCommand) Sending command to server: " + command);
+    size_t received = 0;
+    this -> connection -> await(requestId, [&](std::string_view chunk) {
+        received += chunk.size();
+        onOutput(chunk);
+    });
     
-    if(command.length() > 1024){
-        this -> logger.log("[ERROR](ClientBackend::sendCommand) Command too long.");
-        throw std::length_error("Command too long.");
-    }
+    LOG_DEBUG(logger, "(ClientBackend::sendCommandStreaming) Streamed " + std::to_string(received) + " bytes from server.");
+}
+
+uint32_t ClientBackend::submitCommand(const std::string &command) {
+    // the pieces of a save carry file content after their first line
+    LOG_DEBUG(logger, "(ClientBackend::submitCommand) Sending command to server: " + command.substr(0, command.find('\n')));
     
-    if(-1 == send(clientSocket, command.c_str(), command.size(), 0)){
-        this -> logger.log("[ERROR](ClientBackend::sendCommand) Failed to send command to server.");
-        throw "Failed to send command to server.";
+    if(command.length() > protocol::MAX_PAYLOAD){
+        LOG_ERROR(this -> logger, "(ClientBackend::submitCommand) Command too long.");
+        throw std::length_error("Command too long.");
     }
     
-    std::vector<char> buffer(8192, '\0');
-    
-    ssize_t bytesRead = recv(clientSocket, buffer.data(), buffer.size() - 1, 0);
+    return this -> connection -> submit(this -> channel, command);
+}
+
+std::string ClientBackend::awaitResponse(uint32_t requestId) {
+    std::string response = this -> connection -> await(requestId);
     
-    if (bytesRead <= 0) {
-        logger.log("[ERROR](ClientBackend::sendCommand) Failed to receive response from server.");
-        throw "Failed to receive response from server.";
+    // file pages and transfer chunks are logged by their first line
+    if (response.size() > 4096) {
+        LOG_DEBUG(logger, "(ClientBackend::awaitResponse) Received response from server: " + response.substr(0, response.find('\n')) +
+                          " (" + std::to_string(response.size()) + " bytes)");
+    } else {
+        LOG_DEBUG(logger, "(ClientBackend::awaitResponse) Received response from server: " + response);
     }
     
-    buffer[bytesRead] = '\0';
-    std::string response(buffer.data());
+    return response;
+}
+
+std::vector<std::string> ClientBackend::sendBatch(const std::vector<std::string>& commands) {
+    std::vector<uint32_t> ids;
+    ids.reserve(commands.size());
+    for (const auto& command : commands) {
+        ids.push_back(submitCommand(command));
+    }
     
-    logger.log("[DEBUG](ClientBackend::sendCommand) Received response from server: " + response);
+    std::vector<std::string> responses;
+    responses.reserve(ids.size());
+    for (uint32_t id : ids) {
+        responses.push_back(awaitResponse(id));
+    }
+    return responses;
+}
+
+void ClientBackend::resizeTerminal(unsigned short rows, unsigned short columns, bool screen) {
+    LOG_DEBUG(logger, "(ClientBackend::resizeTerminal) Terminal size " + std::to_string(rows) + "x" + std::to_string(columns) +
+                      (screen ? " (screen)" : "") + " on channel " + std::to_string(this -> channel) + ".");
     
-    return response;
+    this -> connection -> resizeTerminal(this -> channel, protocol::WindowSize{rows, columns, screen});
+}
+
+void ClientBackend::sendTerminalInput(std::string_view keys) {
+    this -> connection -> sendKeys(this -> channel, keys);
+}
+
+std::string ClientBackend::takeWatchEvents() {
+    return this -> connection -> takeWatchEvents(this -> channel);
 }
 
 void ClientBackend::SetPath(std::string& new_path){
@@ -0,0 +1,357 @@
+//
+//  Connection.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../../headers/Connection.hpp"
+
+#include <unistd.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+#include <algorithm>
+
+namespace backend {
+
+Connection::Connection(const std::string& ip, unsigned short port) : logger("./client_backend.log") {
+
+    this -> clientSocket = ::socket(AF_INET, SOCK_STREAM, 0);
+
+    if(-1 == this -> clientSocket) {
+        LOG_ERROR(logger, "(Connection::Connection) Failed to create client socket.");
+        throw "Failed to create client socket.";
+    }
+
+    sockaddr_in serverAddr{};
+    serverAddr.sin_family = AF_INET;
+    serverAddr.sin_port = htons(port);
+    if (inet_pton(AF_INET, ip.c_str(), &serverAddr.sin_addr) <= 0) {
+        close(clientSocket);
+        LOG_ERROR(this -> logger, "(Connection::Connection) Invalid server address.");
+        throw "Invalid server address.";
+    }
+    if (connect(clientSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == -1){
+        close(clientSocket);
+        LOG_ERROR(this -> logger, "(Connection::Connection) Failed to connect to server.");
+        throw "Failed to connect to server.";
+    }
+    protocol::setNoDelay(clientSocket);
+
+    // responses may come compressed from here on, the server decides frame by frame
+    const char codec = static_cast<char>(protocol::CODEC_DEFLATE);
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::COMPRESSION, 0, 0, std::string_view(&codec, 1))) {
+        LOG_WARN(this -> logger, "(Connection::Connection) Failed to offer compression, responses come as they are.");
+    }
+
+    LOG_DEBUG(this -> logger, "(Connection::Connection) Client with id " + std::to_string(clientSocket) + " connected to server at " + ip + ":" + std::to_string(port));
+}
+
+Connection::~Connection() {
+    LOG_DEBUG(this -> logger, "(Connection::~Connection) Socket with id " + std::to_string(this -> clientSocket) + " closed.");
+    close(this -> clientSocket);
+}
+
+uint16_t Connection::openChannel() {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    uint16_t channel = this -> nextChannel++;
+    if (this -> nextChannel == 0) {
+        this -> nextChannel = 1; // 0 belongs to the first pane
+    }
+    {
+        // a number that wrapped around belongs to the new pane from here on
+        std::lock_guard<std::mutex> retiredLock(this -> retiredMutex);
+        this -> closedChannels.erase(channel);
+        this -> retired.erase(std::remove(this -> retired.begin(), this -> retired.end(), channel), this -> retired.end());
+    }
+
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::CHANNEL_OPEN, channel, 0, {})) {
+        LOG_ERROR(this -> logger, "(Connection::openChannel) Failed to open channel " + std::to_string(channel) + ".");
+        throw "Failed to open channel.";
+    }
+
+    LOG_DEBUG(this -> logger, "(Connection::openChannel) Opened channel " + std::to_string(channel) + ".");
+    return channel;
+}
+
+void Connection::closeChannel(uint16_t channel) {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    // best effort, a pane going away must not throw
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::CHANNEL_CLOSE, channel, 0, {})) {
+        LOG_WARN(this -> logger, "(Connection::closeChannel) Failed to close channel " + std::to_string(channel) + ".");
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> retiredLock(this -> retiredMutex);
+        this -> retired.push_back(channel);
+    }
+    LOG_DEBUG(this -> logger, "(Connection::closeChannel) Closed channel " + std::to_string(channel) + ".");
+}
+
+uint32_t Connection::submit(uint16_t channel, const std::string& command) {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    uint32_t requestId = this -> nextRequestId++;
+
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::REQUEST, channel, requestId, command)) {
+        LOG_ERROR(this -> logger, "(Connection::submit) Failed to send command to server.");
+        throw "Failed to send command to server.";
+    }
+
+    return requestId;
+}
+
+void Connection::resizeTerminal(uint16_t channel, const protocol::WindowSize& size) {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::TERMINAL_RESIZE, channel, 0, protocol::encodeWindowSize(size))) {
+        LOG_ERROR(this -> logger, "(Connection::resizeTerminal) Failed to send terminal size for channel " + std::to_string(channel) + ".");
+        throw "Failed to send terminal size to server.";
+    }
+}
+
+void Connection::sendKeys(uint16_t channel, std::string_view keys) {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    // keystrokes are small, a lost one only shows on the screen, the response read reports a dead connection
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::TERMINAL_INPUT, channel, 0, keys)) {
+        LOG_WARN(this -> logger, "(Connection::sendKeys) Failed to send keystrokes for channel " + std::to_string(channel) + ".");
+    }
+}
+
+std::string Connection::await(uint32_t requestId, const ChunkHandler& onChunk) {
+    std::unique_lock<std::mutex> lock(this -> receiveMutex);
+
+    // wait until the whole response of this request arrived, however large it is; the server answers
+    // in completion order, so whoever reads parks the others' frames and wakes their owners
+    std::string response;
+    while (true) {
+        auto it = this -> completed.find(requestId);
+        if (it != this -> completed.end()) {
+            response = std::move(it -> second.body);
+            this -> completed.erase(it);
+            break;
+        }
+
+        // what another reader parked for us goes out first
+        auto parked = this -> partial.find(requestId);
+        if (onChunk && parked != this -> partial.end() && !parked -> second.body.empty()) {
+            std::string chunk = std::move(parked -> second.body);
+            this -> partial.erase(parked);
+            lock.unlock();
+            onChunk(chunk);
+            lock.lock();
+            continue;
+        }
+
+        if (this -> reading) {
+            this -> arrived.wait(lock);
+            continue;
+        }
+
+        // nobody reads the socket, this caller does until its own response is in
+        this -> reading = true;
+        bool streamed = false;
+        try {
+            streamed = readUntil(requestId, onChunk, lock);
+        } catch (...) {
+            // the next waiter reads and finds the connection dead on its own
+            this -> reading = false;
+            this -> arrived.notify_all();
+            throw;
+        }
+        this -> reading = false;
+        this -> arrived.notify_all();
+        if (streamed) {
+            break;
+        }
+    }
+
+    flushWindowUpdates(0);
+    lock.unlock();
+    if (onChunk && !response.empty()) {
+        onChunk(response);
+        response.clear();
+    }
+    return response;
+}
+
+bool Connection::readUntil(uint32_t requestId, const ChunkHandler& onChunk, std::unique_lock<std::mutex>& lock) {
+    protocol::Frame frame;
+    while (true) {
+        protocol::FrameParser::Result result = this -> parser.next(frame);
+
+        if (result == protocol::FrameParser::Result::FRAME) {
+            if (!decode(frame)) {
+                continue;
+            }
+            // streamed: straight to the caller, the payload is only valid until the next read
+            if (onChunk && frame.header.type == protocol::FrameType::RESPONSE && frame.header.requestId == requestId) {
+                // window is counted per frame, a response larger than the window still flows
+                this -> consumed[frame.header.channel] += frame.header.length;
+                bool last = !frame.hasMore();
+                lock.unlock();
+                onChunk(frame.payload);
+                lock.lock();
+                if (last) {
+                    return true;
+                }
+                continue;
+            }
+            park(frame);
+            if (this -> completed.count(requestId) > 0) {
+                return false;
+            }
+            continue;
+        }
+
+        if (result == protocol::FrameParser::Result::MALFORMED) {
+            LOG_ERROR(logger, "(Connection::readUntil) Malformed response from server.");
+            throw "Malformed response from server.";
+        }
+
+        // everything buffered is parked, its owners take it while this one waits for more
+        this -> arrived.notify_all();
+        flushWindowUpdates(protocol::INITIAL_WINDOW / 4);
+
+        char* space = this -> parser.prepare(8192);
+        lock.unlock();
+        ssize_t bytesRead = recv(clientSocket, space, this -> parser.writable(), 0);
+        lock.lock();
+
+        if (bytesRead <= 0) {
+            LOG_ERROR(logger, "(Connection::readUntil) Failed to receive response from server.");
+            throw "Failed to receive response from server.";
+        }
+
+        this -> parser.commit(bytesRead);
+    }
+}
+
+std::string Connection::takeWatchEvents(uint16_t channel) {
+    std::lock_guard<std::mutex> lock(this -> receiveMutex);
+
+    // a caller in await reads the socket, it parks the events for the next call
+    if (!this -> reading) {
+        protocol::Frame frame;
+        while (true) {
+            protocol::FrameParser::Result result;
+            while ((result = this -> parser.next(frame)) == protocol::FrameParser::Result::FRAME) {
+                if (decode(frame)) {
+                    park(frame);
+                }
+            }
+            if (result == protocol::FrameParser::Result::MALFORMED) {
+                LOG_ERROR(logger, "(Connection::takeWatchEvents) Malformed frame from server.");
+                break;
+            }
+
+            char* space = this -> parser.prepare(8192);
+            ssize_t bytesRead = recv(clientSocket, space, this -> parser.writable(), MSG_DONTWAIT);
+            if (bytesRead <= 0) {
+                // nothing more for now, a dead connection shows up in the next await
+                break;
+            }
+            this -> parser.commit(bytesRead);
+        }
+        flushWindowUpdates(protocol::INITIAL_WINDOW / 4);
+        this -> arrived.notify_all();
+    }
+
+    std::string events;
+    auto parked = this -> watchEvents.find(channel);
+    if (parked != this -> watchEvents.end()) {
+        events = std::move(parked -> second);
+        this -> watchEvents.erase(parked);
+    }
+    return events;
+}
+
+bool Connection::decode(protocol::Frame& frame) {
+    if (!(frame.header.flags & protocol::FLAG_COMPRESSED)) {
+        return true;
+    }
+    if (isClosed(frame.header.channel)) {
+        return false;
+    }
+
+    auto& stream = this -> decompressors[frame.header.channel];
+    if (frame.header.flags & protocol::FLAG_NEW_STREAM) {
+        stream = std::make_unique<protocol::FrameDecompressor>();
+    }
+    if (!stream) {
+        this -> decompressors.erase(frame.header.channel);
+        LOG_DEBUG(this -> logger, "(Connection::decode) Dropping a frame of closed channel " + std::to_string(frame.header.channel) + ".");
+        return false;
+    }
+    if (!stream -> decompress(frame.payload, this -> inflated)) {
+        LOG_ERROR(this -> logger, "(Connection::decode) Corrupt compressed response on channel " + std::to_string(frame.header.channel) + ".");
+        throw "Corrupt compressed response from server.";
+    }
+    frame.payload = this -> inflated;
+    return true;
+}
+
+bool Connection::isClosed(uint16_t channel) {
+    std::lock_guard<std::mutex> lock(this -> retiredMutex);
+    for (uint16_t closed : this -> retired) {
+        this -> decompressors.erase(closed);
+        this -> consumed.erase(closed);
+        this -> watchEvents.erase(closed);
+        std::erase_if(this -> partial, [closed](const auto& entry) { return entry.second.channel == closed; });
+        std::erase_if(this -> completed, [closed](const auto& entry) { return entry.second.channel == closed; });
+        this -> closedChannels.insert(closed);
+    }
+    this -> retired.clear();
+    return this -> closedChannels.count(channel) > 0;
+}
+
+void Connection::park(const protocol::Frame& frame) {
+    // nobody will ask for it, and the server forgot the channel's window
+    if (isClosed(frame.header.channel)) {
+        return;
+    }
+    if (frame.header.type == protocol::FrameType::WATCH_EVENT) {
+        this -> watchEvents[frame.header.channel].append(frame.payload);
+        return;
+    }
+    if (frame.header.type != protocol::FrameType::RESPONSE) {
+        return;
+    }
+
+    // window is counted per frame, a response larger than the window still flows
+    this -> consumed[frame.header.channel] += frame.header.length;
+
+    auto body = this -> partial.find(frame.header.requestId);
+    if (body == this -> partial.end()) {
+        body = this -> partial.emplace(frame.header.requestId, Parked{frame.header.channel, std::string()}).first;
+    }
+    body -> second.body.append(frame.payload);
+
+    if (!frame.hasMore()) {
+        this -> completed[frame.header.requestId] = std::move(body -> second);
+        this -> partial.erase(body);
+    }
+}
+
+void Connection::flushWindowUpdates(uint32_t threshold) {
+    for (auto& [channel, bytes] : this -> consumed) {
+        if (bytes > 0 && bytes >= threshold) {
+            grantWindow(channel, bytes);
+            bytes = 0;
+        }
+    }
+}
+
+void Connection::grantWindow(uint16_t channel, uint32_t bytes) {
+    std::lock_guard<std::mutex> lock(this -> sendMutex);
+
+    if (!protocol::sendMessage(clientSocket, protocol::FrameType::WINDOW_UPDATE, channel, 0, protocol::encodeWindowUpdate(bytes))) {
+        LOG_ERROR(this -> logger, "(Connection::grantWindow) Failed to send window update for channel " + std::to_string(channel) + ".");
+    }
+}
+
+}
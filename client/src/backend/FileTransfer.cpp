@@ -0,0 +1,348 @@
+//
+//  FileTransfer.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../../headers/FileTransfer.hpp"
+#include "../../../common/headers/Checksum.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <sstream>
+#include <algorithm>
+
+namespace backend {
+
+namespace {
+
+bool readFully(int fd, char* out, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t got = pread(fd, out, length, offset);
+        if (got <= 0) {
+            if (got == -1 && errno == EINTR) continue;
+            return false;
+        }
+        out += got;
+        offset += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool writeFully(int fd, const char* data, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t put = pwrite(fd, data, length, offset);
+        if (put == -1) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        data += put;
+        offset += put;
+        length -= static_cast<size_t>(put);
+    }
+    return true;
+}
+
+}
+
+FileTransfer::FileTransfer(ClientBackend& session) : session(session) {}
+
+std::string FileTransfer::get(const std::string& remote, const std::string& local, const Progress& progress) {
+    this -> moved = 0;
+    this -> caution.clear();
+    this -> saved = local;
+    std::string path = remotePath(remote);
+
+    // FILE <size> <mode> <version>, or DIR
+    std::string response = this -> session.sendCommand("get --stat " + path);
+    if (response == "DIR") {
+        return getTree(path, local, progress);
+    }
+    std::istringstream header(response);
+    std::string tag, mode, version;
+    uint64_t size = 0;
+    if (!(header >> tag >> size >> mode >> version) || tag != "FILE") {
+        return response.rfind("Error", 0) == 0 ? response : "Error: unexpected answer to get: " + response;
+    }
+
+    std::string partial = local + ".part";
+    int fd = open(partial.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        std::string error = "Error: Cannot write " + partial + ": " + strerror(errno);
+        if (fd != -1) {
+            close(fd);
+        }
+        return error;
+    }
+
+    uint64_t verified = verifiedChunks(fd, static_cast<uint64_t>(info.st_size), size,
+                                       "get --sums=" + std::to_string(CHUNK) + "," + std::to_string(info.st_size) + " " + path);
+    uint64_t count = (size + CHUNK - 1) / CHUNK;
+
+    std::string error = pump(verified, count, size, [&](uint64_t chunk) {
+        return "get --chunk=" + std::to_string(chunk * CHUNK) + "," + std::to_string(CHUNK) + "," + version + " " + path;
+    }, [&](uint64_t chunk, const std::string& answer) -> std::string {
+        // CHUNK <offset> <length> <checksum>, then the bytes
+        size_t headerEnd = answer.find('\n');
+        if (answer.rfind("CHUNK ", 0) != 0 || headerEnd == std::string::npos) {
+            return answer.empty() ? "Error: empty answer" : answer;
+        }
+        std::istringstream fields(answer.substr(6, headerEnd - 6));
+        uint64_t offset = 0, length = 0, sum = 0;
+        std::string text;
+        std::string_view bytes = std::string_view(answer).substr(headerEnd + 1);
+        if (!(fields >> offset >> length >> text) || !protocol::parseChecksum(text, sum) || offset != chunk * CHUNK ||
+            bytes.size() != length || length != std::min<uint64_t>(CHUNK, size - offset)) {
+            return "Error: chunk at " + std::to_string(chunk * CHUNK) + " came back short";
+        }
+        if (protocol::checksum(bytes) != sum) {
+            return "Error: checksum mismatch at " + std::to_string(offset);
+        }
+        if (!writeFully(fd, bytes.data(), bytes.size(), static_cast<off_t>(offset))) {
+            return "Error: Cannot write " + partial + ": " + strerror(errno);
+        }
+        return "";
+    }, progress);
+
+    // complete: cut what an earlier, longer file left, then it takes its name
+    if (error.empty() && (ftruncate(fd, static_cast<off_t>(size)) == -1 || fsync(fd) == -1 ||
+                          fchmod(fd, static_cast<mode_t>(std::stoul(mode, nullptr, 8))) == -1 ||
+                          rename(partial.c_str(), local.c_str()) == -1)) {
+        error = "Error: Cannot write " + local + ": " + strerror(errno);
+    }
+    close(fd);
+    return error;
+}
+
+std::string FileTransfer::put(const std::string& local, const std::string& remote, const Progress& progress) {
+    this -> moved = 0;
+    this -> caution.clear();
+    std::string path = remotePath(remote);
+
+    int fd = open(local.c_str(), O_RDONLY | O_CLOEXEC);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1 || !S_ISREG(info.st_mode)) {
+        std::string error = "Error: Cannot read " + local + ": " + (fd == -1 ? strerror(errno) : "not a regular file");
+        if (fd != -1) {
+            close(fd);
+        }
+        return error;
+    }
+    uint64_t size = static_cast<uint64_t>(info.st_size);
+
+    // PART <bytes an earlier put left>
+    std::string response = this -> session.sendCommand("put --begin=" + std::to_string(size) + " " + path);
+    if (response.rfind("PART ", 0) != 0) {
+        close(fd);
+        return response.rfind("Error", 0) == 0 ? response : "Error: unexpected answer to put: " + response;
+    }
+    uint64_t partialSize = std::stoull(response.substr(5));
+    uint64_t verified = verifiedChunks(fd, size, partialSize,
+                                       "put --sums=" + std::to_string(CHUNK) + "," + std::to_string(partialSize) + " " + path);
+    uint64_t count = (size + CHUNK - 1) / CHUNK;
+
+    bool unreadable = false;
+    std::string error = pump(verified, count, size, [&](uint64_t chunk) {
+        uint64_t offset = chunk * CHUNK;
+        std::string bytes(std::min<uint64_t>(CHUNK, size - offset), '\0');
+        unreadable = unreadable || !readFully(fd, bytes.data(), bytes.size(), static_cast<off_t>(offset));
+        return "put --data=" + std::to_string(offset) + "," + protocol::formatChecksum(protocol::checksum(bytes)) + " " +
+               path + "\n" + bytes;
+    }, [&](uint64_t, const std::string& answer) -> std::string {
+        return answer == "OK" ? "" : answer;
+    }, progress);
+
+    // a file written to while it was sent would arrive as a mix of both versions
+    struct stat after;
+    if (error.empty() && (unreadable || fstat(fd, &after) == -1 || after.st_size != info.st_size ||
+                          after.st_mtim.tv_sec != info.st_mtim.tv_sec || after.st_mtim.tv_nsec != info.st_mtim.tv_nsec)) {
+        error = "Error: " + local + " changed while it was sent, put it again";
+    }
+    close(fd);
+    if (!error.empty()) {
+        return error;
+    }
+    response = this -> session.sendCommand("put --commit=" + std::to_string(size) + " " + path);
+    return response == "DONE" ? "" : response;
+}
+
+std::string FileTransfer::remotePath(const std::string& remote) const {
+    // the streams are channels of their own, they start in the server's directory and not the session's
+    if ((!remote.empty() && remote[0] == '/') || this -> session.GetPath().empty()) {
+        return remote;
+    }
+    return this -> session.GetPath() + "/" + remote;
+}
+
+std::string FileTransfer::getTree(const std::string& path, const std::string& local, const Progress& progress) {
+    std::string target = local;
+    if (!target.ends_with(".tar.gz") && !target.ends_with(".tgz")) {
+        target += ".tar.gz";
+    }
+    this -> saved = target;
+
+    // an archive is made anew every time, nothing to resume from
+    std::string partial = target + ".part";
+    int fd = open(partial.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd == -1) {
+        return "Error: Cannot write " + partial + ": " + strerror(errno);
+    }
+
+    // TREE <name>, then the archive and the result line; anything else is the error the server answered with
+    std::string head;
+    std::string tail;   // the last TREE_RESULT_SIZE bytes so far, they may be the result line
+    bool started = false;
+    std::string error;
+    try {
+        this -> session.sendCommandStreaming("get --tree " + path, [&](std::string_view chunk) {
+            if (!error.empty()) {
+                return;   // the rest still has to be read off the connection
+            }
+            if (!started) {
+                head.append(chunk);
+                size_t lineEnd = head.find('\n');
+                if (lineEnd == std::string::npos || head.rfind("TREE ", 0) != 0) {
+                    return;
+                }
+                started = true;
+                chunk = std::string_view(head).substr(lineEnd + 1);
+            }
+            tail.append(chunk);
+            if (tail.size() <= TREE_RESULT_SIZE) {
+                return;
+            }
+            size_t ready = tail.size() - TREE_RESULT_SIZE;
+            if (!writeFully(fd, tail.data(), ready, static_cast<off_t>(this -> moved))) {
+                error = "Error: Cannot write " + partial + ": " + strerror(errno);
+                return;
+            }
+            tail.erase(0, ready);
+            this -> moved += ready;
+            if (progress) {
+                progress(this -> moved, 0);
+            }
+        });
+    } catch (const std::exception& e) {
+        error = "Error: " + std::string(e.what());
+    }
+
+    if (error.empty() && !started) {
+        error = head.rfind("Error", 0) == 0 ? head : "Error: unexpected answer to get: " + head.substr(0, 200);
+    }
+    // SKIPPED <count>: the archive is complete as far as it goes, what it misses the user has to know
+    unsigned long long skipped = 0;
+    if (error.empty() && (tail.size() != TREE_RESULT_SIZE || tail.rfind("SKIPPED ", 0) != 0 ||
+                          sscanf(tail.c_str() + 8, "%12llu", &skipped) != 1)) {
+        error = "Error: the archive of " + path + " ended early";
+    }
+    if (error.empty() && skipped > 0) {
+        this -> caution = "Warn: " + std::to_string(skipped) + " entries of " + path +
+                          " could not be read and are missing from the archive, see the server log";
+    }
+    if (error.empty() && (fsync(fd) == -1 || rename(partial.c_str(), target.c_str()) == -1)) {
+        error = "Error: Cannot write " + target + ": " + strerror(errno);
+    }
+    close(fd);
+    if (!error.empty()) {
+        unlink(partial.c_str());
+    }
+    return error;
+}
+
+uint64_t FileTransfer::verifiedChunks(int localFd, uint64_t localSize, uint64_t remoteSize, const std::string& sumsRequest) {
+    uint64_t candidates = std::min(localSize, remoteSize) / CHUNK;
+    if (candidates == 0) {
+        return 0;
+    }
+
+    // SUMS and the checksum of every whole chunk the other side holds
+    std::istringstream sums(this -> session.sendCommand(sumsRequest));
+    std::string tag, text;
+    if (!(sums >> tag) || tag != "SUMS") {
+        return 0;
+    }
+    std::string buffer(CHUNK, '\0');
+    uint64_t chunk = 0;
+    uint64_t sum = 0;
+    while (chunk < candidates && sums >> text && protocol::parseChecksum(text, sum) &&
+           readFully(localFd, buffer.data(), CHUNK, static_cast<off_t>(chunk * CHUNK)) &&
+           protocol::checksum(buffer) == sum) {
+        ++chunk;
+    }
+    return chunk;
+}
+
+std::string FileTransfer::pump(uint64_t first, uint64_t count, uint64_t total, const Request& request, const Check& check,
+                               const Progress& progress) {
+    struct Pending {
+        ClientBackend* stream;
+        uint32_t requestId;
+        uint64_t chunk;
+        int attempts;
+    };
+
+    uint64_t done = std::min(first * CHUNK, total);
+    if (progress) {
+        progress(done, total);
+    }
+    if (first >= count) {
+        return "";
+    }
+
+    // channels of the session's connection, each with its own window for the responses
+    std::vector<std::unique_ptr<ClientBackend>> streams;
+    for (size_t i = 0; i < std::min<uint64_t>(STREAMS, count - first); ++i) {
+        streams.push_back(this -> session.openChannel());
+    }
+
+    std::deque<Pending> inFlight;
+    std::string error;
+    uint64_t next = first;
+    size_t turn = 0;
+    auto submit = [&](uint64_t chunk, int attempts) {
+        ClientBackend* stream = streams[turn++ % streams.size()].get();
+        inFlight.push_back({stream, stream -> submitCommand(request(chunk)), chunk, attempts});
+    };
+
+    while (true) {
+        while (error.empty() && next < count && inFlight.size() < streams.size() * IN_FLIGHT) {
+            submit(next++, 1);
+        }
+        if (inFlight.empty()) {
+            break;
+        }
+
+        // the oldest first, the ones that arrived meanwhile wait parked on the connection
+        Pending pending = inFlight.front();
+        inFlight.pop_front();
+        std::string answer = pending.stream -> awaitResponse(pending.requestId);
+        if (!error.empty()) {
+            continue;   // only draining, nothing may stay parked for a request nobody awaits
+        }
+
+        std::string problem = check(pending.chunk, answer);
+        if (problem.empty()) {
+            uint64_t length = std::min<uint64_t>(CHUNK, total - pending.chunk * CHUNK);
+            done += length;
+            this -> moved += length;
+            if (progress) {
+                progress(done, total);
+            }
+        } else if (pending.attempts < ATTEMPTS) {
+            submit(pending.chunk, pending.attempts + 1);
+        } else {
+            error = problem;
+        }
+    }
+    return error;
+}
+
+}
@@ -7,38 +7,191 @@
 
 #include "../../headers/Logger.hpp"
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+
 using namespace std::filesystem;
 
 namespace logs {
 
-Logger::Logger(const std::string& fileName) {
-    
+Logger::Logger(const std::string& fileName, Mode mode) : mode(mode) {
+
     this -> logFilePath = path(current_path() / "logs" / fileName).string();
-    this -> logFile.open(logFilePath, std::ios::app);
-    if (!this -> logFile.is_open()) {
+    this -> logFd = open(this -> logFilePath.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+    if (this -> logFd == -1) {
         std::cerr << "Error: Unable to open log file: " << this -> logFilePath << "\n";
                    exit(1);
     }
+
+    if (this -> mode == Mode::ASYNC) {
+        this -> ring = std::make_unique<Slot[]>(RING_CAPACITY);
+        for (size_t i = 0; i < RING_CAPACITY; ++i) {
+            this -> ring[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        this -> flusher = std::thread(&Logger::flushLoop, this);
+    }
 }
 
 Logger::~Logger() {
-    if (this -> logFile.is_open()) {
-        this -> logFile.close();
+    if (this -> flusher.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(this -> flusherMutex);
+            this -> stopping = true;
+        }
+        this -> flusherWake.notify_one();
+        this -> flusher.join();
+    }
+    if (this -> logFd != -1) {
+        close(this -> logFd);
     }
 }
 
-void Logger::log(const std::string& message) {
+namespace {
+
+constexpr std::string_view LEVEL_NAMES[] = {"debug", "info", "warn", "error", "security", "critical"};
+constexpr std::string_view LEVEL_TAGS[] = {"[DEBUG]", "[INFO]", "[WARN]", "[ERROR]", "[SECURITY]", "[CRITICAL]"};
+
+}
+
+bool Logger::parseLevel(std::string_view name, Level& level) {
+    for (size_t i = 0; i < std::size(LEVEL_NAMES); ++i) {
+        if (LEVEL_NAMES[i] == name) {
+            level = static_cast<Level>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Logger::log(Level level, const std::string& message) {
+    log(level, std::string(message));
+}
+
+void Logger::log(Level level, std::string&& message) {
+    if (this -> mode == Mode::ASYNC) {
+        push(level, std::move(message));
+        return;
+    }
+
     // Lock for thread-safe access
     std::lock_guard<std::mutex> guard(logMutex);
-    
-    // Get current timestamp
+    std::string line;
+    appendLine(line, std::time(nullptr), level, message);
+    writeOut(line);
+}
+
+void Logger::push(Level level, std::string&& message) {
     std::time_t now = std::time(nullptr);
-    char timeBuffer[20];
-    std::strftime(timeBuffer, sizeof(timeBuffer), "%Y-%m-%d %H:%M:%S", std::localtime(&now));
-    
-    // Write timestamp and message in the file
-    this -> logFile << "[" << timeBuffer << "]" << message << '\n';
-    this -> logFile.flush();
+
+    // claim the slot at head once the flusher gave it back
+    uint64_t position = this -> head.load(std::memory_order_relaxed);
+    Slot* slot;
+    int retries = 0;
+    while (true) {
+        slot = &this -> ring[position & (RING_CAPACITY - 1)];
+        uint64_t sequence = slot -> sequence.load(std::memory_order_acquire);
+        int64_t turn = static_cast<int64_t>(sequence - position);
+        if (turn == 0) {
+            if (this -> head.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (turn < 0) {
+            // full: the flusher gets a few turns to make room before the message is given up
+            if (retries++ == FULL_RETRIES) {
+                this -> dropped.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+            wakeFlusher();
+            std::this_thread::yield();
+            position = this -> head.load(std::memory_order_relaxed);
+        } else {
+            position = this -> head.load(std::memory_order_relaxed);
+        }
+    }
+
+    slot -> time = now;
+    slot -> level = level;
+    slot -> message = std::move(message);
+    slot -> sequence.store(position + 1, std::memory_order_release);
+
+    // a look at the fill level every few slots, half full does not wait for the interval
+    if ((position & (RING_CAPACITY / 16 - 1)) == 0 &&
+        position - this -> tail.load(std::memory_order_relaxed) >= RING_CAPACITY / 2) {
+        wakeFlusher();
+    }
+}
+
+void Logger::wakeFlusher() {
+    this -> flusherWake.notify_one();
+}
+
+void Logger::flushLoop() {
+    std::string batch;
+    std::unique_lock<std::mutex> lock(this -> flusherMutex);
+    while (!this -> stopping) {
+        // producers wake it only when the ring fills up, a notify on every line would cost them a syscall
+        this -> flusherWake.wait_for(lock, FLUSH_INTERVAL);
+        lock.unlock();
+        drain(batch);
+        lock.lock();
+    }
+    lock.unlock();
+    drain(batch);
+}
+
+void Logger::drain(std::string& batch) {
+    batch.clear();
+    uint64_t lost = this -> dropped.exchange(0, std::memory_order_relaxed);
+    if (lost > 0) {
+        appendLine(batch, std::time(nullptr), Level::WARN, "(Logger::drain) " + std::to_string(lost) + " messages dropped, the log fell behind");
+    }
+
+    uint64_t position = this -> tail.load(std::memory_order_relaxed);
+    while (true) {
+        Slot& slot = this -> ring[position & (RING_CAPACITY - 1)];
+        if (slot.sequence.load(std::memory_order_acquire) != position + 1) {
+            break;
+        }
+        appendLine(batch, slot.time, slot.level, slot.message);
+        std::string().swap(slot.message);   // long messages give their memory back here, not in a producer
+        slot.sequence.store(position + RING_CAPACITY, std::memory_order_release);
+        this -> tail.store(++position, std::memory_order_relaxed);
+
+        if (batch.size() >= (1u << 20)) {
+            writeOut(batch);
+            batch.clear();
+        }
+    }
+    if (!batch.empty()) {
+        writeOut(batch);
+    }
+}
+
+void Logger::appendLine(std::string& batch, std::time_t time, Level level, const std::string& message) {
+    // localtime and strftime once a second, not once a line
+    if (time != this -> stampSecond) {
+        struct tm local;
+        localtime_r(&time, &local);
+        std::strftime(this -> stamp, sizeof(this -> stamp), "[%Y-%m-%d %H:%M:%S]", &local);
+        this -> stampSecond = time;
+    }
+    batch += this -> stamp;
+    batch += LEVEL_TAGS[static_cast<size_t>(level)];
+    batch += message;
+    batch += '\n';
+}
+
+void Logger::writeOut(const std::string& batch) {
+    size_t written = 0;
+    while (written < batch.size()) {
+        ssize_t result = write(this -> logFd, batch.data() + written, batch.size() - written);
+        if (result == -1) {
+            if (errno == EINTR) continue;
+            return;   // nowhere left to report it
+        }
+        written += static_cast<size_t>(result);
+    }
 }
 
 }
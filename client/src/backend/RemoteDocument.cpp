@@ -0,0 +1,451 @@
+//
+//  RemoteDocument.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../../headers/RemoteDocument.hpp"
+
+#include <sstream>
+#include <deque>
+#include <chrono>
+#include <algorithm>
+
+namespace backend {
+
+RemoteDocument::RemoteDocument(ClientBackend& session, std::string path) : session(session), path(std::move(path)) {}
+
+RemoteDocument::~RemoteDocument() {
+    // the upload uses the session, which may go away with the document
+    if (saving()) {
+        finishSave();
+    }
+    // a response nobody waits for would stay parked on the connection
+    for (Page& page : this -> pages) {
+        if (page.pending != 0) {
+            this -> session.awaitResponse(page.pending);
+        }
+    }
+}
+
+std::string RemoteDocument::open() {
+    std::string response = this -> session.sendCommand("nano --lines=0," + std::to_string(PAGE_LINES) + " " + this -> path);
+    this -> pages.emplace_back();
+    if (apply(0, response)) {
+        return "";
+    }
+
+    this -> pages.clear();
+    if (response == "NEW_FILE") {
+        // one empty line to type into, like a new file in nano
+        Page page;
+        page.lines = 1;
+        page.text.emplace_back();
+        page.loaded = true;
+        this -> pages.push_back(std::move(page));
+        this -> knownLines = 1;
+        this -> reachedEnd = true;
+    }
+    return response;
+}
+
+bool RemoteDocument::hasLine(size_t index) {
+    while (index >= this -> knownLines && discover()) {}
+    return index < this -> knownLines;
+}
+
+const std::string& RemoteDocument::line(size_t index) {
+    size_t offset;
+    size_t page = locate(index, offset);
+    load(page);
+    return this -> pages[page].text[offset];
+}
+
+std::string& RemoteDocument::editLine(size_t index) {
+    size_t offset;
+    size_t page = locate(index, offset);
+    load(page);
+    touch(page);
+    return this -> pages[page].text[offset];
+}
+
+void RemoteDocument::insertLine(size_t index, std::string text) {
+    size_t offset;
+    size_t page;
+    if (index < this -> knownLines) {
+        page = locate(index, offset);
+    } else {
+        // after the last known line, the lines not paged in yet stay behind it
+        page = this -> pages.size() - 1;
+        while (page > 0 && !this -> pages[page].loaded && this -> pages[page].lines == 0) {
+            --page;
+        }
+        load(page);
+        offset = this -> pages[page].text.size();
+    }
+    load(page);
+
+    Page& target = this -> pages[page];
+    target.text.insert(target.text.begin() + offset, std::move(text));
+    ++target.lines;
+    touch(page);
+    ++this -> knownLines;
+}
+
+void RemoteDocument::eraseLine(size_t index) {
+    size_t offset;
+    size_t page = locate(index, offset);
+    load(page);
+
+    Page& target = this -> pages[page];
+    target.text.erase(target.text.begin() + offset);
+    --target.lines;
+    touch(page);
+    --this -> knownLines;
+}
+
+void RemoteDocument::show(size_t first, size_t count) {
+    // the screen itself waits for its lines, everything else is only requested
+    while (this -> knownLines < first + count && discover()) {}
+    if (this -> knownLines == 0) {
+        return;
+    }
+
+    size_t offset;
+    size_t firstPage = locate(std::min(first, this -> knownLines - 1), offset);
+    size_t lastPage = locate(std::min(first + std::max<size_t>(count, 1), this -> knownLines) - 1, offset);
+
+    size_t from = firstPage > PREFETCH_PAGES ? firstPage - PREFETCH_PAGES : 0;
+    for (size_t page = from; page <= lastPage + PREFETCH_PAGES && page < this -> pages.size(); ++page) {
+        request(page);
+    }
+    // the page after the last known one too, scrolling down a file that was not paged through yet;
+    // not while a save runs, the file it would be read from is about to be replaced
+    if (!this -> reachedEnd && !saving() && lastPage + PREFETCH_PAGES >= this -> pages.size() &&
+        (this -> pages.back().loaded || this -> pages.back().lines > 0)) {
+        Page next;
+        next.firstLine = this -> pages.back().firstLine + this -> pages.back().fileLines;
+        this -> pages.push_back(std::move(next));
+        request(this -> pages.size() - 1);
+    }
+    for (size_t page = firstPage; page <= lastPage; ++page) {
+        load(page);
+    }
+
+    // what was read far away goes again, edits stay until they are saved; so does a page
+    // that edits grew past what one request brings back
+    size_t keepFrom = firstPage > KEPT_PAGES / 2 ? firstPage - KEPT_PAGES / 2 : 0;
+    size_t keepTo = lastPage + KEPT_PAGES / 2;
+    for (size_t page = 0; page < this -> pages.size(); ++page) {
+        Page& candidate = this -> pages[page];
+        if ((page < keepFrom || page > keepTo) && candidate.loaded && !candidate.edited && candidate.pending == 0 &&
+            candidate.placed && candidate.fileLines <= PAGE_LINES) {
+            std::vector<std::string>().swap(candidate.text);
+            candidate.loaded = false;
+        }
+    }
+}
+
+std::string RemoteDocument::text() {
+    while (discover()) {}
+
+    // pipelined, one round trip for all pages that are not loaded
+    for (size_t page = 0; page < this -> pages.size(); ++page) {
+        request(page);
+    }
+    std::string content;
+    for (size_t page = 0; page < this -> pages.size(); ++page) {
+        load(page);
+        for (const std::string& line : this -> pages[page].text) {
+            content += line;
+            content += '\n';
+        }
+    }
+    return content;
+}
+
+size_t RemoteDocument::locate(size_t index, size_t& offset) {
+    for (size_t page = 0; page < this -> pages.size(); ++page) {
+        if (index < this -> pages[page].lines) {
+            offset = index;
+            return page;
+        }
+        index -= this -> pages[page].lines;
+    }
+    throw std::out_of_range("RemoteDocument line out of range");
+}
+
+void RemoteDocument::request(size_t page) {
+    Page& target = this -> pages[page];
+    // while a save runs, pages are only read once it is done and says where they went
+    if (target.loaded || target.pending != 0 || saving()) {
+        return;
+    }
+    target.pending = this -> session.submitCommand("nano --lines=" + std::to_string(target.firstLine) + "," +
+                                                   std::to_string(target.fileLines) + " " + this -> path);
+}
+
+void RemoteDocument::load(size_t page) {
+    if (this -> pages[page].loaded) {
+        return;
+    }
+    if (saving()) {
+        finishSave();
+    }
+    request(page);
+    std::string response = this -> session.awaitResponse(this -> pages[page].pending);
+    this -> pages[page].pending = 0;
+
+    if (!apply(page, response)) {
+        // gone or unreadable on the server meanwhile, its lines stay empty
+        Page& target = this -> pages[page];
+        target.text.assign(target.lines, std::string());
+        target.loaded = true;
+        if (target.lines == 0 && page + 1 == this -> pages.size() && page > 0) {
+            this -> pages.pop_back();
+            this -> reachedEnd = true;
+        }
+    }
+}
+
+bool RemoteDocument::discover() {
+    if (this -> reachedEnd || this -> pages.empty()) {
+        return false;
+    }
+    if (saving()) {
+        finishSave();
+    }
+    size_t before = this -> knownLines;
+    // a page requested ahead is the next one already
+    if (this -> pages.back().loaded || this -> pages.back().lines > 0) {
+        Page next;
+        next.firstLine = this -> pages.back().firstLine + this -> pages.back().fileLines;
+        this -> pages.push_back(std::move(next));
+    }
+    load(this -> pages.size() - 1);
+    return this -> knownLines > before;
+}
+
+bool RemoteDocument::apply(size_t page, const std::string& response) {
+    // LINES <first> <lines> <total or -1> <offset> <length> <file size> <version>, then the bytes of those lines
+    size_t headerEnd = response.find('\n');
+    if (response.rfind("LINES ", 0) != 0 || headerEnd == std::string::npos) {
+        return false;
+    }
+    std::istringstream header(response.substr(6, headerEnd - 6));
+    size_t first = 0, lines = 0, offset = 0, length = 0;
+    uint64_t size = 0;
+    long long total = -1;
+    std::string fileVersion;
+    if (!(header >> first >> lines >> total >> offset >> length >> size >> fileVersion) ||
+        response.size() - headerEnd - 1 != length) {
+        return false;
+    }
+    if (this -> version.empty()) {
+        this -> version = fileVersion;
+        this -> fileSize = size;
+    } else if (fileVersion != this -> version) {
+        // changed on the server since the other pages were read, their offsets do not fit this one
+        this -> stale = true;
+    }
+
+    Page& target = this -> pages[page];
+    target.text.clear();
+    target.text.reserve(lines);
+    size_t start = headerEnd + 1;
+    for (size_t i = 0; i < lines; ++i) {
+        size_t end = response.find('\n', start);
+        if (end == std::string::npos) {
+            end = response.size();   // the last line of a file without a final newline
+        }
+        target.text.emplace_back(response, start, end - start);
+        start = end + 1;
+    }
+    this -> knownLines += lines;
+    this -> knownLines -= target.lines;
+    size_t requested = target.fileLines;
+    target.lines = lines;
+    target.fileLines = lines;
+    target.loaded = true;
+    target.placed = true;
+    target.offset = offset;
+    target.length = length;
+
+    bool last = page + 1 == this -> pages.size();
+    if (last && (lines < requested || (total >= 0 && first + lines >= static_cast<size_t>(total)))) {
+        this -> reachedEnd = true;
+        if (lines == 0 && page > 0) {
+            this -> pages.pop_back();
+        }
+    }
+    return true;
+}
+
+void RemoteDocument::touch(size_t page) {
+    this -> pages[page].edited = true;
+    ++this -> pages[page].edits;
+}
+
+std::string RemoteDocument::save() {
+    if (saving()) {
+        return "Error: a save is already running";
+    }
+    if (this -> stale) {
+        return "Error: " + this -> path + " changed on the server while it was open, not saved";
+    }
+    // pages in flight are read from the original before it is replaced
+    for (size_t page = 0; page < this -> pages.size(); ++page) {
+        if (this -> pages[page].pending != 0) {
+            load(page);
+        }
+    }
+
+    auto plan = std::make_shared<SavePlan>();
+    plan -> base = this -> version.empty() ? "new" : this -> version;
+    auto copy = [&plan](uint64_t at, uint64_t from, uint64_t length) {
+        // neighbouring unedited pages are one range of the original
+        SavePlan::Piece* last = plan -> pieces.empty() ? nullptr : &plan -> pieces.back();
+        if (last != nullptr && last -> copied && last -> at + last -> length == at && last -> from + last -> length == from) {
+            last -> length += length;
+        } else if (length > 0) {
+            SavePlan::Piece piece;
+            piece.at = at;
+            piece.from = from;
+            piece.length = length;
+            piece.copied = true;
+            plan -> pieces.push_back(std::move(piece));
+        }
+    };
+
+    uint64_t at = 0;
+    uint64_t originalEnd = 0;
+    size_t line = 0;
+    for (const Page& page : this -> pages) {
+        Page placed;
+        placed.firstLine = line;
+        placed.edits = page.edits;
+        placed.offset = at;
+        if (page.placed && !page.edited) {
+            copy(at, page.offset, page.length);
+            placed.fileLines = page.fileLines;
+            placed.length = page.length;
+        } else {
+            SavePlan::Piece piece;
+            piece.at = at;
+            for (const std::string& text : page.text) {
+                piece.bytes += text;
+                piece.bytes += '\n';
+            }
+            piece.length = piece.bytes.size();
+            placed.fileLines = page.lines;
+            placed.length = piece.length;
+            if (piece.length > 0) {
+                plan -> pieces.push_back(std::move(piece));
+            }
+        }
+        if (page.placed) {
+            originalEnd = page.offset + page.length;
+        }
+        at += placed.length;
+        line += placed.fileLines;
+        plan -> placed.push_back(std::move(placed));
+    }
+    // the part never paged in is copied as it is
+    if (!this -> reachedEnd && this -> fileSize > originalEnd) {
+        copy(at, originalEnd, this -> fileSize - originalEnd);
+        at += this -> fileSize - originalEnd;
+    }
+    plan -> size = at;
+
+    this -> plan = plan;
+    this -> upload = std::async(std::launch::async, &RemoteDocument::send, std::ref(this -> session), this -> path, std::ref(*plan));
+    return "";
+}
+
+bool RemoteDocument::saveFinished(std::string& result) {
+    if (!saving() || this -> upload.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+        return false;
+    }
+    result = finishSave();
+    return true;
+}
+
+std::string RemoteDocument::finishSave() {
+    std::string result;
+    try {
+        result = this -> upload.get();
+    } catch (const std::exception& e) {
+        result = "Error: " + std::string(e.what());
+    }
+    std::shared_ptr<SavePlan> done = std::move(this -> plan);
+    if (!result.empty()) {
+        return result;
+    }
+
+    // the pages now come from the saved file; one edited during the upload still has changes to save
+    this -> version = done -> version;
+    this -> fileSize = done -> size;
+    for (size_t page = 0; page < done -> placed.size() && page < this -> pages.size(); ++page) {
+        const Page& placed = done -> placed[page];
+        Page& target = this -> pages[page];
+        target.firstLine = placed.firstLine;
+        target.fileLines = placed.fileLines;
+        target.placed = true;
+        target.offset = placed.offset;
+        target.length = placed.length;
+        if (target.edits == placed.edits) {
+            target.edited = false;
+        }
+    }
+    return "";
+}
+
+std::string RemoteDocument::send(ClientBackend& session, const std::string& path, SavePlan& plan) {
+    std::string response = session.sendCommand("nano --save=" + plan.base + " " + path);
+    if (response.rfind("SAVING ", 0) != 0) {
+        return response;
+    }
+    std::string id = response.substr(7);
+
+    // every piece names where it goes, so they are pipelined and may land in any order
+    std::deque<uint32_t> inFlight;
+    std::string error;
+    auto collect = [&]() {
+        std::string answer = session.awaitResponse(inFlight.front());
+        inFlight.pop_front();
+        if (answer != "OK" && error.empty()) {
+            error = answer;
+        }
+    };
+    for (const SavePlan::Piece& piece : plan.pieces) {
+        for (uint64_t done = 0; done < piece.length && error.empty(); done += SAVE_CHUNK) {
+            if (inFlight.size() >= SAVE_WINDOW) {
+                collect();
+            }
+            if (piece.copied) {
+                inFlight.push_back(session.submitCommand("nano --save-copy=" + id + "," + std::to_string(piece.at) + "," +
+                                                         std::to_string(piece.from) + "," + std::to_string(piece.length)));
+                break;
+            }
+            inFlight.push_back(session.submitCommand("nano --save-data=" + id + "," + std::to_string(piece.at + done) + "\n" +
+                                                     piece.bytes.substr(done, SAVE_CHUNK)));
+        }
+    }
+    while (!inFlight.empty()) {
+        collect();
+    }
+    if (!error.empty()) {
+        session.sendCommand("nano --save-abort=" + id);
+        return error;
+    }
+
+    response = session.sendCommand("nano --save-commit=" + id + "," + std::to_string(plan.size));
+    if (response.rfind("SAVED ", 0) != 0) {
+        return response;
+    }
+    plan.version = response.substr(6);
+    return "";
+}
+
+}
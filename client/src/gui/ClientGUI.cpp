@@ -24,29 +24,31 @@ cursorBlinkInterval(sf::seconds(0.5f)) {
         setupTexts();
         initializeCursor();
         
-        guiLogger.log("[DEBUG](ClientGUI::ClientGUI) GUI initialized successfully.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::ClientGUI) GUI initialized successfully.");
     }
     catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::ClientGUI) An error occured during initialization: " + std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::ClientGUI) An error occured during initialization: " + std::string(e.what()));
     }
 }
 
 ClientGUI::~ClientGUI() {
     try {
         // Log destructor entry
-        guiLogger.log("[DEBUG](ClientGUI::~ClientGUI) Starting destructor.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::~ClientGUI) Starting destructor.");
         
         // Close the window if it's still open
         if (window.isOpen()) {
             window.close();
-            guiLogger.log("[INFO](ClientGUI::~ClientGUI) Window closed.");
+            LOG_INFO(guiLogger, "(ClientGUI::~ClientGUI) Window closed.");
         }
         
         // Clean up panes
         for (auto& pane : panes) {
             // Explicitly close backend connections
+            // a get or put still running uses the backend, it finishes first
+            pane.transfer.reset();
             if (pane.backend) {
-                guiLogger.log("[DEBUG](ClientGUI::~ClientGUI) Closing pane backend.");
+                LOG_DEBUG(guiLogger, "(ClientGUI::~ClientGUI) Closing pane backend.");
                 // The unique_ptr will automatically delete the backend
                 pane.backend.reset();
             }
@@ -56,13 +58,13 @@ ClientGUI::~ClientGUI() {
         panes.clear();
         
         // Log successful cleanup
-        guiLogger.log("[DEBUG](ClientGUI::~ClientGUI) Destructor completed successfully.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::~ClientGUI) Destructor completed successfully.");
     }
     catch (const std::exception& e) {
         // Log any errors during destruction
         try {
-            guiLogger.log("[ERROR](ClientGUI::~ClientGUI) Exception during destruction: " +
-                          std::string(e.what()));
+            LOG_ERROR(guiLogger, "(ClientGUI::~ClientGUI) Exception during destruction: " +
+                                 std::string(e.what()));
         }
         catch (...) {
             // Fallback error logging in case logger fails
@@ -72,7 +74,7 @@ ClientGUI::~ClientGUI() {
     catch (...) {
         // Catch any unexpected errors
         try {
-            guiLogger.log("[CRITICAL](ClientGUI::~ClientGUI) Unknown error during destruction.");
+            LOG_CRITICAL(guiLogger, "(ClientGUI::~ClientGUI) Unknown error during destruction.");
         }
         catch (...) {
             std::cerr << "Critical unknown error in ClientGUI destructor" << std::endl;
@@ -85,16 +87,16 @@ void ClientGUI::initializeWindow() {
     this -> window.create(sf::VideoMode(1280, 720), "Client RemMux", sf::Style::Resize | sf::Style::Default);
     this -> window.setFramerateLimit(60);
     this -> window.setVerticalSyncEnabled(true);
-    guiLogger.log("[DEBUG](ClientGUI::ClientGUI) Window initialized successfully.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::ClientGUI) Window initialized successfully.");
 }
 
 void ClientGUI::loadFont() {
     std::string fontPath = path(current_path() / "assets" / "arial.ttf").string();
     if (!this -> font.loadFromFile(fontPath)) {
-        guiLogger.log("[ERROR](ClientGUI::loadFont) Failed to load font from path: " + fontPath);
+        LOG_ERROR(guiLogger, "(ClientGUI::loadFont) Failed to load font from path: " + fontPath);
         throw std::runtime_error("Failed to load font from path: " + fontPath);
     }
-    guiLogger.log("[DEBUG](ClientGUI::loadFont) Font loaded successfully from path: " + fontPath);
+    LOG_DEBUG(guiLogger, "(ClientGUI::loadFont) Font loaded successfully from path: " + fontPath);
 }
 
 void ClientGUI::setupTexts(){
@@ -121,7 +123,7 @@ void ClientGUI::setupTexts(){
     this -> inputText.setString(initialText);
     this -> outputText.setString("");
     
-    guiLogger.log("[DEBUG](ClientGui::setupTexts) Text elements configured successfully.");
+    LOG_DEBUG(guiLogger, "(ClientGui::setupTexts) Text elements configured successfully.");
 }
 
 void ClientGUI::initializeCursor() {
@@ -150,7 +152,7 @@ void ClientGUI::initializeCursor() {
     this -> cursorBlinkInterval = sf::seconds(0.5f);
     this -> cursorVisible = true;
     
-    guiLogger.log("[DEBUG](ClientGUI::initializeCursor) Cursor initialized successfully.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::initializeCursor) Cursor initialized successfully.");
     
 }
 
@@ -181,8 +183,8 @@ void ClientGUI::updateCursor() {
     cursor.setPosition(cursorOffset, this -> inputText.getPosition().y + 3);
     cursor.setSize(sf::Vector2f(2, this -> inputText.getCharacterSize()));
     
-    guiLogger.log("[DEBUG](ClientGUI::updateCursor) Cursor positioned at: " +
-                  std::to_string(cursorOffset) + ", Position: " + std::to_string(cursorPosition));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updateCursor) Cursor positioned at: " +
+                         std::to_string(cursorOffset) + ", Position: " + std::to_string(cursorPosition));
 }
 
 void ClientGUI::updateTerminalDisplay() {
@@ -222,25 +224,25 @@ void ClientGUI::updateTerminalDisplay() {
             inputYPosition = newInputYPosition;
             this -> inputText.setPosition(0, inputYPosition);
             
-            guiLogger.log("[DEBUG](ClientGUI::updateTerminalDisplay) Position Updated: " +
-                          std::to_string(inputYPosition) +
-                          ", Output Height: " + std::to_string(outputHeight));
+            LOG_DEBUG(guiLogger, "(ClientGUI::updateTerminalDisplay) Position Updated: " +
+                                 std::to_string(inputYPosition) +
+                                 ", Output Height: " + std::to_string(outputHeight));
         }
         
         
         
         // Debug logging
-        this -> guiLogger.log("[DEBUG](ClientGUI::updateTerminalDisplay) Input Y Position: " +
-                              std::to_string(inputYPosition) +
-                              ". Total lines: " + std::to_string(this -> terminalLines.size()));
+        LOG_DEBUG(this -> guiLogger, "(ClientGUI::updateTerminalDisplay) Input Y Position: " +
+                                     std::to_string(inputYPosition) +
+                                     ". Total lines: " + std::to_string(this -> terminalLines.size()));
     }
     catch (const std::exception& e) {
         // Log any exception that occurs
-        this -> guiLogger.log("[ERROR](ClientGUI::updateTerminalDisplay) Exception: " + std::string(e.what()));
+        LOG_ERROR(this -> guiLogger, "(ClientGUI::updateTerminalDisplay) Exception: " + std::string(e.what()));
     }
     catch (...) {
         // Log any unknown exception
-        this -> guiLogger.log("[ERROR](ClientGUI::updateTerminalDisplay) Unknown exception occurred");
+        LOG_ERROR(this -> guiLogger, "(ClientGUI::updateTerminalDisplay) Unknown exception occurred");
     }
 }
 
@@ -268,8 +270,8 @@ void ClientGUI::updateScrollBar() {
         this -> scrollBar.setSize(sf::Vector2f(0,0));
     }
     
-    guiLogger.log("[DEBUG](ClientGUI::updateScrollBar) Updated scroll bar. Total lines: " + std::to_string(this -> terminalLines.size()) +
-                  ", Visible lines: " + std::to_string(maxVisibleLines) + ", Scroll position: " + std::to_string(this -> scrollPosition));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updateScrollBar) Updated scroll bar. Total lines: " + std::to_string(this -> terminalLines.size()) +
+                         ", Visible lines: " + std::to_string(maxVisibleLines) + ", Scroll position: " + std::to_string(this -> scrollPosition));
     
 }
 
@@ -290,9 +292,9 @@ void ClientGUI::scrollUp(int lines) {
         updateTerminalDisplay();
         updateScrollBar();
         
-        guiLogger.log("[DEBUG](ClientGUI::scrollUp) Scrolled up " +
-                      std::to_string(lines) + " lines. Current scroll position: " +
-                      std::to_string(this -> scrollPosition));
+        LOG_DEBUG(guiLogger, "(ClientGUI::scrollUp) Scrolled up " +
+                             std::to_string(lines) + " lines. Current scroll position: " +
+                             std::to_string(this -> scrollPosition));
     }
 }
 
@@ -306,9 +308,9 @@ void ClientGUI::scrollDown(int lines) {
         updateTerminalDisplay();
         updateScrollBar();
         
-        guiLogger.log("[DEBUG](ClientGUI::scrollDown) Scrolled down " +
-                      std::to_string(lines) + " lines. Current scroll position: " +
-                      std::to_string(this -> scrollPosition));
+        LOG_DEBUG(guiLogger, "(ClientGUI::scrollDown) Scrolled down " +
+                             std::to_string(lines) + " lines. Current scroll position: " +
+                             std::to_string(this -> scrollPosition));
     }
 }
 
@@ -316,7 +318,7 @@ void ClientGUI::navigateCommandHistory(bool goUp) {
     std::string currentPath = this -> backend.GetPath() + "> ";
     
     if (this -> commandHistory.empty()) {
-        guiLogger.log("[DEBUG](ClientGUI::navigateCommandHistory) No commands in history.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigateCommandHistory) No commands in history.");
         return;
     }
     
@@ -344,14 +346,14 @@ void ClientGUI::navigateCommandHistory(bool goUp) {
         
         this -> cursorPosition = this -> commandHistory[this -> currentHistoryIndex].length();
         
-        guiLogger.log("[DEBUG](ClientGUI::navigateCommandHistory) Selected command: '" +
-                      this -> commandHistory[this -> currentHistoryIndex] +
-                      "'. Index: " + std::to_string(this -> currentHistoryIndex));
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigateCommandHistory) Selected command: '" +
+                             this -> commandHistory[this -> currentHistoryIndex] +
+                             "'. Index: " + std::to_string(this -> currentHistoryIndex));
     } else {
         this -> inputText.setString(currentPath);
         this -> cursorPosition = 0;
         
-        guiLogger.log("[DEBUG](ClientGUI::navigateCommandHistory) Reset to initial state.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigateCommandHistory) Reset to initial state.");
     }
     
     updateCursor();
@@ -384,7 +386,7 @@ void ClientGUI::handleSpecialInput(sf::Event event) {
             break;
     }
     
-    guiLogger.log("[DEBUG](ClientGUI::handleSpecialInput) Processed special input.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::handleSpecialInput) Processed special input.");
     
     updateCursor();
     
@@ -397,7 +399,7 @@ void ClientGUI::processNanoInput(sf::Event event) {
         event.key.code == sf::Keyboard::X &&
         sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
         
-        guiLogger.log("[INFO](ClientGUI::processNanoInput) Exiting nano editor.");
+        LOG_INFO(guiLogger, "(ClientGUI::processNanoInput) Exiting nano editor.");
         exitNanoEditorMode();
         return;
     }
@@ -407,7 +409,7 @@ void ClientGUI::processNanoInput(sf::Event event) {
         event.key.code == sf::Keyboard::O &&
         sf::Keyboard::isKeyPressed(sf::Keyboard::LControl)) {
         
-        guiLogger.log("[INFO](ClientGUI::processNanoInput) Saving file.");
+        LOG_INFO(guiLogger, "(ClientGUI::processNanoInput) Saving file.");
         this->nanoCursor.column = 0;
         this->nanoCursor.line = 0;
         saveNanoFile();
@@ -421,15 +423,15 @@ void ClientGUI::processNanoInput(sf::Event event) {
                 if (this -> nanoCursor.line > 0) {
                     this -> nanoCursor.line--;
                     this -> nanoCursor.column = std::min(this -> nanoCursor.column,
-                                                         this->editorLines[this -> nanoCursor.line].length());
+                                                         this -> document -> line(this -> nanoCursor.line).length());
                 }
                 break;
                 
             case sf::Keyboard::Down:
-                if (this -> nanoCursor.line < this->editorLines.size() - 1) {
+                if (this -> document -> hasLine(this -> nanoCursor.line + 1)) {
                     this -> nanoCursor.line++;
                     this -> nanoCursor.column = std::min(this -> nanoCursor.column,
-                                                         this -> editorLines[this -> nanoCursor.line].length());
+                                                         this -> document -> line(this -> nanoCursor.line).length());
                 }
                 break;
                 
@@ -439,15 +441,15 @@ void ClientGUI::processNanoInput(sf::Event event) {
                 }
                 else if (this -> nanoCursor.line > 0) {
                     this -> nanoCursor.line--;
-                    this -> nanoCursor.column = this->editorLines[this -> nanoCursor.line].length();
+                    this -> nanoCursor.column = this -> document -> line(this -> nanoCursor.line).length();
                 }
                 break;
                 
             case sf::Keyboard::Right:
-                if (this -> nanoCursor.column < this->editorLines[this -> nanoCursor.line].length()) {
+                if (this -> nanoCursor.column < this -> document -> line(this -> nanoCursor.line).length()) {
                     this -> nanoCursor.column++;
                 }
-                else if (this -> nanoCursor.line < this -> editorLines.size() - 1) {
+                else if (this -> document -> hasLine(this -> nanoCursor.line + 1)) {
                     this -> nanoCursor.line++;
                     this -> nanoCursor.column = 0;
                 }
@@ -466,8 +468,8 @@ void ClientGUI::processNanoInput(sf::Event event) {
         char inputChar = static_cast<char>(event.text.unicode);
         
         // Ensure at least one line exists
-        if (this -> editorLines.empty()) {
-            this -> editorLines.push_back("");
+        if (this -> document -> lineCount() == 0) {
+            this -> document -> insertLine(0, "");
             this -> nanoCursor = {0, 0, 0};
         }
         
@@ -475,15 +477,12 @@ void ClientGUI::processNanoInput(sf::Event event) {
             case '\r':  // Enter
             case '\n': {
                 // Split current line at cursor position
-                std::string& currentLine = this -> editorLines[this -> nanoCursor.line];
+                std::string& currentLine = this -> document -> editLine(this -> nanoCursor.line);
                 std::string secondPart = currentLine.substr(this -> nanoCursor.column);
                 currentLine = currentLine.substr(0, this -> nanoCursor.column);
                 
                 // Insert new line
-                this->editorLines.insert(
-                                         this->editorLines.begin() + this -> nanoCursor.line + 1,
-                                         secondPart
-                                         );
+                this -> document -> insertLine(this -> nanoCursor.line + 1, secondPart);
                 
                 // Move cursor to start of new line
                 nanoCursor.line++;
@@ -494,21 +493,17 @@ void ClientGUI::processNanoInput(sf::Event event) {
             case '\b':  // Backspace
                 if (nanoCursor.column > 0) {
                     // Remove character before cursor
-                    this->editorLines[nanoCursor.line].erase(
-                                                             nanoCursor.column - 1, 1
-                                                             );
+                    this -> document -> editLine(nanoCursor.line).erase(nanoCursor.column - 1, 1);
                     nanoCursor.column--;
                 }
                 else if (nanoCursor.line > 0) {
                     // Merge with previous line
-                    size_t prevLineLength = this->editorLines[nanoCursor.line - 1].length();
-                    this->editorLines[nanoCursor.line - 1] +=
-                    this->editorLines[nanoCursor.line];
+                    std::string currentLine = this -> document -> line(nanoCursor.line);
+                    size_t prevLineLength = this -> document -> line(nanoCursor.line - 1).length();
+                    this -> document -> editLine(nanoCursor.line - 1) += currentLine;
                     
                     // Remove current line
-                    this->editorLines.erase(
-                                            this->editorLines.begin() + nanoCursor.line
-                                            );
+                    this -> document -> eraseLine(nanoCursor.line);
                     
                     // Move cursor
                     nanoCursor.line--;
@@ -520,9 +515,7 @@ void ClientGUI::processNanoInput(sf::Event event) {
                 // Printable characters
                 if (inputChar >= 32 && inputChar <= 126) {
                     // Insert character at cursor position
-                    this->editorLines[nanoCursor.line].insert(
-                                                              nanoCursor.column, 1, inputChar
-                                                              );
+                    this -> document -> editLine(nanoCursor.line).insert(nanoCursor.column, 1, inputChar);
                     nanoCursor.column++;
                 }
                 break;
@@ -535,38 +528,42 @@ void ClientGUI::processNanoInput(sf::Event event) {
 
 void ClientGUI::saveNanoFile() {
     try {
-        // Prepare file content
-        std::string fileContent;
-        for (const auto& line : this->editorLines) {
-            fileContent += line + "\n";
-        }
-        
-        // Open local file for writing
-        std::ofstream file(this -> currentEditingFile);
-        if (!file.is_open()) {
-            throw std::runtime_error("Couldn't open file for writing");
+        // written back on the server, the upload runs on its own thread while editing goes on
+        std::string error = this -> document -> save();
+        if (!error.empty()) {
+            throw std::runtime_error(error);
         }
         
-        // Write content
-        file << fileContent;
-        file.close();
-        
-        // Log and confirm
-        guiLogger.log("[INFO](ClientGUI::saveNanoFile) File saved: " +
-                      this->currentEditingFile);
+        LOG_INFO(guiLogger, "(ClientGUI::saveNanoFile) Saving file: " +
+                            this->currentEditingFile);
         
-        this -> savedMessage = "File Saved!";
+        this -> savedMessage = "Saving...";
         
         refreshNanoDisplay();
     }
     catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::saveNanoFile) Save failed: " +
-                      std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::saveNanoFile) Save failed: " +
+                             std::string(e.what()));
         
         this -> savedMessage = "Save Failed!";
     }
 }
 
+void ClientGUI::finishNanoSave() {
+    std::string result;
+    if (!this -> document || !this -> document -> saveFinished(result)) {
+        return;
+    }
+    
+    if (result.empty()) {
+        LOG_INFO(guiLogger, "(ClientGUI::finishNanoSave) File saved: " + this -> currentEditingFile);
+        this -> savedMessage = "File Saved!";
+    } else {
+        LOG_ERROR(guiLogger, "(ClientGUI::finishNanoSave) Save failed: " + result);
+        this -> savedMessage = "Save Failed!";
+    }
+}
+
 std::vector<std::string> ClientGUI::wrapLines(const std::string& originalLine, float maxWidth) {
     std::vector<std::string> wrappedLines;
     sf::Text testText;
@@ -601,7 +598,7 @@ std::vector<std::string> ClientGUI::wrapLines(const std::string& originalLine, f
 
 void ClientGUI::refreshNanoDisplay() {
     // Log entry point
-    guiLogger.log("[DEBUG](ClientGUI::refreshNanoDisplay) Starting nano display refresh");
+    LOG_DEBUG(guiLogger, "(ClientGUI::refreshNanoDisplay) Starting nano display refresh");
     
     // Prepare content text configuration
     sf::Text contentText;
@@ -612,36 +609,39 @@ void ClientGUI::refreshNanoDisplay() {
     // Determine visible lines based on window size
     size_t maxVisibleLines = (window.getSize().y - 100) / 25;
     float maxWidth = window.getSize().x - 30;
+    
+    // only the lines on screen are fetched, the pages around them are requested ahead
+    this -> document -> show(nanoCursor.scrollOffset, maxVisibleLines);
     std::vector<std::string> fullWrappedLines;
     for (size_t i = nanoCursor.scrollOffset;
-         i < std::min(nanoCursor.scrollOffset + maxVisibleLines, this->editorLines.size());
+         i < std::min(nanoCursor.scrollOffset + maxVisibleLines, this -> document -> lineCount());
          ++i) {
-        std::vector<std::string> currentfullWrappedLines = wrapLines(this->editorLines[i], maxWidth);
+        std::vector<std::string> currentfullWrappedLines = wrapLines(this -> document -> line(i), maxWidth);
         fullWrappedLines.insert(fullWrappedLines.end(), currentfullWrappedLines.begin(), currentfullWrappedLines.end());
     }
     
     
     // Log initial scroll state
-    guiLogger.log("[DEBUG](ClientGUI::refreshNanoDisplay) Initial scroll state : Line: " + std::to_string(nanoCursor.line) +
-                  ", Scroll Offset: " + std::to_string(nanoCursor.scrollOffset) +
-                  ", Max Visible Lines: " + std::to_string(maxVisibleLines));
+    LOG_DEBUG(guiLogger, "(ClientGUI::refreshNanoDisplay) Initial scroll state : Line: " + std::to_string(nanoCursor.line) +
+                         ", Scroll Offset: " + std::to_string(nanoCursor.scrollOffset) +
+                         ", Max Visible Lines: " + std::to_string(maxVisibleLines));
     
     // Adjust scroll offset if cursor is out of view
     if (nanoCursor.line < nanoCursor.scrollOffset) {
         nanoCursor.scrollOffset = nanoCursor.line;
-        guiLogger.log("[INFO](ClientGUI::refreshNanoDisplay) Adjusted scroll offset down");
+        LOG_INFO(guiLogger, "(ClientGUI::refreshNanoDisplay) Adjusted scroll offset down");
     }
     if (nanoCursor.line >= nanoCursor.scrollOffset + maxVisibleLines) {
         nanoCursor.scrollOffset = nanoCursor.line - maxVisibleLines + 1;
-        guiLogger.log("[INFO](ClientGUI::refreshNanoDisplay) Adjusted scroll offset up");
+        LOG_INFO(guiLogger, "(ClientGUI::refreshNanoDisplay) Adjusted scroll offset up");
     }
     
     // Log updated scroll state
-    guiLogger.log("[DEBUG](ClientGUI::refreshNanoDisplay) Updated scroll state : Line: " + std::to_string(nanoCursor.line) +
-                  ", Scroll Offset: " + std::to_string(nanoCursor.scrollOffset));
+    LOG_DEBUG(guiLogger, "(ClientGUI::refreshNanoDisplay) Updated scroll state : Line: " + std::to_string(nanoCursor.line) +
+                         ", Scroll Offset: " + std::to_string(nanoCursor.scrollOffset));
     
     // Prepare full line text
-    std::string fullLineText = this->editorLines[nanoCursor.line];
+    std::string fullLineText = this -> document -> line(nanoCursor.line);
     contentText.setString(fullLineText);
     
     // Calculate cursor position more precisely
@@ -700,9 +700,10 @@ void ClientGUI::refreshNanoDisplay() {
     }
     
     // Log rendering details
-    guiLogger.log("[DEBUG](ClientGUI::refreshNanoDisplay) Rendered lines: " +
-                  std::to_string(fullWrappedLines.size()) +
-                  ", Total lines: " + std::to_string(this->editorLines.size()));
+    LOG_DEBUG(guiLogger, "(ClientGUI::refreshNanoDisplay) Rendered lines: " +
+                         std::to_string(fullWrappedLines.size()) +
+                         ", Total lines: " + std::to_string(this -> document -> lineCount()) +
+                         (this -> document -> complete() ? "" : "+"));
     
     // Footer text
     sf::Text footerText;
@@ -739,7 +740,7 @@ void ClientGUI::refreshNanoDisplay() {
         sf::Text cursorText;
         cursorText.setFont(this->font);
         cursorText.setCharacterSize(20);
-        cursorText.setString(this->editorLines[nanoCursor.line].substr(0, nanoCursor.column));
+        cursorText.setString(this -> document -> line(nanoCursor.line).substr(0, nanoCursor.column));
         sf::Vector2f cursorPos = cursorText.findCharacterPos(nanoCursor.column);
         
         sf::RectangleShape cursor;
@@ -756,12 +757,12 @@ void ClientGUI::refreshNanoDisplay() {
     this -> window.draw(sprite);
     this -> window.display();
     
-    guiLogger.log("[DEBUG](ClientGUI::refreshNanoDisplay) Nano display refresh complete");
+    LOG_DEBUG(guiLogger, "(ClientGUI::refreshNanoDisplay) Nano display refresh complete");
 }
 
-void ClientGUI::enterNanoEditorMode(const std::string& fileContent, const std::string& fileName) {
+void ClientGUI::enterNanoEditorMode(std::unique_ptr<backend::RemoteDocument> document, const std::string& fileName) {
     // Log entry into nano editor mode
-    guiLogger.log("[INFO](ClientGUI::enterNanoEditorMode) Entering Nano Editor Mode.");
+    LOG_INFO(guiLogger, "(ClientGUI::enterNanoEditorMode) Entering Nano Editor Mode.");
     
     // reset the cursor to 0
     this -> nanoCursor = {0, 0, 0};
@@ -778,29 +779,18 @@ void ClientGUI::enterNanoEditorMode(const std::string& fileContent, const std::s
     // Save filename
     this->currentEditingFile = fileName;
     
-    // Reset editor lines
-    this->editorLines.clear();
-    
-    // Split content into lines
-    if(!fileContent.empty()) {
-        std::istringstream contentStream(fileContent);
-        std::string line;
-        while (std::getline(contentStream, line)) {
-            this->editorLines.push_back(line);
-        }
-    } else {
-        this->editorLines.push_back("");
-    }
+    // the first page is loaded, the rest follows the scrolling
+    this -> document = std::move(document);
     
     // Logging
-    guiLogger.log("[DEBUG](ClientGUI::enterNanoEditorMode) Loaded " +
-                  std::to_string(this->editorLines.size()) + " lines.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::enterNanoEditorMode) Loaded " +
+                         std::to_string(this -> document -> lineCount()) + (this -> document -> complete() ? "" : "+") + " lines.");
     
     refreshNanoDisplay();
 }
 
 void ClientGUI::exitNanoEditorMode() {
-    guiLogger.log("[INFO](ClientGUI::exitNanoEditor) Exiting Nano Editor Mode.");
+    LOG_INFO(guiLogger, "(ClientGUI::exitNanoEditor) Exiting Nano Editor Mode.");
     
     //thread safe access
     std::lock_guard<std::mutex> lock(this -> ModeMutex);
@@ -812,24 +802,24 @@ void ClientGUI::exitNanoEditorMode() {
     this -> cursor.setSize(sf::Vector2f(2, this -> inputText.getCharacterSize()));
     
     // Reset editor state
-    this -> editorLines.clear();
+    this -> document.reset();
     this -> currentEditingFile = "";
     
     // Restore terminal state
     std::string currentPath = this -> backend.GetPath() + "> ";
     this->inputText.setString(currentPath);
     
-    guiLogger.log("[DEBUG](ClientGUI::exitNanoEditor) Nano editor state reset.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::exitNanoEditor) Nano editor state reset.");
 }
 
 // pane functions
 void ClientGUI::createNewPane(SplitType splitType) {
     // Log entry point and current state
-    guiLogger.log("[DEBUG](ClientGUI::createNewPane) Entering method.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::createNewPane) Entering method.");
     
     // Pane limit check
     if (panes.size() >= 4) {
-        guiLogger.log("[WARN](ClientGUI::createNewPane) Maximum pane limit (4) reached.");
+        LOG_WARN(guiLogger, "(ClientGUI::createNewPane) Maximum pane limit (4) reached.");
         addLineToTerminal("Maximum panes (4) reached!");
         return;
     }
@@ -840,8 +830,8 @@ void ClientGUI::createNewPane(SplitType splitType) {
             Pane initialPane;
             initialPane.splitType = splitType;
             
-            // new Backend
-            initialPane.backend = std::make_unique<backend::ClientBackend>("127.0.0.1", 8080);
+            // new Backend, a channel on the main connection
+            initialPane.backend = this -> backend.openChannel();
             
             // Initialize current path
             std::string path = current_path().string();
@@ -871,8 +861,8 @@ void ClientGUI::createNewPane(SplitType splitType) {
         Pane newPane;
         newPane.splitType = splitType;
         
-        // Backend creation
-        newPane.backend = std::make_unique<backend::ClientBackend>("127.0.0.1", 8080);
+        // Backend creation, no new TCP connection per pane
+        newPane.backend = this -> backend.openChannel();
         
         // Initialize current path
         std::string path = current_path().string();
@@ -914,13 +904,13 @@ void ClientGUI::createNewPane(SplitType splitType) {
         updatePaneTerminalDisplay(panes[currentPaneIndex]);
         
         // Log pane creation summary
-        guiLogger.log("[DEBUG](ClientGUI::createNewPane) New pane created successfully");
-        guiLogger.log("[DEBUG](ClientGUI::createNewPane) Total panes now: " + std::to_string(panes.size()));
-        guiLogger.log("[DEBUG](ClientGUI::createNewPane) Current pane index: " + std::to_string(currentPaneIndex));
+        LOG_DEBUG(guiLogger, "(ClientGUI::createNewPane) New pane created successfully");
+        LOG_DEBUG(guiLogger, "(ClientGUI::createNewPane) Total panes now: " + std::to_string(panes.size()));
+        LOG_DEBUG(guiLogger, "(ClientGUI::createNewPane) Current pane index: " + std::to_string(currentPaneIndex));
         
     }
     catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::createNewPane) Pane creation failed: " + std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::createNewPane) Pane creation failed: " + std::string(e.what()));
         addLineToTerminal("Pane creation error: " + std::string(e.what()));
     }
 }
@@ -949,33 +939,33 @@ void ClientGUI::initializePaneCursor(Pane& pane) {
     // initiate the cursor position
     pane.cursorPosition = 0.0f;
     
-    guiLogger.log("[DEBUG](ClientGUI::initializePaneCursor) Pane cursor initialized successfully.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::initializePaneCursor) Pane cursor initialized successfully.");
 }
 
 void ClientGUI::updatePaneBounds() {
     // Comprehensive logging and diagnostic information
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Starting pane bounds update");
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Starting pane bounds update");
     
     // Get window dimensions
     sf::Vector2u windowSize = window.getSize();
     size_t paneCount = panes.size();
     
     // Log critical information
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Window dimensions: " +
-                  std::to_string(windowSize.x) + "x" +
-                  std::to_string(windowSize.y));
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Total panes: " + std::to_string(paneCount));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Window dimensions: " +
+                         std::to_string(windowSize.x) + "x" +
+                         std::to_string(windowSize.y));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Total panes: " + std::to_string(paneCount));
     
     // Validate pane count
     if (paneCount == 0) {
-        guiLogger.log("[WARN](ClientGUI::updatePaneBounds) No panes to update - skipping bounds calculation");
+        LOG_WARN(guiLogger, "(ClientGUI::updatePaneBounds) No panes to update - skipping bounds calculation");
         return;
     }
     
     // Detailed pane information logging
     for (size_t i = 0; i < paneCount; ++i) {
-        guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Pane " + std::to_string(i) + " split type: " +
-                      (panes[i].splitType == SplitType::HORIZONTAL ? "HORIZONTAL" : "VERTICAL"));
+        LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Pane " + std::to_string(i) + " split type: " +
+                             (panes[i].splitType == SplitType::HORIZONTAL ? "HORIZONTAL" : "VERTICAL"));
     }
     
     // Comprehensive bounds calculation
@@ -987,7 +977,7 @@ void ClientGUI::updatePaneBounds() {
                                             windowSize.x,            // width
                                             windowSize.y             // height
                                             );
-            guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Single pane set to full window");
+            LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Single pane set to full window");
             break;
         }
             
@@ -1005,7 +995,7 @@ void ClientGUI::updatePaneBounds() {
                                                 windowSize.x,        // width
                                                 windowSize.y / 2     // height
                                                 );
-                guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) 2 panes - Horizontal split");
+                LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) 2 panes - Horizontal split");
             } else {
                 // Vertical split (left and right)
                 panes[0].bounds = sf::FloatRect(
@@ -1018,7 +1008,7 @@ void ClientGUI::updatePaneBounds() {
                                                 windowSize.x / 2,    // width
                                                 windowSize.y         // height
                                                 );
-                guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) 2 panes - Vertical split");
+                LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) 2 panes - Vertical split");
             }
             break;
         }
@@ -1042,7 +1032,7 @@ void ClientGUI::updatePaneBounds() {
                                                 windowSize.x / 2,    // width
                                                 windowSize.y / 2     // height
                                                 );
-                guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) 3 panes - Horizontal primary split");
+                LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) 3 panes - Horizontal primary split");
             } else {
                 // Left full height, right split
                 panes[0].bounds = sf::FloatRect(
@@ -1060,7 +1050,7 @@ void ClientGUI::updatePaneBounds() {
                                                 windowSize.x / 2,    // width
                                                 windowSize.y / 2     // height
                                                 );
-                guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) 3 panes - Vertical primary split");
+                LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) 3 panes - Vertical primary split");
             }
             break;
         }
@@ -1087,26 +1077,26 @@ void ClientGUI::updatePaneBounds() {
                                             windowSize.x / 2,        // width
                                             windowSize.y / 2         // height
                                             );
-            guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) 4 panes - Quadrant split");
+            LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) 4 panes - Quadrant split");
             break;
         }
             
         default: {
-            guiLogger.log("[ERROR](ClientGUI::updatePaneBounds) Unsupported number of panes: " + std::to_string(paneCount));
+            LOG_ERROR(guiLogger, "(ClientGUI::updatePaneBounds) Unsupported number of panes: " + std::to_string(paneCount));
             break;
         }
     }
     
     // Log final bounds for verification
     for (size_t i = 0; i < paneCount; ++i) {
-        guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Pane " + std::to_string(i) + " Final Bounds: " +
-                      "Left: " + std::to_string(panes[i].bounds.left) +
-                      ", Top: " + std::to_string(panes[i].bounds.top) +
-                      ", Width: " + std::to_string(panes[i].bounds.width) +
-                      ", Height: " + std::to_string(panes[i].bounds.height));
+        LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Pane " + std::to_string(i) + " Final Bounds: " +
+                             "Left: " + std::to_string(panes[i].bounds.left) +
+                             ", Top: " + std::to_string(panes[i].bounds.top) +
+                             ", Width: " + std::to_string(panes[i].bounds.width) +
+                             ", Height: " + std::to_string(panes[i].bounds.height));
     }
     
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneBounds) Pane bounds update completed");
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneBounds) Pane bounds update completed");
 }
 
 void ClientGUI::updatePaneTerminalDisplay(Pane& pane) {
@@ -1178,11 +1168,11 @@ void ClientGUI::updatePaneTerminalDisplay(Pane& pane) {
         updatePaneCursor(pane);
         updatePaneScrollBar(pane);
         
-        guiLogger.log("[DEBUG] Display updated - Start: " + std::to_string(startIndex) +
-                      ", Visible: " + std::to_string(maxVisibleLines) +
-                      ", Total: " + std::to_string(pane.terminalLines.size()));
+        LOG_DEBUG(guiLogger, " Display updated - Start: " + std::to_string(startIndex) +
+                             ", Visible: " + std::to_string(maxVisibleLines) +
+                             ", Total: " + std::to_string(pane.terminalLines.size()));
     } catch(const std::exception& e) {
-        guiLogger.log("[ERROR] " + std::string(e.what()));
+        LOG_ERROR(guiLogger, " " + std::string(e.what()));
     }
 }
 
@@ -1246,8 +1236,8 @@ void ClientGUI::addLineToPaneTerminal(Pane& currentPane, const std::string& line
     updatePaneScrollBar(currentPane);
     updatePaneTerminalDisplay(currentPane);
     
-    guiLogger.log("[DEBUG](ClientGUI::addLineToPaneTerminal) Added line: '" + trimmedLine +
-                  "'. Total lines: " + std::to_string(currentPane.terminalLines.size()));
+    LOG_DEBUG(guiLogger, "(ClientGUI::addLineToPaneTerminal) Added line: '" + trimmedLine +
+                         "'. Total lines: " + std::to_string(currentPane.terminalLines.size()));
 }
 
 void ClientGUI::updatePaneScrollBar(Pane& pane) {
@@ -1287,9 +1277,9 @@ void ClientGUI::updatePaneScrollBar(Pane& pane) {
         window.draw(scrollTrack);
         window.draw(scrollThumb);
         
-        guiLogger.log("[DEBUG](ClientGUI::updatePaneScrollBar) Bottom scrollbar - Y: " +
-                      std::to_string(scrollTrack.getPosition().y) +
-                      ", Height: " + std::to_string(visibleHeight));
+        LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneScrollBar) Bottom scrollbar - Y: " +
+                             std::to_string(scrollTrack.getPosition().y) +
+                             ", Height: " + std::to_string(visibleHeight));
     }
 }
 
@@ -1299,9 +1289,9 @@ void ClientGUI::updatePaneCursor(Pane& pane) {
                                     [&pane](const Pane& p) { return &p == &pane; }) - panes.begin();
     
     // Log the start of cursor update for this specific pane
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneCursor) Updating cursor for Pane " +
-                  std::to_string(paneIndex) +
-                  ", Current Pane Index: " + std::to_string(currentPaneIndex));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneCursor) Updating cursor for Pane " +
+                         std::to_string(paneIndex) +
+                         ", Current Pane Index: " + std::to_string(currentPaneIndex));
     
     // Get current path with shell prompt
     std::string currentPath = pane.backend->GetPath() + "> ";
@@ -1344,10 +1334,10 @@ void ClientGUI::updatePaneCursor(Pane& pane) {
     // Update cursor position with bounds checking
     float finalCursorX = std::min(std::max(pane.bounds.left + 10 + cursorOffset, pane.bounds.left + 10), pane.bounds.left + pane.bounds.width);
     // Detailed logging of cursor calculation
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
-                  " Cursor Details: CurrentPath: '" + currentPath + "' CurrentInput: '" + currentInput + "' CursorOffset: " + std::to_string(cursorOffset) +
-                  " PaneBounds Left: " + std::to_string(pane.bounds.left) +
-                  " InputText Y: " + std::to_string(pane.inputText.getPosition().y));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
+                         " Cursor Details: CurrentPath: '" + currentPath + "' CurrentInput: '" + currentInput + "' CursorOffset: " + std::to_string(cursorOffset) +
+                         " PaneBounds Left: " + std::to_string(pane.bounds.left) +
+                         " InputText Y: " + std::to_string(pane.inputText.getPosition().y));
     
     // Update cursor position relative to pane bounds
     pane.cursor.setPosition(
@@ -1369,34 +1359,34 @@ void ClientGUI::updatePaneCursor(Pane& pane) {
         pane.cursor.setFillColor(cursorVisible ? sf::Color::White : sf::Color::Transparent);
         
         // Log cursor visibility state
-        guiLogger.log("[DEBUG](ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
-                      " Cursor Visibility: " + (cursorVisible ? "Visible" : "Hidden"));
+        LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
+                             " Cursor Visibility: " + (cursorVisible ? "Visible" : "Hidden"));
     } else {
         pane.cursor.setFillColor(sf::Color::Transparent);
         
         // Log inactive pane cursor state
-        guiLogger.log("[DEBUG](ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
-                      " Cursor: Hidden (Inactive Pane)");
+        LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
+                             " Cursor: Hidden (Inactive Pane)");
     }
     
     // Log final cursor position
-    guiLogger.log("[DEBUG](ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
-                  " Final Cursor Position: X=" + std::to_string(pane.cursor.getPosition().x) +
-                  " Y=" + std::to_string(pane.cursor.getPosition().y));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updatePaneCursor) Pane " + std::to_string(paneIndex) +
+                         " Final Cursor Position: X=" + std::to_string(pane.cursor.getPosition().x) +
+                         " Y=" + std::to_string(pane.cursor.getPosition().y));
 }
 
 void ClientGUI::renderPanes() {
     // Comprehensive logging and debugging
-    guiLogger.log("[DEBUG](ClientGUI::renderPanes) Starting pane rendering.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::renderPanes) Starting pane rendering.");
     
     // Ensure we have panes to render
     if (panes.empty()) {
-        guiLogger.log("[WARN](ClientGUI::renderPanes) No panes to render.");
+        LOG_WARN(guiLogger, "(ClientGUI::renderPanes) No panes to render.");
         return;
     }
     
     if (currentMode == editorMode::EDITTING){
-        guiLogger.log("[WARN](ClientGUI::renderPanes) No panes to render because of editing of a file using nano.");
+        LOG_WARN(guiLogger, "(ClientGUI::renderPanes) No panes to render because of editing of a file using nano.");
            return; // Don't render panes in nano mode
        }
     
@@ -1407,7 +1397,7 @@ void ClientGUI::renderPanes() {
     updatePaneBounds();
     
     // Log total panes
-    guiLogger.log("[DEBUG](ClientGUI::renderPanes) Rendering " + std::to_string(panes.size()) + " panes");
+    LOG_DEBUG(guiLogger, "(ClientGUI::renderPanes) Rendering " + std::to_string(panes.size()) + " panes");
     
     // Render each pane with distinct visual characteristics
     for (size_t i = 0; i < panes.size(); ++i) {
@@ -1415,10 +1405,10 @@ void ClientGUI::renderPanes() {
         bool isActivePane = (i == currentPaneIndex);
         
         // Detailed pane bounds logging
-        guiLogger.log("[DEBUG](ClientGUI::renderPanes) Pane " + std::to_string(i) + " Bounds: Left: " + std::to_string(pane.bounds.left) +
-                      ", Top: " + std::to_string(pane.bounds.top) +
-                      ", Width: " + std::to_string(pane.bounds.width) +
-                      ", Height: " + std::to_string(pane.bounds.height));
+        LOG_DEBUG(guiLogger, "(ClientGUI::renderPanes) Pane " + std::to_string(i) + " Bounds: Left: " + std::to_string(pane.bounds.left) +
+                             ", Top: " + std::to_string(pane.bounds.top) +
+                             ", Width: " + std::to_string(pane.bounds.width) +
+                             ", Height: " + std::to_string(pane.bounds.height));
         
         // Create a rectangle shape for the pane with distinct visual properties
         sf::RectangleShape paneBackground;
@@ -1483,8 +1473,8 @@ void ClientGUI::renderPanes() {
             }
         }
         catch (const std::exception& e) {
-            guiLogger.log("[ERROR](ClientGUI::renderPanes) Failed to render pane text: " +
-                          std::string(e.what()));
+            LOG_ERROR(guiLogger, "(ClientGUI::renderPanes) Failed to render pane text: " +
+                                 std::string(e.what()));
         }
         
     }
@@ -1492,7 +1482,7 @@ void ClientGUI::renderPanes() {
     // Display the rendered frame
     window.display();
     
-    guiLogger.log("[DEBUG](ClientGUI::renderPanes) Pane rendering completed");
+    LOG_DEBUG(guiLogger, "(ClientGUI::renderPanes) Pane rendering completed");
 }
 
 void ClientGUI::switchPane(int direction) {
@@ -1508,9 +1498,9 @@ void ClientGUI::switchPane(int direction) {
     newPane.cursorPosition = newPane.currentInput.length() -
     (newPane.backend->GetPath() + "> ").length();
     
-    guiLogger.log("[DEBUG](ClientGUI::switchPane) Switched from pane " +
-                  std::to_string(oldIndex) + " to " +
-                  std::to_string(currentPaneIndex));
+    LOG_DEBUG(guiLogger, "(ClientGUI::switchPane) Switched from pane " +
+                         std::to_string(oldIndex) + " to " +
+                         std::to_string(currentPaneIndex));
 }
 
 void ClientGUI::closeCurrentPane() {
@@ -1525,6 +1515,8 @@ void ClientGUI::closeCurrentPane() {
         panes.clear();
         currentPaneIndex = 0;
     } else {
+        // its get or put uses the backend, it finishes before the panes after it move down
+        panes[currentPaneIndex].transfer.reset();
         panes.erase(panes.begin() + currentPaneIndex);
         
         updatePaneBounds();
@@ -1549,9 +1541,9 @@ void ClientGUI::scrollPaneUp(Pane& pane, int lines) {
         updatePaneTerminalDisplay(pane);
         updatePaneScrollBar(pane);
         
-        guiLogger.log("[DEBUG](ClientGUI::scrollPaneUp) Scrolled up " +
-                      std::to_string(lines) + " lines. Position: " +
-                      std::to_string(pane.scrollPosition));
+        LOG_DEBUG(guiLogger, "(ClientGUI::scrollPaneUp) Scrolled up " +
+                             std::to_string(lines) + " lines. Position: " +
+                             std::to_string(pane.scrollPosition));
     }
 }
 
@@ -1563,21 +1555,21 @@ void ClientGUI::scrollPaneDown(Pane& pane, int lines) {
         updatePaneTerminalDisplay(pane);
         updatePaneScrollBar(pane);
         
-        guiLogger.log("[DEBUG](ClientGUI::scrollPaneDown) Scrolled down " +
-                      std::to_string(lines) + " lines. Position: " +
-                      std::to_string(pane.scrollPosition));
+        LOG_DEBUG(guiLogger, "(ClientGUI::scrollPaneDown) Scrolled down " +
+                             std::to_string(lines) + " lines. Position: " +
+                             std::to_string(pane.scrollPosition));
     }
 }
 
 void ClientGUI::handlePaneScrolling(sf::Event event, Pane& pane) {
     pane.scrollAccumulator += event.mouseWheelScroll.delta;
     
-    guiLogger.log("[DEBUG](ClientGUI::handlePaneScrolling) Terminal lines count: " + std::to_string(pane.terminalLines.size()));
+    LOG_DEBUG(guiLogger, "(ClientGUI::handlePaneScrolling) Terminal lines count: " + std::to_string(pane.terminalLines.size()));
     if (!pane.terminalLines.empty()) {
-        guiLogger.log("[DEBUG] First line: " + pane.terminalLines.front());
-        guiLogger.log("[DEBUG] Last line: " + pane.terminalLines.back());
+        LOG_DEBUG(guiLogger, " First line: " + pane.terminalLines.front());
+        LOG_DEBUG(guiLogger, " Last line: " + pane.terminalLines.back());
     }
-    guiLogger.log("[DEBUG](ClientGUI::handlePaneScrolling) Current scroll position: " + std::to_string(pane.scrollPosition));
+    LOG_DEBUG(guiLogger, "(ClientGUI::handlePaneScrolling) Current scroll position: " + std::to_string(pane.scrollPosition));
     
     if (std::abs(pane.scrollAccumulator) >= 1.0f) {
         int scrollLines = static_cast<int>(pane.scrollAccumulator);
@@ -1590,7 +1582,7 @@ void ClientGUI::handlePaneScrolling(sf::Event event, Pane& pane) {
                 scrollPaneDown(pane, 1);    // Show newer lines (lower index)
             }
         } catch (const std::exception& e) {
-            guiLogger.log("[ERROR](ClientGUI::handlePaneScrolling) Scroll failed: " + std::string(e.what()));
+            LOG_ERROR(guiLogger, "(ClientGUI::handlePaneScrolling) Scroll failed: " + std::string(e.what()));
         }
         
         pane.scrollAccumulator = 0.0f;
@@ -1600,7 +1592,7 @@ void ClientGUI::handlePaneScrolling(sf::Event event, Pane& pane) {
 void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
     
     if (currentMode == editorMode::EDITTING) {
-        guiLogger.log("[DEBUG](ClientGUI::processPaneInput) Currently in nano editor mode, processing nano input.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::processPaneInput) Currently in nano editor mode, processing nano input.");
         processNanoInput(event);
         return;
     }
@@ -1623,7 +1615,7 @@ void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
                 if(currentPath == currentInput) {
                     addLineToPaneTerminal(currentPane, currentPath);
                     currentPane.inputText.setString(currentPath);
-                    guiLogger.log("[DEBUG](ClientGUI::ProcessPaneInput) Empty input, added new line.");
+                    LOG_DEBUG(guiLogger, "(ClientGUI::ProcessPaneInput) Empty input, added new line.");
                     return;
                 }
                 
@@ -1636,16 +1628,34 @@ void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
                 if (!command.empty()) {
                     try {
                         
-                        // Send command to backend
-                        std::string response = currentPane.backend->sendCommand(command);
-                        
-                        // Add command to terminal lines
-                        addLineToPaneTerminal(currentPane, currentInput);
+                        // Send command to backend, plain commands show their output while they run
+                        std::string response;
+                        if (isTerminalCommand(command)) {
+                            addLineToPaneTerminal(currentPane, currentInput);
+                            runTerminalCommand(*currentPane.backend, command, currentPane.terminalLines);
+                        } else if (isStreamedCommand(command)) {
+                            addLineToPaneTerminal(currentPane, currentInput);
+                            streamCommandOutput(*currentPane.backend, command, [&](const std::string& line) {
+                                addLineToPaneTerminal(currentPane, line);
+                            });
+                        } else {
+                            if (!isClientCommand(command)) {
+                                response = currentPane.backend->sendCommand(command);
+                            }
+                            
+                            // Add command to terminal lines
+                            addLineToPaneTerminal(currentPane, currentInput);
+                        }
                         
                         if (command.substr(0, 2) == "cd") {
-                            guiLogger.log("[DEBUG](ClientGUI::processPaneInput) Processing cd in pane " + std::to_string(currentPaneIndex) + ", old path: " + currentPane.backend->GetPath());
+                            LOG_DEBUG(guiLogger, "(ClientGUI::processPaneInput) Processing cd in pane " + std::to_string(currentPaneIndex) + ", old path: " + currentPane.backend->GetPath());
                             if (response.find("Invalid directory") == std::string::npos &&
                                 response.find("Error") == std::string::npos) {
+                                // what the commands after it printed comes first, cd /tmp && ls
+                                std::istringstream output(response.substr(0, response.find_last_of('\n') + 1));
+                                for (std::string line; std::getline(output, line);) {
+                                    addLineToPaneTerminal(currentPane, line);
+                                }
                                 std::string newPath = response.substr(response.find_last_of('\n') + 1);
                                 currentPane.backend->SetPath(newPath);
                                 addLineToPaneTerminal(currentPane, "Changed directory to: " + newPath);
@@ -1657,21 +1667,21 @@ void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
                             if (command.substr(0, 4) == "nano") {
                                 std::string fullPath = command.substr(5);
                                 std::string fileName = std::filesystem::path(fullPath).filename().string();
-                                std::string fileContent = currentPane.backend->sendCommand(command);
+                                auto document = std::make_unique<backend::RemoteDocument>(*currentPane.backend, fullPath);
+                                std::string fileContent = document -> open();
                                 
                                 if (fileContent.find("Error") == std::string::npos) {
-                                    bool fileMode = (fileContent == "NEW_FILE");
                                     currentMode = editorMode::EDITTING;
-                                    if (!fileMode) {
-                                        enterNanoEditorMode(fileContent, fileName);
-                                    } else {
-                                        enterNanoEditorMode("", fileName);
-                                    }
-                                    
+                                    enterNanoEditorMode(std::move(document), fileName);
                                 } else {
                                     addLineToPaneTerminal(currentPane, fileContent);
                                 }
                             }
+                            else if (command.rfind("get ", 0) == 0 || command.rfind("put ", 0) == 0) {
+                                startTransfer(*currentPane.backend, command, currentPane.transfer, [&](const std::string& line) {
+                                    addLineToPaneTerminal(currentPane, line);
+                                });
+                            }
                         // Handle clear command
                             else if (command == "clear") {
                                 currentPane.terminalLines.clear();
@@ -1687,18 +1697,8 @@ void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
                                 sf::sleep(sf::milliseconds(700));
                                 closeCurrentPane();
                             }
-                            else {
-                                // Process response
-                                if(!response.empty()) {
-                                    std::istringstream responseStream(response);
-                                    std::string line;
-                                    while (std::getline(responseStream, line)) {
-                                        if (!line.empty()) {
-                                            addLineToPaneTerminal(currentPane, line);
-                                        }
-                                    }
-                                }
-                            }
+                        // other commands already printed their output while it streamed
+                        
                         // Reset input
                         std::string newPrompt = currentPane.backend->GetPath() + "> ";
                         currentPane.currentInput = newPrompt;
@@ -1740,7 +1740,7 @@ void ClientGUI::processPaneInput(sf::Event event, Pane& currentPane) {
             updatePaneTerminalDisplay(currentPane);
             updatePaneCursor(currentPane);
             
-            guiLogger.log("[DEBUG](ClientGUI::processPaneInput) Input processed. Current input: " + currentInput);
+            LOG_DEBUG(guiLogger, "(ClientGUI::processPaneInput) Input processed. Current input: " + currentInput);
         }
     }
 }
@@ -1787,7 +1787,7 @@ void ClientGUI::navigatePaneCommandHistory(Pane& currentPane, bool goUp) {
     
     // Check if command history is empty
     if (currentPane.commandHistory.empty()) {
-        guiLogger.log("[DEBUG](ClientGUI::navigatecommandHistory) No commands in pane history.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigatecommandHistory) No commands in pane history.");
         return;
     }
     
@@ -1831,22 +1831,22 @@ void ClientGUI::navigatePaneCommandHistory(Pane& currentPane, bool goUp) {
         currentPane.cursorPosition =
         currentPane.commandHistory[currentPane.currentHistoryIndex].length();
         
-        guiLogger.log("[DEBUG](ClientGUI::navigatecommandHistory) Pane command selected: '" +
-                      currentPane.commandHistory[currentPane.currentHistoryIndex] +
-                      "'. Index: " + std::to_string(currentPane.currentHistoryIndex));
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigatecommandHistory) Pane command selected: '" +
+                             currentPane.commandHistory[currentPane.currentHistoryIndex] +
+                             "'. Index: " + std::to_string(currentPane.currentHistoryIndex));
     } else {
         // Reset to initial state
         currentPane.currentInput = currentPath;
         currentPane.inputText.setString(currentPath);
         currentPane.cursorPosition = 0.0f;
         
-        guiLogger.log("[DEBUG](ClientGUI::navigatecommandHistory) Pane command history reset.");
+        LOG_DEBUG(guiLogger, "(ClientGUI::navigatecommandHistory) Pane command history reset.");
     }
 }
 
 std::vector<std::string> ClientGUI::splitFileContent(const std::string& content) {
-    guiLogger.log("[DEBUG](ClientGUI::splitFileContent) Splitting file content. Total length: " +
-                  std::to_string(content.length()) + " bytes.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::splitFileContent) Splitting file content. Total length: " +
+                         std::to_string(content.length()) + " bytes.");
     
     std::vector<std::string> lines;
     std::istringstream stream(content);
@@ -1858,11 +1858,11 @@ std::vector<std::string> ClientGUI::splitFileContent(const std::string& content)
     
     // Ensure at least one line
     if (lines.empty()) {
-        guiLogger.log("[WARN](ClientGUI::splitFileContent) No lines found. Creating empty line.");
+        LOG_WARN(guiLogger, "(ClientGUI::splitFileContent) No lines found. Creating empty line.");
         lines.push_back("");
     }
     
-    guiLogger.log("[DEBUG](ClientGUI::splitFileContent) Split result: " + std::to_string(lines.size()) + " lines.");
+    LOG_DEBUG(guiLogger, "(ClientGUI::splitFileContent) Split result: " + std::to_string(lines.size()) + " lines.");
     return lines;
 }
 
@@ -1870,7 +1870,7 @@ void ClientGUI::processInput(sf::Event event) {
     try {
         
         if (currentMode == editorMode::EDITTING) {
-            guiLogger.log("[DEBUG](ClientGUI::processInput) Currently in nano editor mode, processing nano input.");
+            LOG_DEBUG(guiLogger, "(ClientGUI::processInput) Currently in nano editor mode, processing nano input.");
             processNanoInput(event);
             return;
         }
@@ -1895,7 +1895,7 @@ void ClientGUI::processInput(sf::Event event) {
                         if (currentInput == currentPath) {
                             addLineToTerminal(currentPath);
                             this -> inputText.setString(currentPath);
-                            guiLogger.log("[DEBUG](ClientGUI::ProcessInput) Empty input, added new line.");
+                            LOG_DEBUG(guiLogger, "(ClientGUI::ProcessInput) Empty input, added new line.");
                             return;
                         }
                         
@@ -1907,12 +1907,28 @@ void ClientGUI::processInput(sf::Event event) {
                         if (!command.empty()) {
                             try {
                                 addLineToTerminal(currentInput);
-                                std::string response = this -> backend.sendCommand(command);
+                                
+                                // plain commands show their output while they run
+                                std::string response;
+                                if (isTerminalCommand(command)) {
+                                    runTerminalCommand(this -> backend, command, this -> terminalLines);
+                                } else if (isStreamedCommand(command)) {
+                                    streamCommandOutput(this -> backend, command, [this](const std::string& line) {
+                                        addLineToTerminal(line);
+                                    });
+                                } else if (!isClientCommand(command)) {
+                                    response = this -> backend.sendCommand(command);
+                                }
                                 
                                 // check if the command is cd
                                 if (command.substr(0, 2) == "cd") {
                                     if (response.find("Invalid directory") == std::string::npos &&
                                         response.find("Error") == std::string::npos) {
+                                        // what the commands after it printed comes first, cd /tmp && ls
+                                        std::istringstream output(response.substr(0, response.find_last_of('\n') + 1));
+                                        for (std::string line; std::getline(output, line);) {
+                                            addLineToTerminal(line);
+                                        }
                                         std::string newPath = response.substr(response.find_last_of('\n') + 1);
                                         this -> backend.SetPath(newPath);
                                         addLineToTerminal("Changed directory to: " + newPath);
@@ -1923,26 +1939,22 @@ void ClientGUI::processInput(sf::Event event) {
                                     
                                     std::string fullPath = command.substr(5);
                                     std::string fileName = std::filesystem::path(fullPath).filename().string();
-                                    std::string fileContent = this -> backend.sendCommand(command);
-                                    if(fileContent.substr(0,4) == "nano"){
-                                        fileContent.substr(5);
-                                    }
-                                    guiLogger.log("[DEBUG](ClientGUI::ProcessInput) Server response for nano: " + fileContent);
+                                    auto document = std::make_unique<backend::RemoteDocument>(this -> backend, fullPath);
+                                    std::string fileContent = document -> open();
+                                    LOG_DEBUG(guiLogger, "(ClientGUI::ProcessInput) Server response for nano: " + fileContent);
                                     
                                     if (fileContent.find("Error") == std::string::npos) {
-                                        bool fileMode = (fileContent == "NEW_FILE");
                                         // Enter nano editor mode
                                         this -> currentMode = editorMode::EDITTING;
-                                        if(!fileMode){
-                                            enterNanoEditorMode(fileContent, fileName);
-                                        }
-                                        else {
-                                            enterNanoEditorMode("", fileName);
-                                        }
+                                        enterNanoEditorMode(std::move(document), fileName);
                                         return;
                                     } else {
                                         addLineToTerminal(fileContent);
                                     }
+                                } else if (command.rfind("get ", 0) == 0 || command.rfind("put ", 0) == 0) {
+                                    startTransfer(this -> backend, command, this -> transfer, [this](const std::string& line) {
+                                        addLineToTerminal(line);
+                                    });
                                 } else // check if the command is exit
                                     if (command == "exit") {
                                         addLineToTerminal(response);
@@ -1964,18 +1976,8 @@ void ClientGUI::processInput(sf::Event event) {
                                         updateCursor();
                                         
                                         return;
-                                    } else {
-                                        // Normal output case for other commands
-                                        if (!response.empty()) {
-                                            std::istringstream responseStream(response);
-                                            std::string line;
-                                            while (std::getline(responseStream, line)) {
-                                                if (!line.empty()) {
-                                                    addLineToTerminal(line);
-                                                }
-                                            }
-                                        }
                                     }
+                                // other commands already printed their output while it streamed
                                 
                                 // Update inputText with new path
                                 std::string newCurrentPath = this -> backend.GetPath() + "> ";
@@ -2014,11 +2016,11 @@ void ClientGUI::processInput(sf::Event event) {
             }
     }
     catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::processInput) Exception: " + std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::processInput) Exception: " + std::string(e.what()));
         addLineToTerminal("Error: " + std::string(e.what()));
     }
     catch (...) {
-        guiLogger.log("[ERROR](ClientGUI::processInput) Unknown exception occurred.");
+        LOG_ERROR(guiLogger, "(ClientGUI::processInput) Unknown exception occurred.");
         addLineToTerminal("An unknown error occurred.");
     }
 }
@@ -2076,9 +2078,374 @@ void ClientGUI::addLineToTerminal(const std::string &line) {
         updateTerminalDisplay();
         updateScrollBar();
         
-        this -> guiLogger.log("([DEBUG](ClientGUI::addLineToTerminal) Terminal line added. Total lines: " +
-                              std::to_string(terminalLines.size()));
+        LOG_DEBUG(this -> guiLogger, "(ClientGUI::addLineToTerminal) Terminal line added. Total lines: " +
+                                     std::to_string(terminalLines.size()));
+    }
+}
+
+bool ClientGUI::isStreamedCommand(const std::string& command) const {
+    // cd, clear and exit answer with something the GUI acts on as a whole
+    return command.substr(0, 2) != "cd" && command != "clear" && command != "exit" && !isClientCommand(command);
+}
+
+bool ClientGUI::isClientCommand(const std::string& command) const {
+    return command.substr(0, 4) == "nano" || command.rfind("get ", 0) == 0 || command.rfind("put ", 0) == 0;
+}
+
+void ClientGUI::startTransfer(backend::ClientBackend& session, const std::string& command,
+                              std::unique_ptr<RunningTransfer>& running, const std::function<void(const std::string&)>& addLine) {
+    if (running) {
+        addLine("Error: " + running -> label + " is still running in this pane");
+        return;
+    }
+    
+    running = std::make_unique<RunningTransfer>();
+    running -> label = command;
+    RunningTransfer* transfer = running.get();
+    running -> result = std::async(std::launch::async, [this, &session, command, transfer]() {
+        return transferFile(session, command, [transfer](uint64_t done, uint64_t total) {
+            transfer -> done = done;
+            transfer -> total = total;
+        });
+    });
+    addLine(command + ": starting");
+}
+
+bool ClientGUI::showTransferProgress(std::unique_ptr<RunningTransfer>& running, std::vector<std::string>& lines,
+                                     const std::function<void(const std::string&)>& addLine) {
+    if (!running) {
+        return false;
+    }
+    
+    // the line it started with, unless a clear took it away meanwhile
+    std::string prefix = running -> label + ": ";
+    auto line = std::find_if(lines.rbegin(), lines.rend(), [&prefix](const std::string& text) {
+        return text.rfind(prefix, 0) == 0;
+    });
+    
+    if (running -> result.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+        std::string result = running -> result.get();
+        running.reset();
+        if (line != lines.rend()) {
+            lines.erase(std::next(line).base());
+        }
+        addLine(result);
+        return false;
+    }
+    
+    uint64_t done = running -> done;
+    uint64_t total = running -> total;
+    std::string progress = prefix + std::to_string(done) + (total > 0 ? " of " + std::to_string(total) + " bytes (" +
+                           std::to_string(done * 100 / total) + "%)" : " bytes");
+    if (line == lines.rend()) {
+        addLine(progress);
+        return false;
+    }
+    if (*line == progress) {
+        return false;
+    }
+    *line = progress;
+    return true;
+}
+
+std::string ClientGUI::transferFile(backend::ClientBackend& session, const std::string& command,
+                                    const backend::FileTransfer::Progress& progress) {
+    std::istringstream words(command);
+    std::string verb, source, destination;
+    words >> verb >> source >> destination;
+    if (source.empty()) {
+        return "Usage: get <remote> [local], put <local> [remote]";
+    }
+    // without a destination the file keeps its name, here in the client's directory or in the session's
+    if (destination.empty()) {
+        path named(source);
+        destination = (named.has_filename() ? named : named.parent_path()).filename().string();
+    }
+
+    backend::FileTransfer transfer(session);
+    auto started = std::chrono::steady_clock::now();
+    std::string error = verb == "get" ? transfer.get(source, destination, progress) : transfer.put(source, destination, progress);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (!error.empty()) {
+        LOG_ERROR(guiLogger, "(ClientGUI::transferFile) " + command + ": " + error);
+        return error;
+    }
+
+    char rate[96];
+    snprintf(rate, sizeof(rate), "%llu bytes in %.2f s (%.1f MB/s)", static_cast<unsigned long long>(transfer.transferred()),
+             seconds, seconds > 0 ? transfer.transferred() / seconds / 1e6 : 0.0);
+    LOG_INFO(guiLogger, "(ClientGUI::transferFile) " + command + ": " + rate);
+    std::string done = (verb == "get" ? "Received " + source + " -> " + transfer.localCopy() : "Sent " + source + " -> " + destination) +
+                       ", " + rate;
+    if (!transfer.warning().empty()) {
+        LOG_WARN(guiLogger, "(ClientGUI::transferFile) " + command + ": " + transfer.warning());
+        done += "; " + transfer.warning();
+    }
+    return done;
+}
+
+void ClientGUI::streamCommandOutput(backend::ClientBackend& session, const std::string& command,
+                                    const std::function<void(const std::string&)>& addLine) {
+    std::mutex outputMutex;
+    std::string output;
+    std::atomic<bool> finished{false};
+    
+    // the response is read on a thread of its own, the window keeps taking events meanwhile
+    std::thread reader([&]() {
+        try {
+            session.sendCommandStreaming(command, [&](std::string_view chunk) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output.append(chunk);
+            });
+        } catch (...) {
+            LOG_ERROR(guiLogger, "(ClientGUI::streamCommandOutput) Command failed: " + command);
+        }
+        finished = true;
+    });
+    
+    // only whole lines go to the terminal, the tail waits for the next chunk
+    std::string pendingLine;
+    auto takeLines = [&]() {
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            pendingLine += output;
+            output.clear();
+        }
+        size_t start = 0;
+        size_t end;
+        while ((end = pendingLine.find('\n', start)) != std::string::npos) {
+            if (end > start) {
+                addLine(pendingLine.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        pendingLine.erase(0, start);
+    };
+    
+    bool closing = false;
+    while (!finished) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            // Ctrl+C interrupts the command; closing the window does too and waits for it to stop
+            if (event.type == sf::Event::Closed) {
+                session.sendTerminalInput("\x03");
+                closing = true;
+            } else if (event.type == sf::Event::KeyPressed && event.key.control && event.key.code == sf::Keyboard::C) {
+                session.sendTerminalInput("\x03");
+            }
+        }
+        
+        // repaint once per frame while the command runs, not once per chunk
+        takeLines();
+        if (!panes.empty()) {
+            renderPanes();
+        } else {
+            renderDefaultTerminal();
+            window.display();
+        }
+        sf::sleep(sf::milliseconds(16));
+    }
+    reader.join();
+    
+    takeLines();
+    if (!pendingLine.empty()) {
+        addLine(pendingLine);
+    }
+    if (closing) {
+        window.close();
+    }
+}
+
+bool ClientGUI::isTerminalCommand(const std::string& command) const {
+    // programs that need a tty to draw and read single keys
+    static const std::vector<std::string> fullScreen = {"top", "htop", "less", "more", "man", "vi", "vim", "ssh"};
+    std::istringstream words(command);
+    std::vector<std::string> arguments;
+    for (std::string word; words >> word;) {
+        arguments.push_back(word);
+    }
+    if (arguments.empty()) {
+        return false;
+    }
+    
+    // watch <path> is the server's file watch, only watch -n 1 ls and the like are the watch program
+    if (arguments[0] == "watch") {
+        return arguments.size() > 2 || (arguments.size() == 2 && arguments[1][0] == '-');
+    }
+    return std::find(fullScreen.begin(), fullScreen.end(), arguments[0]) != fullScreen.end();
+}
+
+void ClientGUI::runTerminalCommand(backend::ClientBackend& session, const std::string& command,
+                                   std::vector<std::string>& lines) {
+    // a channel of its own, the pane's session stays in line mode for the commands after this one
+    std::unique_ptr<backend::ClientBackend> terminal = session.openChannel();
+    
+    // the new channel starts in the server's directory, a plain cd takes it to the pane's;
+    // the command itself goes unchanged, its verb decides how the server runs it
+    if (!session.GetPath().empty()) {
+        std::string quotedPath = "'";
+        for (char c : session.GetPath()) {
+            quotedPath += (c == '\'') ? std::string("'\\''") : std::string(1, c);
+        }
+        quotedPath += "'";
+        terminal -> sendCommand("cd " + quotedPath);
+    }
+    
+    auto windowSize = [this]() {
+        float advance = this -> font.getGlyph('M', this -> outputText.getCharacterSize(), false).advance;
+        unsigned columns = advance > 0 ? static_cast<unsigned>(this -> window.getSize().x / advance) : 80;
+        return std::make_pair(static_cast<unsigned short>(MAX_VISIBLE_LINES), static_cast<unsigned short>(std::max(columns, 20u)));
+    };
+    auto [rows, columns] = windowSize();
+    terminal -> resizeTerminal(rows, columns, true);
+    
+    std::mutex outputMutex;
+    std::string output;
+    std::atomic<bool> finished{false};
+    
+    std::thread reader([&]() {
+        try {
+            terminal -> sendCommandStreaming(command, [&](std::string_view chunk) {
+                std::lock_guard<std::mutex> lock(outputMutex);
+                output.append(chunk);
+            });
+        } catch (...) {
+            LOG_ERROR(guiLogger, "(ClientGUI::runTerminalCommand) Terminal command failed: " + command);
+        }
+        finished = true;
+    });
+    
+    // the server sends the cells that changed, the mirror replaces the lines below base
+    const size_t base = lines.size();
+    std::vector<std::u32string> screen;
+    std::string pending;
+    std::string trailing;
+    auto applyUpdates = [&]() {
+        bool redraw = false;
+        size_t start = 0;
+        while (start < pending.size()) {
+            protocol::ScreenUpdate update;
+            size_t used = protocol::decodeScreenUpdate(std::string_view(pending).substr(start), update);
+            if (used == 0) {
+                break;
+            }
+            if (used == std::string::npos) {
+                // plain text, an error from the server rather than the program's screen
+                trailing += stripTerminalControls(pending.substr(start));
+                start = pending.size();
+                break;
+            }
+            if (screen.size() != update.rows || (!screen.empty() && screen[0].size() != update.columns)) {
+                screen.assign(update.rows, std::u32string(update.columns, U' '));
+            }
+            for (const protocol::ScreenRun& run : update.runs) {
+                if (run.row < screen.size() && run.column < screen[run.row].size()) {
+                    screen[run.row].replace(run.column, std::min(run.text.size(), screen[run.row].size() - run.column), run.text);
+                }
+            }
+            start += used;
+            redraw = true;
+        }
+        pending.erase(0, start);
+        
+        if (redraw) {
+            lines.resize(base);
+            for (const std::u32string& row : screen) {
+                std::string text = protocol::encodeUtf8(row);
+                text.erase(text.find_last_not_of(' ') + 1);
+                lines.push_back(text);
+            }
+            // a program that leaves the alternate screen leaves blank rows, they are not output
+            while (lines.size() > base && lines.back().empty()) {
+                lines.pop_back();
+            }
+        }
+    };
+    
+    while (!finished) {
+        sf::Event event;
+        while (window.pollEvent(event)) {
+            if (event.type == sf::Event::Closed) {
+                // interrupt the program and let the read finish before the window goes away
+                terminal -> sendTerminalInput("\x03");
+            } else if (event.type == sf::Event::TextEntered && event.text.unicode < 128) {
+                char key = static_cast<char>(event.text.unicode);
+                terminal -> sendTerminalInput(std::string(1, key == '\b' ? '\x7f' : key));
+            } else if (event.type == sf::Event::KeyPressed) {
+                switch (event.key.code) {
+                    case sf::Keyboard::Up:       terminal -> sendTerminalInput("\x1b[A"); break;
+                    case sf::Keyboard::Down:     terminal -> sendTerminalInput("\x1b[B"); break;
+                    case sf::Keyboard::Right:    terminal -> sendTerminalInput("\x1b[C"); break;
+                    case sf::Keyboard::Left:     terminal -> sendTerminalInput("\x1b[D"); break;
+                    case sf::Keyboard::PageUp:   terminal -> sendTerminalInput("\x1b[5~"); break;
+                    case sf::Keyboard::PageDown: terminal -> sendTerminalInput("\x1b[6~"); break;
+                    default: break;
+                }
+            } else if (event.type == sf::Event::Resized) {
+                auto [newRows, newColumns] = windowSize();
+                terminal -> resizeTerminal(newRows, newColumns, true);
+            }
+        }
+        
+        {
+            std::lock_guard<std::mutex> lock(outputMutex);
+            pending += output;
+            output.clear();
+        }
+        applyUpdates();
+        
+        if (!panes.empty()) {
+            renderPanes();
+        } else {
+            renderDefaultTerminal();
+            window.display();
+        }
+        sf::sleep(sf::milliseconds(16));
+    }
+    reader.join();
+    
+    pending += output;
+    applyUpdates();
+    std::istringstream rest(trailing);
+    for (std::string text; std::getline(rest, text);) {
+        if (!text.empty()) {
+            lines.push_back(text);
+        }
+    }
+}
+
+std::string ClientGUI::stripTerminalControls(const std::string& output) {
+    // the line view has no screen to address, escape sequences and carriage returns are dropped
+    std::string text;
+    text.reserve(output.size());
+    for (size_t i = 0; i < output.size(); ++i) {
+        char c = output[i];
+        if (c == '\x1b' && i + 1 < output.size()) {
+            char kind = output[++i];
+            if (kind == '[') {
+                // CSI: parameters up to a final byte in @..~
+                while (i + 1 < output.size() && (output[i + 1] < 0x40 || output[i + 1] > 0x7e)) {
+                    ++i;
+                }
+                ++i;
+            } else if (kind == ']') {
+                // OSC: up to BEL or ESC backslash
+                while (i + 1 < output.size() && output[i + 1] != '\x07' && output[i + 1] != '\x1b') {
+                    ++i;
+                }
+                ++i;
+                if (i < output.size() && output[i] == '\x1b') {
+                    ++i;
+                }
+            }
+            continue;
+        }
+        if (c == '\r' || (static_cast<unsigned char>(c) < 0x20 && c != '\n' && c != '\t')) {
+            continue;
+        }
+        text.push_back(c);
     }
+    return text;
 }
 
 void ClientGUI::renderDefaultTerminal() {
@@ -2096,8 +2463,8 @@ void ClientGUI::renderDefaultTerminal() {
         // Update cursor position
         updateCursor();
     } catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::renderDefaultTerminal) Update components failed: " +
-                      std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::renderDefaultTerminal) Update components failed: " +
+                             std::string(e.what()));
     }
     
     // Render output text if not empty
@@ -2105,8 +2472,8 @@ void ClientGUI::renderDefaultTerminal() {
         try {
             window.draw(outputText);
         } catch (const std::exception& e) {
-            guiLogger.log("[ERROR](ClientGUI::renderDefaultTerminal) Drawing output text failed: " +
-                          std::string(e.what()));
+            LOG_ERROR(guiLogger, "(ClientGUI::renderDefaultTerminal) Drawing output text failed: " +
+                                 std::string(e.what()));
         }
     }
     
@@ -2115,8 +2482,8 @@ void ClientGUI::renderDefaultTerminal() {
         window.draw(inputText);
         window.draw(cursor);
     } catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::renderDefaultTerminal) Drawing input text or cursor failed: " +
-                      std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::renderDefaultTerminal) Drawing input text or cursor failed: " +
+                             std::string(e.what()));
     }
     
     // Render scrollbar if needed
@@ -2125,18 +2492,18 @@ void ClientGUI::renderDefaultTerminal() {
             window.draw(scrollBar);
         }
     } catch (const std::exception& e) {
-        guiLogger.log("[ERROR](ClientGUI::renderDefaultTerminal) Drawing scrollbar failed: " +
-                      std::string(e.what()));
+        LOG_ERROR(guiLogger, "(ClientGUI::renderDefaultTerminal) Drawing scrollbar failed: " +
+                             std::string(e.what()));
     }
     
     // Log rendering completion
-    guiLogger.log("[DEBUG](ClientGUI::renderDefaultTerminal) Default terminal rendered. Total terminal lines: " + std::to_string(terminalLines.size()));
+    LOG_DEBUG(guiLogger, "(ClientGUI::renderDefaultTerminal) Default terminal rendered. Total terminal lines: " + std::to_string(terminalLines.size()));
 }
 
 void ClientGUI::processNormalModeInput(sf::Event event) {
     // Log input event for debugging
-    guiLogger.log("[DEBUG](ClientGUI::processNormalModeInput) Event type: " +
-                  std::to_string(event.type));
+    LOG_DEBUG(guiLogger, "(ClientGUI::processNormalModeInput) Event type: " +
+                         std::to_string(event.type));
     
     // Pane-specific input processing
     if (!panes.empty()) {
@@ -2147,8 +2514,8 @@ void ClientGUI::processNormalModeInput(sf::Event event) {
             try {
                 processPaneInput(event, currentPane);
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::processNormalModeInput) Pane text input failed: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::processNormalModeInput) Pane text input failed: " +
+                                     std::string(e.what()));
             }
         }
         
@@ -2157,8 +2524,8 @@ void ClientGUI::processNormalModeInput(sf::Event event) {
             try {
                 handlePaneSpecialInput(event, currentPane);
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::processNormalModeInput) Pane special input failed: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::processNormalModeInput) Pane special input failed: " +
+                                     std::string(e.what()));
             }
         }
     }
@@ -2169,8 +2536,8 @@ void ClientGUI::processNormalModeInput(sf::Event event) {
             try {
                 processInput(event);
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::processNormalModeInput) Default terminal text input failed: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::processNormalModeInput) Default terminal text input failed: " +
+                                     std::string(e.what()));
             }
         }
         
@@ -2179,8 +2546,8 @@ void ClientGUI::processNormalModeInput(sf::Event event) {
             try {
                 handleSpecialInput(event);
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::processNormalModeInput) Default terminal special input failed: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::processNormalModeInput) Default terminal special input failed: " +
+                                     std::string(e.what()));
             }
         }
     }
@@ -2194,9 +2561,9 @@ void ClientGUI::handleScrolling(sf::Event event) {
     scrollAccumulator += event.mouseWheelScroll.delta;
     
     // Log scroll event
-    guiLogger.log("[DEBUG](ClientGUI::handleScrolling) Scroll delta: " +
-                  std::to_string(event.mouseWheelScroll.delta) +
-                  ", Accumulator: " + std::to_string(scrollAccumulator));
+    LOG_DEBUG(guiLogger, "(ClientGUI::handleScrolling) Scroll delta: " +
+                         std::to_string(event.mouseWheelScroll.delta) +
+                         ", Accumulator: " + std::to_string(scrollAccumulator));
     
     // Trigger scroll on significant movement
     if (std::abs(scrollAccumulator) >= 1.0f) {
@@ -2206,14 +2573,14 @@ void ClientGUI::handleScrolling(sf::Event event) {
             if (scrollLines > 0) {
                 // Scroll up
                 scrollUp(1);
-                guiLogger.log("[DEBUG](ClientGUI::handleScrolling) Scrolled up");
+                LOG_DEBUG(guiLogger, "(ClientGUI::handleScrolling) Scrolled up");
             } else if (scrollLines < 0) {
                 // Scroll down
                 scrollDown(1);
-                guiLogger.log("[DEBUG](ClientGUI::handleScrolling) Scrolled down");
+                LOG_DEBUG(guiLogger, "(ClientGUI::handleScrolling) Scrolled down");
             }
         } catch (const std::exception& e) {
-            guiLogger.log("[ERROR](ClientGUI::handleScrolling) Scroll failed: " + std::string(e.what()));
+            LOG_ERROR(guiLogger, "(ClientGUI::handleScrolling) Scroll failed: " + std::string(e.what()));
         }
         
         // Reset accumulator
@@ -2223,8 +2590,8 @@ void ClientGUI::handleScrolling(sf::Event event) {
 
 void ClientGUI::updateCursorVisibility(bool visible) {
     // Log cursor visibility change
-    guiLogger.log("[DEBUG](ClientGUI::updateCursorVisibility) Visibility: " +
-                  std::string(visible ? "Visible" : "Hidden"));
+    LOG_DEBUG(guiLogger, "(ClientGUI::updateCursorVisibility) Visibility: " +
+                         std::string(visible ? "Visible" : "Hidden"));
     
     // Pane mode cursor handling
     if (!panes.empty()) {
@@ -2257,27 +2624,27 @@ void ClientGUI::updateCursorVisibility(bool visible) {
 
 void ClientGUI::handlePaneShortcuts(sf::Event event) {
     // Log the shortcut attempt for debugging
-    guiLogger.log("[DEBUG](ClientGUI::handlePaneShortcuts) Shortcut pressed: " +
-                  std::to_string(event.key.code));
+    LOG_DEBUG(guiLogger, "(ClientGUI::handlePaneShortcuts) Shortcut pressed: " +
+                         std::to_string(event.key.code));
     
     switch(event.key.code) {
         case sf::Keyboard::H: // Horizontal split
             try {
                 createNewPane(SplitType::HORIZONTAL);
-                guiLogger.log("[INFO](ClientGUI::handlePaneShortcuts) Created horizontal pane split");
+                LOG_INFO(guiLogger, "(ClientGUI::handlePaneShortcuts) Created horizontal pane split");
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::handlePaneShortcuts) Failed to create horizontal pane: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::handlePaneShortcuts) Failed to create horizontal pane: " +
+                                     std::string(e.what()));
             }
             break;
             
         case sf::Keyboard::V: // Vertical split
             try {
                 createNewPane(SplitType::VERTICAL);
-                guiLogger.log("[INFO] Created vertical pane split");
+                LOG_INFO(guiLogger, " Created vertical pane split");
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::handlePaneShortcuts) Failed to create vertical pane: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::handlePaneShortcuts) Failed to create vertical pane: " +
+                                     std::string(e.what()));
             }
             break;
             
@@ -2285,7 +2652,7 @@ void ClientGUI::handlePaneShortcuts(sf::Event event) {
         {
             if (panes.size() > 1) {
                 switchPane(-1); // Move backwards
-                guiLogger.log("[DEBUG](ClientGUI::handlePaneShortcuts) Switched to previous pane");
+                LOG_DEBUG(guiLogger, "(ClientGUI::handlePaneShortcuts) Switched to previous pane");
             }
             break;
         }
@@ -2294,7 +2661,7 @@ void ClientGUI::handlePaneShortcuts(sf::Event event) {
         {
             if (panes.size() > 1) {
                 switchPane(1); // Move forward
-                guiLogger.log("[DEBUG](ClientGUI::handlePaneShortcuts) Switched to next pane");
+                LOG_DEBUG(guiLogger, "(ClientGUI::handlePaneShortcuts) Switched to next pane");
             }
             break;
         }
@@ -2302,7 +2669,7 @@ void ClientGUI::handlePaneShortcuts(sf::Event event) {
         case sf::Keyboard::W: // Close current pane
             if (!panes.empty()) {
                 closeCurrentPane();
-                guiLogger.log("[INFO](ClientGUI::handlePaneShortcuts) Closed current pane");
+                LOG_INFO(guiLogger, "(ClientGUI::handlePaneShortcuts) Closed current pane");
             }
             break;
             
@@ -2312,6 +2679,24 @@ void ClientGUI::handlePaneShortcuts(sf::Event event) {
     renderPanes();
 }
 
+void ClientGUI::showWatchEvents() {
+    auto show = [](const std::string& events, const std::function<void(const std::string&)>& addLine) {
+        std::istringstream lines(events);
+        std::string line;
+        while (std::getline(lines, line)) {
+            addLine("[watch] " + line);
+        }
+    };
+    
+    if (panes.empty()) {
+        show(this -> backend.takeWatchEvents(), [this](const std::string& line) { addLineToTerminal(line); });
+        return;
+    }
+    for (Pane& pane : panes) {
+        show(pane.backend -> takeWatchEvents(), [this, &pane](const std::string& line) { addLineToPaneTerminal(pane, line); });
+    }
+}
+
 void ClientGUI::run() {
     // Set up frame rate control
     window.setFramerateLimit(60);  // Limit to 60 FPS
@@ -2324,15 +2709,16 @@ void ClientGUI::run() {
     // Frame and event timing
     const sf::Time frameTime = sf::seconds(1.0f / 60.0f);
     const sf::Time blinkInterval = sf::seconds(0.5f);
+    const sf::Time watchInterval = sf::seconds(0.25f);
     
     // Cursor visibility state
     bool cursorVisible = true;
     
     // Log start of run method
-    guiLogger.log("[DEBUG](ClientGUI::run) Starting GUI run loop. " +
-                  std::string("Panes: ") + std::to_string(panes.size()) +
-                  ", Current mode: " +
-                  (currentMode == editorMode::NORMAL ? "Normal" : "Editing"));
+    LOG_DEBUG(guiLogger, "(ClientGUI::run) Starting GUI run loop. " +
+                         std::string("Panes: ") + std::to_string(panes.size()) +
+                         ", Current mode: " +
+                         (currentMode == editorMode::NORMAL ? "Normal" : "Editing"));
     editorMode lastMode = this -> currentMode;
     
     // Main application loop
@@ -2347,7 +2733,7 @@ void ClientGUI::run() {
         while (window.pollEvent(event)) {
             // Handle window close event
             if (event.type == sf::Event::Closed) {
-                guiLogger.log("[INFO](ClientGUI::run) Window close requested.");
+                LOG_INFO(guiLogger, "(ClientGUI::run) Window close requested.");
                 window.close();
                 return;
             }
@@ -2362,8 +2748,8 @@ void ClientGUI::run() {
                     }
                     
                 } catch (const std::exception& e) {
-                    guiLogger.log("[ERROR](ClientGUI::run) Pane shortcut error: " +
-                                  std::string(e.what()));
+                    LOG_ERROR(guiLogger, "(ClientGUI::run) Pane shortcut error: " +
+                                         std::string(e.what()));
                 }
             }
             
@@ -2372,8 +2758,8 @@ void ClientGUI::run() {
                 try {
                     processNormalModeInput(event);
                 } catch (const std::exception& e) {
-                    guiLogger.log("[ERROR](ClientGUI::run) Normal mode input error: " +
-                                  std::string(e.what()));
+                    LOG_ERROR(guiLogger, "(ClientGUI::run) Normal mode input error: " +
+                                         std::string(e.what()));
                 }
             }
             else {
@@ -2399,8 +2785,8 @@ void ClientGUI::run() {
                 try {
                     handleScrolling(event);
                 } catch (const std::exception& e) {
-                    guiLogger.log("[ERROR](ClientGUI::run) Scroll handling error: " +
-                                  std::string(e.what()));
+                    LOG_ERROR(guiLogger, "(ClientGUI::run) Scroll handling error: " +
+                                         std::string(e.what()));
                 }
             }
         }
@@ -2412,13 +2798,42 @@ void ClientGUI::run() {
             try {
                 updateCursorVisibility(cursorVisible);
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::run) Cursor visibility update error: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::run) Cursor visibility update error: " +
+                                     std::string(e.what()));
             }
             
             cursorBlinkClock.restart();
         }
         
+        // the server pushes watch events, a look at what arrived costs no round trip
+        if (eventClock.getElapsedTime() >= watchInterval) {
+            try {
+                showWatchEvents();
+            } catch (...) {
+                LOG_ERROR(guiLogger, "(ClientGUI::run) Failed to read watch events.");
+            }
+            eventClock.restart();
+        }
+        
+        // a nano save uploads on its own thread, it is reported once it is done
+        if (currentMode == editorMode::EDITTING) {
+            finishNanoSave();
+        }
+        
+        // so do get and put, their progress line moves along meanwhile
+        for (Pane& pane : panes) {
+            if (showTransferProgress(pane.transfer, pane.terminalLines, [this, &pane](const std::string& line) {
+                    addLineToPaneTerminal(pane, line);
+                })) {
+                updatePaneTerminalDisplay(pane);
+            }
+        }
+        if (showTransferProgress(this -> transfer, this -> terminalLines, [this](const std::string& line) {
+                addLineToTerminal(line);
+            })) {
+            updateTerminalDisplay();
+        }
+        
         // Rendering
         if (frameClock.getElapsedTime() >= frameTime || lastMode != currentMode) {
             // render only one
@@ -2441,8 +2856,8 @@ void ClientGUI::run() {
                     }
                 }
             } catch (const std::exception& e) {
-                guiLogger.log("[ERROR](ClientGUI::run) Rendering error: " +
-                              std::string(e.what()));
+                LOG_ERROR(guiLogger, "(ClientGUI::run) Rendering error: " +
+                                     std::string(e.what()));
                 
                 // Fallback rendering
                 window.clear(sf::Color::Black);
@@ -2463,7 +2878,7 @@ void ClientGUI::run() {
     }
     
     
-    guiLogger.log("[INFO](ClientGUI::run) GUI run loop terminated.");
+    LOG_INFO(guiLogger, "(ClientGUI::run) GUI run loop terminated.");
 }
 
 }
@@ -0,0 +1,32 @@
+//
+//  Checksum.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace protocol {
+
+// XXH64 of the bytes, what get and put check every chunk of a transfer with.
+// Not cryptographic: it catches corruption and a file that changed under a
+// transfer, at memory speed, not someone forging content.
+uint64_t checksum(const void* data, size_t size, uint64_t seed = 0);
+
+inline uint64_t checksum(std::string_view bytes) {
+    return checksum(bytes.data(), bytes.size());
+}
+
+// 16 lowercase hex digits, how checksums travel in request and response lines
+std::string formatChecksum(uint64_t value);
+// false unless text is exactly such a value
+bool parseChecksum(std::string_view text, uint64_t& value);
+
+}
@@ -0,0 +1,67 @@
+//
+//  Compression.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// zlib
+#include <zlib.h>
+
+// std
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+namespace protocol {
+
+// Response frames of a channel compress as one raw deflate stream: every frame
+// ends on a sync flush so it inflates as soon as it arrives, and the window the
+// earlier frames built carries over to the next ones, so the lines a command
+// repeats cost a few bytes each. Small frames and output that did not compress
+// lately go as they are and stay out of the stream on both sides.
+constexpr uint8_t CODEC_DEFLATE = 1;
+constexpr size_t COMPRESS_THRESHOLD = 1024;        // smaller frames go as they are
+constexpr size_t INCOMPRESSIBLE_SKIP = 1u << 20;   // bytes sent as they are after a frame that did not compress
+constexpr int COMPRESSION_LEVEL = 1;               // the fastest, text still shrinks several times
+
+class FrameCompressor {
+public:
+    FrameCompressor();
+    ~FrameCompressor();
+
+    // deactivate copy constructors and assign operator
+    FrameCompressor(const FrameCompressor&) = delete;
+    FrameCompressor& operator = (const FrameCompressor&) = delete;
+
+    // false when the frame goes as it is, otherwise out holds the FLAG_COMPRESSED payload;
+    // started tells the first one, the receiver begins a new stream with it
+    bool compress(std::string_view input, std::string& out);
+    bool started() const { return this -> frames > 0; }
+
+private:
+    z_stream stream = {};
+    uint64_t frames = 0;
+    size_t skip = 0;
+};
+
+class FrameDecompressor {
+public:
+    FrameDecompressor();
+    ~FrameDecompressor();
+
+    // deactivate copy constructors and assign operator
+    FrameDecompressor(const FrameDecompressor&) = delete;
+    FrameDecompressor& operator = (const FrameDecompressor&) = delete;
+
+    // replaces out with the frame's bytes, false when the payload is not the next piece of the stream
+    bool decompress(std::string_view input, std::string& out);
+
+private:
+    z_stream stream = {};
+};
+
+}
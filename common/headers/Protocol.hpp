@@ -0,0 +1,189 @@
+//
+//  Protocol.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <unordered_map>
+
+namespace protocol {
+
+// Every message on the wire is a sequence of frames. A frame is a fixed
+// 12 byte header in network byte order followed by `length` payload bytes:
+//
+//   0      1       2         4            8           12
+//   | type | flags | channel | request id | length    | payload ...
+//
+// Payloads above MAX_PAYLOAD are split, every frame but the last carries
+// FLAG_MORE so the receiver knows the message continues.
+//
+// One connection carries many channels, one per pane. Channel 0 is open from
+// the start, the client opens others with CHANNEL_OPEN. Response bytes of a
+// channel are flow controlled: the server never has more than the channel's
+// window in flight and the client hands bytes back with WINDOW_UPDATE.
+//
+// A channel switches to terminal mode with its first TERMINAL_RESIZE: its commands
+// then run on a pseudo-terminal of that size, RESPONSE frames carry the raw terminal
+// bytes and TERMINAL_INPUT frames are keystrokes for the command that is running.
+// With the screen flag set the server emulates the terminal itself and the response
+// carries ScreenUpdates, the cells that changed since the previous one, instead.
+//
+// WATCH_EVENT frames are pushed by the server on their own, to channels that ran
+// `watch <path>`: lines of "<kind> <path>" for what changed since the last one, kind
+// being created, deleted, modified, attributes, moved, unwatched or overflow (too much
+// changed to list, look at the path again). They carry request id 0 and stay outside
+// the window, a channel gets at most one every FileWatcher::DEBOUNCE.
+//
+// A client that can inflate offers it with COMPRESSION on channel 0. From then on
+// the server may send RESPONSE frames with FLAG_COMPRESSED: the payload is the
+// next piece of the channel's deflate stream (see Compression.hpp), the first of
+// a stream also carries FLAG_NEW_STREAM. The window counts the bytes on the wire.
+enum class FrameType : uint8_t {
+    REQUEST = 1,        // command line sent by the client
+    RESPONSE = 2,       // output of the request with the same id
+    CHANNEL_OPEN = 3,   // client starts a new session on the channel
+    CHANNEL_CLOSE = 4,  // client ends the session of the channel
+    WINDOW_UPDATE = 5,  // payload is a u32 of response bytes the client consumed
+    TERMINAL_RESIZE = 6,// payload is u16 rows, u16 columns and an optional u8 screen flag
+    TERMINAL_INPUT = 7, // raw keystrokes for the command running on the channel's terminal
+    WATCH_EVENT = 8,    // server to client, changes under the paths the channel watches
+    COMPRESSION = 9     // client to server, payload is the u8 codec it can take responses in
+};
+
+enum FrameFlags : uint8_t {
+    FLAG_NONE = 0,
+    FLAG_MORE = 1 << 0,         // more frames of the same message follow
+    FLAG_COMPRESSED = 1 << 1,   // payload inflates with the channel's stream
+    FLAG_NEW_STREAM = 1 << 2    // with FLAG_COMPRESSED: the channel's stream starts over here
+};
+
+constexpr size_t HEADER_SIZE = 12;
+constexpr uint32_t MAX_PAYLOAD = 1u << 20;
+// what a receiver joins FLAG_MORE frames into at most, a longer message or more unfinished ones are malformed
+constexpr size_t MAX_MESSAGE = 16 * MAX_PAYLOAD;
+constexpr size_t MAX_OPEN_MESSAGES = 256;
+
+// flow control: initial per channel window and the frame size responses are cut into,
+// small enough that channels interleave fairly on the shared connection
+constexpr uint32_t INITIAL_WINDOW = 1u << 20;
+constexpr uint32_t STREAM_CHUNK = 32 * 1024;
+
+struct FrameHeader {
+    FrameType type = FrameType::REQUEST;
+    uint8_t flags = FLAG_NONE;
+    uint16_t channel = 0;
+    uint32_t requestId = 0;
+    uint32_t length = 0;
+};
+
+// payload is a view into the parser buffer, it stays valid until the parser is written again
+struct Frame {
+    FrameHeader header;
+    std::string_view payload;
+
+    bool hasMore() const { return this -> header.flags & FLAG_MORE; }
+};
+
+void encodeHeader(const FrameHeader& header, char* out);
+FrameHeader decodeHeader(const char* in);
+
+// appends the frames of one message to a send buffer, frameSize caps each frame's payload
+void appendMessage(std::string& out, FrameType type, uint16_t channel, uint32_t requestId,
+                   std::string_view payload, size_t frameSize = MAX_PAYLOAD);
+
+// blocking send of one message, the payload goes out with writev straight from the caller's buffer
+bool sendMessage(int socket, FrameType type, uint16_t channel, uint32_t requestId, std::string_view payload);
+
+// blocking send of bytes that are already framed
+bool sendAll(int socket, const char* data, size_t size);
+
+// frames are already batched per send, Nagle would only hold back the short last one
+void setNoDelay(int socket);
+
+// WINDOW_UPDATE payload
+std::string encodeWindowUpdate(uint32_t bytes);
+uint32_t decodeWindowUpdate(std::string_view payload);
+
+// TERMINAL_RESIZE payload
+struct WindowSize {
+    uint16_t rows = 24;
+    uint16_t columns = 80;
+    bool screen = false;    // screen updates instead of raw terminal bytes
+};
+std::string encodeWindowSize(const WindowSize& size);
+WindowSize decodeWindowSize(std::string_view payload);
+
+// screen mode output: at most SCREEN_UPDATE_RATE updates a second, however fast the program writes
+constexpr unsigned SCREEN_UPDATE_RATE = 30;
+
+// changed cells of one row, starting at column
+struct ScreenRun {
+    uint16_t row = 0;
+    uint16_t column = 0;
+    std::u32string text;
+};
+
+// A screen with a size other than the receiver's mirror starts from a blank one.
+// On the wire: "SU", u32 body length, then u16 rows, columns, cursor row, cursor column,
+// u16 run count and per run u16 row, column, byte length and the run's UTF-8 text.
+struct ScreenUpdate {
+    uint16_t rows = 0;
+    uint16_t columns = 0;
+    uint16_t cursorRow = 0;
+    uint16_t cursorColumn = 0;
+    std::vector<ScreenRun> runs;
+};
+std::string encodeScreenUpdate(const ScreenUpdate& update);
+// bytes of buffer the update took, 0 while it is still incomplete, npos when the buffer
+// does not start with an update (the plain text that ends a command)
+size_t decodeScreenUpdate(std::string_view buffer, ScreenUpdate& update);
+
+std::string encodeUtf8(std::u32string_view text);
+
+// Incremental frame parser. Bytes are received directly into the parser's
+// buffer (prepare/commit) and frames come out as views over that buffer, so a
+// payload is never copied between the socket and the request handler.
+class FrameParser {
+public:
+    enum class Result {
+        FRAME,      // frame filled in
+        NEED_MORE,  // wait for more bytes
+        MALFORMED   // the stream is not RemMux framing, drop the connection
+    };
+
+    // writable space of at least `minimum` bytes, compacts consumed frames first;
+    // call writable() after prepare(), never in the same argument list
+    char* prepare(size_t minimum);
+    size_t writable() const;
+    void commit(size_t bytes);
+
+    // copies bytes that already sit in another buffer
+    void append(const char* data, size_t size);
+
+    Result next(Frame& frame);
+
+    // like next, but joins FLAG_MORE frames of one request id on one channel into a single message;
+    // MALFORMED past MAX_MESSAGE bytes or MAX_OPEN_MESSAGES unfinished messages
+    Result nextMessage(Frame& message);
+
+    size_t buffered() const { return this -> writePos - this -> readPos; }
+
+private:
+    std::vector<char> buffer;
+    size_t readPos = 0;
+    size_t writePos = 0;
+
+    std::unordered_map<uint64_t, std::string> partial;  // unfinished messages by channel and request id
+    std::string assembled;                              // backs the last joined message
+};
+
+}
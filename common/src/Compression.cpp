@@ -0,0 +1,90 @@
+//
+//  Compression.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Compression.hpp"
+
+#include <algorithm>
+
+namespace protocol {
+
+FrameCompressor::FrameCompressor() {
+    deflateInit2(&this -> stream, COMPRESSION_LEVEL, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+}
+
+FrameCompressor::~FrameCompressor() {
+    deflateEnd(&this -> stream);
+}
+
+bool FrameCompressor::compress(std::string_view input, std::string& out) {
+    if (input.size() < COMPRESS_THRESHOLD) {
+        return false;
+    }
+    if (this -> skip > 0) {
+        this -> skip -= std::min(this -> skip, input.size());
+        return false;
+    }
+
+    // a sync flush adds its empty block on top of the bound
+    out.resize(deflateBound(&this -> stream, static_cast<uLong>(input.size())) + 16);
+    this -> stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    this -> stream.avail_in = static_cast<uInt>(input.size());
+    size_t produced = 0;
+    do {
+        if (produced == out.size()) {
+            out.resize(out.size() * 2);
+        }
+        this -> stream.next_out = reinterpret_cast<Bytef*>(out.data() + produced);
+        this -> stream.avail_out = static_cast<uInt>(out.size() - produced);
+        deflate(&this -> stream, Z_SYNC_FLUSH);
+        produced = out.size() - this -> stream.avail_out;
+    } while (this -> stream.avail_out == 0);
+    out.resize(produced);
+    ++this -> frames;
+
+    // the stream took it, so it goes compressed; the next ones try again after a while
+    if (produced * 10 > input.size() * 9) {
+        this -> skip = INCOMPRESSIBLE_SKIP;
+    }
+    return true;
+}
+
+FrameDecompressor::FrameDecompressor() {
+    inflateInit2(&this -> stream, -15);
+}
+
+FrameDecompressor::~FrameDecompressor() {
+    inflateEnd(&this -> stream);
+}
+
+bool FrameDecompressor::decompress(std::string_view input, std::string& out) {
+    out.resize(std::max<size_t>(input.size() * 4, 64 * 1024));
+    this -> stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(input.data()));
+    this -> stream.avail_in = static_cast<uInt>(input.size());
+    size_t produced = 0;
+    while (true) {
+        this -> stream.next_out = reinterpret_cast<Bytef*>(out.data() + produced);
+        this -> stream.avail_out = static_cast<uInt>(out.size() - produced);
+        int status = inflate(&this -> stream, Z_SYNC_FLUSH);
+        produced = out.size() - this -> stream.avail_out;
+        if (status != Z_OK && status != Z_BUF_ERROR) {
+            return false;
+        }
+        // the sync flush at the end of every frame lets all of it out
+        if (this -> stream.avail_in == 0 && this -> stream.avail_out > 0) {
+            break;
+        }
+        if (this -> stream.avail_out == 0) {
+            out.resize(out.size() * 2);
+        } else if (status == Z_BUF_ERROR) {
+            return false;
+        }
+    }
+    out.resize(produced);
+    return true;
+}
+
+}
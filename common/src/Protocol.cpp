@@ -0,0 +1,425 @@
+//
+//  Protocol.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Protocol.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
+
+namespace protocol {
+
+namespace {
+
+#ifdef MSG_NOSIGNAL
+constexpr int SEND_FLAGS = MSG_NOSIGNAL;
+#else
+constexpr int SEND_FLAGS = 0;
+#endif
+
+bool isKnownType(uint8_t type) {
+    return type >= static_cast<uint8_t>(FrameType::REQUEST) &&
+           type <= static_cast<uint8_t>(FrameType::COMPRESSION);
+}
+
+void putU16(std::string& out, uint16_t value) {
+    uint16_t wire = htons(value);
+    out.append(reinterpret_cast<const char*>(&wire), sizeof(wire));
+}
+
+uint16_t getU16(const char* in) {
+    uint16_t wire;
+    std::memcpy(&wire, in, sizeof(wire));
+    return ntohs(wire);
+}
+
+// one code point from UTF-8, malformed bytes come out as U+FFFD
+char32_t nextCodePoint(std::string_view text, size_t& i) {
+    unsigned char lead = static_cast<unsigned char>(text[i++]);
+    if (lead < 0x80) {
+        return lead;
+    }
+    int length = (lead >= 0xf0) ? 3 : (lead >= 0xe0) ? 2 : (lead >= 0xc0) ? 1 : -1;
+    if (length < 0 || i + length > text.size()) {
+        return 0xfffd;
+    }
+    char32_t point = lead & (0x3f >> length);
+    for (int k = 0; k < length; ++k) {
+        point = (point << 6) | (static_cast<unsigned char>(text[i++]) & 0x3f);
+    }
+    return point;
+}
+
+}
+
+void encodeHeader(const FrameHeader& header, char* out) {
+    uint16_t channel = htons(header.channel);
+    uint32_t requestId = htonl(header.requestId);
+    uint32_t length = htonl(header.length);
+
+    out[0] = static_cast<char>(header.type);
+    out[1] = static_cast<char>(header.flags);
+    std::memcpy(out + 2, &channel, sizeof(channel));
+    std::memcpy(out + 4, &requestId, sizeof(requestId));
+    std::memcpy(out + 8, &length, sizeof(length));
+}
+
+FrameHeader decodeHeader(const char* in) {
+    uint16_t channel;
+    uint32_t requestId;
+    uint32_t length;
+    std::memcpy(&channel, in + 2, sizeof(channel));
+    std::memcpy(&requestId, in + 4, sizeof(requestId));
+    std::memcpy(&length, in + 8, sizeof(length));
+
+    FrameHeader header;
+    header.type = static_cast<FrameType>(static_cast<uint8_t>(in[0]));
+    header.flags = static_cast<uint8_t>(in[1]);
+    header.channel = ntohs(channel);
+    header.requestId = ntohl(requestId);
+    header.length = ntohl(length);
+    return header;
+}
+
+void appendMessage(std::string& out, FrameType type, uint16_t channel, uint32_t requestId,
+                   std::string_view payload, size_t frameSize) {
+    frameSize = std::clamp<size_t>(frameSize, 1, MAX_PAYLOAD);
+    size_t frames = std::max<size_t>(1, (payload.size() + frameSize - 1) / frameSize);
+    out.reserve(out.size() + frames * HEADER_SIZE + payload.size());
+
+    size_t offset = 0;
+    do {
+        size_t chunk = std::min<size_t>(payload.size() - offset, frameSize);
+
+        FrameHeader header;
+        header.type = type;
+        header.channel = channel;
+        header.requestId = requestId;
+        header.length = static_cast<uint32_t>(chunk);
+        header.flags = (offset + chunk < payload.size()) ? FLAG_MORE : FLAG_NONE;
+
+        char raw[HEADER_SIZE];
+        encodeHeader(header, raw);
+        out.append(raw, HEADER_SIZE);
+        out.append(payload.data() + offset, chunk);
+        offset += chunk;
+    } while (offset < payload.size());
+}
+
+bool sendMessage(int socket, FrameType type, uint16_t channel, uint32_t requestId, std::string_view payload) {
+    size_t offset = 0;
+    do {
+        size_t chunk = std::min<size_t>(payload.size() - offset, MAX_PAYLOAD);
+
+        FrameHeader header;
+        header.type = type;
+        header.channel = channel;
+        header.requestId = requestId;
+        header.length = static_cast<uint32_t>(chunk);
+        header.flags = (offset + chunk < payload.size()) ? FLAG_MORE : FLAG_NONE;
+
+        char raw[HEADER_SIZE];
+        encodeHeader(header, raw);
+
+        iovec parts[2];
+        parts[0].iov_base = raw;
+        parts[0].iov_len = HEADER_SIZE;
+        parts[1].iov_base = const_cast<char*>(payload.data() + offset);
+        parts[1].iov_len = chunk;
+
+        msghdr message{};
+        message.msg_iov = parts;
+        message.msg_iovlen = chunk ? 2 : 1;
+
+        // the kernel may take less than a frame, advance the vectors and retry
+        while (message.msg_iovlen > 0) {
+            ssize_t bytesSent = sendmsg(socket, &message, SEND_FLAGS);
+            if (bytesSent == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return false;
+            }
+
+            size_t left = static_cast<size_t>(bytesSent);
+            while (message.msg_iovlen > 0 && left >= message.msg_iov[0].iov_len) {
+                left -= message.msg_iov[0].iov_len;
+                ++message.msg_iov;
+                --message.msg_iovlen;
+            }
+            if (message.msg_iovlen > 0) {
+                message.msg_iov[0].iov_base = static_cast<char*>(message.msg_iov[0].iov_base) + left;
+                message.msg_iov[0].iov_len -= left;
+            }
+        }
+
+        offset += chunk;
+    } while (offset < payload.size());
+
+    return true;
+}
+
+bool sendAll(int socket, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t bytesSent = send(socket, data, size, SEND_FLAGS);
+        if (bytesSent == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        data += bytesSent;
+        size -= bytesSent;
+    }
+    return true;
+}
+
+void setNoDelay(int socket) {
+    int enable = 1;
+    setsockopt(socket, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+}
+
+std::string encodeWindowUpdate(uint32_t bytes) {
+    uint32_t wire = htonl(bytes);
+    return std::string(reinterpret_cast<const char*>(&wire), sizeof(wire));
+}
+
+uint32_t decodeWindowUpdate(std::string_view payload) {
+    if (payload.size() < sizeof(uint32_t)) {
+        return 0;
+    }
+    uint32_t wire;
+    std::memcpy(&wire, payload.data(), sizeof(wire));
+    return ntohl(wire);
+}
+
+std::string encodeWindowSize(const WindowSize& size) {
+    uint16_t wire[2] = {htons(size.rows), htons(size.columns)};
+    std::string payload(reinterpret_cast<const char*>(wire), sizeof(wire));
+    if (size.screen) {
+        payload.push_back(1);
+    }
+    return payload;
+}
+
+WindowSize decodeWindowSize(std::string_view payload) {
+    WindowSize size;
+    if (payload.size() < 2 * sizeof(uint16_t)) {
+        return size;
+    }
+    uint16_t wire[2];
+    std::memcpy(wire, payload.data(), sizeof(wire));
+    // a zero sized terminal breaks full screen programs, keep the default then
+    if (wire[0] != 0 && wire[1] != 0) {
+        size.rows = ntohs(wire[0]);
+        size.columns = ntohs(wire[1]);
+    }
+    size.screen = payload.size() > sizeof(wire) && (payload[sizeof(wire)] & 1);
+    return size;
+}
+
+std::string encodeUtf8(std::u32string_view text) {
+    std::string out;
+    out.reserve(text.size());
+    for (char32_t point : text) {
+        if (point < 0x80) {
+            out.push_back(static_cast<char>(point));
+        } else if (point < 0x800) {
+            out.push_back(static_cast<char>(0xc0 | (point >> 6)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3f)));
+        } else if (point < 0x10000) {
+            out.push_back(static_cast<char>(0xe0 | (point >> 12)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3f)));
+        } else {
+            out.push_back(static_cast<char>(0xf0 | (point >> 18)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 12) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | ((point >> 6) & 0x3f)));
+            out.push_back(static_cast<char>(0x80 | (point & 0x3f)));
+        }
+    }
+    return out;
+}
+
+std::string encodeScreenUpdate(const ScreenUpdate& update) {
+    std::string body;
+    putU16(body, update.rows);
+    putU16(body, update.columns);
+    putU16(body, update.cursorRow);
+    putU16(body, update.cursorColumn);
+    putU16(body, static_cast<uint16_t>(update.runs.size()));
+    for (const auto& run : update.runs) {
+        std::string text = encodeUtf8(run.text);
+        putU16(body, run.row);
+        putU16(body, run.column);
+        putU16(body, static_cast<uint16_t>(text.size()));
+        body += text;
+    }
+
+    uint32_t length = htonl(static_cast<uint32_t>(body.size()));
+    std::string out = "SU";
+    out.append(reinterpret_cast<const char*>(&length), sizeof(length));
+    return out + body;
+}
+
+size_t decodeScreenUpdate(std::string_view buffer, ScreenUpdate& update) {
+    constexpr size_t PREFIX = 2 + sizeof(uint32_t);
+    if (buffer.size() < 2) {
+        return buffer.empty() || buffer[0] == 'S' ? 0 : std::string_view::npos;
+    }
+    if (buffer[0] != 'S' || buffer[1] != 'U') {
+        return std::string_view::npos;
+    }
+    if (buffer.size() < PREFIX) {
+        return 0;
+    }
+    uint32_t length;
+    std::memcpy(&length, buffer.data() + 2, sizeof(length));
+    length = ntohl(length);
+    if (buffer.size() < PREFIX + length) {
+        return 0;
+    }
+
+    const char* in = buffer.data() + PREFIX;
+    const char* end = in + length;
+    if (length < 10) {
+        return std::string_view::npos;
+    }
+    update.rows = getU16(in);
+    update.columns = getU16(in + 2);
+    update.cursorRow = getU16(in + 4);
+    update.cursorColumn = getU16(in + 6);
+    uint16_t count = getU16(in + 8);
+    in += 10;
+
+    update.runs.clear();
+    update.runs.reserve(count);
+    for (uint16_t r = 0; r < count; ++r) {
+        if (end - in < 6) {
+            return std::string_view::npos;
+        }
+        ScreenRun run;
+        run.row = getU16(in);
+        run.column = getU16(in + 2);
+        uint16_t bytes = getU16(in + 4);
+        in += 6;
+        if (end - in < bytes) {
+            return std::string_view::npos;
+        }
+        std::string_view text(in, bytes);
+        for (size_t i = 0; i < text.size();) {
+            run.text.push_back(nextCodePoint(text, i));
+        }
+        in += bytes;
+        update.runs.push_back(std::move(run));
+    }
+    return PREFIX + length;
+}
+
+char* FrameParser::prepare(size_t minimum) {
+    if (this -> readPos == this -> writePos) {
+        this -> readPos = this -> writePos = 0;
+    }
+
+    if (this -> buffer.size() - this -> writePos < minimum && this -> readPos > 0) {
+        // move the partial frame to the front, only the unparsed tail is copied
+        std::memmove(this -> buffer.data(), this -> buffer.data() + this -> readPos, buffered());
+        this -> writePos -= this -> readPos;
+        this -> readPos = 0;
+    }
+
+    if (this -> buffer.size() - this -> writePos < minimum) {
+        this -> buffer.resize(std::max(this -> writePos + minimum, this -> buffer.size() * 2));
+    }
+
+    return this -> buffer.data() + this -> writePos;
+}
+
+size_t FrameParser::writable() const {
+    return this -> buffer.size() - this -> writePos;
+}
+
+void FrameParser::commit(size_t bytes) {
+    this -> writePos += std::min(bytes, writable());
+}
+
+void FrameParser::append(const char* data, size_t size) {
+    std::memcpy(prepare(size), data, size);
+    commit(size);
+}
+
+FrameParser::Result FrameParser::next(Frame& frame) {
+    if (buffered() < HEADER_SIZE) {
+        return Result::NEED_MORE;
+    }
+
+    const char* start = this -> buffer.data() + this -> readPos;
+    FrameHeader header = decodeHeader(start);
+    if (!isKnownType(static_cast<uint8_t>(header.type)) || header.length > MAX_PAYLOAD) {
+        return Result::MALFORMED;
+    }
+
+    if (buffered() < HEADER_SIZE + header.length) {
+        return Result::NEED_MORE;
+    }
+
+    frame.header = header;
+    frame.payload = std::string_view(start + HEADER_SIZE, header.length);
+    this -> readPos += HEADER_SIZE + header.length;
+    return Result::FRAME;
+}
+
+FrameParser::Result FrameParser::nextMessage(Frame& message) {
+    Frame frame;
+    while (true) {
+        Result result = next(frame);
+        if (result != Result::FRAME) {
+            return result;
+        }
+
+        // request ids are only unique within their channel
+        uint64_t key = (static_cast<uint64_t>(frame.header.channel) << 32) | frame.header.requestId;
+        auto it = this -> partial.find(key);
+
+        // the common case, a message that fits one frame is handed out without copying
+        if (!frame.hasMore() && it == this -> partial.end()) {
+            message = frame;
+            return Result::FRAME;
+        }
+
+        // a peer that never finishes its messages must not grow them without end
+        if (it == this -> partial.end()) {
+            if (this -> partial.size() >= MAX_OPEN_MESSAGES) {
+                return Result::MALFORMED;
+            }
+            it = this -> partial.emplace(key, std::string()).first;
+        }
+        if (it -> second.size() + frame.payload.size() > MAX_MESSAGE) {
+            return Result::MALFORMED;
+        }
+        it -> second.append(frame.payload);
+
+        if (frame.hasMore()) {
+            continue;
+        }
+
+        this -> assembled = std::move(it -> second);
+        this -> partial.erase(it);
+
+        message.header = frame.header;
+        message.header.length = static_cast<uint32_t>(this -> assembled.size());
+        message.payload = this -> assembled;
+        return Result::FRAME;
+    }
+}
+
+}
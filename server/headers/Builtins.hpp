@@ -0,0 +1,91 @@
+//
+//  Builtins.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/Reactor.hpp"
+#include "../headers/SessionDirectory.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <locale.h>
+#include <sys/types.h>
+
+namespace server {
+
+// The commands panes send most (ls, pwd, cat, stat, echo) answered inside the
+// server with getdents64/statx and plain reads instead of a trip through bash.
+// Only what comes out byte for byte like coreutils behind a pipe is handled:
+// any other flag, a shell metacharacter or an error (whose message bash and
+// coreutils word themselves) leaves the command to the shell, untouched.
+class Builtins {
+public:
+    explicit Builtins(logs::Logger& logger);
+    ~Builtins();
+
+    // deactivate copy operator overload
+    Builtins(const Builtins&) = delete;
+    Builtins& operator=(const Builtins&) = delete;
+
+    // true when command was answered, result then holds what executeCommand would
+    // return; false when the shell has to run it, nothing was emitted in that case
+    bool run(const std::string& command, const SessionDirectory& workingDirectory,
+             const Reactor::OutputSink& emit, std::string& result);
+
+    // a command that may define aliases, functions or variables in the session's shell,
+    // after which ls and friends no longer mean the programs reproduced here: one of its
+    // simple commands starts with such a builtin or a NAME= word, or it defines name()
+    static bool mayCustomize(const std::string& command);
+
+private:
+    // one directory entry or operand with the metadata ls -l and stat print
+    struct Entry {
+        std::string name;
+        mode_t mode = 0;
+        nlink_t links = 0;
+        uid_t user = 0;
+        gid_t group = 0;
+        off_t size = 0;
+        blkcnt_t blocks = 0;    // 512 byte units
+        blksize_t blockSize = 0;
+        unsigned deviceMajor = 0;
+        unsigned deviceMinor = 0;
+        ino_t inode = 0;
+        timespec accessed{};
+        timespec modified{};
+        timespec changed{};
+        timespec born{};
+        bool hasBirth = false;
+    };
+
+    logs::Logger& logger;
+    bool enabled;           // the system's ls and stat are the GNU ones reproduced here
+    locale_t collation;     // the locale ls sorts names with
+    bool plainTime;         // month names and time format are the C ones ls -l prints
+    bool plainStat = true;  // no SELinux Context line in stat
+
+    bool ls(const std::vector<std::string>& arguments, int directoryFd, std::string& output);
+    bool pwd(const std::vector<std::string>& arguments, const SessionDirectory& workingDirectory, std::string& output);
+    bool cat(const std::vector<std::string>& arguments, int directoryFd, const Reactor::OutputSink& emit, std::string& result);
+    bool stat(const std::vector<std::string>& arguments, int directoryFd, std::string& output);
+    bool echo(const std::vector<std::string>& arguments, std::string& output);
+
+    bool listDirectory(int directoryFd, bool all, bool almostAll, std::vector<std::string>& names);
+    bool describe(int directoryFd, const std::string& name, bool follow, Entry& entry);
+    void sortNames(std::vector<std::string>& names) const;
+    // measured: what the column widths are taken over; total: a directory's listing,
+    // headed by its size in 1K blocks
+    bool longFormat(const std::vector<Entry>& entries, const std::vector<Entry>& measured, int directoryFd, bool total,
+                    std::string& output, std::map<uid_t, std::string>& users, std::map<gid_t, std::string>& groups) const;
+    static bool hasExtendedAccess(int directoryFd, const std::string& name);
+};
+
+}
@@ -0,0 +1,102 @@
+//
+//  ChannelTable.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../../common/headers/Protocol.hpp"
+#include "../../common/headers/Compression.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <map>
+#include <memory>
+#include <cstdint>
+
+namespace server {
+
+// one framed request, the response frames carry the same channel and id
+struct Request {
+    uint16_t channel = 0;
+    uint32_t id = 0;
+    std::string command;
+    bool barrier = false;   // cd/exit: runs alone and in order within its channel
+};
+
+// Per connection view of the pane sessions multiplexed over it: which channels
+// are open, which queued requests may start, and how many response bytes each
+// channel may still put on the wire before the client grants more window.
+// Not thread safe, the owning transport serializes access.
+class ChannelTable {
+public:
+    // what a client frame did, the transport runs its session hooks from this
+    enum class Event {
+        NONE,
+        OPENED,
+        CLOSED,
+        WINDOW,   // new credit, output may be drained
+        REQUEST,  // caller builds the Request and enqueues it
+        TERMINAL  // resize or keystrokes, handed to the session right away
+    };
+
+    // queued response bytes a streaming command may have waiting per channel before it blocks
+    static constexpr size_t STREAM_BUFFER_LIMIT = 256 * 1024;
+
+    ChannelTable();
+
+    Event apply(const protocol::Frame& frame);
+
+    bool open(uint16_t channel);
+    // stops new requests at once, queued output still drains before the channel is forgotten
+    // unless the client itself closed it and nobody reads that output anymore
+    bool close(uint16_t channel, bool discardOutput = false);
+    bool isOpen(uint16_t channel) const;
+    std::vector<uint16_t> openChannels() const;
+
+    // scheduling
+    void enqueue(Request request);
+    std::vector<Request> takeRunnable(unsigned maxInFlight);
+    void finished(const Request& request);
+    void clearPending();
+    unsigned running() const { return this -> inFlight; }
+
+    // flow control; complete = false keeps FLAG_MORE on the last frame, more output follows;
+    // once the client offered COMPRESSION the frames of a channel are compressed as they are queued;
+    // dropped for a channel that is closing, its client no longer reads them
+    void queueResponse(uint16_t channel, uint32_t requestId, std::string_view response, bool complete = true);
+    size_t queuedBytes(uint16_t channel) const;
+    void grant(uint16_t channel, uint32_t bytes);
+    // room for a response frame the transport writes itself, like a file it sends straight from
+    // the page cache: true and taken off the window once nothing of the channel waits before it
+    bool claimWindow(uint16_t channel, size_t bytes);
+    // appends every frame the windows allow, taking one frame per channel in turn
+    void drainInto(std::string& out);
+    bool hasQueuedOutput() const;
+
+private:
+    struct Channel {
+        uint32_t window = protocol::INITIAL_WINDOW;
+        std::deque<std::string> frames;  // encoded response frames waiting for window
+        size_t queued = 0;               // payload bytes in frames
+        unsigned running = 0;
+        bool barrierRunning = false;
+        bool closing = false;
+        std::unique_ptr<protocol::FrameCompressor> compressor;  // made with the first frame worth compressing
+    };
+
+    std::map<uint16_t, Channel> channels;
+    bool compressing = false;
+    std::string compressed;  // the payload of the frame being queued
+    std::deque<Request> pending;
+    unsigned inFlight = 0;
+
+    void forgetIfDone(std::map<uint16_t, Channel>::iterator it);
+};
+
+}
@@ -0,0 +1,158 @@
+//
+//  CommandTable.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <array>
+#include <algorithm>
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <stdexcept>
+
+namespace server {
+
+namespace commands {
+
+// every verb the server can answer itself; a new server side command adds its verb here
+// and registers a handler for it, the hash below is checked to stay perfect at compile time
+constexpr std::array<std::string_view, 11> VERBS = {"cd", "nano", "ls", "pwd", "cat", "stat", "echo", "watch", "unwatch", "get", "put"};
+
+// slots per verb, a sparse table keeps the seed search short
+constexpr size_t SLOTS = 4 * VERBS.size() < 16 ? 16 : 4 * VERBS.size();
+
+constexpr uint32_t hash(std::string_view verb, uint32_t seed) {
+    // FNV-1a started from the seed
+    uint32_t value = 2166136261u ^ seed;
+    for (char c : verb) {
+        value = (value ^ static_cast<unsigned char>(c)) * 16777619u;
+    }
+    return value;
+}
+
+constexpr size_t slotOf(std::string_view verb, uint32_t seed) {
+    return hash(verb, seed) % SLOTS;
+}
+
+// the first seed that puts every verb in a slot of its own, 0 if none was found
+constexpr uint32_t findSeed() {
+    for (uint32_t seed = 1; seed < 100000; ++seed) {
+        bool taken[SLOTS] = {};
+        bool collision = false;
+        for (std::string_view verb : VERBS) {
+            size_t slot = slotOf(verb, seed);
+            collision = collision || taken[slot];
+            taken[slot] = true;
+        }
+        if (!collision) {
+            return seed;
+        }
+    }
+    return 0;
+}
+
+constexpr uint32_t SEED = findSeed();
+static_assert(SEED != 0, "no perfect hash seed for the command verbs, make SLOTS larger");
+
+// slot -> index into VERBS, -1 for the empty ones
+constexpr std::array<int, SLOTS> buildSlots() {
+    std::array<int, SLOTS> slots{};
+    for (int& slot : slots) {
+        slot = -1;
+    }
+    for (size_t i = 0; i < VERBS.size(); ++i) {
+        slots[slotOf(VERBS[i], SEED)] = static_cast<int>(i);
+    }
+    return slots;
+}
+
+constexpr std::array<int, SLOTS> SLOT_TABLE = buildSlots();
+
+// index of verb in VERBS, -1 when the server has no command of that name
+constexpr int find(std::string_view verb) {
+    int index = SLOT_TABLE[slotOf(verb, SEED)];
+    return index != -1 && VERBS[index] == verb ? index : -1;
+}
+
+// a command line cut into its verb and the arguments after it, both views into the line
+struct Parsed {
+    std::string_view verb;
+    std::string_view arguments;
+};
+
+constexpr Parsed parse(std::string_view line) {
+    constexpr std::string_view blanks = " \t";
+    size_t start = line.find_first_not_of(blanks);
+    if (start == std::string_view::npos) {
+        return {};
+    }
+    line.remove_prefix(start);
+    size_t end = line.find_first_of(blanks);
+    if (end == std::string_view::npos) {
+        return {line, {}};
+    }
+    std::string_view arguments = line.substr(end);
+    arguments.remove_prefix(std::min(arguments.find_first_not_of(blanks), arguments.size()));
+    return {line.substr(0, end), arguments};
+}
+
+// one command and nothing after it: no unquoted ; & | ( ) < > or line break
+constexpr bool isSimple(std::string_view line) {
+    char quote = 0;
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (quote != 0) {
+            if (c == quote) {
+                quote = 0;
+            } else if (c == '\\' && quote == '"') {
+                ++i;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+        } else if (c == '\\') {
+            ++i;
+        } else if (std::string_view(";&|()<>\n").find(c) != std::string_view::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static_assert(isSimple("cd 'a;b' \"c|d\" e\\&f") && !isSimple("cd /tmp && ls") && !isSimple("cd /tmp; ls"));
+
+}
+
+// The commands the server answers itself, looked up by the verb of a command
+// line in one hash and one compare, without building a string. Handler is a
+// callable the owner defines; an empty slot means the verb is not registered.
+template <typename Handler>
+class CommandTable {
+public:
+    // verb must be listed in commands::VERBS
+    void add(std::string_view verb, Handler handler) {
+        int index = commands::find(verb);
+        if (index == -1) {
+            throw std::runtime_error("Unknown command verb: " + std::string(verb));
+        }
+        this -> handlers[index] = std::move(handler);
+    }
+
+    // nullptr when the line's verb has no handler
+    const Handler* find(std::string_view verb) const {
+        int index = commands::find(verb);
+        if (index == -1 || !this -> handlers[index]) {
+            return nullptr;
+        }
+        return &this -> handlers[index];
+    }
+
+private:
+    std::array<Handler, commands::VERBS.size()> handlers{};
+};
+
+}
@@ -0,0 +1,53 @@
+//
+//  DirectExec.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+
+namespace server {
+
+// Most command lines are one program and literal arguments, which need no
+// shell at all. Those are split here the way bash would split them and
+// spawned straight from the PATH, with lookups cached like bash's own hash
+// table. Anything bash would expand, redirect or interpret is left to it.
+class DirectExec {
+public:
+    explicit DirectExec(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    DirectExec(const DirectExec&) = delete;
+    DirectExec& operator=(const DirectExec&) = delete;
+
+    // the words of a line bash would run as one plain command, quotes removed; false when it
+    // has expansions, globs, redirections, pipes, lists or a leading assignment
+    static bool split(const std::string& line, std::vector<std::string>& words);
+
+    // argv for a line that can skip the shell and the file to execute for it; false for
+    // shell builtins and keywords and for programs the PATH does not have
+    bool prepare(const std::string& line, std::vector<std::string>& argv, std::string& program);
+
+    // a cached program failed to start, the next call looks it up again
+    void forget(const std::string& name);
+
+private:
+    logs::Logger& logger;
+    std::vector<std::string> searchPath;   // empty when PATH has relative entries, those depend on the cwd
+    std::mutex mutex;                      // paths
+    std::unordered_map<std::string, std::string> paths;
+
+    std::optional<std::string> resolve(const std::string& name);
+};
+
+}
@@ -0,0 +1,73 @@
+//
+//  DirectoryCache.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/SessionDirectory.hpp"
+
+// std
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <unordered_map>
+#include <cstdint>
+
+namespace server {
+
+// Where `cd <path>` lands, by the directory it starts from and its argument, so
+// a session hopping between the same few directories does not resolve them
+// again each time. Like bash, the argument is taken against the session's $PWD
+// and . and .. are dropped from the text, symlinks stay in the path; only when
+// that path cannot be entered is it resolved physically. A hit costs one statx
+// of the path, checked against the directory it resolved to before, which
+// catches a replaced directory or a repointed symlink. Arguments that led
+// nowhere are remembered for MISSING_TTL, and only until the next command that
+// could have created them.
+class DirectoryCache {
+public:
+    static constexpr std::chrono::milliseconds MISSING_TTL{1000};
+    static constexpr size_t MAX_ENTRIES = 256;   // each positive one holds a descriptor
+
+    explicit DirectoryCache(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    DirectoryCache(const DirectoryCache&) = delete;
+    DirectoryCache& operator=(const DirectoryCache&) = delete;
+
+    // false when CDPATH is set, bash would search it for relative names
+    bool enabled() const { return this -> usable; }
+
+    // the directory `cd argument` from `from` ends up in, its path what bash puts in $PWD;
+    // nullptr when bash would refuse it
+    std::shared_ptr<const SessionDirectory> resolve(const SessionDirectory& from, const std::string& argument);
+
+    // a command ran that may have created directories, the missing ones are looked up again
+    void forgetMissing() { ++this -> generation; }
+
+private:
+    struct Entry {
+        std::shared_ptr<const SessionDirectory> directory;   // nullptr for a missing one
+        bool logical = false;                                // directory's path was opened, not the argument
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        std::chrono::steady_clock::time_point expires;       // missing ones only
+        uint64_t generation = 0;
+    };
+
+    logs::Logger& logger;
+    bool usable = true;
+    std::atomic<uint64_t> generation{0};
+    std::mutex mutex;   // entries
+    std::unordered_map<std::string, Entry> entries;
+
+    void storeLocked(const std::string& key, Entry entry);
+};
+
+}
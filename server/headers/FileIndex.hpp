@@ -0,0 +1,82 @@
+//
+//  FileIndex.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <map>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <cstdint>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace server {
+
+// Where the lines of a file start, so the editor can ask for a few lines of a
+// file of any size: `nano --lines=<first>,<count> <file>`. The file is read
+// with pread, SCAN_BLOCK bytes at a time, and only as far as a request needs;
+// one offset per CHECKPOINT_LINES lines is kept, so the first screen of a huge
+// log costs the same as the one of a small file. Nothing is mapped, a file
+// truncated under a scan only ends early. Descriptors stay open for the last
+// MAX_FILES files and are dropped once a file changes size or modification
+// time, which is checked on every request.
+class FileIndex {
+public:
+    static constexpr size_t CHECKPOINT_LINES = 256;
+    static constexpr size_t MAX_FILES = 8;
+    static constexpr size_t MAX_LINES = 4096;   // per request
+    static constexpr size_t SCAN_BLOCK = 64 * 1024;
+
+    // lines [firstLine, firstLine + lines) are the bytes [offset, offset + length) of the file
+    struct Range {
+        std::shared_ptr<const void> file;   // keeps the descriptor below open
+        int fd = -1;
+        size_t length = 0;
+        size_t firstLine = 0;
+        size_t lines = 0;
+        long long totalLines = -1;          // -1 until a request reached the end of the file
+        size_t offset = 0;
+        size_t fileSize = 0;
+        std::string version;
+
+        // the bytes themselves, for a sink that cannot send from the descriptor;
+        // false when the file got shorter since it was scanned
+        bool read(std::string& out) const;
+    };
+
+    // changes whenever the file is replaced or written, a save checks the file it edits still has it
+    static std::string version(const struct stat& info);
+
+    explicit FileIndex(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    FileIndex(const FileIndex&) = delete;
+    FileIndex& operator=(const FileIndex&) = delete;
+
+    // fd is an open, non-empty regular file, info its fstat; the index keeps a descriptor of its own
+    bool lines(int fd, const struct stat& info, size_t firstLine, size_t count, Range& range);
+
+private:
+    struct Scanned;
+    using Key = std::pair<uint64_t, uint64_t>;   // device, inode
+
+    logs::Logger& logger;
+    std::mutex mutex;   // the two below
+    std::map<Key, std::shared_ptr<Scanned>> files;
+    std::list<Key> ages;   // least recently used first
+
+    std::shared_ptr<Scanned> opened(int fd, const struct stat& info);
+};
+
+}
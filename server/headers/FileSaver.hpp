@@ -0,0 +1,83 @@
+//
+//  FileSaver.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/SessionDirectory.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <memory>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <utility>
+#include <cstdint>
+#include <sys/stat.h>
+
+namespace server {
+
+// Saves from nano, written next to the file they replace. The new content goes
+// into a temporary file in the same directory, in pieces that may arrive in any
+// order, and only a commit that received every byte fsyncs it and renames it
+// over the original: readers see the old file or the new one, never a mix, and
+// a connection that drops mid-save leaves the original as it was. A piece
+// either carries its bytes or names a range of the original to copy, which the
+// kernel does without the data passing through the server, so a client that
+// edited a few lines of a large file only uploads those.
+class FileSaver {
+public:
+    // client socket and channel, the server's SessionKey
+    using Owner = std::pair<int, uint16_t>;
+
+    static constexpr size_t MAX_SAVES_PER_SESSION = 4;
+
+    explicit FileSaver(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    FileSaver(const FileSaver&) = delete;
+    FileSaver& operator=(const FileSaver&) = delete;
+
+    // starts replacing name, relative to directory; base is the version of the original the
+    // copied ranges refer to, empty when nothing is copied. Every call returns empty on success,
+    // otherwise the error for the client
+    std::string begin(const Owner& owner, const SessionDirectory& directory, const std::string& name,
+                      const std::string& base, uint64_t& id);
+    std::string write(const Owner& owner, uint64_t id, uint64_t at, std::string_view bytes);
+    std::string copy(const Owner& owner, uint64_t id, uint64_t at, uint64_t from, uint64_t length);
+    // the new content is size bytes long; version is the one the saved file has
+    std::string commit(const Owner& owner, uint64_t id, uint64_t size, std::string& version);
+    void abort(const Owner& owner, uint64_t id);
+    // the session is closing, its unfinished saves are thrown away
+    void dropSession(const Owner& owner);
+
+private:
+    struct Save {
+        std::string target;      // what the commit renames onto, symlinks resolved
+        std::string temporary;   // removed unless the commit renamed it
+        int fd = -1;             // temporary
+        int source = -1;         // the original, -1 when there was none
+        uint64_t sourceSize = 0;
+        bool replaces = false;   // the original's mode and owner carry over
+        struct stat original{};
+        std::atomic<uint64_t> written{0};
+        bool committed = false;
+
+        ~Save();
+    };
+
+    logs::Logger& logger;
+    std::atomic<uint64_t> nextId{1};
+    std::mutex mutex;   // saves
+    std::map<std::pair<Owner, uint64_t>, std::shared_ptr<Save>> saves;
+
+    std::shared_ptr<Save> find(const Owner& owner, uint64_t id);
+};
+
+}
@@ -0,0 +1,70 @@
+//
+//  FileTransfer.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/Reactor.hpp"
+#include "../headers/SessionDirectory.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+#include <mutex>
+#include <unordered_map>
+
+namespace server {
+
+// The server side of the client's get and put. Every request stands on its own
+// and names its file, so the client can spread the chunks of one file over
+// several channels and pick an interrupted transfer up on a new connection:
+//
+//   get --stat <file>                               FILE <size> <mode> <version>, or DIR for a TreeArchive
+//   get --chunk=<offset>,<length>,<version> <file>  CHUNK <offset> <length> <checksum>, then the bytes
+//   get --sums=<chunk>,<up to> <file>               SUMS and the checksum of every whole chunk
+//   put --begin=<size> <file>                       PART <bytes an earlier put left>
+//   put --sums=<chunk>,<up to> <file>               the same, over those bytes
+//   put --data=<offset>,<checksum> <file>           OK once the bytes after this line matched and are written
+//   put --commit=<size> <file>                      DONE, the upload replaced the file
+//
+// An upload collects in .<name>.remmux-part next to its file until the commit
+// fsyncs it and renames it over the file. The size given to begin bounds every
+// data request and the commit after it.
+class FileTransfer {
+public:
+    static constexpr size_t MAX_CHUNK = 8u << 20;
+    static constexpr size_t MAX_SUMS = 65536;   // checksums in one SUMS answer
+
+    explicit FileTransfer(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    FileTransfer(const FileTransfer&) = delete;
+    FileTransfer& operator=(const FileTransfer&) = delete;
+
+    // arguments are what follows the verb; false when they are not one of the requests above,
+    // the line is then the shell's
+    bool get(const std::string& arguments, const SessionDirectory& workingDirectory,
+             const Reactor::OutputSink& emit, std::string& result);
+    bool put(const std::string& arguments, const SessionDirectory& workingDirectory, std::string& result);
+
+private:
+    logs::Logger& logger;
+
+    // partial file -> the size its begin announced
+    std::mutex uploadsMutex;
+    std::unordered_map<std::string, uint64_t> uploads;
+
+    bool announced(const std::string& partial, uint64_t& size);
+
+    std::string chunk(int fd, uint64_t offset, uint64_t length, const std::string& version, const Reactor::OutputSink& emit);
+    std::string sums(int fd, uint64_t chunkSize, uint64_t upTo);
+    std::string commit(const std::string& target, const std::string& partial, uint64_t size);
+};
+
+}
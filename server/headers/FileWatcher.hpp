@@ -0,0 +1,91 @@
+//
+//  FileWatcher.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <utility>
+#include <cstdint>
+
+namespace server {
+
+// Filesystem changes pushed to the sessions that asked for them with
+// `watch <path>`, so a pane learns about a new file without running ls in a
+// loop. One inotify watch serves every session watching the same path. A
+// session's changes are collected for DEBOUNCE and then leave as one batch,
+// one line per path with the latest kind of change; a batch that grows past
+// MAX_BATCH is replaced by an overflow line telling the client to look again.
+// The owner serves fd() on its event loop and calls process when it is
+// readable. Linux only.
+class FileWatcher {
+public:
+    // client socket and channel, the server's SessionKey
+    using Subscriber = std::pair<int, uint16_t>;
+    // sends one batch of "<kind> <path>\n" lines; called by process with the watcher locked,
+    // so a session that is being dropped never gets one after its socket closed
+    using Delivery = std::function<void(const Subscriber& subscriber, std::string_view events)>;
+
+    static constexpr std::chrono::milliseconds DEBOUNCE{100};
+    static constexpr size_t MAX_WATCHES_PER_SESSION = 16;
+    static constexpr size_t MAX_BATCH = 256;
+
+    explicit FileWatcher(logs::Logger& logger);
+    ~FileWatcher();
+
+    // deactivate copy operator overload
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // readable while changes wait to be read or a batch is due, -1 without inotify
+    int fd() const { return this -> pollFd; }
+
+    // path is absolute; empty on success, otherwise the error for the client
+    std::string watch(const Subscriber& subscriber, const std::string& path);
+    bool unwatch(const Subscriber& subscriber, const std::string& path);
+    std::vector<std::string> watched(const Subscriber& subscriber);
+    // the session is closing, nothing is delivered to it after this returns
+    void dropSession(const Subscriber& subscriber);
+
+    // reads pending changes and delivers the batches that are due
+    void process(const Delivery& deliver);
+
+private:
+    struct Batch {
+        std::map<std::string, std::string> changes;   // path -> kind
+        std::set<std::string> overflowed;             // watched paths that changed too much to list
+        std::chrono::steady_clock::time_point due;
+    };
+
+    logs::Logger& logger;
+    int pollFd = -1;      // epoll set of the two below
+    int inotifyFd = -1;
+    int timerFd = -1;     // fires when the earliest batch is due
+
+    std::mutex mutex;     // everything below
+    std::map<std::string, int> watchByPath;
+    std::map<int, std::string> pathByWatch;
+    std::map<int, std::set<Subscriber>> subscribers;
+    std::map<Subscriber, std::set<int>> watchesOf;
+    std::map<Subscriber, Batch> batches;
+
+    void readEventsLocked();
+    void recordLocked(const Subscriber& subscriber, const std::string& root, const std::string& path, std::string_view kind);
+    void releaseLocked(const Subscriber& subscriber, int watch);
+    void armTimerLocked();
+};
+
+}
@@ -0,0 +1,85 @@
+//
+//  ProcessRunner.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <functional>
+#include <sys/types.h>
+
+namespace server {
+
+// how a child ended
+struct ExitStatus {
+    bool started = false;   // false when the spawn itself failed
+    int code = -1;          // exit code, -1 when killed by a signal
+    int signal = 0;         // terminating signal, 0 for a normal exit
+
+    bool success() const { return this -> started && this -> code == 0; }
+};
+
+// Runs commands without forking the server: posix_spawn (vfork semantics, the
+// cost does not grow with the server's RSS) into its own process group, with
+// stdout and stderr on separate pipes that are polled and forwarded as they fill.
+// On Linux the child is reaped through a pidfd as soon as it exits.
+class ProcessRunner {
+public:
+    enum class Stream {
+        STDOUT,
+        STDERR
+    };
+
+    // output as it arrives; returning false kills the child and everything it started
+    using OutputHandler = std::function<bool(Stream stream, std::string_view chunk)>;
+
+    // a started child, the caller owns the descriptors and reaps the pid
+    struct Child {
+        pid_t pid = -1;
+        int input = -1;    // write end of its stdin, -1 when stdin is /dev/null
+        int output = -1;   // on a terminal the master side, read and written
+        int error = -1;
+    };
+
+    explicit ProcessRunner(logs::Logger& logger);
+
+    // deactivate copy operator overload
+    ProcessRunner(const ProcessRunner&) = delete;
+    ProcessRunner& operator=(const ProcessRunner&) = delete;
+
+    // what a child executes, by default argv[0] with the server's environment
+    struct Exec {
+        std::string program;                  // the file to execute when argv[0] is only the name it sees
+        std::vector<std::string> variables;   // NAME=value on top of the server's environment
+        // run passes the child's process group once it runs and -1 before reaping it, a signal sent to
+        // the group in between reaches only the child and what it started
+        std::function<void(pid_t group)> onGroup;
+    };
+
+    // argv[0] (or exec.program) is a path taken after the child fchdirs into directoryFd (-1 keeps
+    // the server's cwd); the child reads /dev/null; blocks until it exited and its pipes are drained
+    ExitStatus run(const std::vector<std::string>& argv, int directoryFd, const OutputHandler& onOutput,
+                   const Exec& exec = {});
+
+    // only spawns, for children that outlive one request; withInput gives them a stdin pipe
+    bool start(const std::vector<std::string>& argv, int directoryFd, bool withInput, Child& child,
+               const Exec& exec = {});
+
+    // spawns as the leader of a new session on a fresh pseudo-terminal of the given size,
+    // the terminal is its controlling tty and TERM is set for full screen programs
+    bool startTerminal(const std::vector<std::string>& argv, int directoryFd,
+                       unsigned short rows, unsigned short columns, Child& child);
+
+private:
+    logs::Logger& logger;
+};
+
+}
@@ -0,0 +1,109 @@
+//
+//  Reactor.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/ThreadPool.hpp"
+#include "../headers/ChannelTable.hpp"
+#include "../../common/headers/Protocol.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <functional>
+#include <unordered_map>
+#include <sys/types.h>
+
+namespace server {
+
+// Edge-triggered epoll event loop. All client sockets are non-blocking and
+// spread over a small fixed set of I/O threads; requests run on a worker pool
+// so a slow command never stalls the other connections of its loop.
+class Reactor {
+public:
+    // takes output of a running request as it is produced, blocks while the client is behind;
+    // false once nobody reads it anymore and the command should stop
+    using OutputSink = std::function<bool(std::string_view chunk)>;
+    // the same for length bytes of a file from offset, which go from the page cache to the socket;
+    // empty when the transport cannot, the caller then reads them and uses the OutputSink
+    using FileSink = std::function<bool(int fd, off_t offset, size_t length)>;
+    // returns the rest of the response for one request, sets closeSession to end the channel after it is sent;
+    // ending channel 0 hangs up the whole connection
+    using RequestHandler = std::function<std::string(int clientSocket, uint16_t channel, const std::string& request,
+                                                     const OutputSink& emit, const FileSink& sendFile, bool& closeSession)>;
+    using SessionHook = std::function<void(int clientSocket, uint16_t channel)>;
+    // TERMINAL_RESIZE and TERMINAL_INPUT frames, run on the I/O thread as soon as they arrive
+    using TerminalHook = std::function<void(int clientSocket, const protocol::Frame& frame)>;
+    // true for requests that must run alone and in arrival order (cd, exit)
+    using OrderingPredicate = std::function<bool(const std::string& request)>;
+
+    // requests of one connection that may run on the worker pool at the same time
+    static constexpr unsigned MAX_IN_FLIGHT = 32;
+    // the pool grows up to this while its workers sit in long commands, a blocked one must not stall other clients
+    static constexpr size_t MAX_WORKERS = 512;
+
+    Reactor(int listenSocket, unsigned ioThreads, size_t workerThreads, logs::Logger& logger,
+            RequestHandler handler, OrderingPredicate isBarrier, SessionHook onOpen, SessionHook onClose,
+            TerminalHook onTerminal);
+    ~Reactor();
+
+    // deactivate copy operator overload
+    Reactor(const Reactor&) = delete;
+    Reactor& operator=(const Reactor&) = delete;
+
+    // false on platforms without epoll, the caller then keeps the threaded mode
+    static bool isSupported();
+
+    // blocks forever, the calling thread becomes I/O loop 0 and owns the listening socket
+    void run();
+
+    // another descriptor served by I/O loop 0, onReadable runs there for as long as it is readable;
+    // only before run
+    void addSource(int fd, std::function<void()> onReadable);
+
+    // a message the client did not ask for, like WATCH_EVENT, dropped when the channel is not open;
+    // it bypasses the channel window, so only for small ones
+    void push(int clientSocket, uint16_t channel, protocol::FrameType type, std::string_view payload);
+
+private:
+    struct Connection;
+    struct IOLoop;
+
+    int listenSocket;
+    logs::Logger& logger;
+    RequestHandler handler;
+    OrderingPredicate isBarrier;
+    SessionHook onOpen;
+    SessionHook onClose;
+    TerminalHook onTerminal;
+    std::vector<std::unique_ptr<IOLoop>> loops;
+    std::unique_ptr<ThreadPool> workers;
+    std::unordered_map<int, std::function<void()>> sources;   // fixed once the loops run
+    size_t nextLoop = 0;
+
+    void loopRun(IOLoop& loop);
+    void acceptClients();
+    void handleReadable(IOLoop& loop, const std::shared_ptr<Connection>& connection);
+    void handleWritable(const std::shared_ptr<Connection>& connection);
+    void closeConnection(IOLoop& loop, int clientSocket);
+
+    // request execution on the worker pool, independent requests of a connection run concurrently
+    void dispatch(const std::shared_ptr<Connection>& connection, Request request);
+    void execute(const std::shared_ptr<Connection>& connection, Request request);
+    bool streamChunk(const std::shared_ptr<Connection>& connection, const Request& request, std::string_view chunk);
+    bool streamFile(const std::shared_ptr<Connection>& connection, const Request& request, int fd, off_t offset, size_t length);
+    void completeRequest(const std::shared_ptr<Connection>& connection, const Request& request, std::string response, bool closeAfter);
+    void applyFrame(const std::shared_ptr<Connection>& connection, const protocol::Frame& frame);
+    bool flushLocked(Connection& connection);
+};
+
+}
@@ -0,0 +1,104 @@
+//
+//  ResultCache.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/SessionDirectory.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <list>
+#include <map>
+#include <set>
+#include <mutex>
+#include <optional>
+#include <unordered_map>
+#include <cstdint>
+
+namespace server {
+
+// Output of read only commands (ls -la, cat config, wc -l log) kept per command
+// line and working directory, so a dashboard rerunning them on files that did
+// not change is answered without a process. The directories a command reads
+// are watched with inotify and any change in them drops its entries; the
+// inode and times of every path it names are checked again on each hit for
+// changes inotify cannot see. Commands that name a device, a fifo or a path on
+// /proc, /sys or another filesystem that changes without telling run every
+// time. Opt-in with --cache-results, Linux only.
+class ResultCache {
+public:
+    // one cached answer is at most this much output, larger ones are not kept
+    static constexpr size_t MAX_OUTPUT = 64 * 1024;
+    static constexpr size_t MAX_ENTRIES = 256;
+
+    // where a path stood when the command was looked up
+    struct Snapshot {
+        bool exists = false;
+        uint64_t device = 0;
+        uint64_t inode = 0;
+        int64_t modified = 0;   // nanoseconds
+        int64_t changed = 0;
+        uint64_t size = 0;
+
+        bool operator==(const Snapshot& other) const;
+    };
+
+    // a cacheable command between lookup and store
+    struct Ticket {
+        std::string key;
+        std::vector<Snapshot> snapshots;
+        std::vector<int> watches;
+        uint64_t sequence = 0;   // events seen when the ticket was made
+    };
+
+    explicit ResultCache(logs::Logger& logger);
+    ~ResultCache();
+
+    // deactivate copy operator overload
+    ResultCache(const ResultCache&) = delete;
+    ResultCache& operator=(const ResultCache&) = delete;
+
+    // nullopt unless command is a whitelisted read only program with literal arguments;
+    // watches what it reads from here on
+    std::optional<Ticket> prepare(const std::string& command, const SessionDirectory& workingDirectory);
+
+    // what the command answered last time, if nothing it reads changed since
+    bool lookup(const Ticket& ticket, std::string& output, std::string& result);
+
+    // kept unless something the command reads changed while it ran
+    void store(const Ticket& ticket, std::string output, std::string result);
+
+private:
+    struct Entry {
+        std::vector<Snapshot> snapshots;
+        std::vector<int> watches;
+        std::string output;
+        std::string result;
+        std::list<std::string>::iterator age;
+    };
+
+    logs::Logger& logger;
+    int inotifyFd = -1;
+
+    std::mutex mutex;   // everything below
+    std::unordered_map<std::string, Entry> entries;
+    std::list<std::string> ages;                        // least recently used first
+    std::map<std::string, int> watchByPath;
+    std::map<int, std::string> pathByWatch;
+    std::map<int, std::set<std::string>> dependents;    // watch -> keys of the entries it guards
+    std::map<int, uint64_t> lastEvent;                  // watch -> sequence of its latest event
+    uint64_t sequence = 0;
+
+    void drainEventsLocked();
+    int watchLocked(const std::string& path);
+    void eraseLocked(const std::string& key);
+    void forgetWatchLocked(int watch);
+};
+
+}
@@ -0,0 +1,83 @@
+//
+//  Screen.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../../common/headers/Protocol.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <cstdint>
+
+namespace server {
+
+// The screen a terminal program draws on, kept on the server so the client is
+// sent the cells that changed instead of every byte the program writes. Covers
+// what full screen programs use in practice: cursor movement, erasing, scroll
+// regions, insert/delete and the alternate screen. Colors and attributes are
+// parsed and dropped, the client draws plain text. Not thread safe.
+class Screen {
+public:
+    Screen(uint16_t rows, uint16_t columns);
+
+    void feed(std::string_view bytes);
+    void resize(uint16_t rows, uint16_t columns);
+
+    // anything to send since the last takeUpdate
+    bool changed() const { return this -> dirty; }
+    // the difference to the screen the client was last sent, one run per changed row
+    protocol::ScreenUpdate takeUpdate();
+
+private:
+    enum class State {
+        GROUND,
+        ESCAPE,
+        CHARSET,   // ESC ( and friends, one designator byte follows
+        CSI,
+        OSC,
+        OSC_ESCAPE
+    };
+
+    uint16_t rows;
+    uint16_t columns;
+    std::vector<std::u32string> cells;
+    std::vector<std::u32string> sent;        // what the client shows
+    std::vector<std::u32string> mainScreen;  // parked while the alternate screen is up
+    bool alternate = false;
+    bool dirty = true;
+
+    uint16_t cursorRow = 0;
+    uint16_t cursorColumn = 0;
+    bool wrapPending = false;   // the last column was written, the next character wraps
+    uint16_t savedRow = 0;
+    uint16_t savedColumn = 0;
+    uint16_t scrollTop = 0;
+    uint16_t scrollBottom = 0;  // inclusive
+
+    State state = State::GROUND;
+    std::string parameters;     // CSI bytes before the final one
+    char32_t codePoint = 0;     // UTF-8 sequence being assembled
+    int continuation = 0;
+
+    void print(char32_t character);
+    void control(unsigned char byte);
+    void escape(unsigned char byte);
+    void csi(unsigned char final);
+
+    void lineFeed();
+    void reverseLineFeed();
+    void scrollUp(uint16_t top, uint16_t bottom, uint16_t lines);
+    void scrollDown(uint16_t top, uint16_t bottom, uint16_t lines);
+    void eraseCells(uint16_t row, uint16_t from, uint16_t to);
+    void moveCursor(int row, int column);
+    std::vector<int> numbers(int fallback) const;
+    void reset();
+};
+
+}
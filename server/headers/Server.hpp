@@ -8,6 +8,25 @@
 #pragma once
 
 #include "../headers/Logger.hpp"
+#include "../headers/Reactor.hpp"
+#include "../headers/UringReactor.hpp"
+#include "../headers/ChannelTable.hpp"
+#include "../headers/ProcessRunner.hpp"
+#include "../headers/ShellPool.hpp"
+#include "../headers/SessionDirectory.hpp"
+#include "../headers/Terminal.hpp"
+#include "../headers/Builtins.hpp"
+#include "../headers/DirectExec.hpp"
+#include "../headers/CommandTable.hpp"
+#include "../headers/ResultCache.hpp"
+#include "../headers/FileWatcher.hpp"
+#include "../headers/DirectoryCache.hpp"
+#include "../headers/ZeroCopy.hpp"
+#include "../headers/FileIndex.hpp"
+#include "../headers/FileSaver.hpp"
+#include "../headers/FileTransfer.hpp"
+#include "../headers/TreeArchive.hpp"
+#include "../../common/headers/Protocol.hpp"
 
 // std
 #include <string>
@@ -21,14 +40,49 @@
 #include <cstring>
 #include <stdexcept>
 #include <map>
+#include <functional>
+#include <set>
+#include <vector>
+#include <memory>
+#include <optional>
+#include <algorithm>
+#include <csignal>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <poll.h>
+#include <condition_variable>
+#include <sys/socket.h>
 
 using namespace std::filesystem;
 
 namespace server {
 
+// how client connections are served, picked at startup
+enum class ServerMode {
+    THREADED, // blocking sockets, one detached thread per client
+    EPOLL,    // non-blocking sockets multiplexed by the epoll reactor
+    IO_URING  // batched submissions on a single io_uring
+};
+
+// one pane session: the client socket and the channel multiplexed on it
+using SessionKey = std::pair<int, uint16_t>;
+
+// what a command the server answers itself is handed
+struct CommandCall {
+    const std::string& command;         // the whole line
+    std::string_view arguments;         // after the verb
+    const SessionKey& session;
+    const SessionDirectory& directory;  // held for the whole request
+    const Reactor::OutputSink& emit;
+    const Reactor::FileSink& sendFile;  // empty when the transport cannot send files itself
+};
+
+// true when the command was answered into result, false hands the line on to the shell
+using CommandHandler = std::function<bool(const CommandCall& call, std::string& result)>;
+
 class Server {
 public:
-    Server(unsigned short port);
+    Server(unsigned short port, ServerMode mode = ServerMode::THREADED, unsigned ioThreads = 2, bool cacheResults = false);
     ~Server();
     
     // deactivate copy operator overload
@@ -38,29 +92,97 @@ public:
     void run();
     
 private:
+    struct ThreadedConnection;
+    
     int serverSocket;
     unsigned short port;
-    std::mutex clientMutex; // Mutex for syncing the access to the resources
+    ServerMode mode;
+    unsigned ioThreads;
     logs::Logger logger;
-    std::map<int, path> clientPaths;
-    std::mutex pathsMutex;
+    ProcessRunner runner;   // spawns shell commands, needs the logger above
+    ShellPool shells;       // warm shells handed to new sessions
+    Builtins builtins;      // ls, pwd, cat, stat and echo without a shell
+    DirectExec directExec;  // plain program calls spawned without a shell
+    std::unique_ptr<ResultCache> resultCache;  // read only command output, nullptr unless --cache-results
+    FileWatcher fileWatcher;  // watch <path>, served on the event loop of the mode
+    DirectoryCache directoryCache;  // where cd with a literal path lands, resolved without the shell
+    FileIndex fileIndex;            // line offsets of the files nano pages through
+    FileSaver fileSaver;            // nano saves being uploaded, renamed over their file once complete
+    FileTransfer fileTransfer;      // the chunks of the client's get and put
+    TreeArchive treeArchive;        // a directory's get, compressed on workers of its own
+    std::shared_ptr<const SessionDirectory> startDirectory; // where every new session begins
+    std::map<SessionKey, std::shared_ptr<const SessionDirectory>> clientPaths;
+    std::map<SessionKey, std::string> previousDirectories;  // OLDPWD of each session, for the shell it gets later
+    std::map<SessionKey, std::shared_ptr<Shell>> sessionShells;
+    std::map<SessionKey, protocol::WindowSize> terminalSizes;           // sessions in terminal mode
+    std::map<SessionKey, std::shared_ptr<Terminal>> runningTerminals;  // their command that takes keystrokes
+    std::multimap<SessionKey, std::function<void()>> runningCommands;  // interrupt the line mode commands a session runs
+    std::map<int, std::shared_ptr<ThreadedConnection>> threadedConnections;  // threaded mode, by client socket
+    std::mutex connectionsMutex;  // guards threadedConnections
+    std::unique_ptr<ThreadPool> requestWorkers;  // threaded mode, runs the requests of every client
+    std::set<SessionKey> customizedShells;  // may have aliased or redefined programs, their commands all go to the shell
+    std::mutex pathsMutex;  // guards the session maps
+    CommandTable<CommandHandler> commandTable;  // cd, nano, watch, get, put and the builtins
     
+    void runThreaded();
+    void runReactor();
+    void runUring();
     void handleClient(int clientSocket);
+    // threaded mode: the client's thread only reads, its requests run on requestWorkers
+    void startRequests(const std::shared_ptr<ThreadedConnection>& connection, std::vector<Request> ready);
+    void runRequest(const std::shared_ptr<ThreadedConnection>& connection, const Request& request);
+    // sends the queued watch events and what the windows allow, false once the client is gone
+    bool flushConnection(ThreadedConnection& connection);
+    
+    // session bookkeeping and request handling shared by every server mode
+    void openSession(int clientSocket, uint16_t channel);
+    void closeSession(int clientSocket, uint16_t channel);
+    std::string handleRequest(int clientSocket, uint16_t channel, const std::string& request,
+                              const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile, bool& closeSession);
+    bool isOrderingBarrier(const std::string& request) const;
+    void handleTerminalFrame(int clientSocket, const protocol::Frame& frame);
+    // threaded mode has no event loop, a thread of its own queues the watch events for the workers to send
+    void serveWatches();
     
-    // cd functions to handle edge cases and ensure proper functionality
-    bool validateDirectory(const path& targetPath);
-    path resolvePath(const std::string& rawPath, const path& currentPath);
-    void handleChangeDirectory(const std::string& command, int clientSocket);
+    void registerCommands();
+    
+    // session shells: cd runs in them and every command reports the cwd it left behind
+    std::string handleChangeDirectory(const std::string& command, std::string_view arguments, const SessionKey& session);
+    std::shared_ptr<Shell> sessionShell(const SessionKey& session, const SessionDirectory& workingDirectory);
+    bool rememberDirectory(const SessionKey& session, const std::string& directory, const std::string& previous);
+    // the session's directory handle, nullptr once the pane is closed
+    std::shared_ptr<const SessionDirectory> sessionDirectory(const SessionKey& session);
+    // a terminal for the next command of a terminal mode session, nullptr in line mode
+    // or while another command of the session holds the terminal
+    std::shared_ptr<Terminal> claimTerminal(const SessionKey& session);
+    // line mode sessions whose shell is still the stock bash, the fast paths may stand in for it
+    bool hasStockShell(const SessionKey& session);
     
     //  clean client command
     std::string cleanedCommand(std::string& command);
     
-    // functions to handle other commands execution
-    std::string executeCommand(const std::string& cmd);
-    void processCommand(const std::string& command, int clientSocket, std::string& outputBuffer);
+    // functions to handle other commands execution, output is streamed to emit while the command runs
+    std::string executeCommand(const std::string& cmd, const SessionKey& session, const SessionDirectory& workingDirectory,
+                               const Reactor::OutputSink& emit);
+    // executeCommand answered from the result cache when the command's files did not change
+    std::string executeCached(const std::string& cmd, const SessionKey& session, const SessionDirectory& workingDirectory,
+                              const Reactor::OutputSink& emit);
+    void processCommand(const std::string& command, const SessionKey& session, const Reactor::OutputSink& emit,
+                        const Reactor::FileSink& sendFile, std::string& outputBuffer);
+    
+    // watch <path> and unwatch [path]; false for a watch that is the watch program instead
+    bool handleWatchCommand(const CommandCall& call, std::string& result);
+    bool handleUnwatchCommand(const CommandCall& call, std::string& result);
     
     // nano editor functions
-    std::string handleNanoCommand(const std::string& command);
+    // nano [--lines=<first>,<count>] <file>: the whole file or a page of its lines, streamed through
+    // sendFile or read in STREAM_CHUNK pieces into emit, whatever its size
+    std::string handleNanoCommand(const std::string& arguments, const SessionDirectory& workingDirectory,
+                                  const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile);
+    // nano --save=<version>|new <file> answers SAVING <id>, then pieces of the new content follow:
+    // --save-data=<id>,<at> with the bytes after the first newline, --save-copy=<id>,<at>,<from>,<length>
+    // for a range of the original, and --save-commit=<id>,<size> or --save-abort=<id> end it
+    std::string handleNanoSave(const SessionKey& session, const std::string& arguments, const SessionDirectory& workingDirectory);
     
 };
 
@@ -0,0 +1,43 @@
+//
+//  SessionDirectory.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <string>
+#include <memory>
+#include <filesystem>
+
+namespace server {
+
+// A pane session's working directory held open as a descriptor. Files are resolved
+// with openat/fstatat against it and spawned children fchdir into it, so no request
+// ever reads or moves the server's process-wide cwd and sessions run side by side.
+class SessionDirectory {
+public:
+    // nullptr when the path is not an accessible directory
+    static std::shared_ptr<const SessionDirectory> open(const std::filesystem::path& directory);
+    // the directory name leads to from base, symlinks resolved, with its canonical path taken from
+    // the kernel instead of a walk over every component; nullptr with errno set when it cannot be opened
+    static std::shared_ptr<const SessionDirectory> openAt(const SessionDirectory& base, const std::string& name);
+    ~SessionDirectory();
+
+    // deactivate copy operator overload
+    SessionDirectory(const SessionDirectory&) = delete;
+    SessionDirectory& operator=(const SessionDirectory&) = delete;
+
+    int fd() const { return this -> descriptor; }
+    const std::filesystem::path& path() const { return this -> location; }
+
+private:
+    SessionDirectory(int descriptor, std::filesystem::path location);
+
+    int descriptor;
+    std::filesystem::path location;   // for logs and for shells that cd by name
+};
+
+}
@@ -0,0 +1,98 @@
+//
+//  ShellPool.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/ProcessRunner.hpp"
+
+// std
+#include <string>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <optional>
+#include <condition_variable>
+
+namespace server {
+
+// One long-lived bash bound to a pane session. Commands go in over its stdin
+// and end with a sentinel line on stdout and on stderr, so cd, exports and
+// aliases stay in place between requests and no command pays shell startup.
+class Shell {
+public:
+    // nullptr when bash could not be spawned
+    static std::shared_ptr<Shell> start(ProcessRunner& runner, logs::Logger& logger);
+    ~Shell();
+
+    // deactivate copy operator overload
+    Shell(const Shell&) = delete;
+    Shell& operator=(const Shell&) = delete;
+
+    // false once the shell exited, e.g. after an "exit 1" or "exec" inside a command
+    bool alive();
+
+    // runs one command line in the shell, waiting for a request that is still using it;
+    // directory receives the shell's cwd after the command
+    ExitStatus run(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory);
+    // the same without waiting, nullopt while the shell is busy
+    std::optional<ExitStatus> tryRun(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory);
+
+    // SIGINT to the command it runs, the shell traps it and goes on with the next one
+    void interrupt();
+
+    // the session changed directory without the shell, it cds there before its next command
+    // and takes previous as OLDPWD, so cd - still goes back
+    void follow(const std::string& directory, const std::string& previous);
+
+private:
+    Shell(const ProcessRunner::Child& child, logs::Logger& logger);
+
+    ProcessRunner::Child child;
+    logs::Logger& logger;
+    std::string sentinel;   // random per shell, output never contains it by accident
+    std::string pendingMove;   // script line of the last follow, run ahead of the next command
+    size_t linesRead = 0;   // lines written to the shell, bash numbers its errors by them
+    std::mutex mutex;       // one command at a time
+    std::mutex groupMutex;  // child.pid against reaping, interrupt comes from another thread
+    bool dead = false;
+
+    ExitStatus runLocked(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory);
+    size_t heldBack(const std::string& pending) const;   // length of a tail that may be the start of the sentinel
+    int kill();   // kills the group, reaps, returns the wait status
+};
+
+// Keeps a few shells started ahead of time so a new session gets one without
+// waiting for bash to come up; a background thread refills the pool.
+class ShellPool {
+public:
+    ShellPool(ProcessRunner& runner, logs::Logger& logger, size_t warmShells);
+    ~ShellPool();
+
+    // deactivate copy operator overload
+    ShellPool(const ShellPool&) = delete;
+    ShellPool& operator=(const ShellPool&) = delete;
+
+    // a shell of its own for one session, already inside workingDirectory with previousDirectory as
+    // OLDPWD when there is one; nullptr if none can be started
+    std::shared_ptr<Shell> acquire(const std::string& workingDirectory, const std::string& previousDirectory = "");
+
+private:
+    ProcessRunner& runner;
+    logs::Logger& logger;
+    size_t warmShells;
+    std::deque<std::shared_ptr<Shell>> idle;
+    std::mutex idleMutex;
+    std::condition_variable refillCondition;
+    bool stopping = false;
+    std::thread refiller;
+
+    void refillLoop();
+};
+
+}
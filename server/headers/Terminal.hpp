@@ -0,0 +1,71 @@
+//
+//  Terminal.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/ProcessRunner.hpp"
+#include "../headers/Screen.hpp"
+#include "../../common/headers/Protocol.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <mutex>
+#include <functional>
+#include <sys/types.h>
+
+namespace server {
+
+// One command of a terminal mode session on its own pseudo-terminal, for the
+// full screen programs (top, less, vim) a pipe cannot drive. The raw terminal
+// output is streamed as it comes, or in screen mode fed to a Screen whose
+// changes go out at most SCREEN_UPDATE_RATE times a second, so a flood of output
+// costs the client a bounded number of updates. Keystrokes and resizes may
+// arrive from any thread while run() drives the command.
+class Terminal {
+public:
+    // output as it arrives (encoded ScreenUpdates in screen mode); returning false kills
+    // the command and its whole session
+    using OutputHandler = std::function<bool(std::string_view chunk)>;
+
+    // keystrokes the program has not read yet, beyond it input is dropped like on a full tty
+    static constexpr size_t INPUT_LIMIT = 64 * 1024;
+
+    Terminal(ProcessRunner& runner, logs::Logger& logger, const protocol::WindowSize& size);
+    ~Terminal();
+
+    // deactivate copy operator overload
+    Terminal(const Terminal&) = delete;
+    Terminal& operator=(const Terminal&) = delete;
+
+    // runs command through bash inside directoryFd, blocks until it ended or was hung up
+    ExitStatus run(const std::string& command, int directoryFd, const OutputHandler& onOutput);
+
+    // any thread; input sent before the command started is delivered once it runs
+    void write(std::string_view keys);
+    void resize(const protocol::WindowSize& size);
+    // the client went away, run() kills the command and returns
+    void hangUp();
+
+private:
+    ProcessRunner& runner;
+    logs::Logger& logger;
+
+    std::mutex mutex;           // everything below
+    int master = -1;            // -1 before the command started and after it ended
+    protocol::WindowSize size;
+    bool resized = false;       // size changed, run() resizes its screen
+    std::string pendingInput;   // keystrokes the terminal did not take yet
+    bool hungUp = false;
+    int wake[2] = {-1, -1};     // pokes run() out of poll
+
+    void poke();
+    void flushInputLocked();
+};
+
+}
@@ -0,0 +1,55 @@
+//
+//  ThreadPool.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <vector>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <chrono>
+
+namespace server {
+
+// workers running queued tasks in FIFO order. With maxWorkers above workerCount
+// the pool grows while every worker is busy, so tasks that sleep in a child, a
+// shell or a slow client do not hold up the ones queued behind them; the extra
+// workers leave again after IDLE_TIMEOUT without work.
+class ThreadPool {
+public:
+    static constexpr auto IDLE_TIMEOUT = std::chrono::seconds(30);
+
+    explicit ThreadPool(size_t workerCount, size_t maxWorkers = 0);
+    ~ThreadPool();
+
+    // deactivate copy operator overload
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void submit(std::function<void()> task);
+    // the workers it always keeps
+    size_t size() const;
+
+private:
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> tasks;
+    std::mutex tasksMutex;
+    std::condition_variable tasksCondition;
+    bool stopping = false;
+
+    size_t maxWorkers;
+    size_t idle = 0;                         // workers waiting for a task
+    size_t extra = 0;                        // workers started on demand, detached
+    std::condition_variable extraFinished;   // the destructor waits here for them
+
+    void workerLoop(bool temporary);
+};
+
+}
@@ -0,0 +1,87 @@
+//
+//  TreeArchive.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/Reactor.hpp"
+#include "../headers/SessionDirectory.hpp"
+#include "../headers/ThreadPool.hpp"
+
+// std
+#include <string>
+#include <deque>
+#include <memory>
+#include <future>
+#include <cstdint>
+#include <cstddef>
+#include <sys/stat.h>
+
+namespace server {
+
+// A directory sent as a .tar.gz that is made while it is sent: `get --tree <dir>`
+// answers TREE <name> and a line break, then the archive. The request's thread
+// walks the tree and cuts the tar stream into BLOCK sized pieces, the pool
+// deflates them side by side, each primed with the 32 KiB before it, and they
+// leave in order as one gzip stream the moment they are done. At most AHEAD
+// blocks are held at once and emit waits for the client, so a tree of any size
+// costs the same few megabytes. After the gzip stream comes RESULT_SIZE bytes of
+// "SKIPPED <count>\n", the entries that could not be read and are missing from
+// the archive, the count 12 digits wide.
+class TreeArchive {
+public:
+    static constexpr size_t BLOCK = 1u << 20;
+    static constexpr size_t DICTIONARY = 32 * 1024;
+    static constexpr size_t AHEAD_PER_WORKER = 2;   // blocks in the pool or waiting to be sent, per worker
+    static constexpr size_t MAX_DEPTH = 128;        // directory levels, each holds a descriptor while it is walked
+    static constexpr size_t RESULT_SIZE = 21;       // "SKIPPED " and 12 digits and a line break
+
+    TreeArchive(size_t workerCount, logs::Logger& logger);
+
+    // deactivate copy operator overload
+    TreeArchive(const TreeArchive&) = delete;
+    TreeArchive& operator=(const TreeArchive&) = delete;
+
+    // the directory relative to the session's; an error before the first byte when it cannot be read,
+    // entries that vanish meanwhile are left out of the archive, the ones that cannot be read too and counted
+    std::string stream(const std::string& directory, const SessionDirectory& workingDirectory, const Reactor::OutputSink& emit);
+
+private:
+    struct Compressed {
+        std::string bytes;
+        uint32_t crc = 0;
+        size_t length = 0;   // of the input, for the combined crc
+    };
+
+    // one archive on its way out, the blocks it has in the pool in order
+    struct Output {
+        const Reactor::OutputSink& emit;
+        std::string block;
+        std::shared_ptr<const std::string> previous;
+        std::deque<std::future<Compressed>> pending;
+        uint32_t crc = 0;
+        uint64_t length = 0;
+        bool failed = false;   // the client went away
+        uint64_t skipped = 0;  // unreadable entries, missing from the archive or cut short
+    };
+
+    ThreadPool workers;
+    logs::Logger& logger;
+
+    void walk(int directoryFd, const std::string& prefix, Output& output, size_t depth);
+    void addEntry(int directoryFd, const char* name, const std::string& path, Output& output, size_t depth);
+    void append(Output& output, const char* data, size_t length);
+    void header(Output& output, const std::string& path, const struct stat& info, char type, uint64_t size,
+                const std::string& link);
+    // the full block to the pool, then out whatever is already done; waits while AHEAD blocks are in flight
+    void seal(Output& output, bool last);
+    void sendFront(Output& output);
+
+    static Compressed deflateBlock(std::shared_ptr<const std::string> block, std::shared_ptr<const std::string> previous, bool last);
+};
+
+}
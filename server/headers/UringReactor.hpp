@@ -0,0 +1,112 @@
+//
+//  UringReactor.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+#include "../headers/Logger.hpp"
+#include "../headers/Reactor.hpp"
+#include "../headers/ThreadPool.hpp"
+
+// std
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <cstdint>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+
+namespace server {
+
+// io_uring transport: one ring thread owns every socket, accepts with a
+// multishot accept, receives with multishot recv into a provided-buffer ring
+// and writes responses as chains of linked sends. All SQEs produced while
+// draining a batch of completions go to the kernel in a single io_uring_enter.
+class UringReactor {
+public:
+    UringReactor(int listenSocket, size_t workerThreads, logs::Logger& logger,
+                 Reactor::RequestHandler handler, Reactor::OrderingPredicate isBarrier,
+                 Reactor::SessionHook onOpen, Reactor::SessionHook onClose, Reactor::TerminalHook onTerminal);
+    ~UringReactor();
+
+    // deactivate copy operator overload
+    UringReactor(const UringReactor&) = delete;
+    UringReactor& operator=(const UringReactor&) = delete;
+
+    // probes the running kernel, false means the caller keeps the blocking path
+    static bool isSupported();
+
+    // blocks forever on the calling thread
+    void run();
+
+    // another descriptor polled on the ring, onReadable runs on the ring thread whenever it is
+    // readable; only before run
+    void addSource(int fd, std::function<void()> onReadable);
+
+    // a message the client did not ask for, like WATCH_EVENT, outside the channel window;
+    // ring thread only, which is where source callbacks run
+    void push(int clientSocket, uint16_t channel, protocol::FrameType type, std::string_view payload);
+
+private:
+    struct Ring;
+    struct Connection;
+    struct Completion {
+        std::shared_ptr<Connection> connection;
+        Request request;
+        std::string response;
+        bool closeAfter;
+        bool partial = false;   // streamed output, the request is still running
+    };
+
+    int listenSocket;
+    int wakeFd = -1;          // eventfd the workers poke after finishing a request
+    uint64_t wakeValue = 0;   // target of the pending eventfd read
+    uint32_t nextGeneration = 1;
+    logs::Logger& logger;
+    Reactor::RequestHandler handler;
+    Reactor::OrderingPredicate isBarrier;
+    Reactor::SessionHook onOpen;
+    Reactor::SessionHook onClose;
+    Reactor::TerminalHook onTerminal;
+    std::unique_ptr<Ring> ring;
+    std::unique_ptr<ThreadPool> workers;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+    std::vector<std::pair<int, std::function<void()>>> sources;
+
+    std::mutex completionsMutex;
+    std::vector<Completion> completions;
+
+    // submission helpers
+    void armAccept();
+    void armRecv(Connection& connection);
+    void armWake();
+    void armSource(size_t index);
+    void flushSends(Connection& connection);
+
+    // completion handlers
+    void onAccept(int result, uint32_t flags);
+    void onRecv(uint64_t userData, int result, uint32_t flags);
+    void onSend(uint64_t userData, int result);
+    void onWake();
+    void onSource(uint64_t userData, int result);
+
+    void applyFrame(const std::shared_ptr<Connection>& connection, const protocol::Frame& frame);
+    void dispatch(const std::shared_ptr<Connection>& connection, Request request);
+    void execute(const std::shared_ptr<Connection>& connection, Request request);
+    void startRunnable(const std::shared_ptr<Connection>& connection);
+    void queueOutput(Connection& connection);
+    bool streamChunk(const std::shared_ptr<Connection>& connection, const Request& request, std::string_view chunk);
+    void publishBacklog(Connection& connection);
+    void wake();
+    void closeConnection(Connection& connection);
+    void maybeRelease(int clientSocket);
+    Connection* lookup(uint64_t userData);
+};
+
+}
@@ -0,0 +1,34 @@
+//
+//  ZeroCopy.hpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#pragma once
+
+// std
+#include <string>
+#include <cstddef>
+#include <sys/types.h>
+
+namespace server {
+
+// File bytes put on a socket by the kernel, straight from the page cache into
+// the socket buffer without passing through the server. sendfile on Linux,
+// which splices internally; a pread and send loop elsewhere.
+class ZeroCopy {
+public:
+    // at most length bytes from offset; the count sent, 0 at the end of the file,
+    // -1 with errno set, EAGAIN included for a full non-blocking socket
+    static ssize_t send(int socket, int fd, off_t offset, size_t length);
+
+    // a frame announced length bytes, so a file that shrank meanwhile is padded with zeros;
+    // blocking sockets only
+    static bool sendAll(int socket, int fd, off_t offset, size_t length);
+
+    // the same bytes appended to out, for what the socket could not take
+    static bool read(int fd, off_t offset, size_t length, std::string& out);
+};
+
+}
@@ -8,10 +8,42 @@
 #include "./headers/Server.hpp"
 
 
-int main()
+// usage: runner_server.out [--port=N] [--mode=threaded|epoll|uring] [--io-threads=N] [--cache-results]
+//                          [--log-level=debug|info|warn|error|security|critical]
+int main(int argc, char* argv[])
 {
+    server::ServerMode mode = server::ServerMode::THREADED;
+    unsigned ioThreads = 2;
+    unsigned short port = 8080;
+    bool cacheResults = false;
+    logs::Level logLevel = logs::DEFAULT_LEVEL;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--port=", 0) == 0) {
+            port = static_cast<unsigned short>(std::atoi(arg.c_str() + 7));
+        } else if (arg == "--mode=threaded") {
+            mode = server::ServerMode::THREADED;
+        } else if (arg == "--mode=epoll") {
+            mode = server::ServerMode::EPOLL;
+        } else if (arg == "--mode=uring") {
+            mode = server::ServerMode::IO_URING;
+        } else if (arg.rfind("--io-threads=", 0) == 0) {
+            ioThreads = static_cast<unsigned>(std::max(1, std::atoi(arg.c_str() + 13)));
+        } else if (arg == "--cache-results") {
+            cacheResults = true;
+        } else if (arg.rfind("--log-level=", 0) == 0 && logs::Logger::parseLevel(arg.substr(12), logLevel)) {
+            logs::Logger::setLevel(logLevel);
+        } else {
+            std::cerr << "Unknown option: " << arg << '\n';
+            std::cerr << "Usage: " << argv[0] << " [--port=N] [--mode=threaded|epoll|uring] [--io-threads=N] [--cache-results]"
+                      << " [--log-level=debug|info|warn|error|security|critical]\n";
+            return 1;
+        }
+    }
+
     try {
-        server::Server server(8080);
+        server::Server server(port, mode, ioThreads, cacheResults);
         server.run();
     } catch (std::exception& e) {
         std::cerr << e.what() << '\n';
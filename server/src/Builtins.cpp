@@ -0,0 +1,721 @@
+//
+//  Builtins.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Builtins.hpp"
+#include "../headers/DirectExec.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <pwd.h>
+#include <grp.h>
+#include <sys/stat.h>
+#include <sys/xattr.h>
+#include <sys/sysmacros.h>
+#include <sys/syscall.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <climits>
+
+namespace server {
+
+namespace {
+
+// the value a locale category takes from the environment, like setlocale(category, "") reads it
+std::string localeVariable(const char* category) {
+    for (const char* name : {"LC_ALL", category, "LANG"}) {
+        const char* value = getenv(name);
+        if (value != nullptr && *value != '\0') {
+            return value;
+        }
+    }
+    return "C";
+}
+
+std::string modeString(mode_t mode) {
+    std::string text = "----------";
+    text[0] = S_ISDIR(mode) ? 'd' : S_ISLNK(mode) ? 'l' : S_ISCHR(mode) ? 'c' : S_ISBLK(mode) ? 'b'
+            : S_ISFIFO(mode) ? 'p' : S_ISSOCK(mode) ? 's' : '-';
+    const char* permissions = "rwxrwxrwx";
+    for (int bit = 0; bit < 9; ++bit) {
+        if (mode & (0400 >> bit)) {
+            text[1 + bit] = permissions[bit];
+        }
+    }
+    if (mode & S_ISUID) {
+        text[3] = (mode & S_IXUSR) ? 's' : 'S';
+    }
+    if (mode & S_ISGID) {
+        text[6] = (mode & S_IXGRP) ? 's' : 'S';
+    }
+    if (mode & S_ISVTX) {
+        text[9] = (mode & S_IXOTH) ? 't' : 'T';
+    }
+    return text;
+}
+
+std::string padLeft(const std::string& text, size_t width) {
+    return text.size() < width ? std::string(width - text.size(), ' ') + text : text;
+}
+
+std::string padRight(const std::string& text, size_t width) {
+    return text.size() < width ? text + std::string(width - text.size(), ' ') : text;
+}
+
+bool isCharacterOrBlock(mode_t mode) {
+    return S_ISCHR(mode) || S_ISBLK(mode);
+}
+
+// names stat prints without quotes under its default shell-escape quoting
+bool printsUnquoted(const std::string& name) {
+    if (name.empty()) {
+        return false;
+    }
+    return std::all_of(name.begin(), name.end(), [](char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') ||
+               std::string_view("%+,-./:=@_").find(c) != std::string_view::npos;
+    });
+}
+
+bool readLink(int directoryFd, const std::string& name, std::string& target) {
+    char buffer[PATH_MAX];
+    ssize_t length = readlinkat(directoryFd, name.c_str(), buffer, sizeof(buffer));
+    if (length == -1) {
+        return false;
+    }
+    target.assign(buffer, length);
+    return true;
+}
+
+int compareTimes(const timespec& left, const timespec& right) {
+    if (left.tv_sec != right.tv_sec) {
+        return left.tv_sec < right.tv_sec ? -1 : 1;
+    }
+    return left.tv_nsec < right.tv_nsec ? -1 : left.tv_nsec > right.tv_nsec ? 1 : 0;
+}
+
+// ls -l: month, day and time within the last six months, the year for anything older or in the future
+std::string listingTime(const timespec& when, timespec& now) {
+    if (compareTimes(now, when) < 0) {
+        clock_gettime(CLOCK_REALTIME, &now);
+    }
+    timespec sixMonthsAgo = now;
+    sixMonthsAgo.tv_sec -= 31556952 / 2;
+    bool recent = compareTimes(sixMonthsAgo, when) < 0 && compareTimes(when, now) <= 0;
+
+    tm local{};
+    localtime_r(&when.tv_sec, &local);
+    char text[64];
+    size_t length = strftime(text, sizeof(text), recent ? "%b %e %H:%M" : "%b %e  %Y", &local);
+    return std::string(text, length);
+}
+
+// stat: full date, nanoseconds and the zone offset
+std::string statTime(const timespec& when) {
+    tm local{};
+    localtime_r(&when.tv_sec, &local);
+    char date[64];
+    char zone[16];
+    strftime(date, sizeof(date), "%Y-%m-%d %H:%M:%S", &local);
+    strftime(zone, sizeof(zone), "%z", &local);
+    char nanoseconds[16];
+    snprintf(nanoseconds, sizeof(nanoseconds), ".%09ld ", static_cast<long>(when.tv_nsec));
+    return std::string(date) + nanoseconds + zone;
+}
+
+std::string userName(uid_t user, std::map<uid_t, std::string>& users) {
+    auto it = users.find(user);
+    if (it != users.end()) {
+        return it -> second;
+    }
+    passwd entry{};
+    passwd* found = nullptr;
+    char buffer[4096];
+    getpwuid_r(user, &entry, buffer, sizeof(buffer), &found);
+    return users[user] = found ? std::string(found -> pw_name) : std::string();
+}
+
+std::string groupName(gid_t group, std::map<gid_t, std::string>& groups) {
+    auto it = groups.find(group);
+    if (it != groups.end()) {
+        return it -> second;
+    }
+    struct group entry{};
+    struct group* found = nullptr;
+    char buffer[4096];
+    getgrgid_r(group, &entry, buffer, sizeof(buffer), &found);
+    return groups[group] = found ? std::string(found -> gr_name) : std::string();
+}
+
+#ifdef __linux__
+// what getdents64 fills the buffer with, the name follows the fixed part
+struct LinuxDirent64 {
+    uint64_t inode;
+    int64_t offset;
+    unsigned short length;
+    unsigned char type;
+    char name[1];
+};
+#endif
+
+}
+
+Builtins::Builtins(logs::Logger& logger)
+: logger(logger) {
+    this -> collation = newlocale(LC_COLLATE_MASK, "", static_cast<locale_t>(0));
+    if (this -> collation == static_cast<locale_t>(0)) {
+        this -> collation = newlocale(LC_COLLATE_MASK, "C", static_cast<locale_t>(0));
+    }
+
+    // ls translates month names and honours TIME_STYLE, only the C format is reproduced
+    std::string timeLocale = localeVariable("LC_TIME");
+    this -> plainTime = getenv("TIME_STYLE") == nullptr &&
+                        (timeLocale == "C" || timeLocale == "POSIX" || timeLocale.rfind("C.", 0) == 0 || timeLocale.rfind("en_", 0) == 0);
+
+#ifdef __linux__
+    // the output copies GNU coreutils, a busybox system keeps its own
+    char resolved[PATH_MAX];
+    this -> enabled = realpath("/bin/ls", resolved) != nullptr && std::string_view(resolved).find("busybox") == std::string_view::npos;
+#else
+    // BSD ls and stat print differently
+    this -> enabled = false;
+#endif
+
+    // stat adds a Context line when SELinux is on
+    if (access("/sys/fs/selinux/enforce", F_OK) == 0) {
+        this -> plainStat = false;
+    }
+}
+
+Builtins::~Builtins() {
+    if (this -> collation != static_cast<locale_t>(0)) {
+        freelocale(this -> collation);
+    }
+}
+
+bool Builtins::run(const std::string& command, const SessionDirectory& workingDirectory,
+                   const Reactor::OutputSink& emit, std::string& result) {
+    std::vector<std::string> words;
+    if (!this -> enabled || !DirectExec::split(command, words)) {
+        return false;
+    }
+    std::string program = words.front();
+    std::vector<std::string> arguments(words.begin() + 1, words.end());
+
+    std::string output;
+    bool handled = false;
+    if (program == "ls") {
+        handled = ls(arguments, workingDirectory.fd(), output);
+    } else if (program == "pwd") {
+        handled = pwd(arguments, workingDirectory, output);
+    } else if (program == "stat") {
+        handled = stat(arguments, workingDirectory.fd(), output);
+    } else if (program == "echo") {
+        handled = echo(arguments, output);
+    } else if (program == "cat") {
+        // streams as it reads, the other commands are small enough to answer at once
+        return cat(arguments, workingDirectory.fd(), emit, result);
+    }
+    if (!handled) {
+        return false;
+    }
+
+    LOG_DEBUG(this -> logger, "(Builtins::run) Answered in process: " + command);
+    if (output.empty()) {
+        result = "Warn: Command executed but produced no output.";
+    } else if (!emit(output)) {
+        LOG_WARN(this -> logger, "(Builtins::run) Client stopped reading: " + command);
+    }
+    return true;
+}
+
+bool Builtins::mayCustomize(const std::string& command) {
+    // the simple commands of the line, split at unquoted ; & | ( ) { } and line breaks; quotes and
+    // backslashes only decide where words end, the words are compared without them
+    std::vector<std::vector<std::string>> simpleCommands(1);
+    std::string word;
+    bool inWord = false;
+    auto endWord = [&]() {
+        if (inWord) {
+            simpleCommands.back().push_back(std::move(word));
+            word.clear();
+            inWord = false;
+        }
+    };
+    char quote = 0;
+    for (size_t i = 0; i < command.size(); ++i) {
+        char c = command[i];
+        if (quote != 0) {
+            if (c == quote) {
+                quote = 0;
+            } else if (c == '\\' && quote == '"' && i + 1 < command.size()) {
+                word += command[++i];
+            } else {
+                word += c;
+            }
+        } else if (c == '\'' || c == '"') {
+            quote = c;
+            inWord = true;
+        } else if (c == '\\' && i + 1 < command.size()) {
+            word += command[++i];
+            inWord = true;
+        } else if (c == ' ' || c == '\t') {
+            endWord();
+        } else if (std::strchr(";&|(){}\n", c) != nullptr) {
+            // name() { ...; } defines a function, whatever the name
+            if (c == '(' && command.find_first_not_of(" \t", i + 1) != std::string::npos &&
+                command[command.find_first_not_of(" \t", i + 1)] == ')') {
+                return true;
+            }
+            endWord();
+            simpleCommands.emplace_back();
+        } else {
+            word += c;
+            inWord = true;
+        }
+    }
+    endWord();
+
+    static const std::vector<std::string> keywords = {"if", "then", "else", "elif", "do", "while", "until", "!", "time"};
+    static const std::vector<std::string> customizing = {"alias", "function", "export", "declare", "typeset", "readonly", "local",
+                                                         "source", ".", "eval", "exec", "set", "shopt", "enable", "builtin",
+                                                         "hash", "unset", "unalias"};
+    for (const auto& words : simpleCommands) {
+        auto verb = std::find_if(words.begin(), words.end(), [](const std::string& candidate) {
+            return std::find(keywords.begin(), keywords.end(), candidate) == keywords.end();
+        });
+        if (verb == words.end()) {
+            continue;
+        }
+        // NAME=value, alone it sets a shell variable and before a program it may reach the shell's state
+        size_t name = verb -> find_first_not_of("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_0123456789");
+        if (name != 0 && name != std::string::npos && !std::isdigit(static_cast<unsigned char>((*verb)[0])) &&
+            ((*verb)[name] == '=' || (*verb)[name] == '[' || verb -> compare(name, 2, "+=") == 0)) {
+            return true;
+        }
+        if (std::find(customizing.begin(), customizing.end(), *verb) != customizing.end()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool Builtins::ls(const std::vector<std::string>& arguments, int directoryFd, std::string& output) {
+    bool longListing = false;
+    bool all = false;
+    bool almostAll = false;
+    std::vector<std::string> operands;
+    for (const std::string& argument : arguments) {
+        if (argument.size() < 2 || argument[0] != '-') {
+            operands.push_back(argument);
+            continue;
+        }
+        for (size_t i = 1; i < argument.size(); ++i) {
+            switch (argument[i]) {
+                case 'l': longListing = true; break;
+                case 'a': all = true; almostAll = false; break;
+                case 'A': almostAll = true; all = false; break;
+                case '1': break;
+                default: return false;   // "--" and every other option
+            }
+        }
+    }
+    if (longListing && !this -> plainTime) {
+        return false;
+    }
+
+    bool namedOperands = !operands.empty();
+    if (!namedOperands) {
+        operands.push_back(".");
+    }
+
+    // files first, then each directory; -l lists a symlink operand itself, plain ls follows it
+    std::vector<Entry> files;
+    std::vector<Entry> measured;   // ls sizes the columns of the operand files over every operand
+    std::vector<std::string> directories;
+    for (const std::string& operand : operands) {
+        Entry entry;
+        if (!describe(directoryFd, operand, !longListing, entry)) {
+            return false;
+        }
+        measured.push_back(entry);
+        if (S_ISDIR(entry.mode)) {
+            directories.push_back(operand);
+        } else {
+            files.push_back(std::move(entry));
+        }
+    }
+    std::stable_sort(files.begin(), files.end(), [this](const Entry& left, const Entry& right) {
+        return strcoll_l(left.name.c_str(), right.name.c_str(), this -> collation) < 0;
+    });
+    sortNames(directories);
+
+    std::map<uid_t, std::string> users;
+    std::map<gid_t, std::string> groups;
+    if (longListing) {
+        if (!longFormat(files, measured, directoryFd, false, output, users, groups)) {
+            return false;
+        }
+    } else {
+        for (const Entry& file : files) {
+            output += file.name + "\n";
+        }
+    }
+
+    bool headers = operands.size() > 1;
+    for (size_t i = 0; i < directories.size(); ++i) {
+        int listed = openat(directoryFd, directories[i].c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (listed == -1) {
+            return false;
+        }
+        std::vector<std::string> names;
+        bool read = listDirectory(listed, all, almostAll, names);
+
+        std::vector<Entry> entries;
+        if (read && longListing) {
+            entries.resize(names.size());
+            for (size_t j = 0; j < names.size() && read; ++j) {
+                read = describe(listed, names[j], false, entries[j]);
+            }
+        }
+
+        if (headers) {
+            output += (files.empty() && i == 0 ? "" : "\n") + directories[i] + ":\n";
+        }
+        if (read && longListing) {
+            read = longFormat(entries, entries, listed, true, output, users, groups);
+        } else if (read) {
+            for (const std::string& name : names) {
+                output += name + "\n";
+            }
+        }
+        close(listed);
+        if (!read) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Builtins::pwd(const std::vector<std::string>& arguments, const SessionDirectory& workingDirectory, std::string& output) {
+    if (!arguments.empty()) {
+        return false;
+    }
+    // the path the session's shell last reported in $PWD, which is what its pwd prints
+    output = workingDirectory.path().string() + "\n";
+    return true;
+}
+
+bool Builtins::cat(const std::vector<std::string>& arguments, int directoryFd, const Reactor::OutputSink& emit, std::string& result) {
+    if (arguments.empty()) {
+        return false;
+    }
+
+    // every file opened before the first byte goes out, a missing one is still the shell's to report
+    std::vector<int> files;
+    auto closeAll = [&files]() {
+        for (int file : files) {
+            close(file);
+        }
+    };
+    for (const std::string& argument : arguments) {
+        if (argument[0] == '-') {
+            closeAll();
+            return false;
+        }
+        int file = openat(directoryFd, argument.c_str(), O_RDONLY | O_CLOEXEC);
+        struct stat info;
+        if (file == -1 || fstat(file, &info) == -1 || !S_ISREG(info.st_mode)) {
+            if (file != -1) {
+                close(file);
+            }
+            closeAll();
+            return false;
+        }
+        files.push_back(file);
+    }
+
+    bool hasOutput = false;
+    bool stopped = false;
+    std::vector<char> buffer(64 * 1024);
+    for (size_t i = 0; i < files.size() && !stopped; ++i) {
+        ssize_t bytesRead;
+        while ((bytesRead = read(files[i], buffer.data(), buffer.size())) != 0) {
+            if (bytesRead == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                LOG_ERROR(this -> logger, "(Builtins::cat) Failed to read " + arguments[i] + ": " + std::string(strerror(errno)));
+                result = "Error: cat: " + arguments[i] + ": " + std::string(strerror(errno));
+                closeAll();
+                return true;
+            }
+            hasOutput = true;
+            if (!emit(std::string_view(buffer.data(), bytesRead))) {
+                LOG_WARN(this -> logger, "(Builtins::cat) Client stopped reading, abandoning cat.");
+                stopped = true;
+                break;
+            }
+        }
+    }
+    closeAll();
+
+    if (!hasOutput) {
+        result = "Warn: Command executed but produced no output.";
+    }
+    return true;
+}
+
+bool Builtins::stat(const std::vector<std::string>& arguments, int directoryFd, std::string& output) {
+    if (arguments.empty() || !this -> plainStat) {
+        return false;
+    }
+
+    std::map<uid_t, std::string> users;
+    std::map<gid_t, std::string> groups;
+    for (const std::string& argument : arguments) {
+        Entry entry;
+        if (argument[0] == '-' || !printsUnquoted(argument) || !describe(directoryFd, argument, false, entry) ||
+            isCharacterOrBlock(entry.mode)) {
+            return false;
+        }
+
+        std::string name = argument;
+        if (S_ISLNK(entry.mode)) {
+            std::string target;
+            if (!readLink(directoryFd, argument, target) || !printsUnquoted(target)) {
+                return false;
+            }
+            name += " -> " + target;
+        }
+
+        std::string type = S_ISREG(entry.mode) ? (entry.size == 0 ? "regular empty file" : "regular file")
+                         : S_ISDIR(entry.mode) ? "directory" : S_ISLNK(entry.mode) ? "symbolic link"
+                         : S_ISFIFO(entry.mode) ? "fifo" : "socket";
+        std::string user = userName(entry.user, users);
+        std::string group = groupName(entry.group, groups);
+        char permissions[8];
+        snprintf(permissions, sizeof(permissions), "%04o", static_cast<unsigned>(entry.mode & 07777));
+
+        output += "  File: " + name + "\n";
+        output += "  Size: " + padRight(std::to_string(entry.size), 10) + "\tBlocks: " + padRight(std::to_string(entry.blocks), 10) +
+                  " IO Block: " + padRight(std::to_string(entry.blockSize), 6) + " " + type + "\n";
+        output += "Device: " + std::to_string(entry.deviceMajor) + "," + std::to_string(entry.deviceMinor) +
+                  "\tInode: " + padRight(std::to_string(entry.inode), 11) + " Links: " + std::to_string(entry.links) + "\n";
+        output += "Access: (" + std::string(permissions) + "/" + modeString(entry.mode) + ")  Uid: (" +
+                  padLeft(std::to_string(entry.user), 5) + "/" + padLeft(user.empty() ? "UNKNOWN" : user, 8) + ")   Gid: (" +
+                  padLeft(std::to_string(entry.group), 5) + "/" + padLeft(group.empty() ? "UNKNOWN" : group, 8) + ")\n";
+        output += "Access: " + statTime(entry.accessed) + "\n";
+        output += "Modify: " + statTime(entry.modified) + "\n";
+        output += "Change: " + statTime(entry.changed) + "\n";
+        output += " Birth: " + (entry.hasBirth ? statTime(entry.born) : std::string("-")) + "\n";
+    }
+    return true;
+}
+
+bool Builtins::echo(const std::vector<std::string>& arguments, std::string& output) {
+    // bash's echo: leading words made of n, e and E only are options
+    bool newline = true;
+    size_t first = 0;
+    for (; first < arguments.size(); ++first) {
+        const std::string& argument = arguments[first];
+        if (argument.size() < 2 || argument[0] != '-' || argument.find_first_not_of("neE", 1) != std::string::npos) {
+            break;
+        }
+        if (argument.find_first_of("eE") != std::string::npos) {
+            return false;   // escapes are interpreted or not depending on xpg_echo
+        }
+        newline = false;
+    }
+
+    for (size_t i = first; i < arguments.size(); ++i) {
+        output += (i == first ? "" : " ") + arguments[i];
+    }
+    if (newline) {
+        output += "\n";
+    }
+    return true;
+}
+
+bool Builtins::listDirectory(int directoryFd, bool all, bool almostAll, std::vector<std::string>& names) {
+    auto keep = [all, almostAll](const char* name) {
+        if (name[0] != '.') {
+            return true;
+        }
+        if (all) {
+            return true;
+        }
+        return almostAll && strcmp(name, ".") != 0 && strcmp(name, "..") != 0;
+    };
+
+#ifdef __linux__
+    // getdents64 hands back a whole buffer of entries per call, without readdir's per entry bookkeeping
+    alignas(LinuxDirent64) char buffer[32 * 1024];
+    while (true) {
+        long bytes = syscall(SYS_getdents64, directoryFd, buffer, sizeof(buffer));
+        if (bytes == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        if (bytes == 0) {
+            break;
+        }
+        for (long offset = 0; offset < bytes;) {
+            const LinuxDirent64* entry = reinterpret_cast<const LinuxDirent64*>(buffer + offset);
+            const char* name = buffer + offset + offsetof(LinuxDirent64, name);
+            if (keep(name)) {
+                names.emplace_back(name);
+            }
+            offset += entry -> length;
+        }
+    }
+#else
+    DIR* directory = fdopendir(dup(directoryFd));
+    if (directory == nullptr) {
+        return false;
+    }
+    while (dirent* entry = readdir(directory)) {
+        if (keep(entry -> d_name)) {
+            names.emplace_back(entry -> d_name);
+        }
+    }
+    closedir(directory);
+#endif
+
+    sortNames(names);
+    return true;
+}
+
+bool Builtins::describe(int directoryFd, const std::string& name, bool follow, Entry& entry) {
+    entry.name = name;
+#ifdef __linux__
+    // statx also reports the birth time stat prints
+    struct statx info;
+    int flags = AT_NO_AUTOMOUNT | (follow ? 0 : AT_SYMLINK_NOFOLLOW);
+    if (statx(directoryFd, name.c_str(), flags, STATX_BASIC_STATS | STATX_BTIME, &info) == -1) {
+        return false;
+    }
+    auto time = [](const statx_timestamp& stamp) {
+        timespec converted{};
+        converted.tv_sec = stamp.tv_sec;
+        converted.tv_nsec = stamp.tv_nsec;
+        return converted;
+    };
+    entry.mode = info.stx_mode;
+    entry.links = info.stx_nlink;
+    entry.user = info.stx_uid;
+    entry.group = info.stx_gid;
+    entry.size = info.stx_size;
+    entry.blocks = info.stx_blocks;
+    entry.blockSize = info.stx_blksize;
+    entry.deviceMajor = info.stx_dev_major;
+    entry.deviceMinor = info.stx_dev_minor;
+    entry.inode = info.stx_ino;
+    entry.accessed = time(info.stx_atime);
+    entry.modified = time(info.stx_mtime);
+    entry.changed = time(info.stx_ctime);
+    entry.born = time(info.stx_btime);
+    entry.hasBirth = (info.stx_mask & STATX_BTIME) != 0;
+    return true;
+#else
+    (void)directoryFd;
+    (void)follow;
+    return false;
+#endif
+}
+
+void Builtins::sortNames(std::vector<std::string>& names) const {
+    std::stable_sort(names.begin(), names.end(), [this](const std::string& left, const std::string& right) {
+        return strcoll_l(left.c_str(), right.c_str(), this -> collation) < 0;
+    });
+}
+
+bool Builtins::longFormat(const std::vector<Entry>& entries, const std::vector<Entry>& measured, int directoryFd, bool total,
+                          std::string& output, std::map<uid_t, std::string>& users, std::map<gid_t, std::string>& groups) const {
+    auto owner = [&users](const Entry& entry) {
+        std::string name = userName(entry.user, users);
+        return name.empty() ? std::to_string(entry.user) : name;
+    };
+    auto group = [&groups](const Entry& entry) {
+        std::string name = groupName(entry.group, groups);
+        return name.empty() ? std::to_string(entry.group) : name;
+    };
+    
+    // columns are as wide as their widest value among the measured entries
+    size_t linksWidth = 0;
+    size_t userWidth = 0;
+    size_t groupWidth = 0;
+    size_t sizeWidth = 0;
+    for (const Entry& entry : measured) {
+        // device numbers and the ACL or SELinux marks are left to the real ls
+        if (isCharacterOrBlock(entry.mode) || hasExtendedAccess(directoryFd, entry.name)) {
+            return false;
+        }
+        linksWidth = std::max(linksWidth, std::to_string(entry.links).size());
+        userWidth = std::max(userWidth, owner(entry).size());
+        groupWidth = std::max(groupWidth, group(entry).size());
+        sizeWidth = std::max(sizeWidth, std::to_string(entry.size).size());
+    }
+    blkcnt_t blocks = 0;
+    for (const Entry& entry : entries) {
+        blocks += entry.blocks;
+    }
+
+    timespec now{};
+    clock_gettime(CLOCK_REALTIME, &now);
+    std::string lines;
+    if (total) {
+        lines += "total " + std::to_string((blocks + 1) / 2) + "\n";
+    }
+    for (size_t i = 0; i < entries.size(); ++i) {
+        const Entry& entry = entries[i];
+        lines += modeString(entry.mode) + " " + padLeft(std::to_string(entry.links), linksWidth) + " " +
+                 padRight(owner(entry), userWidth) + " " + padRight(group(entry), groupWidth) + " " +
+                 padLeft(std::to_string(entry.size), sizeWidth) + " " + listingTime(entry.modified, now) + " " + entry.name;
+        if (S_ISLNK(entry.mode)) {
+            std::string target;
+            if (!readLink(directoryFd, entry.name, target)) {
+                return false;
+            }
+            lines += " -> " + target;
+        }
+        lines += "\n";
+    }
+    output += lines;
+    return true;
+}
+
+bool Builtins::hasExtendedAccess(int directoryFd, const std::string& name) {
+#ifdef __linux__
+    // no llistxattrat, the descriptor's /proc entry names the directory
+    std::string path = "/proc/self/fd/" + std::to_string(directoryFd) + "/" + name;
+    char list[1024];
+    ssize_t length = llistxattr(path.c_str(), list, sizeof(list));
+    if (length == -1) {
+        return errno == ERANGE;
+    }
+    for (ssize_t offset = 0; offset < length; offset += strlen(list + offset) + 1) {
+        std::string_view attribute(list + offset);
+        if (attribute.rfind("system.", 0) == 0 || attribute.rfind("security.", 0) == 0) {
+            return true;
+        }
+    }
+#else
+    (void)directoryFd;
+    (void)name;
+#endif
+    return false;
+}
+
+}
@@ -0,0 +1,239 @@
+//
+//  ChannelTable.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ChannelTable.hpp"
+
+#include <algorithm>
+
+namespace server {
+
+ChannelTable::ChannelTable() {
+    // the first pane talks on channel 0 without opening it
+    open(0);
+}
+
+ChannelTable::Event ChannelTable::apply(const protocol::Frame& frame) {
+    uint16_t channel = frame.header.channel;
+
+    switch (frame.header.type) {
+        case protocol::FrameType::CHANNEL_OPEN:
+            return open(channel) ? Event::OPENED : Event::NONE;
+        case protocol::FrameType::CHANNEL_CLOSE:
+            return close(channel, true) ? Event::CLOSED : Event::NONE;
+        case protocol::FrameType::WINDOW_UPDATE:
+            grant(channel, protocol::decodeWindowUpdate(frame.payload));
+            return Event::WINDOW;
+        case protocol::FrameType::REQUEST:
+            return isOpen(channel) ? Event::REQUEST : Event::NONE;
+        case protocol::FrameType::TERMINAL_RESIZE:
+        case protocol::FrameType::TERMINAL_INPUT:
+            return isOpen(channel) ? Event::TERMINAL : Event::NONE;
+        case protocol::FrameType::COMPRESSION:
+            // deflate is the only codec, anything else leaves the responses as they are
+            this -> compressing = frame.payload.size() == 1 && static_cast<uint8_t>(frame.payload[0]) == protocol::CODEC_DEFLATE;
+            return Event::NONE;
+        default:
+            return Event::NONE;
+    }
+}
+
+bool ChannelTable::open(uint16_t channel) {
+    return this -> channels.try_emplace(channel).second;
+}
+
+bool ChannelTable::close(uint16_t channel, bool discardOutput) {
+    auto it = this -> channels.find(channel);
+    if (it == this -> channels.end() || it -> second.closing) {
+        return false;
+    }
+
+    it -> second.closing = true;
+    if (discardOutput) {
+        it -> second.frames.clear();
+        it -> second.queued = 0;
+    }
+    this -> pending.erase(std::remove_if(this -> pending.begin(), this -> pending.end(),
+                                         [channel](const Request& request) { return request.channel == channel; }),
+                          this -> pending.end());
+    forgetIfDone(it);
+    return true;
+}
+
+bool ChannelTable::isOpen(uint16_t channel) const {
+    auto it = this -> channels.find(channel);
+    return it != this -> channels.end() && !it -> second.closing;
+}
+
+std::vector<uint16_t> ChannelTable::openChannels() const {
+    std::vector<uint16_t> open;
+    for (const auto& [id, channel] : this -> channels) {
+        if (!channel.closing) {
+            open.push_back(id);
+        }
+    }
+    return open;
+}
+
+void ChannelTable::enqueue(Request request) {
+    if (isOpen(request.channel)) {
+        this -> pending.push_back(std::move(request));
+    }
+}
+
+std::vector<Request> ChannelTable::takeRunnable(unsigned maxInFlight) {
+    std::vector<Request> ready;
+    std::vector<uint16_t> blocked;
+
+    // arrival order within a channel, a waiting barrier holds back only its own channel
+    for (auto it = this -> pending.begin(); it != this -> pending.end() && this -> inFlight < maxInFlight; ) {
+        Channel& channel = this -> channels[it -> channel];
+        bool channelBlocked = std::find(blocked.begin(), blocked.end(), it -> channel) != blocked.end();
+
+        if (channelBlocked || channel.barrierRunning || (it -> barrier && channel.running > 0)) {
+            if (!channelBlocked) {
+                blocked.push_back(it -> channel);
+            }
+            ++it;
+            continue;
+        }
+
+        ++channel.running;
+        ++this -> inFlight;
+        channel.barrierRunning = it -> barrier;
+        ready.push_back(std::move(*it));
+        it = this -> pending.erase(it);
+    }
+
+    return ready;
+}
+
+void ChannelTable::finished(const Request& request) {
+    --this -> inFlight;
+
+    auto it = this -> channels.find(request.channel);
+    if (it == this -> channels.end()) {
+        return;
+    }
+    --it -> second.running;
+    if (request.barrier) {
+        it -> second.barrierRunning = false;
+    }
+    forgetIfDone(it);
+}
+
+void ChannelTable::clearPending() {
+    this -> pending.clear();
+}
+
+void ChannelTable::queueResponse(uint16_t channel, uint32_t requestId, std::string_view response, bool complete) {
+    auto it = this -> channels.find(channel);
+    if (it == this -> channels.end() || it -> second.closing) {
+        return;
+    }
+
+    // cut into stream chunks so one large output cannot starve the other panes
+    Channel& target = it -> second;
+    size_t offset = 0;
+    do {
+        size_t chunk = std::min<size_t>(response.size() - offset, protocol::STREAM_CHUNK);
+        bool last = offset + chunk >= response.size();
+        std::string_view payload = response.substr(offset, chunk);
+
+        protocol::FrameHeader header;
+        header.type = protocol::FrameType::RESPONSE;
+        header.flags = (last && complete) ? protocol::FLAG_NONE : protocol::FLAG_MORE;
+        header.channel = channel;
+        header.requestId = requestId;
+
+        // compressed in queue order, which is the order the client inflates them in
+        if (this -> compressing && chunk >= protocol::COMPRESS_THRESHOLD) {
+            if (!target.compressor) {
+                target.compressor = std::make_unique<protocol::FrameCompressor>();
+            }
+            bool first = !target.compressor -> started();
+            if (target.compressor -> compress(payload, this -> compressed)) {
+                header.flags |= protocol::FLAG_COMPRESSED | (first ? protocol::FLAG_NEW_STREAM : 0);
+                payload = this -> compressed;
+            }
+        }
+        header.length = static_cast<uint32_t>(payload.size());
+
+        std::string frame(protocol::HEADER_SIZE, '\0');
+        protocol::encodeHeader(header, frame.data());
+        frame.append(payload);
+        target.frames.push_back(std::move(frame));
+        target.queued += payload.size();
+
+        offset += chunk;
+    } while (offset < response.size());
+}
+
+void ChannelTable::grant(uint16_t channel, uint32_t bytes) {
+    auto it = this -> channels.find(channel);
+    if (it != this -> channels.end()) {
+        it -> second.window += bytes;
+    }
+}
+
+bool ChannelTable::claimWindow(uint16_t channel, size_t bytes) {
+    auto it = this -> channels.find(channel);
+    if (it == this -> channels.end() || it -> second.closing || !it -> second.frames.empty() || bytes > it -> second.window) {
+        return false;
+    }
+    it -> second.window -= static_cast<uint32_t>(bytes);
+    return true;
+}
+
+void ChannelTable::drainInto(std::string& out) {
+    bool progress = true;
+    while (progress) {
+        progress = false;
+        for (auto& [id, channel] : this -> channels) {
+            if (channel.frames.empty()) {
+                continue;
+            }
+            size_t payload = channel.frames.front().size() - protocol::HEADER_SIZE;
+            if (payload > channel.window) {
+                continue;
+            }
+
+            channel.window -= static_cast<uint32_t>(payload);
+            channel.queued -= payload;
+            out += channel.frames.front();
+            channel.frames.pop_front();
+            progress = true;
+        }
+    }
+
+    for (auto it = this -> channels.begin(); it != this -> channels.end(); ) {
+        auto next = std::next(it);
+        forgetIfDone(it);
+        it = next;
+    }
+}
+
+size_t ChannelTable::queuedBytes(uint16_t channel) const {
+    auto it = this -> channels.find(channel);
+    return it == this -> channels.end() ? 0 : it -> second.queued;
+}
+
+bool ChannelTable::hasQueuedOutput() const {
+    for (const auto& [id, channel] : this -> channels) {
+        if (!channel.frames.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void ChannelTable::forgetIfDone(std::map<uint16_t, Channel>::iterator it) {
+    if (it -> second.closing && it -> second.frames.empty() && it -> second.running == 0) {
+        this -> channels.erase(it);
+    }
+}
+
+}
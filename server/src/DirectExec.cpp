@@ -0,0 +1,168 @@
+//
+//  DirectExec.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/DirectExec.hpp"
+
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cstdlib>
+#include <algorithm>
+#include <string_view>
+
+namespace server {
+
+namespace {
+
+// the builtins and reserved words of bash, a program of the same name is not what bash would run
+const std::vector<std::string_view> SHELL_WORDS = {
+    ".", ":", "[", "alias", "bg", "bind", "break", "builtin", "caller", "cd", "command", "compgen", "complete",
+    "compopt", "continue", "declare", "dirs", "disown", "echo", "enable", "eval", "exec", "exit", "export", "false",
+    "fc", "fg", "getopts", "hash", "help", "history", "jobs", "kill", "let", "local", "logout", "mapfile", "popd",
+    "printf", "pushd", "pwd", "read", "readarray", "readonly", "return", "set", "shift", "shopt", "source",
+    "suspend", "test", "times", "trap", "true", "type", "typeset", "ulimit", "umask", "unalias", "unset", "wait",
+    "if", "then", "else", "elif", "fi", "case", "esac", "for", "select", "while", "until", "do", "done", "in",
+    "function", "time", "{", "}", "!", "[[", "]]", "coproc"
+};
+
+// programs whose output is the shell's environment, which a direct child only approximates
+const std::vector<std::string_view> ENVIRONMENT_READERS = {"env", "printenv"};
+
+}
+
+DirectExec::DirectExec(logs::Logger& logger) : logger(logger) {
+    const char* path = getenv("PATH");
+    std::string_view entries = path != nullptr ? path : "";
+    while (!entries.empty()) {
+        size_t end = std::min(entries.find(':'), entries.size());
+        std::string_view entry = entries.substr(0, end);
+        if (entry.empty() || entry[0] != '/') {
+            LOG_WARN(this -> logger, "(DirectExec::DirectExec) PATH has a relative entry, every command goes to the shell.");
+            this -> searchPath.clear();
+            return;
+        }
+        this -> searchPath.emplace_back(entry);
+        entries.remove_prefix(std::min(end + 1, entries.size()));
+    }
+}
+
+bool DirectExec::split(const std::string& line, std::vector<std::string>& words) {
+    // unquoted, these make bash do more than run a program
+    static constexpr std::string_view special = "|&;<>()$`*?[]{}\n\r";
+    std::string word;
+    bool inWord = false;   // '' is a word of its own
+
+    for (size_t i = 0; i < line.size(); ++i) {
+        char c = line[i];
+        if (c == ' ' || c == '\t') {
+            if (inWord) {
+                words.push_back(std::move(word));
+                word.clear();
+                inWord = false;
+            }
+            continue;
+        }
+        if (special.find(c) != std::string_view::npos) {
+            return false;
+        }
+        // comments and tilde expansion at the start of a word, ~ also after = and : like in a=~/x
+        if ((c == '#' && !inWord) || (c == '~' && (!inWord || (!word.empty() && (word.back() == '=' || word.back() == ':'))))) {
+            return false;
+        }
+
+        if (c == '\\') {
+            if (++i == line.size()) {
+                return false;
+            }
+            word.push_back(line[i]);
+        } else if (c == '\'') {
+            size_t end = line.find('\'', i + 1);
+            if (end == std::string::npos) {
+                return false;
+            }
+            word.append(line, i + 1, end - i - 1);
+            i = end;
+        } else if (c == '"') {
+            // literal unless it expands something; backslash only escapes what bash lets it escape
+            for (++i; i < line.size() && line[i] != '"'; ++i) {
+                if (line[i] == '$' || line[i] == '`' || line[i] == '!') {
+                    return false;
+                }
+                if (line[i] == '\\' && i + 1 < line.size() && std::string_view("\\\"").find(line[i + 1]) != std::string_view::npos) {
+                    ++i;
+                }
+                word.push_back(line[i]);
+            }
+            if (i == line.size()) {
+                return false;
+            }
+        } else {
+            // NAME=value before the program is an assignment for it
+            if (c == '=' && words.empty() && !word.empty()) {
+                return false;
+            }
+            word.push_back(c);
+        }
+        inWord = true;
+    }
+    if (inWord) {
+        words.push_back(std::move(word));
+    }
+    return !words.empty();
+}
+
+bool DirectExec::prepare(const std::string& line, std::vector<std::string>& argv, std::string& program) {
+    if (!split(line, argv)) {
+        return false;
+    }
+    const std::string& name = argv.front();
+    if (name.empty() || std::find(SHELL_WORDS.begin(), SHELL_WORDS.end(), name) != SHELL_WORDS.end() ||
+        std::find(ENVIRONMENT_READERS.begin(), ENVIRONMENT_READERS.end(), name) != ENVIRONMENT_READERS.end()) {
+        return false;
+    }
+
+    // with a slash bash runs the file as named, relative to the cwd the child starts in
+    if (name.find('/') != std::string::npos) {
+        program = name;
+        return true;
+    }
+
+    std::optional<std::string> resolved = resolve(name);
+    if (!resolved) {
+        return false;
+    }
+    program = *resolved;
+    return true;
+}
+
+void DirectExec::forget(const std::string& name) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> paths.erase(name);
+}
+
+std::optional<std::string> DirectExec::resolve(const std::string& name) {
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        auto it = this -> paths.find(name);
+        if (it != this -> paths.end()) {
+            return it -> second;
+        }
+    }
+
+    // misses are not remembered, a program installed later is found without a restart
+    for (const std::string& directory : this -> searchPath) {
+        std::string candidate = directory + "/" + name;
+        struct stat info;
+        if (::stat(candidate.c_str(), &info) == 0 && S_ISREG(info.st_mode) && access(candidate.c_str(), X_OK) == 0) {
+            std::lock_guard<std::mutex> lock(this -> mutex);
+            this -> paths[name] = candidate;
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+}
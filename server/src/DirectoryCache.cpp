@@ -0,0 +1,162 @@
+//
+//  DirectoryCache.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/DirectoryCache.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <cerrno>
+#include <cstdlib>
+#include <vector>
+#include <string_view>
+#ifdef __linux__
+#include <sys/sysmacros.h>
+#endif
+
+namespace server {
+
+namespace {
+
+// argument still leads to the directory it led to when the entry was made
+bool leadsTo(int fromFd, const std::string& argument, uint64_t device, uint64_t inode) {
+#ifdef STATX_INO
+    struct statx info;
+    if (statx(fromFd, argument.c_str(), 0, STATX_TYPE | STATX_INO, &info) == -1) {
+        return false;
+    }
+    return S_ISDIR(info.stx_mode) && makedev(info.stx_dev_major, info.stx_dev_minor) == device && info.stx_ino == inode;
+#else
+    struct stat info;
+    if (fstatat(fromFd, argument.c_str(), &info, 0) == -1) {
+        return false;
+    }
+    return S_ISDIR(info.st_mode) && static_cast<uint64_t>(info.st_dev) == device && static_cast<uint64_t>(info.st_ino) == inode;
+#endif
+}
+
+// what bash's cd makes of the argument before any chdir: appended to $PWD, with . and ..
+// taken out of the text; false when the part a .. removes is not a directory, as bash checks
+bool logicalPath(const std::string& current, const std::string& argument, std::string& path) {
+    std::string joined = argument[0] == '/' ? argument : current + "/" + argument;
+    std::vector<std::string_view> parts;
+    auto spell = [&parts, &path]() {
+        path.clear();
+        for (std::string_view kept : parts) {
+            path.append("/").append(kept);
+        }
+    };
+    std::string_view rest(joined);
+    while (!rest.empty()) {
+        size_t slash = rest.find('/');
+        std::string_view part = rest.substr(0, slash);
+        rest.remove_prefix(slash == std::string_view::npos ? rest.size() : slash + 1);
+        if (part.empty() || part == ".") {
+            continue;
+        }
+        if (part != "..") {
+            parts.push_back(part);
+            continue;
+        }
+        spell();
+        struct stat info;
+        if (!path.empty() && (stat(path.c_str(), &info) == -1 || !S_ISDIR(info.st_mode))) {
+            return false;
+        }
+        if (!parts.empty()) {
+            parts.pop_back();
+        }
+    }
+    spell();
+    if (path.empty()) {
+        path = "/";
+    }
+    return true;
+}
+
+// what chdir checks on top of the directory existing
+bool searchable(const SessionDirectory& directory) {
+#ifdef AT_EMPTY_PATH
+    if (faccessat(directory.fd(), "", X_OK, AT_EMPTY_PATH | AT_EACCESS) == 0) {
+        return true;
+    }
+    if (errno != EINVAL && errno != ENOSYS) {
+        return false;
+    }
+#endif
+    return faccessat(AT_FDCWD, directory.path().c_str(), X_OK, AT_EACCESS) == 0;
+}
+
+}
+
+DirectoryCache::DirectoryCache(logs::Logger& logger) : logger(logger) {
+    // the session shells inherit it from the server
+    const char* searchPath = getenv("CDPATH");
+    if (searchPath != nullptr && *searchPath != '\0') {
+        this -> usable = false;
+        LOG_WARN(this -> logger, "(DirectoryCache::DirectoryCache) CDPATH is set, every cd goes to the shell.");
+    }
+}
+
+std::shared_ptr<const SessionDirectory> DirectoryCache::resolve(const SessionDirectory& from, const std::string& argument) {
+    std::string key = from.path().string() + '\0' + argument;
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        auto it = this -> entries.find(key);
+        if (it != this -> entries.end()) {
+            const Entry& entry = it -> second;
+            if (!entry.directory) {
+                if (entry.generation == this -> generation && std::chrono::steady_clock::now() < entry.expires) {
+                    return nullptr;
+                }
+            } else if ((entry.logical ? leadsTo(AT_FDCWD, entry.directory -> path().string(), entry.device, entry.inode)
+                                      : leadsTo(from.fd(), argument, entry.device, entry.inode)) &&
+                       searchable(*entry.directory)) {
+                return entry.directory;
+            }
+            this -> entries.erase(it);
+        }
+    }
+
+    // the path as bash spells it; when that cannot be entered bash tries the argument itself and
+    // takes the physical path, which one openat resolves in the kernel, the canonical path with it
+    Entry entry;
+    entry.generation = this -> generation;
+    std::string path;
+    if (logicalPath(from.path().string(), argument, path)) {
+        entry.directory = SessionDirectory::open(path);
+        entry.logical = entry.directory != nullptr;
+    }
+    if (!entry.directory) {
+        entry.directory = SessionDirectory::openAt(from, argument);
+    }
+    struct stat info{};
+    if (entry.directory && (fstat(entry.directory -> fd(), &info) == -1 || !searchable(*entry.directory))) {
+        entry.directory.reset();
+    }
+    if (entry.directory) {
+        entry.device = info.st_dev;
+        entry.inode = info.st_ino;
+    } else {
+        entry.expires = std::chrono::steady_clock::now() + MISSING_TTL;
+    }
+
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    storeLocked(key, entry);
+    return entry.directory;
+}
+
+void DirectoryCache::storeLocked(const std::string& key, Entry entry) {
+    // a session walking a large tree fills it once in a while, starting over keeps it simple
+    if (this -> entries.size() >= MAX_ENTRIES) {
+        this -> entries.clear();
+    }
+    this -> entries[key] = std::move(entry);
+}
+
+}
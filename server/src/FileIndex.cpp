@@ -0,0 +1,182 @@
+//
+//  FileIndex.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/FileIndex.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+namespace server {
+
+namespace {
+
+long long modified(const struct stat& info) {
+#ifdef __APPLE__
+    return info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+#else
+    return info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+#endif
+}
+
+}
+
+struct FileIndex::Scanned {
+    int fd = -1;
+    size_t size = 0;
+    long long modified = 0;
+
+    std::mutex mutex;                // the scan state below
+    std::vector<size_t> checkpoints = {0};   // start of line k * CHECKPOINT_LINES
+    size_t scannedLine = 0;          // the first line whose end was not looked for yet
+    size_t scannedOffset = 0;        // where it starts
+    bool complete = false;
+    std::vector<char> block;         // the last SCAN_BLOCK bytes read, from blockOffset on
+    size_t blockOffset = 0;
+
+    ~Scanned() {
+        if (this -> fd != -1) {
+            close(this -> fd);
+        }
+    }
+
+    // one past the '\n' ending the line that starts at offset, the size for the last line;
+    // a file truncated meanwhile reads short and ends there instead of faulting
+    size_t lineEnd(size_t offset) {
+        while (offset < this -> size) {
+            if (offset < this -> blockOffset || offset >= this -> blockOffset + this -> block.size()) {
+                this -> block.resize(std::min(SCAN_BLOCK, this -> size - offset));
+                ssize_t got;
+                while ((got = pread(this -> fd, this -> block.data(), this -> block.size(), static_cast<off_t>(offset))) == -1 && errno == EINTR) {}
+                if (got <= 0) {
+                    this -> block.clear();
+                    return this -> size;
+                }
+                this -> block.resize(static_cast<size_t>(got));
+                this -> blockOffset = offset;
+            }
+            size_t start = offset - this -> blockOffset;
+            const char* end = static_cast<const char*>(memchr(this -> block.data() + start, '\n', this -> block.size() - start));
+            if (end != nullptr) {
+                return this -> blockOffset + static_cast<size_t>(end - this -> block.data()) + 1;
+            }
+            offset = this -> blockOffset + this -> block.size();
+        }
+        return this -> size;
+    }
+
+    // finds line starts until line `line` is known or the file ends
+    void scanTo(size_t line) {
+        while (!this -> complete && this -> scannedLine < line) {
+            this -> scannedOffset = lineEnd(this -> scannedOffset);
+            ++this -> scannedLine;
+            if (this -> scannedOffset >= this -> size) {
+                this -> complete = true;
+            } else if (this -> scannedLine % CHECKPOINT_LINES == 0) {
+                this -> checkpoints.push_back(this -> scannedOffset);
+            }
+        }
+    }
+
+    // start of a line that was scanned past, the size for one past the last
+    size_t offsetOf(size_t line) {
+        if (line >= this -> scannedLine) {
+            return this -> scannedOffset;
+        }
+        size_t offset = this -> checkpoints[line / CHECKPOINT_LINES];
+        for (size_t skip = line % CHECKPOINT_LINES; skip > 0; --skip) {
+            offset = lineEnd(offset);
+        }
+        return offset;
+    }
+};
+
+FileIndex::FileIndex(logs::Logger& logger) : logger(logger) {}
+
+std::string FileIndex::version(const struct stat& info) {
+    return std::to_string(info.st_ino) + "." + std::to_string(info.st_size) + "." + std::to_string(modified(info));
+}
+
+bool FileIndex::Range::read(std::string& out) const {
+    out.resize(this -> length);
+    size_t done = 0;
+    while (done < this -> length) {
+        ssize_t got = pread(this -> fd, out.data() + done, this -> length - done, static_cast<off_t>(this -> offset + done));
+        if (got <= 0) {
+            if (got == -1 && errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(got);
+    }
+    return true;
+}
+
+bool FileIndex::lines(int fd, const struct stat& info, size_t firstLine, size_t count, Range& range) {
+    std::shared_ptr<Scanned> file = opened(fd, info);
+    if (!file) {
+        return false;
+    }
+
+    count = std::min(count, MAX_LINES);
+    std::lock_guard<std::mutex> lock(file -> mutex);
+    // one line further, where the last one asked for ends
+    file -> scanTo(firstLine + count);
+
+    range.firstLine = firstLine;
+    range.lines = std::min(count, file -> scannedLine - std::min(firstLine, file -> scannedLine));
+    range.totalLines = file -> complete ? static_cast<long long>(file -> scannedLine) : -1;
+    range.offset = file -> offsetOf(firstLine);
+    size_t end = file -> offsetOf(firstLine + range.lines);
+    range.length = end - range.offset;
+    range.fd = file -> fd;
+    range.fileSize = file -> size;
+    range.version = version(info);
+    range.file = file;
+    return true;
+}
+
+std::shared_ptr<FileIndex::Scanned> FileIndex::opened(int fd, const struct stat& info) {
+    Key key{static_cast<uint64_t>(info.st_dev), static_cast<uint64_t>(info.st_ino)};
+    std::lock_guard<std::mutex> lock(this -> mutex);
+
+    auto it = this -> files.find(key);
+    if (it != this -> files.end()) {
+        if (it -> second -> size == static_cast<size_t>(info.st_size) && it -> second -> modified == modified(info)) {
+            this -> ages.remove(key);
+            this -> ages.push_back(key);
+            return it -> second;
+        }
+        // changed since it was scanned, requests still sending from the old descriptor keep it alive
+        this -> files.erase(it);
+        this -> ages.remove(key);
+    }
+
+    auto file = std::make_shared<Scanned>();
+    file -> size = static_cast<size_t>(info.st_size);
+    file -> modified = modified(info);
+    file -> fd = fcntl(fd, F_DUPFD_CLOEXEC, 0);
+    if (file -> fd == -1) {
+        LOG_ERROR(this -> logger, "(FileIndex::opened) Cannot keep the file open: " + std::string(strerror(errno)));
+        return nullptr;
+    }
+#ifdef __linux__
+    // read front to back by the scan
+    posix_fadvise(file -> fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    if (this -> files.size() >= MAX_FILES) {
+        this -> files.erase(this -> ages.front());
+        this -> ages.pop_front();
+    }
+    this -> files.emplace(key, file);
+    this -> ages.push_back(key);
+    return file;
+}
+
+}
@@ -0,0 +1,239 @@
+//
+//  FileSaver.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/FileSaver.hpp"
+#include "../headers/FileIndex.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+namespace server {
+
+namespace {
+
+// what copy falls back to where the kernel cannot copy between the two files
+bool copyThrough(int from, off_t fromOffset, int to, off_t toOffset, size_t length) {
+    std::vector<char> buffer(std::min<size_t>(length, 256 * 1024));
+    while (length > 0) {
+        ssize_t got = pread(from, buffer.data(), std::min(length, buffer.size()), fromOffset);
+        if (got <= 0) {
+            if (got == -1 && errno == EINTR) continue;
+            return false;   // the original shrank under the save, its version no longer matches anyway
+        }
+        for (ssize_t done = 0; done < got;) {
+            ssize_t put = pwrite(to, buffer.data() + done, static_cast<size_t>(got - done), toOffset + done);
+            if (put == -1) {
+                if (errno == EINTR) continue;
+                return false;
+            }
+            done += put;
+        }
+        fromOffset += got;
+        toOffset += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+}
+
+FileSaver::Save::~Save() {
+    if (this -> fd != -1) {
+        close(this -> fd);
+    }
+    if (this -> source != -1) {
+        close(this -> source);
+    }
+    if (!this -> committed && !this -> temporary.empty()) {
+        unlink(this -> temporary.c_str());
+    }
+}
+
+FileSaver::FileSaver(logs::Logger& logger) : logger(logger) {}
+
+std::string FileSaver::begin(const Owner& owner, const SessionDirectory& directory, const std::string& name,
+                             const std::string& base, uint64_t& id) {
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        size_t open = 0;
+        for (auto it = this -> saves.lower_bound({owner, 0}); it != this -> saves.end() && it -> first.first == owner; ++it) {
+            ++open;
+        }
+        if (open >= MAX_SAVES_PER_SESSION) {
+            return "Error: A session saves at most " + std::to_string(MAX_SAVES_PER_SESSION) + " files at once";
+        }
+    }
+
+    auto save = std::make_shared<Save>();
+    std::filesystem::path target = name[0] == '/' ? std::filesystem::path(name) : directory.path() / name;
+
+    save -> source = openat(directory.fd(), name.c_str(), O_RDONLY | O_CLOEXEC);
+    if (save -> source != -1) {
+        // writing through a symlink like nano does, the link stays and its target is replaced
+        char resolved[PATH_MAX];
+        if (fstat(save -> source, &save -> original) == -1 || !S_ISREG(save -> original.st_mode) ||
+            realpath(target.c_str(), resolved) == nullptr) {
+            return "Error: Cannot save " + name + ": not a regular file";
+        }
+        target = resolved;
+        save -> replaces = true;
+        save -> sourceSize = static_cast<uint64_t>(save -> original.st_size);
+        if (!base.empty() && FileIndex::version(save -> original) != base) {
+            return "Error: " + name + " changed on the server since it was opened, not saved";
+        }
+    } else if (errno != ENOENT) {
+        return "Error: Cannot save " + name + ": " + std::string(strerror(errno));
+    } else if (!base.empty()) {
+        return "Error: " + name + " was removed on the server since it was opened, not saved";
+    }
+    save -> target = target.string();
+
+    // in the target's directory, the rename that commits it cannot cross filesystems
+    std::string pattern = (target.parent_path() / ("." + target.filename().string() + ".remmux-XXXXXX")).string();
+    save -> fd = mkostemp(pattern.data(), O_CLOEXEC);
+    if (save -> fd == -1) {
+        std::string reason = strerror(errno);
+        LOG_ERROR(this -> logger, "(FileSaver::begin) Cannot create a temporary file for " + save -> target + ": " + reason);
+        return "Error: Cannot save " + name + ": " + reason;
+    }
+    save -> temporary = pattern;
+
+    id = this -> nextId++;
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> saves[{owner, id}] = std::move(save);
+    return {};
+}
+
+std::string FileSaver::write(const Owner& owner, uint64_t id, uint64_t at, std::string_view bytes) {
+    std::shared_ptr<Save> save = find(owner, id);
+    if (!save) {
+        return "Error: no such save";
+    }
+    for (size_t done = 0; done < bytes.size();) {
+        ssize_t put = pwrite(save -> fd, bytes.data() + done, bytes.size() - done, static_cast<off_t>(at + done));
+        if (put == -1) {
+            if (errno == EINTR) continue;
+            std::string reason = strerror(errno);
+            LOG_ERROR(this -> logger, "(FileSaver::write) Cannot write " + save -> temporary + ": " + reason);
+            return "Error: Cannot save: " + reason;
+        }
+        done += static_cast<size_t>(put);
+    }
+    save -> written += bytes.size();
+    return {};
+}
+
+std::string FileSaver::copy(const Owner& owner, uint64_t id, uint64_t at, uint64_t from, uint64_t length) {
+    std::shared_ptr<Save> save = find(owner, id);
+    if (!save) {
+        return "Error: no such save";
+    }
+    if (save -> source == -1 || from > save -> sourceSize || length > save -> sourceSize - from) {
+        return "Error: copied range is outside the original file";
+    }
+
+    off_t fromOffset = static_cast<off_t>(from);
+    off_t toOffset = static_cast<off_t>(at);
+    uint64_t left = length;
+#ifdef __linux__
+    // the kernel moves the bytes, on filesystems that share extents it does not copy them at all
+    while (left > 0) {
+        ssize_t copied = copy_file_range(save -> source, &fromOffset, save -> fd, &toOffset, left, 0);
+        if (copied <= 0) {
+            if (copied == -1 && errno == EINTR) continue;
+            break;
+        }
+        left -= static_cast<uint64_t>(copied);
+    }
+#endif
+    if (left > 0 && !copyThrough(save -> source, fromOffset, save -> fd, toOffset, left)) {
+        std::string reason = strerror(errno);
+        LOG_ERROR(this -> logger, "(FileSaver::copy) Cannot copy into " + save -> temporary + ": " + reason);
+        return "Error: Cannot save: " + reason;
+    }
+    save -> written += length;
+    return {};
+}
+
+std::string FileSaver::commit(const Owner& owner, uint64_t id, uint64_t size, std::string& version) {
+    std::shared_ptr<Save> save;
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        auto it = this -> saves.find({owner, id});
+        if (it == this -> saves.end()) {
+            return "Error: no such save";
+        }
+        save = std::move(it -> second);
+        this -> saves.erase(it);
+    }
+
+    // pieces never overlap, so every one of them is in once the count adds up
+    if (save -> written != size) {
+        LOG_ERROR(this -> logger, "(FileSaver::commit) " + save -> target + " got " + std::to_string(save -> written.load()) +
+                                  " of " + std::to_string(size) + " bytes, not saved.");
+        return "Error: save is incomplete, not saved";
+    }
+
+    // mkostemp made it 0600, the saved file keeps what the original had
+    if (save -> replaces) {
+        fchmod(save -> fd, save -> original.st_mode & 07777);
+        if (fchown(save -> fd, save -> original.st_uid, save -> original.st_gid) == -1) {
+            // only root may give a file away, it stays with whoever saved it
+            LOG_DEBUG(this -> logger, "(FileSaver::commit) Keeping the saving user as owner of " + save -> target);
+        }
+    } else {
+        fchmod(save -> fd, 0644);
+    }
+
+    // the data is on disk before the name points at it, so a crash leaves one of the two files
+    if (ftruncate(save -> fd, static_cast<off_t>(size)) == -1 || fsync(save -> fd) == -1 ||
+        rename(save -> temporary.c_str(), save -> target.c_str()) == -1) {
+        std::string reason = strerror(errno);
+        LOG_ERROR(this -> logger, "(FileSaver::commit) Cannot replace " + save -> target + ": " + reason);
+        return "Error: Cannot save: " + reason;
+    }
+    save -> committed = true;
+
+    // and the rename itself survives a crash
+    std::string parent = std::filesystem::path(save -> target).parent_path().string();
+    int directoryFd = open(parent.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd != -1) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+
+    struct stat info;
+    version = fstat(save -> fd, &info) == 0 ? FileIndex::version(info) : std::string();
+    LOG_INFO(this -> logger, "(FileSaver::commit) Saved " + save -> target + ", " + std::to_string(size) + " bytes");
+    return {};
+}
+
+void FileSaver::abort(const Owner& owner, uint64_t id) {
+    // a piece still being written holds on to the save, the last one out removes the file
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> saves.erase({owner, id});
+}
+
+void FileSaver::dropSession(const Owner& owner) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> saves.erase(this -> saves.lower_bound({owner, 0}), this -> saves.upper_bound({owner, UINT64_MAX}));
+}
+
+std::shared_ptr<FileSaver::Save> FileSaver::find(const Owner& owner, uint64_t id) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    auto it = this -> saves.find({owner, id});
+    return it == this -> saves.end() ? nullptr : it -> second;
+}
+
+}
@@ -0,0 +1,321 @@
+//
+//  FileTransfer.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/FileTransfer.hpp"
+#include "../headers/FileIndex.hpp"
+#include "../../common/headers/Checksum.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+namespace server {
+
+namespace {
+
+// "--<option>[=<field>,<field>...] <file>"
+bool parseRequest(std::string_view line, std::string& option, std::vector<std::string>& fields, std::string& file) {
+    size_t space = line.find(' ');
+    if (line.rfind("--", 0) != 0 || space == std::string_view::npos || space + 1 == line.size()) {
+        return false;
+    }
+    std::string_view head = line.substr(2, space - 2);
+    file = std::string(line.substr(space + 1));
+
+    size_t equals = head.find('=');
+    option = std::string(head.substr(0, equals));
+    fields.clear();
+    if (equals != std::string_view::npos) {
+        std::string_view rest = head.substr(equals + 1);
+        while (true) {
+            size_t comma = rest.find(',');
+            fields.emplace_back(rest.substr(0, comma));
+            if (comma == std::string_view::npos) {
+                break;
+            }
+            rest.remove_prefix(comma + 1);
+        }
+    }
+    return true;
+}
+
+bool parseNumber(const std::string& text, uint64_t& value) {
+    char* end = nullptr;
+    value = std::strtoull(text.c_str(), &end, 10);
+    return !text.empty() && text[0] != '-' && *end == '\0';
+}
+
+// a file changed or truncated under a read comes back short, never as a fault
+bool readFully(int fd, char* out, size_t length, off_t offset) {
+    while (length > 0) {
+        ssize_t got = pread(fd, out, length, offset);
+        if (got <= 0) {
+            if (got == -1 && errno == EINTR) continue;
+            return false;
+        }
+        out += got;
+        offset += got;
+        length -= static_cast<size_t>(got);
+    }
+    return true;
+}
+
+std::string failure(const std::string& what, const std::string& file) {
+    return "Error: Cannot " + what + " " + file + ": " + std::string(errno != 0 ? strerror(errno) : "not a regular file");
+}
+
+}
+
+FileTransfer::FileTransfer(logs::Logger& logger) : logger(logger) {}
+
+bool FileTransfer::get(const std::string& arguments, const SessionDirectory& workingDirectory,
+                       const Reactor::OutputSink& emit, std::string& result) {
+    std::string option, file;
+    std::vector<std::string> fields;
+    if (!parseRequest(arguments, option, fields, file) || (option != "stat" && option != "chunk" && option != "sums")) {
+        return false;
+    }
+
+    // a fifo would wait for a writer in open, it is turned away below like any file that is not regular
+    errno = 0;
+    int fd = openat(workingDirectory.fd(), file.c_str(), O_RDONLY | O_NONBLOCK | O_CLOEXEC);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1 || (!S_ISREG(info.st_mode) && !(option == "stat" && S_ISDIR(info.st_mode)))) {
+        result = failure("read", file);
+        if (fd != -1) {
+            close(fd);
+        }
+        return true;
+    }
+
+    uint64_t first = 0, second = 0;
+    if (option == "stat" && S_ISDIR(info.st_mode)) {
+        result = "DIR";   // fetched whole with get --tree
+    } else if (option == "stat") {
+        char mode[8];
+        snprintf(mode, sizeof(mode), "%o", static_cast<unsigned>(info.st_mode & 07777));
+        result = "FILE " + std::to_string(info.st_size) + " " + mode + " " + FileIndex::version(info);
+    } else if (option == "chunk") {
+        if (fields.size() == 3 && parseNumber(fields[0], first) && parseNumber(fields[1], second)) {
+            result = chunk(fd, first, second, fields[2], emit);
+        } else {
+            result = "Error: usage: get --chunk=<offset>,<length>,<version> <file>";
+        }
+    } else {
+        if (fields.size() == 2 && parseNumber(fields[0], first) && parseNumber(fields[1], second)) {
+            result = sums(fd, first, second);
+        } else {
+            result = "Error: usage: get --sums=<chunk>,<up to> <file>";
+        }
+    }
+    close(fd);
+    return true;
+}
+
+bool FileTransfer::put(const std::string& arguments, const SessionDirectory& workingDirectory, std::string& result) {
+    // the bytes of a data request follow its first line
+    size_t lineEnd = arguments.find('\n');
+    std::string option, file;
+    std::vector<std::string> fields;
+    if (!parseRequest(std::string_view(arguments).substr(0, lineEnd), option, fields, file) ||
+        (option != "begin" && option != "sums" && option != "data" && option != "commit")) {
+        return false;
+    }
+
+    std::filesystem::path target = file[0] == '/' ? std::filesystem::path(file) : workingDirectory.path() / file;
+    std::string partial = (target.parent_path() / ("." + target.filename().string() + ".remmux-part")).string();
+    uint64_t first = 0, second = 0;
+    errno = 0;
+
+    if (option == "begin") {
+        struct stat info;
+        if (fields.size() != 1 || !parseNumber(fields[0], first)) {
+            result = "Error: usage: put --begin=<size> <file>";
+            return true;
+        }
+        if (target.filename().empty() || (stat(target.c_str(), &info) == 0 && !S_ISREG(info.st_mode))) {
+            result = "Error: Cannot write " + file + ": not a regular file";
+            return true;
+        }
+        // what an interrupted put left stays, the client checks how much of it is right;
+        // anything past the new size belonged to another upload
+        int fd = open(partial.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC, 0600);
+        if (fd == -1 || fstat(fd, &info) == -1 ||
+            (static_cast<uint64_t>(info.st_size) > first && ftruncate(fd, static_cast<off_t>(first)) == -1)) {
+            result = failure("write", file);
+        } else {
+            std::lock_guard<std::mutex> lock(this -> uploadsMutex);
+            this -> uploads[partial] = first;
+            result = "PART " + std::to_string(std::min<uint64_t>(info.st_size, first));
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    } else if (option == "sums") {
+        int fd = open(partial.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd == -1) {
+            result = failure("read", partial);
+        } else if (fields.size() == 2 && parseNumber(fields[0], first) && parseNumber(fields[1], second)) {
+            result = sums(fd, first, second);
+        } else {
+            result = "Error: usage: put --sums=<chunk>,<up to> <file>";
+        }
+        if (fd != -1) {
+            close(fd);
+        }
+    } else if (option == "data") {
+        uint64_t expected = 0;
+        if (lineEnd == std::string::npos || fields.size() != 2 || !parseNumber(fields[0], first) ||
+            !protocol::parseChecksum(fields[1], expected)) {
+            result = "Error: usage: put --data=<offset>,<checksum> <file> followed by the bytes";
+            return true;
+        }
+        std::string_view bytes = std::string_view(arguments).substr(lineEnd + 1);
+        uint64_t size = 0;
+        if (!announced(partial, size)) {
+            result = "Error: put --begin " + file + " first";
+            return true;
+        }
+        if (first > size || bytes.size() > size - first) {
+            result = "Error: data at " + std::to_string(first) + " is past the announced size " + std::to_string(size);
+            return true;
+        }
+        if (protocol::checksum(bytes) != expected) {
+            // the client sends the chunk again
+            result = "Error: checksum mismatch at " + std::to_string(first);
+            return true;
+        }
+        int fd = open(partial.c_str(), O_WRONLY | O_CLOEXEC);
+        size_t done = 0;
+        while (fd != -1 && done < bytes.size()) {
+            ssize_t put = pwrite(fd, bytes.data() + done, bytes.size() - done, static_cast<off_t>(first + done));
+            if (put == -1 && errno != EINTR) {
+                break;
+            }
+            done += put > 0 ? static_cast<size_t>(put) : 0;
+        }
+        result = done == bytes.size() && fd != -1 ? "OK" : failure("write", partial);
+        if (fd != -1) {
+            close(fd);
+        }
+    } else {
+        uint64_t size = 0;
+        if (fields.size() != 1 || !parseNumber(fields[0], first)) {
+            result = "Error: usage: put --commit=<size> <file>";
+        } else if (!announced(partial, size)) {
+            result = "Error: put --begin " + file + " first";
+        } else if (size != first) {
+            result = "Error: upload of " + file + " was begun with " + std::to_string(size) + " bytes";
+        } else {
+            result = commit(target.string(), partial, first);
+            if (result == "DONE") {
+                std::lock_guard<std::mutex> lock(this -> uploadsMutex);
+                this -> uploads.erase(partial);
+            }
+        }
+    }
+    return true;
+}
+
+bool FileTransfer::announced(const std::string& partial, uint64_t& size) {
+    std::lock_guard<std::mutex> lock(this -> uploadsMutex);
+    auto upload = this -> uploads.find(partial);
+    if (upload == this -> uploads.end()) {
+        return false;
+    }
+    size = upload -> second;
+    return true;
+}
+
+std::string FileTransfer::chunk(int fd, uint64_t offset, uint64_t length, const std::string& version,
+                                const Reactor::OutputSink& emit) {
+    struct stat info;
+    if (fstat(fd, &info) == -1 || FileIndex::version(info) != version) {
+        return "Error: file changed on the server since the transfer started";
+    }
+    uint64_t size = static_cast<uint64_t>(info.st_size);
+    if (length > MAX_CHUNK || offset > size) {
+        return "Error: chunk is outside the file";
+    }
+    length = std::min(length, size - offset);
+
+    // read once to checksum it, a file truncated meanwhile comes back short instead of faulting a mapping;
+    // the checksum covers what was read, a change after that shows up on the client
+    std::string bytes(length, '\0');
+    if (!readFully(fd, bytes.data(), length, static_cast<off_t>(offset))) {
+        return "Error: file changed on the server since the transfer started";
+    }
+    std::string header = "CHUNK " + std::to_string(offset) + " " + std::to_string(length) + " " +
+                         protocol::formatChecksum(protocol::checksum(bytes)) + "\n";
+    if (emit(header) && length > 0) {
+        emit(bytes);
+    }
+    return "";
+}
+
+std::string FileTransfer::sums(int fd, uint64_t chunkSize, uint64_t upTo) {
+    struct stat info;
+    if (chunkSize == 0 || chunkSize > MAX_CHUNK || fstat(fd, &info) == -1) {
+        return "Error: chunk size must be between 1 and " + std::to_string(MAX_CHUNK);
+    }
+    // whole chunks only, the client starts over with the first one that is missing or differs
+    uint64_t count = std::min<uint64_t>(std::min<uint64_t>(upTo, info.st_size) / chunkSize, MAX_SUMS);
+    std::string result = "SUMS";
+    std::vector<char> buffer(chunkSize);
+    for (uint64_t index = 0; index < count; ++index) {
+        if (!readFully(fd, buffer.data(), chunkSize, static_cast<off_t>(index * chunkSize))) {
+            break;
+        }
+        result += " " + protocol::formatChecksum(protocol::checksum(buffer.data(), chunkSize));
+    }
+    return result;
+}
+
+std::string FileTransfer::commit(const std::string& target, const std::string& partial, uint64_t size) {
+    int fd = open(partial.c_str(), O_RDWR | O_CLOEXEC);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        std::string error = failure("write", target);
+        if (fd != -1) {
+            close(fd);
+        }
+        return error;
+    }
+    if (static_cast<uint64_t>(info.st_size) < size) {
+        close(fd);
+        return "Error: upload of " + target + " is incomplete";
+    }
+
+    // an earlier, longer upload may have left bytes past the end; the file keeps the mode of the one it replaces
+    struct stat original;
+    bool replaces = stat(target.c_str(), &original) == 0;
+    fchmod(fd, replaces ? original.st_mode & 07777 : 0644);
+    if (ftruncate(fd, static_cast<off_t>(size)) == -1 || fsync(fd) == -1 || rename(partial.c_str(), target.c_str()) == -1) {
+        std::string error = failure("write", target);
+        LOG_ERROR(this -> logger, "(FileTransfer::commit) " + error);
+        close(fd);
+        return error;
+    }
+    close(fd);
+
+    // the rename survives a crash too
+    int directoryFd = open(std::filesystem::path(target).parent_path().c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (directoryFd != -1) {
+        fsync(directoryFd);
+        close(directoryFd);
+    }
+    LOG_INFO(this -> logger, "(FileTransfer::commit) Received " + target + ", " + std::to_string(size) + " bytes");
+    return "DONE";
+}
+
+}
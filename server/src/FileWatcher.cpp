@@ -0,0 +1,335 @@
+//
+//  FileWatcher.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/FileWatcher.hpp"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#endif
+
+namespace server {
+
+#ifdef __linux__
+
+namespace {
+
+constexpr uint32_t CHANGES = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_MODIFY | IN_ATTRIB |
+                             IN_DELETE_SELF | IN_MOVE_SELF | IN_EXCL_UNLINK;
+
+std::string_view kindOf(uint32_t mask) {
+    if (mask & (IN_CREATE | IN_MOVED_TO)) return "created";
+    if (mask & (IN_DELETE | IN_MOVED_FROM | IN_DELETE_SELF)) return "deleted";
+    if (mask & IN_MOVE_SELF) return "moved";
+    if (mask & IN_MODIFY) return "modified";
+    if (mask & IN_ATTRIB) return "attributes";
+    return {};
+}
+
+}
+
+FileWatcher::FileWatcher(logs::Logger& logger) : logger(logger) {
+    this -> inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    this -> timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+    this -> pollFd = epoll_create1(EPOLL_CLOEXEC);
+
+    // both behind one descriptor, whatever loop serves it only has to poll that
+    bool ready = this -> inotifyFd != -1 && this -> timerFd != -1 && this -> pollFd != -1;
+    for (int source : {this -> inotifyFd, this -> timerFd}) {
+        epoll_event event{};
+        event.events = EPOLLIN;
+        event.data.fd = source;
+        ready = ready && epoll_ctl(this -> pollFd, EPOLL_CTL_ADD, source, &event) == 0;
+    }
+
+    if (!ready) {
+        LOG_ERROR(this -> logger, "(FileWatcher::FileWatcher) Cannot set up inotify, watch is disabled: " + std::string(strerror(errno)));
+        for (int* descriptor : {&this -> inotifyFd, &this -> timerFd, &this -> pollFd}) {
+            if (*descriptor != -1) {
+                close(*descriptor);
+                *descriptor = -1;
+            }
+        }
+    }
+}
+
+FileWatcher::~FileWatcher() {
+    for (int descriptor : {this -> inotifyFd, this -> timerFd, this -> pollFd}) {
+        if (descriptor != -1) {
+            close(descriptor);
+        }
+    }
+}
+
+std::string FileWatcher::watch(const Subscriber& subscriber, const std::string& path) {
+    if (this -> pollFd == -1) {
+        return "Error: watch is not available on this server";
+    }
+
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    std::set<int>& own = this -> watchesOf[subscriber];
+
+    auto known = this -> watchByPath.find(path);
+    if (known != this -> watchByPath.end() && own.count(known -> second) != 0) {
+        return {};
+    }
+    if (own.size() >= MAX_WATCHES_PER_SESSION) {
+        return "Error: A session watches at most " + std::to_string(MAX_WATCHES_PER_SESSION) + " paths";
+    }
+
+    int watch;
+    if (known != this -> watchByPath.end()) {
+        watch = known -> second;
+    } else {
+        watch = inotify_add_watch(this -> inotifyFd, path.c_str(), CHANGES);
+        if (watch == -1) {
+            std::string reason = strerror(errno);
+            if (own.empty()) {
+                this -> watchesOf.erase(subscriber);
+            }
+            LOG_WARN(this -> logger, "(FileWatcher::watch) Cannot watch " + path + ": " + reason);
+            return "Error: Cannot watch " + path + ": " + reason;
+        }
+        // a second spelling of a watched inode comes back with its watch, events keep the first one
+        this -> watchByPath[path] = watch;
+        this -> pathByWatch.emplace(watch, path);
+    }
+
+    own.insert(watch);
+    this -> subscribers[watch].insert(subscriber);
+    return {};
+}
+
+bool FileWatcher::unwatch(const Subscriber& subscriber, const std::string& path) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    auto known = this -> watchByPath.find(path);
+    auto own = this -> watchesOf.find(subscriber);
+    if (known == this -> watchByPath.end() || own == this -> watchesOf.end() || own -> second.count(known -> second) == 0) {
+        return false;
+    }
+    releaseLocked(subscriber, known -> second);
+    return true;
+}
+
+std::vector<std::string> FileWatcher::watched(const Subscriber& subscriber) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    std::vector<std::string> paths;
+    auto own = this -> watchesOf.find(subscriber);
+    if (own != this -> watchesOf.end()) {
+        for (int watch : own -> second) {
+            paths.push_back(this -> pathByWatch[watch]);
+        }
+    }
+    return paths;
+}
+
+void FileWatcher::dropSession(const Subscriber& subscriber) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    auto own = this -> watchesOf.find(subscriber);
+    if (own != this -> watchesOf.end()) {
+        std::set<int> watches = own -> second;
+        for (int watch : watches) {
+            releaseLocked(subscriber, watch);
+        }
+    }
+    this -> batches.erase(subscriber);
+}
+
+void FileWatcher::process(const Delivery& deliver) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    readEventsLocked();
+
+    // the expiry count is not needed, due batches are found by their time
+    uint64_t expirations;
+    while (read(this -> timerFd, &expirations, sizeof(expirations)) > 0) {}
+
+    auto now = std::chrono::steady_clock::now();
+    for (auto it = this -> batches.begin(); it != this -> batches.end();) {
+        if (it -> second.due > now) {
+            ++it;
+            continue;
+        }
+        std::string events;
+        for (const std::string& root : it -> second.overflowed) {
+            events += "overflow " + root + "\n";
+        }
+        for (const auto& [path, kind] : it -> second.changes) {
+            events += kind + " " + path + "\n";
+        }
+        if (!events.empty()) {
+            deliver(it -> first, events);
+        }
+        it = this -> batches.erase(it);
+    }
+    armTimerLocked();
+}
+
+void FileWatcher::readEventsLocked() {
+    alignas(inotify_event) char buffer[16 * 1024];
+    ssize_t length;
+    while ((length = read(this -> inotifyFd, buffer, sizeof(buffer))) > 0) {
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event -> len;
+
+            if (event -> mask & IN_Q_OVERFLOW) {
+                // changes were lost, every session has to look at everything it watches again
+                LOG_WARN(this -> logger, "(FileWatcher::readEventsLocked) inotify queue overflowed.");
+                for (const auto& [subscriber, watches] : this -> watchesOf) {
+                    for (int watch : watches) {
+                        recordLocked(subscriber, this -> pathByWatch[watch], {}, "overflow");
+                    }
+                }
+                continue;
+            }
+
+            auto guarded = this -> subscribers.find(event -> wd);
+            if (guarded == this -> subscribers.end()) {
+                continue;   // removed, its last events are still queued
+            }
+            const std::string root = this -> pathByWatch[event -> wd];
+            std::string path = root;
+            if (event -> len > 0) {
+                path += (root == "/" ? "" : "/") + std::string(event -> name);
+            }
+
+            std::set<Subscriber> sessions = guarded -> second;
+            if (event -> mask & IN_IGNORED) {
+                // the path is gone, its sessions hear about it once and stop watching it
+                for (const Subscriber& subscriber : sessions) {
+                    recordLocked(subscriber, root, root, "unwatched");
+                    releaseLocked(subscriber, event -> wd);
+                }
+                continue;
+            }
+
+            std::string_view kind = kindOf(event -> mask);
+            if (!kind.empty()) {
+                for (const Subscriber& subscriber : sessions) {
+                    recordLocked(subscriber, root, path, kind);
+                }
+            }
+        }
+    }
+}
+
+void FileWatcher::recordLocked(const Subscriber& subscriber, const std::string& root, const std::string& path, std::string_view kind) {
+    Batch& batch = this -> batches[subscriber];
+    if (batch.changes.empty() && batch.overflowed.empty()) {
+        // counted from the first change, a steady stream of them still goes out every DEBOUNCE
+        batch.due = std::chrono::steady_clock::now() + DEBOUNCE;
+    }
+
+    if (kind == "overflow") {
+        batch.overflowed.insert(root);
+        return;
+    }
+    // a watch that ended is always reported, there are at most MAX_WATCHES_PER_SESSION of them
+    if (kind != "unwatched" && batch.overflowed.count(root) != 0) {
+        return;
+    }
+
+    auto it = batch.changes.find(path);
+    if (it == batch.changes.end()) {
+        if (kind != "unwatched" && batch.changes.size() >= MAX_BATCH) {
+            // too much to list, the client rescans every path this session watches
+            for (int watch : this -> watchesOf[subscriber]) {
+                batch.overflowed.insert(this -> pathByWatch[watch]);
+            }
+            for (auto change = batch.changes.begin(); change != batch.changes.end();) {
+                change = change -> second == "unwatched" ? std::next(change) : batch.changes.erase(change);
+            }
+            return;
+        }
+        batch.changes.emplace(path, kind);
+        return;
+    }
+
+    // the client only sees where the path ended up within the batch; an ended watch stays reported
+    // even when the parent directory's own event for it comes later
+    if (it -> second == "unwatched") {
+        return;
+    }
+    if (it -> second == "created" && kind == "deleted") {
+        batch.changes.erase(it);
+    } else if (it -> second == "deleted" && kind == "created") {
+        it -> second = "modified";   // replaced, like an editor saving through a rename
+    } else if (it -> second != "created" || kind == "unwatched") {
+        it -> second = kind;
+    }
+}
+
+void FileWatcher::releaseLocked(const Subscriber& subscriber, int watch) {
+    auto own = this -> watchesOf.find(subscriber);
+    if (own != this -> watchesOf.end()) {
+        own -> second.erase(watch);
+        if (own -> second.empty()) {
+            this -> watchesOf.erase(own);
+        }
+    }
+
+    auto guarded = this -> subscribers.find(watch);
+    if (guarded == this -> subscribers.end()) {
+        return;
+    }
+    guarded -> second.erase(subscriber);
+    if (!guarded -> second.empty()) {
+        return;
+    }
+
+    // nobody watches the path anymore; harmless when inotify already removed it
+    this -> subscribers.erase(guarded);
+    inotify_rm_watch(this -> inotifyFd, watch);
+    for (auto it = this -> watchByPath.begin(); it != this -> watchByPath.end();) {
+        it = it -> second == watch ? this -> watchByPath.erase(it) : std::next(it);
+    }
+    this -> pathByWatch.erase(watch);
+}
+
+void FileWatcher::armTimerLocked() {
+    itimerspec timer{};
+    if (!this -> batches.empty()) {
+        auto earliest = std::min_element(this -> batches.begin(), this -> batches.end(), [](const auto& a, const auto& b) {
+            return a.second.due < b.second.due;
+        }) -> second.due;
+        // an expired or zero value would disarm the timer instead of firing it
+        auto wait = std::max<std::chrono::nanoseconds>(earliest - std::chrono::steady_clock::now(), std::chrono::nanoseconds(1));
+        timer.it_value.tv_sec = wait.count() / 1000000000;
+        timer.it_value.tv_nsec = wait.count() % 1000000000;
+    }
+    timerfd_settime(this -> timerFd, 0, &timer, nullptr);
+}
+
+#else
+
+FileWatcher::FileWatcher(logs::Logger& logger) : logger(logger) {
+    LOG_WARN(this -> logger, "(FileWatcher::FileWatcher) No inotify on this system, watch is disabled.");
+}
+
+FileWatcher::~FileWatcher() = default;
+
+std::string FileWatcher::watch(const Subscriber&, const std::string&) {
+    return "Error: watch is not available on this server";
+}
+
+bool FileWatcher::unwatch(const Subscriber&, const std::string&) { return false; }
+std::vector<std::string> FileWatcher::watched(const Subscriber&) { return {}; }
+void FileWatcher::dropSession(const Subscriber&) {}
+void FileWatcher::process(const Delivery&) {}
+void FileWatcher::readEventsLocked() {}
+void FileWatcher::recordLocked(const Subscriber&, const std::string&, const std::string&, std::string_view) {}
+void FileWatcher::releaseLocked(const Subscriber&, int) {}
+void FileWatcher::armTimerLocked() {}
+
+#endif
+
+}
@@ -0,0 +1,356 @@
+//
+//  ProcessRunner.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ProcessRunner.hpp"
+
+#include <spawn.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <cerrno>
+#include <cstring>
+#include <algorithm>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+extern char** environ;
+
+namespace server {
+
+namespace {
+
+// pipes must never leak into a child spawned by another worker at the same time,
+// a stray write end would keep the other command's output from ever reaching EOF
+int makePipe(int fds[2]) {
+#ifdef __linux__
+    return pipe2(fds, O_CLOEXEC);
+#else
+    if (pipe(fds) == -1) {
+        return -1;
+    }
+    fcntl(fds[0], F_SETFD, FD_CLOEXEC);
+    fcntl(fds[1], F_SETFD, FD_CLOEXEC);
+    return 0;
+#endif
+}
+
+// -1 where pidfds are missing, the caller then reaps after the pipes close
+int openPidfd(pid_t pid) {
+#if defined(__linux__) && defined(SYS_pidfd_open)
+    return static_cast<int>(syscall(SYS_pidfd_open, pid, 0));
+#else
+    (void)pid;
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+void closeIfOpen(int& fd) {
+    if (fd != -1) {
+        close(fd);
+        fd = -1;
+    }
+}
+
+// signals back to defaults and either a process group or a whole session of its own,
+// abandoning a command then takes everything it started down with it
+void initAttributes(posix_spawnattr_t& attributes, bool newSession) {
+    posix_spawnattr_init(&attributes);
+    sigset_t noSignals;
+    sigemptyset(&noSignals);
+    sigset_t defaultSignals;
+    sigemptyset(&defaultSignals);
+    sigaddset(&defaultSignals, SIGPIPE);
+    // a server started under nohup or as a background job ignores these, ^C in a terminal must work
+    sigaddset(&defaultSignals, SIGINT);
+    sigaddset(&defaultSignals, SIGQUIT);
+    sigaddset(&defaultSignals, SIGHUP);
+    posix_spawnattr_setsigmask(&attributes, &noSignals);
+    posix_spawnattr_setsigdefault(&attributes, &defaultSignals);
+    short flags = POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF;
+    if (newSession) {
+        flags |= POSIX_SPAWN_SETSID;
+    } else {
+        posix_spawnattr_setpgroup(&attributes, 0);
+        flags |= POSIX_SPAWN_SETPGROUP;
+    }
+#ifdef __APPLE__
+    flags |= POSIX_SPAWN_CLOEXEC_DEFAULT;
+#endif
+    posix_spawnattr_setflags(&attributes, flags);
+}
+
+int spawn(pid_t& pid, const std::vector<std::string>& argv, const posix_spawn_file_actions_t& actions,
+          const posix_spawnattr_t& attributes, const ProcessRunner::Exec& exec) {
+    std::vector<char*> args;
+    args.reserve(argv.size() + 1);
+    for (const auto& arg : argv) {
+        args.push_back(const_cast<char*>(arg.c_str()));
+    }
+    args.push_back(nullptr);
+    
+    // the server's environment, with the variables exec sets replacing the ones of the same name
+    std::vector<char*> environment;
+    for (char** variable = environ; *variable != nullptr; ++variable) {
+        std::string_view name(*variable, std::strcspn(*variable, "="));
+        bool replaced = std::any_of(exec.variables.begin(), exec.variables.end(), [name](const std::string& set) {
+            return set.size() > name.size() && set.compare(0, name.size(), name) == 0 && set[name.size()] == '=';
+        });
+        if (!replaced) {
+            environment.push_back(*variable);
+        }
+    }
+    for (const auto& variable : exec.variables) {
+        environment.push_back(const_cast<char*>(variable.c_str()));
+    }
+    environment.push_back(nullptr);
+    
+    const char* program = exec.program.empty() ? args[0] : exec.program.c_str();
+    return posix_spawn(&pid, program, &actions, &attributes, args.data(), environment.data());
+}
+
+}
+
+ProcessRunner::ProcessRunner(logs::Logger& logger) : logger(logger) {}
+
+ExitStatus ProcessRunner::run(const std::vector<std::string>& argv, int directoryFd, const OutputHandler& onOutput,
+                              const Exec& exec) {
+    ExitStatus exitStatus;
+
+    Child child;
+    if (!start(argv, directoryFd, false, child, exec)) {
+        return exitStatus;
+    }
+    exitStatus.started = true;
+
+    pid_t pid = child.pid;
+    int fds[2] = {child.output, child.error};
+    if (exec.onGroup) {
+        exec.onGroup(pid);
+    }
+
+    int pidfd = openPidfd(pid);
+    int status = 0;
+    bool exited = false;
+    bool abandoned = false;
+    std::vector<char> buffer(16384);
+
+    while (!abandoned && (fds[0] != -1 || fds[1] != -1)) {
+        pollfd watched[3];
+        nfds_t count = 0;
+        for (int fd : fds) {
+            if (fd != -1) {
+                watched[count++] = {fd, POLLIN, 0};
+            }
+        }
+        if (pidfd != -1 && !exited) {
+            watched[count++] = {pidfd, POLLIN, 0};
+        }
+
+        // once the child is gone only what it already wrote is read,
+        // a background job holding the pipe open does not hold the response
+        int ready = poll(watched, count, exited ? 0 : -1);
+        if (ready == -1 && errno == EINTR) {
+            continue;
+        }
+        if (ready == -1) {
+            LOG_ERROR(this -> logger, "(ProcessRunner::run) poll failed: " + std::string(strerror(errno)));
+            abandoned = true;
+            break;
+        }
+        if (ready == 0) {
+            break;
+        }
+
+        for (nfds_t i = 0; i < count && !abandoned; ++i) {
+            if (watched[i].revents == 0) {
+                continue;
+            }
+
+            if (watched[i].fd == pidfd) {
+                if (exec.onGroup) {
+                    exec.onGroup(-1);
+                }
+                while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {}
+                exited = true;
+                continue;
+            }
+
+            int& fd = (watched[i].fd == fds[0]) ? fds[0] : fds[1];
+            Stream stream = (&fd == &fds[0]) ? Stream::STDOUT : Stream::STDERR;
+
+            ssize_t bytesRead = read(fd, buffer.data(), buffer.size());
+            if (bytesRead > 0) {
+                if (!onOutput(stream, std::string_view(buffer.data(), bytesRead))) {
+                    abandoned = true;
+                }
+            } else if (bytesRead == 0 || errno != EINTR) {
+                closeIfOpen(fd);
+            }
+        }
+    }
+
+    // the group id is only ours while the leader is unreaped
+    if (abandoned && !exited) {
+        killpg(pid, SIGKILL);
+    }
+    closeIfOpen(fds[0]);
+    closeIfOpen(fds[1]);
+
+    if (!exited) {
+        if (exec.onGroup) {
+            exec.onGroup(-1);
+        }
+        while (waitpid(pid, &status, 0) == -1 && errno == EINTR) {}
+    }
+    closeIfOpen(pidfd);
+
+    if (WIFEXITED(status)) {
+        exitStatus.code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        exitStatus.signal = WTERMSIG(status);
+    }
+    return exitStatus;
+}
+
+bool ProcessRunner::start(const std::vector<std::string>& argv, int directoryFd, bool withInput, Child& child,
+                          const Exec& exec) {
+    if (argv.empty()) {
+        return false;
+    }
+
+    int inPipe[2] = {-1, -1};
+    int outPipe[2];
+    int errPipe[2];
+    if (withInput && makePipe(inPipe) == -1) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::start) Failed to create stdin pipe: " + std::string(strerror(errno)));
+        return false;
+    }
+    if (makePipe(outPipe) == -1) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::start) Failed to create stdout pipe: " + std::string(strerror(errno)));
+        closeIfOpen(inPipe[0]);
+        closeIfOpen(inPipe[1]);
+        return false;
+    }
+    if (makePipe(errPipe) == -1) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::start) Failed to create stderr pipe: " + std::string(strerror(errno)));
+        closeIfOpen(inPipe[0]);
+        closeIfOpen(inPipe[1]);
+        close(outPipe[0]);
+        close(outPipe[1]);
+        return false;
+    }
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    if (withInput) {
+        posix_spawn_file_actions_adddup2(&actions, inPipe[0], STDIN_FILENO);
+    } else {
+        posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, "/dev/null", O_RDONLY, 0);
+    }
+    posix_spawn_file_actions_adddup2(&actions, outPipe[1], STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, errPipe[1], STDERR_FILENO);
+    // the child enters the session directory through its descriptor, the server's own cwd never moves
+    if (directoryFd != -1) {
+        posix_spawn_file_actions_addfchdir_np(&actions, directoryFd);
+    }
+
+    posix_spawnattr_t attributes;
+    initAttributes(attributes, false);
+
+    pid_t pid = -1;
+    int spawnError = spawn(pid, argv, actions, attributes, exec);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    closeIfOpen(inPipe[0]);
+    close(outPipe[1]);
+    close(errPipe[1]);
+
+    if (spawnError != 0) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::start) Failed to spawn " + argv[0] + ": " + std::string(strerror(spawnError)));
+        closeIfOpen(inPipe[1]);
+        close(outPipe[0]);
+        close(errPipe[0]);
+        return false;
+    }
+
+    child.pid = pid;
+    child.input = inPipe[1];
+    child.output = outPipe[0];
+    child.error = errPipe[0];
+    return true;
+}
+
+
+bool ProcessRunner::startTerminal(const std::vector<std::string>& argv, int directoryFd,
+                                  unsigned short rows, unsigned short columns, Child& child) {
+    if (argv.empty()) {
+        return false;
+    }
+
+    int master = posix_openpt(O_RDWR | O_NOCTTY);
+    if (master == -1) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::startTerminal) Failed to open a pseudo-terminal: " + std::string(strerror(errno)));
+        return false;
+    }
+    fcntl(master, F_SETFD, FD_CLOEXEC);
+
+    char slaveName[128];
+    if (grantpt(master) == -1 || unlockpt(master) == -1 || ptsname_r(master, slaveName, sizeof(slaveName)) != 0) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::startTerminal) Failed to set up the pseudo-terminal: " + std::string(strerror(errno)));
+        close(master);
+        return false;
+    }
+
+    // the size is in place before the program first asks for it
+    winsize size{};
+    size.ws_row = rows;
+    size.ws_col = columns;
+    ioctl(master, TIOCSWINSZ, &size);
+
+    // opened after setsid, so the terminal becomes the child's controlling tty
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+    posix_spawn_file_actions_addopen(&actions, STDIN_FILENO, slaveName, O_RDWR, 0);
+    posix_spawn_file_actions_adddup2(&actions, STDIN_FILENO, STDOUT_FILENO);
+    posix_spawn_file_actions_adddup2(&actions, STDIN_FILENO, STDERR_FILENO);
+    if (directoryFd != -1) {
+        posix_spawn_file_actions_addfchdir_np(&actions, directoryFd);
+    }
+
+    posix_spawnattr_t attributes;
+    initAttributes(attributes, true);
+
+    // the server's own TERM may be missing or "dumb" when it runs as a daemon
+    Exec exec;
+    exec.variables.push_back("TERM=xterm-256color");
+
+    pid_t pid = -1;
+    int spawnError = spawn(pid, argv, actions, attributes, exec);
+
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+
+    if (spawnError != 0) {
+        LOG_ERROR(this -> logger, "(ProcessRunner::startTerminal) Failed to spawn " + argv[0] + ": " + std::string(strerror(spawnError)));
+        close(master);
+        return false;
+    }
+
+    child.pid = pid;
+    child.output = master;
+    return true;
+}
+
+}
@@ -0,0 +1,590 @@
+//
+//  Reactor.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Reactor.hpp"
+#include "../headers/ZeroCopy.hpp"
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <deque>
+#include <condition_variable>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#ifdef __linux__
+#include <sys/epoll.h>
+#endif
+
+namespace server {
+
+// per client state, an idle connection only holds these few members
+struct Reactor::Connection {
+    int socket;
+    const SessionHook& onClose;
+    std::mutex mutex;
+    std::condition_variable drained;   // streaming workers wait here for window or a hang up
+    std::string outbound;              // framed responses, the kernel did not take all of them yet
+    size_t outboundSent = 0;           // prefix of outbound already written
+    protocol::FrameParser parser;      // only touched by the owning I/O loop
+    ChannelTable channels;             // pane sessions, their queued requests and windows
+    bool closing = false;              // hang up as soon as outbound drains
+    bool closed = false;               // removed from its loop, late responses are dropped
+
+    Connection(int socket, const SessionHook& onClose) : socket(socket), onClose(onClose) {}
+
+    ~Connection() {
+        // the last reference is gone, no worker can touch the descriptor anymore
+        for (uint16_t channel : this -> channels.openChannels()) {
+            this -> onClose(this -> socket, channel);
+        }
+        close(this -> socket);
+    }
+};
+
+struct Reactor::IOLoop {
+    int epollFd = -1;
+    std::thread thread;
+    std::mutex connectionsMutex;
+    std::unordered_map<int, std::shared_ptr<Connection>> connections;
+};
+
+#ifdef __linux__
+
+bool Reactor::isSupported() {
+    return true;
+}
+
+Reactor::Reactor(int listenSocket, unsigned ioThreads, size_t workerThreads, logs::Logger& logger,
+                 RequestHandler handler, OrderingPredicate isBarrier, SessionHook onOpen, SessionHook onClose,
+                 TerminalHook onTerminal)
+: listenSocket(listenSocket), logger(logger), handler(std::move(handler)), isBarrier(std::move(isBarrier)),
+onOpen(std::move(onOpen)), onClose(std::move(onClose)), onTerminal(std::move(onTerminal)) {
+
+    if (ioThreads == 0) {
+        ioThreads = 1;
+    }
+
+    // the listening socket is drained until EAGAIN on every edge
+    int flags = fcntl(this -> listenSocket, F_GETFL, 0);
+    if (flags == -1 || fcntl(this -> listenSocket, F_SETFL, flags | O_NONBLOCK) == -1) {
+        LOG_ERROR(this -> logger, "(Reactor::Reactor) Failed to make the listening socket non-blocking.");
+        throw std::runtime_error("Failed to make the listening socket non-blocking.");
+    }
+
+    for (unsigned i = 0; i < ioThreads; ++i) {
+        auto loop = std::make_unique<IOLoop>();
+        loop -> epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (loop -> epollFd == -1) {
+            LOG_ERROR(this -> logger, "(Reactor::Reactor) epoll_create1 failed: " + std::string(strerror(errno)));
+            throw std::runtime_error("Failed to create epoll instance.");
+        }
+        this -> loops.push_back(std::move(loop));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLET;
+    event.data.fd = this -> listenSocket;
+    if (epoll_ctl(this -> loops[0] -> epollFd, EPOLL_CTL_ADD, this -> listenSocket, &event) == -1) {
+        LOG_ERROR(this -> logger, "(Reactor::Reactor) Failed to register the listening socket: " + std::string(strerror(errno)));
+        throw std::runtime_error("Failed to register the listening socket.");
+    }
+
+    this -> workers = std::make_unique<ThreadPool>(workerThreads, MAX_WORKERS);
+
+    LOG_DEBUG(this -> logger, "(Reactor::Reactor) Reactor ready with " + std::to_string(ioThreads) +
+                              " I/O threads and " + std::to_string(this -> workers -> size()) + " workers (up to " +
+                              std::to_string(MAX_WORKERS) + ").");
+}
+
+Reactor::~Reactor() {
+    for (auto& loop : this -> loops) {
+        if (loop -> thread.joinable()) {
+            loop -> thread.detach();
+        }
+        if (loop -> epollFd != -1) {
+            close(loop -> epollFd);
+        }
+    }
+}
+
+void Reactor::run() {
+    LOG_DEBUG(this -> logger, "(Reactor::run) Starting epoll event loops.");
+
+    for (size_t i = 1; i < this -> loops.size(); ++i) {
+        IOLoop& loop = *this -> loops[i];
+        loop.thread = std::thread(&Reactor::loopRun, this, std::ref(loop));
+    }
+
+    loopRun(*this -> loops[0]);
+}
+
+void Reactor::loopRun(IOLoop& loop) {
+    epoll_event events[64];
+
+    while (true) {
+        int ready = epoll_wait(loop.epollFd, events, 64, -1);
+        if (ready == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR(this -> logger, "(Reactor::loopRun) epoll_wait failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+            uint32_t flags = events[i].events;
+
+            if (fd == this -> listenSocket) {
+                acceptClients();
+                continue;
+            }
+
+            auto source = this -> sources.find(fd);
+            if (source != this -> sources.end()) {
+                source -> second();
+                continue;
+            }
+
+            std::shared_ptr<Connection> connection;
+            {
+                std::lock_guard<std::mutex> lock(loop.connectionsMutex);
+                auto it = loop.connections.find(fd);
+                if (it == loop.connections.end()) {
+                    continue;
+                }
+                connection = it -> second;
+            }
+
+            // read first so a request sent right before the hang up is not lost
+            if (flags & (EPOLLIN | EPOLLRDHUP)) {
+                handleReadable(loop, connection);
+            }
+            if (flags & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(loop, fd);
+                continue;
+            }
+            if (flags & EPOLLOUT) {
+                handleWritable(connection);
+            }
+        }
+    }
+}
+
+void Reactor::addSource(int fd, std::function<void()> onReadable) {
+    // level triggered, the owner need not drain it in one go
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+    if (epoll_ctl(this -> loops[0] -> epollFd, EPOLL_CTL_ADD, fd, &event) == -1) {
+        LOG_ERROR(this -> logger, "(Reactor::addSource) Failed to register descriptor " + std::to_string(fd) + ": " + std::string(strerror(errno)));
+        return;
+    }
+    this -> sources[fd] = std::move(onReadable);
+}
+
+void Reactor::push(int clientSocket, uint16_t channel, protocol::FrameType type, std::string_view payload) {
+    for (auto& loop : this -> loops) {
+        // the map keeps the connection alive, a copy here could end up running its destructor
+        std::lock_guard<std::mutex> mapLock(loop -> connectionsMutex);
+        auto it = loop -> connections.find(clientSocket);
+        if (it == loop -> connections.end()) {
+            continue;
+        }
+
+        Connection& connection = *it -> second;
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        if (connection.closed || connection.closing || !connection.channels.isOpen(channel)) {
+            return;
+        }
+        // outbound only ever holds whole frames past the sent prefix, this one goes behind them
+        protocol::appendMessage(connection.outbound, type, channel, 0, payload);
+        flushLocked(connection);
+        return;
+    }
+}
+
+void Reactor::acceptClients() {
+    while (true) {
+        sockaddr_in clientAddr{};
+        socklen_t clientLen = sizeof(clientAddr);
+        int clientSocket = accept4(this -> listenSocket, (struct sockaddr*)&clientAddr, &clientLen, SOCK_NONBLOCK | SOCK_CLOEXEC);
+
+        if (clientSocket == -1) {
+            if (errno == EINTR || errno == ECONNABORTED) {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK) {
+                LOG_ERROR(this -> logger, "(Reactor::acceptClients) Failed to accept client connection: " + std::string(strerror(errno)));
+            }
+            return;
+        }
+
+        protocol::setNoDelay(clientSocket);
+        this -> onOpen(clientSocket, 0);
+
+        // round robin over the loops, the listening loop takes its share too
+        IOLoop& loop = *this -> loops[this -> nextLoop];
+        this -> nextLoop = (this -> nextLoop + 1) % this -> loops.size();
+
+        auto connection = std::make_shared<Connection>(clientSocket, this -> onClose);
+        {
+            std::lock_guard<std::mutex> lock(loop.connectionsMutex);
+            loop.connections[clientSocket] = connection;
+        }
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+        event.data.fd = clientSocket;
+        if (epoll_ctl(loop.epollFd, EPOLL_CTL_ADD, clientSocket, &event) == -1) {
+            LOG_ERROR(this -> logger, "(Reactor::acceptClients) Failed to register client " + std::to_string(clientSocket) +
+                                      ": " + std::string(strerror(errno)));
+            std::lock_guard<std::mutex> lock(loop.connectionsMutex);
+            loop.connections.erase(clientSocket);
+            continue;
+        }
+
+        LOG_DEBUG(this -> logger, "(Reactor::acceptClients) Client connected with id: " + std::to_string(clientSocket));
+    }
+}
+
+void Reactor::handleReadable(IOLoop& loop, const std::shared_ptr<Connection>& connection) {
+    protocol::FrameParser& parser = connection -> parser;
+    protocol::Frame frame;
+    bool peerClosed = false;
+
+    // edge triggered: drain everything the kernel holds for this socket
+    while (true) {
+        char* space = parser.prepare(4096);
+        ssize_t bytesRead = recv(connection -> socket, space, parser.writable(), 0);
+        if (bytesRead > 0) {
+            parser.commit(bytesRead);
+
+            // frames are views into the parser, take them out before the next recv
+            protocol::FrameParser::Result result;
+            while ((result = parser.nextMessage(frame)) == protocol::FrameParser::Result::FRAME) {
+                applyFrame(connection, frame);
+            }
+            if (result == protocol::FrameParser::Result::MALFORMED) {
+                LOG_ERROR(this -> logger, "(Reactor::handleReadable) Malformed frame from client " + std::to_string(connection -> socket) + ".");
+                peerClosed = true;
+                break;
+            }
+            continue;
+        }
+        if (bytesRead == 0) {
+            peerClosed = true;
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK) {
+            LOG_ERROR(this -> logger, "(Reactor::handleReadable) Failed to receive data from client: " + std::string(strerror(errno)));
+            peerClosed = true;
+        }
+        break;
+    }
+
+    if (peerClosed) {
+        LOG_DEBUG(this -> logger, "(Reactor::handleReadable) Client disconnected.");
+        closeConnection(loop, connection -> socket);
+    }
+}
+
+void Reactor::applyFrame(const std::shared_ptr<Connection>& connection, const protocol::Frame& frame) {
+    ChannelTable::Event event;
+    {
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        event = connection -> channels.apply(frame);
+        if (event == ChannelTable::Event::WINDOW) {
+            connection -> channels.drainInto(connection -> outbound);
+            flushLocked(*connection);
+        }
+    }
+    if (event == ChannelTable::Event::WINDOW || event == ChannelTable::Event::CLOSED) {
+        connection -> drained.notify_all();
+    }
+
+    switch (event) {
+        case ChannelTable::Event::OPENED:
+            this -> onOpen(connection -> socket, frame.header.channel);
+            break;
+        case ChannelTable::Event::CLOSED:
+            this -> onClose(connection -> socket, frame.header.channel);
+            break;
+        case ChannelTable::Event::REQUEST:
+            dispatch(connection, Request{frame.header.channel, frame.header.requestId, std::string(frame.payload)});
+            break;
+        case ChannelTable::Event::TERMINAL:
+            this -> onTerminal(connection -> socket, frame);
+            break;
+        default:
+            break;
+    }
+}
+
+void Reactor::handleWritable(const std::shared_ptr<Connection>& connection) {
+    std::lock_guard<std::mutex> lock(connection -> mutex);
+    flushLocked(*connection);
+}
+
+void Reactor::closeConnection(IOLoop& loop, int clientSocket) {
+    std::shared_ptr<Connection> connection;
+    {
+        std::lock_guard<std::mutex> lock(loop.connectionsMutex);
+        auto it = loop.connections.find(clientSocket);
+        if (it == loop.connections.end()) {
+            return;
+        }
+        connection = std::move(it -> second);
+        loop.connections.erase(it);
+    }
+
+    epoll_ctl(loop.epollFd, EPOLL_CTL_DEL, clientSocket, nullptr);
+
+    {
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        connection -> closed = true;
+        connection -> channels.clearPending();
+    }
+    connection -> drained.notify_all();
+
+    // the descriptor is closed by the last owner, maybe a worker still running a request
+    LOG_DEBUG(this -> logger, "(Reactor::closeConnection) Client socket " + std::to_string(clientSocket) + " released.");
+}
+
+void Reactor::dispatch(const std::shared_ptr<Connection>& connection, Request request) {
+    request.barrier = this -> isBarrier(request.command);
+
+    std::vector<Request> ready;
+    {
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        if (connection -> closed || connection -> closing) {
+            return;
+        }
+        connection -> channels.enqueue(std::move(request));
+        ready = connection -> channels.takeRunnable(MAX_IN_FLIGHT);
+    }
+
+    for (auto& next : ready) {
+        execute(connection, std::move(next));
+    }
+}
+
+void Reactor::execute(const std::shared_ptr<Connection>& connection, Request request) {
+    this -> workers -> submit([this, connection, request = std::move(request)]() {
+        bool closeAfter = false;
+        std::string response;
+        OutputSink emit = [this, &connection, &request](std::string_view chunk) {
+            return streamChunk(connection, request, chunk);
+        };
+        FileSink sendFile = [this, &connection, &request](int fd, off_t offset, size_t length) {
+            return streamFile(connection, request, fd, offset, length);
+        };
+        try {
+            response = this -> handler(connection -> socket, request.channel, request.command, emit, sendFile, closeAfter);
+        } catch (const std::exception& e) {
+            LOG_ERROR(this -> logger, "(Reactor::dispatch) Request failed: " + std::string(e.what()));
+            response = "Error: " + std::string(e.what());
+        }
+        completeRequest(connection, request, std::move(response), closeAfter);
+    });
+}
+
+bool Reactor::streamChunk(const std::shared_ptr<Connection>& connection, const Request& request, std::string_view chunk) {
+    std::unique_lock<std::mutex> lock(connection -> mutex);
+
+    auto abandoned = [&]() {
+        return connection -> closed || connection -> closing || !connection -> channels.isOpen(request.channel);
+    };
+
+    // bounded buffering: the command waits until the client made room for what is already queued
+    connection -> drained.wait(lock, [&]() {
+        return abandoned() || connection -> channels.queuedBytes(request.channel) < ChannelTable::STREAM_BUFFER_LIMIT;
+    });
+    if (abandoned()) {
+        return false;
+    }
+
+    connection -> channels.queueResponse(request.channel, request.id, chunk, false);
+    connection -> channels.drainInto(connection -> outbound);
+    flushLocked(*connection);
+    return true;
+}
+
+bool Reactor::streamFile(const std::shared_ptr<Connection>& connection, const Request& request, int fd, off_t offset, size_t length) {
+    while (length > 0) {
+        size_t chunk = std::min<size_t>(length, protocol::STREAM_CHUNK);
+        std::unique_lock<std::mutex> lock(connection -> mutex);
+
+        auto abandoned = [&]() {
+            return connection -> closed || connection -> closing || !connection -> channels.isOpen(request.channel);
+        };
+
+        // the frame is written straight to the socket, so everything before it has to be on the
+        // wire already and the client must have the room for all of it
+        connection -> drained.wait(lock, [&]() {
+            return abandoned() || (connection -> outbound.empty() && connection -> channels.claimWindow(request.channel, chunk));
+        });
+        if (abandoned()) {
+            return false;
+        }
+
+        protocol::FrameHeader header;
+        header.type = protocol::FrameType::RESPONSE;
+        header.flags = protocol::FLAG_MORE;
+        header.channel = request.channel;
+        header.requestId = request.id;
+        header.length = static_cast<uint32_t>(chunk);
+        connection -> outbound.resize(protocol::HEADER_SIZE);
+        protocol::encodeHeader(header, connection -> outbound.data());
+
+        size_t sent = 0;
+        bool flushed = flushLocked(*connection);
+        if (!flushed && connection -> outbound.empty()) {
+            return false;   // the send failed, the loop hangs up
+        }
+        if (flushed) {
+            while (sent < chunk) {
+                ssize_t bytesSent = ZeroCopy::send(connection -> socket, fd, offset + sent, chunk - sent);
+                if (bytesSent <= 0) {
+                    break;
+                }
+                sent += bytesSent;
+            }
+        }
+        // a full socket or a file that shrank, the rest of the frame leaves as a copy like any other output
+        if (sent < chunk && !ZeroCopy::read(fd, offset + sent, chunk - sent, connection -> outbound)) {
+            LOG_ERROR(this -> logger, "(Reactor::streamFile) Failed to read the file: " + std::string(strerror(errno)));
+            shutdown(connection -> socket, SHUT_RDWR);
+            return false;
+        }
+        flushLocked(*connection);
+
+        offset += chunk;
+        length -= chunk;
+    }
+    return true;
+}
+
+void Reactor::completeRequest(const std::shared_ptr<Connection>& connection, const Request& request, std::string response, bool closeAfter) {
+    std::vector<Request> ready;
+    bool channelClosed = false;
+    {
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        connection -> channels.finished(request);
+
+        if (connection -> closed) {
+            return;
+        }
+
+        // responses leave in completion order, the client matches them by id
+        connection -> channels.queueResponse(request.channel, request.id, response);
+        if (closeAfter && request.channel == 0) {
+            connection -> closing = true;
+            connection -> channels.clearPending();
+        } else if (closeAfter) {
+            channelClosed = connection -> channels.close(request.channel);
+        }
+        connection -> channels.drainInto(connection -> outbound);
+        flushLocked(*connection);
+
+        if (!connection -> closing) {
+            ready = connection -> channels.takeRunnable(MAX_IN_FLIGHT);
+        }
+    }
+
+    if (closeAfter) {
+        connection -> drained.notify_all();
+    }
+    if (channelClosed) {
+        this -> onClose(connection -> socket, request.channel);
+    }
+
+    for (auto& next : ready) {
+        execute(connection, std::move(next));
+    }
+}
+
+bool Reactor::flushLocked(Connection& connection) {
+    while (connection.outboundSent < connection.outbound.size()) {
+        ssize_t bytesSent = send(connection.socket, connection.outbound.data() + connection.outboundSent,
+                                 connection.outbound.size() - connection.outboundSent, MSG_NOSIGNAL);
+        if (bytesSent > 0) {
+            // advance an offset instead of erasing, large outputs leave in many partial sends
+            connection.outboundSent += bytesSent;
+            continue;
+        }
+        if (bytesSent == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytesSent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            // EPOLLOUT fires once the socket drains
+            return false;
+        }
+        LOG_ERROR(this -> logger, "(Reactor::flushLocked) Failed to send data to client: " + std::string(strerror(errno)));
+        connection.outbound.clear();
+        connection.outboundSent = 0;
+        shutdown(connection.socket, SHUT_RDWR);
+        return false;
+    }
+
+    bool wrote = connection.outboundSent > 0;
+    connection.outbound.clear();
+    connection.outboundSent = 0;
+    // a file waits for the socket to take everything before it
+    if (wrote) {
+        connection.drained.notify_all();
+    }
+
+    // the loop sees the hang up and releases the connection
+    if (connection.closing) {
+        shutdown(connection.socket, SHUT_RDWR);
+    }
+    return true;
+}
+
+#else
+
+bool Reactor::isSupported() {
+    return false;
+}
+
+Reactor::Reactor(int listenSocket, unsigned ioThreads, size_t workerThreads, logs::Logger& logger,
+                 RequestHandler handler, OrderingPredicate isBarrier, SessionHook onOpen, SessionHook onClose,
+                 TerminalHook onTerminal)
+: listenSocket(listenSocket), logger(logger), handler(std::move(handler)), isBarrier(std::move(isBarrier)),
+onOpen(std::move(onOpen)), onClose(std::move(onClose)), onTerminal(std::move(onTerminal)) {
+    LOG_ERROR(this -> logger, "(Reactor::Reactor) epoll is not available on this platform.");
+    throw std::runtime_error("epoll is not available on this platform.");
+}
+
+Reactor::~Reactor() = default;
+
+void Reactor::run() {}
+void Reactor::addSource(int, std::function<void()>) {}
+void Reactor::push(int, uint16_t, protocol::FrameType, std::string_view) {}
+void Reactor::loopRun(IOLoop&) {}
+void Reactor::acceptClients() {}
+void Reactor::handleReadable(IOLoop&, const std::shared_ptr<Connection>&) {}
+void Reactor::handleWritable(const std::shared_ptr<Connection>&) {}
+void Reactor::closeConnection(IOLoop&, int) {}
+void Reactor::dispatch(const std::shared_ptr<Connection>&, Request) {}
+void Reactor::execute(const std::shared_ptr<Connection>&, Request) {}
+bool Reactor::streamChunk(const std::shared_ptr<Connection>&, const Request&, std::string_view) { return false; }
+bool Reactor::streamFile(const std::shared_ptr<Connection>&, const Request&, int, off_t, size_t) { return false; }
+void Reactor::completeRequest(const std::shared_ptr<Connection>&, const Request&, std::string, bool) {}
+void Reactor::applyFrame(const std::shared_ptr<Connection>&, const protocol::Frame&) {}
+bool Reactor::flushLocked(Connection&) { return false; }
+
+#endif
+
+}
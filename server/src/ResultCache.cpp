@@ -0,0 +1,408 @@
+//
+//  ResultCache.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ResultCache.hpp"
+#include "../headers/DirectExec.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <cerrno>
+#include <cstring>
+#include <string_view>
+#include <filesystem>
+#include <algorithm>
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/vfs.h>
+#endif
+
+namespace server {
+
+namespace {
+
+// programs whose output only depends on the files they name and the directory they run in,
+// with the options that would make them read more than that or never finish
+struct ReadOnlyCommand {
+    std::string_view verb;
+    std::string_view forbiddenLetters;   // in a short option cluster
+    std::string_view forbiddenLong;      // a long option, getopt takes any start of it too
+};
+
+constexpr ReadOnlyCommand READ_ONLY[] = {
+    {"ls", "R", "--recursive"},
+    {"cat", "", ""},
+    {"head", "", ""},
+    {"tail", "fF", "--follow"},
+    {"wc", "", "--files0-from"},
+    {"file", "", ""},
+    {"readlink", "", ""},
+    {"md5sum", "", ""},
+    {"sha1sum", "", ""},
+    {"sha256sum", "", ""},
+    {"cksum", "", ""}
+};
+
+// watches kept at most, the ones no entry needs are dropped first
+constexpr size_t MAX_WATCHES = 1024;
+
+#ifdef __linux__
+// filesystems whose files change without an inotify event or a new mtime: the kernel's
+// pseudo filesystems, and network ones another machine writes to
+constexpr long UNWATCHABLE_FILESYSTEMS[] = {
+    0x9fa0,       // proc
+    0x62656572,   // sysfs
+    0x64626720,   // debugfs
+    0x74726163,   // tracefs
+    0x27e0eb,     // cgroup
+    0x63677270,   // cgroup2
+    0x73636673,   // securityfs
+    0x1cd1,       // devpts
+    0xcafe4a11,   // bpf
+    0x62656570,   // configfs
+    0x6165676c,   // pstore
+    0xde5e81e4,   // efivarfs
+    0x6969,       // nfs
+    0xff534d42,   // cifs
+    0xfe534d42,   // smb2
+    0x65735546    // fuse
+};
+#endif
+
+bool isReadOnly(const std::vector<std::string>& words) {
+    const ReadOnlyCommand* command = std::find_if(std::begin(READ_ONLY), std::end(READ_ONLY), [&words](const ReadOnlyCommand& known) {
+        return known.verb == words.front();
+    });
+    if (command == std::end(READ_ONLY)) {
+        return false;
+    }
+    for (size_t i = 1; i < words.size(); ++i) {
+        std::string_view word = words[i];
+        if (word.empty() || word == "-") {
+            return false;   // stdin
+        }
+        if (word.rfind("--", 0) == 0) {
+            // ls --rec is ls --recursive, the name is compared up to its =value
+            std::string_view name = word.substr(0, word.find('='));
+            if (!command -> forbiddenLong.empty() && name.size() > 2 && command -> forbiddenLong.rfind(name, 0) == 0) {
+                return false;
+            }
+        } else if (word[0] == '-' && word.find_first_of(command -> forbiddenLetters) != std::string_view::npos) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// a path whose changes the cache would notice: missing, or a regular file or directory on a
+// filesystem that reports its writes; /proc/uptime reads differently every time and says nothing
+bool isWatchable(int directoryFd, const std::string& name) {
+    struct stat info;
+    if (fstatat(directoryFd, name.c_str(), &info, 0) == -1) {
+        return errno == ENOENT || errno == ENOTDIR;
+    }
+    if (!S_ISREG(info.st_mode) && !S_ISDIR(info.st_mode)) {
+        return false;
+    }
+#ifdef __linux__
+    int fd = openat(directoryFd, name.c_str(), O_PATH | O_CLOEXEC);
+    if (fd == -1) {
+        return false;
+    }
+    struct statfs filesystem;
+    bool known = fstatfs(fd, &filesystem) == 0;
+    close(fd);
+    if (!known) {
+        return false;
+    }
+    return std::find(std::begin(UNWATCHABLE_FILESYSTEMS), std::end(UNWATCHABLE_FILESYSTEMS),
+                     static_cast<long>(filesystem.f_type)) == std::end(UNWATCHABLE_FILESYSTEMS);
+#else
+    return true;
+#endif
+}
+
+ResultCache::Snapshot take(int directoryFd, const std::string& name, bool& directory) {
+    ResultCache::Snapshot snapshot;
+    struct stat info;
+    directory = false;
+    if (fstatat(directoryFd, name.c_str(), &info, 0) == -1) {
+        return snapshot;
+    }
+    snapshot.exists = true;
+    snapshot.device = info.st_dev;
+    snapshot.inode = info.st_ino;
+    snapshot.size = info.st_size;
+#ifdef __APPLE__
+    snapshot.modified = info.st_mtimespec.tv_sec * 1000000000LL + info.st_mtimespec.tv_nsec;
+    snapshot.changed = info.st_ctimespec.tv_sec * 1000000000LL + info.st_ctimespec.tv_nsec;
+#else
+    snapshot.modified = info.st_mtim.tv_sec * 1000000000LL + info.st_mtim.tv_nsec;
+    snapshot.changed = info.st_ctim.tv_sec * 1000000000LL + info.st_ctim.tv_nsec;
+#endif
+    directory = S_ISDIR(info.st_mode);
+    return snapshot;
+}
+
+// one spelling per directory, the watch maps are keyed by it
+std::string normalized(const std::filesystem::path& path) {
+    std::string text = path.lexically_normal().string();
+    while (text.size() > 1 && text.back() == '/') {
+        text.pop_back();
+    }
+    return text;
+}
+
+}
+
+bool ResultCache::Snapshot::operator==(const Snapshot& other) const {
+    return this -> exists == other.exists && this -> device == other.device && this -> inode == other.inode &&
+           this -> modified == other.modified && this -> changed == other.changed && this -> size == other.size;
+}
+
+ResultCache::ResultCache(logs::Logger& logger) : logger(logger) {
+#ifdef __linux__
+    this -> inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (this -> inotifyFd == -1) {
+        LOG_ERROR(this -> logger, "(ResultCache::ResultCache) inotify_init1 failed, results are not cached: " + std::string(strerror(errno)));
+    }
+#else
+    LOG_WARN(this -> logger, "(ResultCache::ResultCache) No inotify on this system, results are not cached.");
+#endif
+}
+
+ResultCache::~ResultCache() {
+    if (this -> inotifyFd != -1) {
+        close(this -> inotifyFd);
+    }
+}
+
+std::optional<ResultCache::Ticket> ResultCache::prepare(const std::string& command, const SessionDirectory& workingDirectory) {
+    std::vector<std::string> words;
+    if (this -> inotifyFd == -1 || !DirectExec::split(command, words) || !isReadOnly(words)) {
+        return std::nullopt;
+    }
+
+    // the working directory and every word that is not an option; a value like the 5 of
+    // head -n 5 is a path that does not exist, which costs nothing
+    std::vector<std::string> touched = {"."};
+    for (size_t i = 1; i < words.size(); ++i) {
+        if (words[i][0] != '-') {
+            touched.push_back(words[i]);
+        }
+    }
+
+    // a file is watched through its directory, which also reports writes to it; a directory
+    // through itself for its entries and its parent for its own rename or removal
+    std::set<std::string> directories;
+    for (const std::string& name : touched) {
+        if (!isWatchable(workingDirectory.fd(), name)) {
+            return std::nullopt;
+        }
+        bool directory = false;
+        take(workingDirectory.fd(), name, directory);
+        std::filesystem::path full = name[0] == '/' ? std::filesystem::path(name) : workingDirectory.path() / name;
+        directories.insert(normalized(full.lexically_normal().parent_path()));
+        if (directory) {
+            directories.insert(normalized(full));
+        }
+    }
+
+    Ticket ticket;
+    ticket.key = workingDirectory.path().string() + '\0' + command;
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        drainEventsLocked();
+        for (const std::string& directory : directories) {
+            int watch = watchLocked(directory);
+            if (watch == -1) {
+                return std::nullopt;
+            }
+            ticket.watches.push_back(watch);
+        }
+        ticket.sequence = this -> sequence;
+    }
+
+    // taken after the watches are in place, a change in between shows up as an event
+    for (const std::string& name : touched) {
+        bool directory = false;
+        ticket.snapshots.push_back(take(workingDirectory.fd(), name, directory));
+    }
+    return ticket;
+}
+
+bool ResultCache::lookup(const Ticket& ticket, std::string& output, std::string& result) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    drainEventsLocked();
+
+    auto it = this -> entries.find(ticket.key);
+    if (it == this -> entries.end()) {
+        return false;
+    }
+    // replaced or touched behind inotify's back, e.g. through a hard link elsewhere
+    if (!(it -> second.snapshots == ticket.snapshots)) {
+        eraseLocked(ticket.key);
+        return false;
+    }
+
+    this -> ages.splice(this -> ages.end(), this -> ages, it -> second.age);
+    output = it -> second.output;
+    result = it -> second.result;
+    return true;
+}
+
+void ResultCache::store(const Ticket& ticket, std::string output, std::string result) {
+    if (output.size() > MAX_OUTPUT) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    drainEventsLocked();
+
+    // something it reads changed while the command ran, or a watch was dropped meanwhile
+    for (int watch : ticket.watches) {
+        if (this -> pathByWatch.count(watch) == 0 || this -> lastEvent[watch] > ticket.sequence) {
+            return;
+        }
+    }
+
+    eraseLocked(ticket.key);
+    this -> ages.push_back(ticket.key);
+    Entry& entry = this -> entries[ticket.key];
+    entry.snapshots = ticket.snapshots;
+    entry.watches = ticket.watches;
+    entry.output = std::move(output);
+    entry.result = std::move(result);
+    entry.age = std::prev(this -> ages.end());
+    for (int watch : ticket.watches) {
+        this -> dependents[watch].insert(ticket.key);
+    }
+
+    while (this -> entries.size() > MAX_ENTRIES) {
+        eraseLocked(this -> ages.front());
+    }
+}
+
+void ResultCache::drainEventsLocked() {
+#ifdef __linux__
+    alignas(inotify_event) char buffer[16 * 1024];
+    while (true) {
+        ssize_t length = read(this -> inotifyFd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            // EAGAIN once the queue is empty
+            return;
+        }
+        for (ssize_t offset = 0; offset < length;) {
+            const inotify_event* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += sizeof(inotify_event) + event -> len;
+            ++this -> sequence;
+
+            if (event -> mask & IN_Q_OVERFLOW) {
+                // events were lost, nothing cached can be trusted
+                LOG_WARN(this -> logger, "(ResultCache::drainEventsLocked) inotify queue overflowed, dropping every cached result.");
+                while (!this -> ages.empty()) {
+                    eraseLocked(this -> ages.front());
+                }
+                for (auto& watched : this -> lastEvent) {
+                    watched.second = this -> sequence;
+                }
+                continue;
+            }
+
+            this -> lastEvent[event -> wd] = this -> sequence;
+            auto guarded = this -> dependents.find(event -> wd);
+            if (guarded != this -> dependents.end()) {
+                std::set<std::string> keys = guarded -> second;
+                for (const std::string& key : keys) {
+                    eraseLocked(key);
+                }
+            }
+            if (event -> mask & IN_IGNORED) {
+                // the directory is gone or the watch was removed
+                forgetWatchLocked(event -> wd);
+            }
+        }
+    }
+#endif
+}
+
+int ResultCache::watchLocked(const std::string& path) {
+#ifdef __linux__
+    auto known = this -> watchByPath.find(path);
+    if (known != this -> watchByPath.end()) {
+        return known -> second;
+    }
+
+    if (this -> watchByPath.size() >= MAX_WATCHES) {
+        // watches of commands that were never stored or whose entries are gone
+        std::vector<int> unused;
+        for (const auto& watched : this -> pathByWatch) {
+            if (this -> dependents.count(watched.first) == 0) {
+                unused.push_back(watched.first);
+            }
+        }
+        for (int watch : unused) {
+            inotify_rm_watch(this -> inotifyFd, watch);
+            forgetWatchLocked(watch);
+        }
+        if (this -> watchByPath.size() >= MAX_WATCHES) {
+            return -1;
+        }
+    }
+
+    constexpr uint32_t CHANGES = IN_MODIFY | IN_ATTRIB | IN_CLOSE_WRITE | IN_CREATE | IN_DELETE |
+                                 IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+    int watch = inotify_add_watch(this -> inotifyFd, path.c_str(), CHANGES);
+    if (watch == -1) {
+        LOG_WARN(this -> logger, "(ResultCache::watchLocked) Cannot watch " + path + ": " + std::string(strerror(errno)));
+        return -1;
+    }
+    // the same directory under another spelling comes back with the same watch
+    this -> watchByPath[path] = watch;
+    this -> pathByWatch.emplace(watch, path);
+    this -> lastEvent.emplace(watch, 0);
+    return watch;
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+void ResultCache::eraseLocked(const std::string& key) {
+    auto it = this -> entries.find(key);
+    if (it == this -> entries.end()) {
+        return;
+    }
+    for (int watch : it -> second.watches) {
+        auto guarded = this -> dependents.find(watch);
+        if (guarded != this -> dependents.end()) {
+            guarded -> second.erase(key);
+            if (guarded -> second.empty()) {
+                this -> dependents.erase(guarded);
+            }
+        }
+    }
+    this -> ages.erase(it -> second.age);
+    this -> entries.erase(it);
+}
+
+void ResultCache::forgetWatchLocked(int watch) {
+    auto guarded = this -> dependents.find(watch);
+    if (guarded != this -> dependents.end()) {
+        std::set<std::string> keys = guarded -> second;
+        for (const std::string& key : keys) {
+            eraseLocked(key);
+        }
+    }
+    for (auto it = this -> watchByPath.begin(); it != this -> watchByPath.end();) {
+        it = it -> second == watch ? this -> watchByPath.erase(it) : std::next(it);
+    }
+    this -> pathByWatch.erase(watch);
+    this -> lastEvent.erase(watch);
+}
+
+}
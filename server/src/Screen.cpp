@@ -0,0 +1,461 @@
+//
+//  Screen.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Screen.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+
+namespace server {
+
+Screen::Screen(uint16_t rows, uint16_t columns)
+: rows(std::max<uint16_t>(rows, 1)), columns(std::max<uint16_t>(columns, 1)) {
+    reset();
+}
+
+void Screen::reset() {
+    this -> cells.assign(this -> rows, std::u32string(this -> columns, U' '));
+    this -> mainScreen.clear();
+    this -> alternate = false;
+    this -> cursorRow = this -> cursorColumn = 0;
+    this -> savedRow = this -> savedColumn = 0;
+    this -> wrapPending = false;
+    this -> scrollTop = 0;
+    this -> scrollBottom = this -> rows - 1;
+    this -> dirty = true;
+}
+
+void Screen::feed(std::string_view bytes) {
+    if (bytes.empty()) {
+        return;
+    }
+    this -> dirty = true;
+
+    for (char c : bytes) {
+        unsigned char byte = static_cast<unsigned char>(c);
+
+        // the rest of a multi byte character, a broken one shows as U+FFFD
+        if (this -> continuation > 0) {
+            if ((byte & 0xc0) == 0x80) {
+                this -> codePoint = (this -> codePoint << 6) | (byte & 0x3f);
+                if (--this -> continuation == 0) {
+                    print(this -> codePoint);
+                }
+                continue;
+            }
+            this -> continuation = 0;
+            print(0xfffd);
+        }
+
+        switch (this -> state) {
+            case State::GROUND:
+                if (byte < 0x20 || byte == 0x7f) {
+                    control(byte);
+                } else if (byte < 0x80) {
+                    print(byte);
+                } else if (byte >= 0xc0 && byte < 0xf8) {
+                    this -> continuation = (byte >= 0xf0) ? 3 : (byte >= 0xe0) ? 2 : 1;
+                    this -> codePoint = byte & (0x3f >> this -> continuation);
+                } else {
+                    print(0xfffd);
+                }
+                break;
+            case State::ESCAPE:
+                escape(byte);
+                break;
+            case State::CHARSET:
+                this -> state = State::GROUND;
+                break;
+            case State::CSI:
+                if (byte >= 0x40 && byte <= 0x7e) {
+                    this -> state = State::GROUND;
+                    csi(byte);
+                } else if (byte >= 0x20) {
+                    this -> parameters.push_back(static_cast<char>(byte));
+                } else {
+                    // controls inside a sequence still act, like on a real terminal
+                    control(byte);
+                }
+                break;
+            case State::OSC:
+                if (byte == 0x07) {
+                    this -> state = State::GROUND;
+                } else if (byte == 0x1b) {
+                    this -> state = State::OSC_ESCAPE;
+                }
+                break;
+            case State::OSC_ESCAPE:
+                this -> state = State::GROUND;
+                break;
+        }
+    }
+}
+
+void Screen::resize(uint16_t rows, uint16_t columns) {
+    rows = std::max<uint16_t>(rows, 1);
+    columns = std::max<uint16_t>(columns, 1);
+
+    // content stays anchored at the top left, like in most terminals
+    for (auto* grid : {&this -> cells, &this -> mainScreen}) {
+        if (grid -> empty()) {
+            continue;
+        }
+        grid -> resize(rows, std::u32string(columns, U' '));
+        for (auto& row : *grid) {
+            row.resize(columns, U' ');
+        }
+    }
+
+    this -> rows = rows;
+    this -> columns = columns;
+    this -> scrollTop = 0;
+    this -> scrollBottom = rows - 1;
+    moveCursor(this -> cursorRow, this -> cursorColumn);
+    this -> sent.clear();
+    this -> dirty = true;
+}
+
+protocol::ScreenUpdate Screen::takeUpdate() {
+    protocol::ScreenUpdate update;
+    update.rows = this -> rows;
+    update.columns = this -> columns;
+    update.cursorRow = this -> cursorRow;
+    update.cursorColumn = this -> cursorColumn;
+
+    // a fresh or resized screen is compared against a blank one, as the client starts from that
+    if (this -> sent.size() != this -> rows) {
+        this -> sent.assign(this -> rows, std::u32string(this -> columns, U' '));
+    }
+
+    for (uint16_t row = 0; row < this -> rows; ++row) {
+        const std::u32string& now = this -> cells[row];
+        std::u32string& before = this -> sent[row];
+        if (now == before) {
+            continue;
+        }
+
+        uint16_t first = 0;
+        while (now[first] == before[first]) {
+            ++first;
+        }
+        uint16_t last = this -> columns - 1;
+        while (now[last] == before[last]) {
+            --last;
+        }
+        update.runs.push_back(protocol::ScreenRun{row, first, now.substr(first, last - first + 1)});
+        before = now;
+    }
+
+    this -> dirty = false;
+    return update;
+}
+
+void Screen::print(char32_t character) {
+    if (this -> wrapPending) {
+        this -> cursorColumn = 0;
+        lineFeed();
+    }
+    this -> cells[this -> cursorRow][this -> cursorColumn] = character;
+    if (this -> cursorColumn + 1 >= this -> columns) {
+        this -> wrapPending = true;
+    } else {
+        ++this -> cursorColumn;
+    }
+}
+
+void Screen::control(unsigned char byte) {
+    switch (byte) {
+        case 0x08: // backspace
+            if (this -> cursorColumn > 0) {
+                --this -> cursorColumn;
+            }
+            this -> wrapPending = false;
+            break;
+        case 0x09: // tab stops every 8 columns
+            moveCursor(this -> cursorRow, std::min<int>(this -> columns - 1, (this -> cursorColumn / 8 + 1) * 8));
+            break;
+        case 0x0a:
+        case 0x0b:
+        case 0x0c:
+            lineFeed();
+            break;
+        case 0x0d:
+            this -> cursorColumn = 0;
+            this -> wrapPending = false;
+            break;
+        case 0x1b:
+            this -> state = State::ESCAPE;
+            break;
+        default:
+            break;
+    }
+}
+
+void Screen::escape(unsigned char byte) {
+    this -> state = State::GROUND;
+
+    switch (byte) {
+        case '[':
+            this -> parameters.clear();
+            this -> state = State::CSI;
+            break;
+        case ']':
+            this -> state = State::OSC;
+            break;
+        case '(':
+        case ')':
+        case '*':
+        case '+':
+            this -> state = State::CHARSET;
+            break;
+        case '7':
+            this -> savedRow = this -> cursorRow;
+            this -> savedColumn = this -> cursorColumn;
+            break;
+        case '8':
+            moveCursor(this -> savedRow, this -> savedColumn);
+            break;
+        case 'D':
+            lineFeed();
+            break;
+        case 'E':
+            this -> cursorColumn = 0;
+            lineFeed();
+            break;
+        case 'M':
+            reverseLineFeed();
+            break;
+        case 'c':
+            reset();
+            break;
+        default:
+            break;
+    }
+}
+
+void Screen::csi(unsigned char final) {
+    bool privateMode = !this -> parameters.empty() && (this -> parameters[0] == '?' || this -> parameters[0] == '>' ||
+                                                       this -> parameters[0] == '=');
+    std::vector<int> values = numbers(0);
+    auto value = [&values](size_t i, int fallback) {
+        return (i < values.size() && values[i] > 0) ? values[i] : fallback;
+    };
+    int count = value(0, 1);
+    std::u32string& line = this -> cells[this -> cursorRow];
+
+    switch (final) {
+        case 'A':
+            moveCursor(this -> cursorRow - count, this -> cursorColumn);
+            break;
+        case 'B':
+        case 'e':
+            moveCursor(this -> cursorRow + count, this -> cursorColumn);
+            break;
+        case 'C':
+        case 'a':
+            moveCursor(this -> cursorRow, this -> cursorColumn + count);
+            break;
+        case 'D':
+            moveCursor(this -> cursorRow, this -> cursorColumn - count);
+            break;
+        case 'E':
+            moveCursor(this -> cursorRow + count, 0);
+            break;
+        case 'F':
+            moveCursor(this -> cursorRow - count, 0);
+            break;
+        case 'G':
+        case '`':
+            moveCursor(this -> cursorRow, count - 1);
+            break;
+        case 'd':
+            moveCursor(count - 1, this -> cursorColumn);
+            break;
+        case 'H':
+        case 'f':
+            moveCursor(value(0, 1) - 1, value(1, 1) - 1);
+            break;
+        case 'J': {
+            int mode = values.empty() ? 0 : values[0];
+            if (mode == 0) {
+                eraseCells(this -> cursorRow, this -> cursorColumn, this -> columns);
+                for (uint16_t row = this -> cursorRow + 1; row < this -> rows; ++row) {
+                    eraseCells(row, 0, this -> columns);
+                }
+            } else if (mode == 1) {
+                for (uint16_t row = 0; row < this -> cursorRow; ++row) {
+                    eraseCells(row, 0, this -> columns);
+                }
+                eraseCells(this -> cursorRow, 0, this -> cursorColumn + 1);
+            } else {
+                for (uint16_t row = 0; row < this -> rows; ++row) {
+                    eraseCells(row, 0, this -> columns);
+                }
+            }
+            break;
+        }
+        case 'K': {
+            int mode = values.empty() ? 0 : values[0];
+            if (mode == 0) {
+                eraseCells(this -> cursorRow, this -> cursorColumn, this -> columns);
+            } else if (mode == 1) {
+                eraseCells(this -> cursorRow, 0, this -> cursorColumn + 1);
+            } else {
+                eraseCells(this -> cursorRow, 0, this -> columns);
+            }
+            break;
+        }
+        case 'X':
+            eraseCells(this -> cursorRow, this -> cursorColumn, this -> cursorColumn + count);
+            break;
+        case '@':
+            line.insert(this -> cursorColumn, std::min<int>(count, this -> columns - this -> cursorColumn), U' ');
+            line.resize(this -> columns);
+            break;
+        case 'P':
+            line.erase(this -> cursorColumn, std::min<int>(count, this -> columns - this -> cursorColumn));
+            line.resize(this -> columns, U' ');
+            break;
+        case 'L':
+            if (this -> cursorRow >= this -> scrollTop && this -> cursorRow <= this -> scrollBottom) {
+                scrollDown(this -> cursorRow, this -> scrollBottom, count);
+            }
+            break;
+        case 'M':
+            if (this -> cursorRow >= this -> scrollTop && this -> cursorRow <= this -> scrollBottom) {
+                scrollUp(this -> cursorRow, this -> scrollBottom, count);
+            }
+            break;
+        case 'S':
+            scrollUp(this -> scrollTop, this -> scrollBottom, count);
+            break;
+        case 'T':
+            if (!privateMode) {
+                scrollDown(this -> scrollTop, this -> scrollBottom, count);
+            }
+            break;
+        case 'r': {
+            int top = value(0, 1) - 1;
+            int bottom = value(1, this -> rows) - 1;
+            if (top < bottom && bottom < this -> rows) {
+                this -> scrollTop = top;
+                this -> scrollBottom = bottom;
+                moveCursor(0, 0);
+            }
+            break;
+        }
+        case 's':
+            this -> savedRow = this -> cursorRow;
+            this -> savedColumn = this -> cursorColumn;
+            break;
+        case 'u':
+            moveCursor(this -> savedRow, this -> savedColumn);
+            break;
+        case 'h':
+        case 'l':
+            if (!privateMode) {
+                break;
+            }
+            for (int mode : values) {
+                // alternate screen: full screen programs leave the shell's output as it was
+                if (mode != 1049 && mode != 1047 && mode != 47) {
+                    continue;
+                }
+                if (final == 'h' && !this -> alternate) {
+                    if (mode == 1049) {
+                        this -> savedRow = this -> cursorRow;
+                        this -> savedColumn = this -> cursorColumn;
+                    }
+                    this -> mainScreen = this -> cells;
+                    this -> cells.assign(this -> rows, std::u32string(this -> columns, U' '));
+                    this -> alternate = true;
+                } else if (final == 'l' && this -> alternate) {
+                    this -> cells = std::move(this -> mainScreen);
+                    this -> mainScreen.clear();
+                    this -> alternate = false;
+                    if (mode == 1049) {
+                        moveCursor(this -> savedRow, this -> savedColumn);
+                    }
+                }
+            }
+            break;
+        default:
+            // colors, attributes and modes the plain text mirror has no use for
+            break;
+    }
+}
+
+void Screen::lineFeed() {
+    this -> wrapPending = false;
+    if (this -> cursorRow == this -> scrollBottom) {
+        scrollUp(this -> scrollTop, this -> scrollBottom, 1);
+    } else if (this -> cursorRow + 1 < this -> rows) {
+        ++this -> cursorRow;
+    }
+}
+
+void Screen::reverseLineFeed() {
+    this -> wrapPending = false;
+    if (this -> cursorRow == this -> scrollTop) {
+        scrollDown(this -> scrollTop, this -> scrollBottom, 1);
+    } else if (this -> cursorRow > 0) {
+        --this -> cursorRow;
+    }
+}
+
+void Screen::scrollUp(uint16_t top, uint16_t bottom, uint16_t lines) {
+    lines = std::min<uint16_t>(lines, bottom - top + 1);
+    std::rotate(this -> cells.begin() + top, this -> cells.begin() + top + lines, this -> cells.begin() + bottom + 1);
+    for (uint16_t row = bottom + 1 - lines; row <= bottom; ++row) {
+        eraseCells(row, 0, this -> columns);
+    }
+}
+
+void Screen::scrollDown(uint16_t top, uint16_t bottom, uint16_t lines) {
+    lines = std::min<uint16_t>(lines, bottom - top + 1);
+    std::rotate(this -> cells.begin() + top, this -> cells.begin() + bottom + 1 - lines, this -> cells.begin() + bottom + 1);
+    for (uint16_t row = top; row < top + lines; ++row) {
+        eraseCells(row, 0, this -> columns);
+    }
+}
+
+void Screen::eraseCells(uint16_t row, uint16_t from, uint16_t to) {
+    to = std::min(to, this -> columns);
+    if (from < to) {
+        std::fill(this -> cells[row].begin() + from, this -> cells[row].begin() + to, U' ');
+    }
+}
+
+void Screen::moveCursor(int row, int column) {
+    this -> cursorRow = static_cast<uint16_t>(std::clamp(row, 0, this -> rows - 1));
+    this -> cursorColumn = static_cast<uint16_t>(std::clamp(column, 0, this -> columns - 1));
+    this -> wrapPending = false;
+}
+
+std::vector<int> Screen::numbers(int fallback) const {
+    std::vector<int> values;
+    size_t start = this -> parameters.find_first_not_of("?>=");
+    if (start == std::string::npos) {
+        return values;
+    }
+
+    // "1;;5" -> 1, fallback, 5; intermediates after the digits are ignored
+    std::string_view text(this -> parameters);
+    text.remove_prefix(start);
+    while (true) {
+        size_t separator = text.find(';');
+        std::string_view field = text.substr(0, separator);
+        values.push_back(field.empty() ? fallback : std::atoi(std::string(field).c_str()));
+        if (separator == std::string_view::npos) {
+            break;
+        }
+        text.remove_prefix(separator + 1);
+    }
+    return values;
+}
+
+}
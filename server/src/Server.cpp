@@ -9,266 +9,862 @@
 
 namespace server {
 
-// cd functions
-bool Server::validateDirectory(const path &targetPath){
-    try {
-        // check if the path exists
-        if(!exists(targetPath)){
-            logger.log("[ERROR](Server::validateDirectory) The path does not exists: " + targetPath.string());
-            return false;
+// a threaded mode client, its thread reads while its requests and the watch events write
+struct Server::ThreadedConnection {
+    int socket;
+    std::mutex mutex;                  // channels, events and closed
+    std::condition_variable drained;   // streaming requests wait here for window or a hang up
+    ChannelTable channels;             // pane sessions, their queued requests and windows
+    std::string events;                // WATCH_EVENT frames the next flush sends ahead of the responses
+    bool closed = false;               // the client is gone or said exit, running requests stop
+    std::mutex sendMutex;              // one writer at a time, frames leave in the order they were drained
+    
+    explicit ThreadedConnection(int socket) : socket(socket) {}
+    
+    // the last request that ran for it is done, nobody can write to the descriptor anymore
+    ~ThreadedConnection() {
+        close(this -> socket);
+    }
+};
+
+// cd runs in the session's shell, which follows it with the new cwd
+std::string Server::handleChangeDirectory(const std::string &command, std::string_view arguments, const SessionKey &session){
+    // trim the path of whitespaces
+    std::string rawPath(arguments.substr(0, arguments.find_last_not_of(" \t") + 1));
+    
+    // Get client's current directory, the pane may have been closed meanwhile
+    std::shared_ptr<const SessionDirectory> currentDirectory = sessionDirectory(session);
+    if (!currentDirectory) {
+        return "Error: session closed";
+    }
+    
+    // cd to a literal path needs no shell: it is resolved here and the session's shell, if it has
+    // one yet, moves along before its next command; ~, -, options and expansions still go to bash
+    std::vector<std::string> words;
+    if (directoryCache.enabled() && hasStockShell(session) && DirectExec::split(command, words) && words.size() == 2 &&
+        !words[1].empty() && words[1][0] != '-') {
+        std::shared_ptr<const SessionDirectory> target = directoryCache.resolve(*currentDirectory, words[1]);
+        if (!target) {
+            LOG_ERROR(logger, "(Server::handleChangeDirectory) Invalid directory: " + rawPath);
+            return "Invalid directory: " + rawPath;
         }
         
-        // check if it is a directory
-        if(!is_directory(targetPath)){
-            logger.log("[ERROR](Server::validateDirectory) The path is not a directory: " + targetPath.string());
-            return false;
+        std::lock_guard<std::mutex> lock(pathsMutex);
+        auto session_it = clientPaths.find(session);
+        if (session_it == clientPaths.end()) {
+            return "Error: session closed";
         }
-        
-        // check for privileges (read, execute)
-        if(-1 == access(targetPath.string().c_str(), R_OK | X_OK)){
-            logger.log("[ERROR](Server::validateDirectory) The path does not have read/execute permissions: " + targetPath.string());
-            return false;
+        session_it -> second = target;
+        previousDirectories[session] = currentDirectory -> path().string();
+        auto shell_it = sessionShells.find(session);
+        if (shell_it != sessionShells.end()) {
+            shell_it -> second -> follow(target -> path().string(), currentDirectory -> path().string());
         }
-        
-        return true;
-    } catch (const filesystem_error& e) {
-        logger.log("[ERROR](Server::validateDirectory) An error occurred: " + std::string(e.what()));
-        return false;
+        LOG_DEBUG(logger, "(Server::handleChangeDirectory) Changed directory to: " + target -> path().string());
+        return "\n" + target -> path().string();
     }
-}
-
-path Server::resolvePath(const std::string &rawPath, const path &currentPath){
-    path resolvedPath;
     
-    // home directory (cd or cd ~)
-    if(rawPath.empty() || rawPath == "~") {
-        // get the HOME env
-        const char* home = std::getenv("HOME");
-        resolvedPath = home ? home : "/"; // go root if not found HOME
+    std::shared_ptr<Shell> shell = sessionShell(session, *currentDirectory);
+    if (!shell) {
+        LOG_ERROR(logger, "(Server::handleChangeDirectory) No shell for the session.");
+        return "Error: Failed to start a shell for this session";
     }
     
-    // expand ~/ -> $HOME/
-    else if(rawPath[0] == '~' && rawPath.length() > 1 && rawPath[1] == '/') {
-        const char* home = std::getenv("HOME");
-        resolvedPath = home ? path(home)  / rawPath.substr(2): path(rawPath.substr(2));
+    // the shell resolves ~, -, variables and quoting like in any terminal
+    std::string errors;
+    std::string directory;
+    ExitStatus status = shell -> run(command, [&errors](ProcessRunner::Stream stream, std::string_view chunk) {
+        if (stream == ProcessRunner::Stream::STDERR) {
+            errors.append(chunk);
+        }
+        return true;
+    }, directory);
+    
+    if (!status.success() || directory.empty() || !rememberDirectory(session, directory, currentDirectory -> path().string())) {
+        std::string errorMSG = "Invalid directory: " + rawPath;
+        LOG_ERROR(logger, "(Server::handleChangeDirectory) " + errorMSG + (errors.empty() ? "" : " (" + errors.substr(0, errors.find('\n')) + ")"));
+        return errorMSG;
     }
-    // relative path
-    else if(rawPath == ".") {
-        resolvedPath = currentPath;
+    
+    LOG_DEBUG(logger, "(Server::handleChangeDirectory) Changed directory to: " + directory);
+    
+    return "\n" + directory;
+}
+
+std::shared_ptr<Shell> Server::sessionShell(const SessionKey &session, const SessionDirectory &workingDirectory) {
+    std::string previous;
+    {
+        std::lock_guard<std::mutex> lock(pathsMutex);
+        auto it = sessionShells.find(session);
+        if (it != sessionShells.end() && it -> second -> alive()) {
+            return it -> second;
+        }
+        auto previous_it = previousDirectories.find(session);
+        if (previous_it != previousDirectories.end()) {
+            previous = previous_it -> second;
+        }
     }
-    else if(rawPath == "..") {
-        resolvedPath = currentPath.parent_path();
+    
+    // first command of the session, or its shell exited: a warm one takes over in the session's directory
+    std::shared_ptr<Shell> shell = shells.acquire(workingDirectory.path().string(), previous);
+    
+    std::lock_guard<std::mutex> lock(pathsMutex);
+    if (!shell || clientPaths.find(session) == clientPaths.end()) {
+        return nullptr;
     }
-    // other cases
-    else {
-        resolvedPath = rawPath[0] == '/' ?
-                path(rawPath) : // absolute
-                currentPath / rawPath; // relative
+    sessionShells[session] = shell;
+    return shell;
+}
+
+bool Server::rememberDirectory(const SessionKey &session, const std::string &directory, const std::string &previous) {
+    // opened before taking the lock, requests already running keep the handle they started with
+    std::shared_ptr<const SessionDirectory> handle = SessionDirectory::open(directory);
+    if (!handle) {
+        LOG_WARN(logger, "(Server::rememberDirectory) Cannot open " + directory + ": " + std::string(strerror(errno)));
+        return false;
     }
     
-    resolvedPath = canonical(resolvedPath);
-    
-    return resolvedPath;
+    std::lock_guard<std::mutex> lock(pathsMutex);
+    auto session_it = clientPaths.find(session);
+    if (session_it != clientPaths.end()) {
+        session_it -> second = std::move(handle);
+        previousDirectories[session] = previous;
+    }
+    return true;
 }
 
-void Server::handleChangeDirectory(const std::string &command, int clientSocket){
-    std::string rawPath = command.substr(2); // after "cd"
+std::shared_ptr<const SessionDirectory> Server::sessionDirectory(const SessionKey &session) {
+    std::lock_guard<std::mutex> lock(pathsMutex);
+    auto session_it = clientPaths.find(session);
+    return session_it == clientPaths.end() ? nullptr : session_it -> second;
+}
+
+std::shared_ptr<Terminal> Server::claimTerminal(const SessionKey &session) {
+    std::lock_guard<std::mutex> lock(pathsMutex);
+    auto size_it = terminalSizes.find(session);
+    if (size_it == terminalSizes.end() || runningTerminals.count(session) != 0) {
+        return nullptr;
+    }
     
-    try {
+    std::shared_ptr<Terminal> terminal = std::make_shared<Terminal>(runner, logger, size_it -> second);
+    runningTerminals[session] = terminal;
+    return terminal;
+}
 
-         std::lock_guard<std::mutex> lock(pathsMutex);
-        
-        // Get client's current path
-        auto& currentPath = clientPaths[clientSocket];
+bool Server::hasStockShell(const SessionKey &session) {
+    // a terminal session expects ls in columns and colors, the tty decides that
+    std::lock_guard<std::mutex> lock(pathsMutex);
+    return terminalSizes.count(session) == 0 && customizedShells.count(session) == 0;
+}
 
-        // trim the path of whitespaces
-        rawPath.erase(0, rawPath.find_first_not_of(" \t"));
-        rawPath.erase(rawPath.find_last_not_of(" \t") + 1);
-        
-        path targetPath = resolvePath(rawPath.empty() ? "~" : rawPath, currentPath);
-        
-        // validation phase
-        if(!validateDirectory(targetPath)) {
-            std::string errorMSG = "Invalid directory: " + rawPath;
-            logger.log("[ERROR](Server::handleChangeDirectory) " + errorMSG);
-            send(clientSocket, errorMSG.c_str(), errorMSG.length(), 0);
-            return ;
+void Server::handleTerminalFrame(int clientSocket, const protocol::Frame &frame) {
+    SessionKey session{clientSocket, frame.header.channel};
+    std::shared_ptr<Terminal> terminal;
+    {
+        std::lock_guard<std::mutex> lock(pathsMutex);
+        if (clientPaths.find(session) == clientPaths.end()) {
+            return;
         }
         
-        // change the current directory
-        currentPath = targetPath;
-        
-        std::string msg = "\n" + targetPath.string();
-        send(clientSocket, msg.c_str(), msg.length(), 0);
-        
-        logger.log("[DEBUG](Server::handleChangeDirectory) Changed directory to: " + targetPath.string());
+        if (frame.header.type == protocol::FrameType::TERMINAL_RESIZE) {
+            protocol::WindowSize size = protocol::decodeWindowSize(frame.payload);
+            if (terminalSizes.find(session) == terminalSizes.end()) {
+                LOG_DEBUG(logger, "(Server::handleTerminalFrame) Channel " + std::to_string(session.second) + " of client " +
+                                  std::to_string(clientSocket) + " switched to terminal mode.");
+            }
+            terminalSizes[session] = size;
+        }
         
-    } catch(const filesystem_error& e) {
-        std::string errorMsg = "Filesystem error: " + std::string(e.what());
-        logger.log("[ERROR](Server::handleChangeDirectory) " + errorMsg);
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
-    } catch(const std::exception& e) {
-        std::string errorMsg = "Exception error: " + std::string(e.what());
-        logger.log("[ERROR](Server::handleChangeDirectory) " + errorMsg);
-        send(clientSocket, errorMsg.c_str(), errorMsg.length(), 0);
+        auto it = runningTerminals.find(session);
+        if (it != runningTerminals.end()) {
+            terminal = it -> second;
+        } else if (frame.header.type == protocol::FrameType::TERMINAL_INPUT && frame.payload.find('\x03') != std::string_view::npos) {
+            // ^C on a line mode channel interrupts what it runs, like in a terminal
+            auto [first, last] = runningCommands.equal_range(session);
+            for (auto running = first; running != last; ++running) {
+                running -> second();
+            }
+        }
+    }
+    
+    // other keystrokes with nothing running on the terminal have nobody to read them
+    if (!terminal) {
+        return;
+    }
+    if (frame.header.type == protocol::FrameType::TERMINAL_RESIZE) {
+        terminal -> resize(protocol::decodeWindowSize(frame.payload));
+    } else {
+        terminal -> write(frame.payload);
     }
 }
 
-std::string Server::executeCommand(const std::string &cmd) {
+std::string Server::executeCommand(const std::string &cmd, const SessionKey &session, const SessionDirectory &workingDirectory,
+                                   const Reactor::OutputSink &emit) {
     // security concerns
     if(cmd.find("sudo") != std::string::npos) {
-        logger.log("[SECURITY](Server::executeCommand) Blocked sudo command: " + cmd);
+        LOG_SECURITY(logger, "(Server::executeCommand) Blocked sudo command: " + cmd);
         return "Error: sudo commands are not allowed";
     }
     
-    std::vector<char> buffer(4096, '\0');
-    std::string result;
-
-    // Execute command
-    FILE* pipe = popen(("/bin/bash -c '" + cmd + " 2>&1'").c_str(), "r");
-    if (!pipe) {
-        logger.log("[ERROR](Server::executeCommand) Failed to execute command: " + cmd);
-        return "Error: Command not recognized or failed to execute.";
-    }
-
+    // stdout and stderr share the response in the order they arrive
     bool hasOutput = false;
-    while (fgets(buffer.data(), (int)buffer.size(), pipe) != nullptr) {
-        result.append(buffer.data());
+    auto forward = [&](ProcessRunner::Stream, std::string_view chunk) {
         hasOutput = true;
+        if (!emit(chunk)) {
+            LOG_WARN(logger, "(Server::executeCommand) Client stopped reading, abandoning command: " + cmd);
+            return false;
+        }
+        return true;
+    };
+    
+    ExitStatus status;
+    std::shared_ptr<Terminal> terminal = claimTerminal(session);
+    
+    // terminal mode: raw bytes both ways on a pseudo-terminal, keystrokes reach it through handleTerminalFrame
+    if (terminal) {
+        status = terminal -> run(cmd, workingDirectory.fd(), [&forward](std::string_view chunk) {
+            return forward(ProcessRunner::Stream::STDOUT, chunk);
+        });
+        
+        std::lock_guard<std::mutex> lock(pathsMutex);
+        auto it = runningTerminals.find(session);
+        if (it != runningTerminals.end() && it -> second == terminal) {
+            runningTerminals.erase(it);
+        }
+    } else {
+        // a ^C of the client signals the group of the program while it runs
+        std::optional<decltype(runningCommands)::iterator> interruptible;
+        auto onGroup = [this, &session, &interruptible](pid_t group) {
+            std::lock_guard<std::mutex> lock(pathsMutex);
+            if (group != -1) {
+                interruptible = runningCommands.emplace(session, [group]() { killpg(group, SIGINT); });
+            } else if (interruptible) {
+                runningCommands.erase(*interruptible);
+                interruptible.reset();
+            }
+        };
+        
+        // a plain program call goes straight to the program, it cannot change the shell's state
+        std::vector<std::string> argv;
+        ProcessRunner::Exec exec;
+        exec.onGroup = onGroup;
+        if (hasStockShell(session) && directExec.prepare(cmd, argv, exec.program)) {
+            // what bash would have set for it
+            exec.variables = {"PWD=" + workingDirectory.path().string(), "_=" + exec.program};
+            status = this -> runner.run(argv, workingDirectory.fd(), forward, exec);
+            if (!status.started) {
+                // gone since it was cached, or a script without #! that only bash can run
+                directExec.forget(argv.front());
+            }
+        }
+        
+        if (!status.started) {
+            // Execute command in the session's own shell, so exports, aliases and cd carry over
+            std::string directory;
+            std::shared_ptr<Shell> shell = sessionShell(session, workingDirectory);
+            std::optional<ExitStatus> inShell;
+            if (shell) {
+                {
+                    std::lock_guard<std::mutex> lock(pathsMutex);
+                    interruptible = runningCommands.emplace(session, [shell]() { shell -> interrupt(); });
+                }
+                inShell = shell -> tryRun(cmd, forward, directory);
+                std::lock_guard<std::mutex> lock(pathsMutex);
+                runningCommands.erase(*interruptible);
+                interruptible.reset();
+            }
+            
+            if (inShell) {
+                status = *inShell;
+                if (!directory.empty() && directory != workingDirectory.path().string()) {
+                    rememberDirectory(session, directory, workingDirectory.path().string());
+                }
+            } else {
+                // an earlier pipelined request of the session still holds its shell, this one runs on its own
+                ProcessRunner::Exec inBash;
+                inBash.onGroup = onGroup;
+                status = this -> runner.run({"/bin/bash", "-c", cmd}, workingDirectory.fd(), forward, inBash);
+            }
+        }
     }
-
-    int status = pclose(pipe);
-    if (status != 0) {
-        logger.log("[WARN](Server::executeCommand) Command returned non-zero status: " + cmd);
+    
+    if (!status.started) {
+        return "Error: Command not recognized or failed to execute.";
+    }
+    
+    if (!status.success()) {
+        std::string reason = status.signal != 0 ? "killed by signal " + std::to_string(status.signal)
+                                                : "exited with status " + std::to_string(status.code);
+        LOG_WARN(logger, "(Server::executeCommand) Command " + reason + ": " + cmd);
         
         // no output means error message
         if (!hasOutput) {
-            return "Error: Unknown command: " + cmd;
+            return status.code == 127 ? "Error: Unknown command: " + cmd : "Error: Command " + reason;
         }
     }
 
     // edge case
-    if (result.empty()) {
+    if (!hasOutput) {
         return "Warn: Command executed but produced no output.";
     }
 
+    return {};
+}
+
+std::string Server::executeCached(const std::string &cmd, const SessionKey &session, const SessionDirectory &workingDirectory,
+                                  const Reactor::OutputSink &emit) {
+    // only what the stock shell would run the same way, an alias could make ls anything
+    std::optional<ResultCache::Ticket> ticket;
+    if (resultCache && hasStockShell(session)) {
+        ticket = resultCache -> prepare(cmd, workingDirectory);
+    }
+    if (!ticket) {
+        return executeCommand(cmd, session, workingDirectory, emit);
+    }
+    
+    std::string output;
+    std::string result;
+    if (resultCache -> lookup(*ticket, output, result)) {
+        LOG_DEBUG(logger, "(Server::executeCached) Answered from the result cache: " + cmd);
+        for (size_t offset = 0; offset < output.size(); offset += protocol::STREAM_CHUNK) {
+            if (!emit(std::string_view(output).substr(offset, protocol::STREAM_CHUNK))) {
+                break;
+            }
+        }
+        return result;
+    }
+    
+    // a copy of what the client is sent, given up once it cannot be cached anyway
+    bool complete = true;
+    output.clear();
+    Reactor::OutputSink capture = [&](std::string_view chunk) {
+        if (complete && output.size() + chunk.size() <= ResultCache::MAX_OUTPUT) {
+            output.append(chunk);
+        } else {
+            complete = false;
+        }
+        bool sent = emit(chunk);
+        complete = complete && sent;
+        return sent;
+    };
+    result = executeCommand(cmd, session, workingDirectory, capture);
+    
+    if (complete && result.rfind("Error:", 0) != 0) {
+        resultCache -> store(*ticket, std::move(output), result);
+    }
     return result;
 }
 
 // nano
-std::string Server::handleNanoCommand(const std::string& command) {
-    logger.log("[DEBUG](Server::handleNanoCommand) Received nano command: " + command);
-
-    std::string filename = command.substr(5);
+std::string Server::handleNanoCommand(const std::string& arguments, const SessionDirectory& workingDirectory,
+                                      const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile) {
+    LOG_DEBUG(logger, "(Server::handleNanoCommand) Received nano command for: " + arguments);
     
-    try {
-       
-        std::filesystem::path filePath = current_path() / filename;
-
-        logger.log("[DEBUG](Server::handleNanoCommand) Resolved file path: " + filePath.string());
+    // --lines=<first>,<count> asks for a page of the file instead of all of it
+    std::string filename = arguments;
+    bool paged = false;
+    size_t firstLine = 0;
+    size_t lineCount = 0;
+    if (arguments.rfind("--lines=", 0) == 0) {
+        char* end = nullptr;
+        const char* numbers = arguments.c_str() + 8;
+        firstLine = std::strtoull(numbers, &end, 10);
+        bool valid = end != numbers && *end == ',';
+        if (valid) {
+            numbers = end + 1;
+            lineCount = std::strtoull(numbers, &end, 10);
+            valid = end != numbers && *end == ' ' && end[1] != '\0';
+        }
+        if (!valid) {
+            return "Error: usage: nano --lines=<first>,<count> <file>";
+        }
+        filename = end + 1;
+        paged = true;
+    }
 
-        if (!std::filesystem::exists(filePath)) {
-            std::ofstream newFile(filePath);
-            newFile.close();
-            logger.log("[DEBUG](Server::handleNanoCommand) Created new file: " + filePath.string());
+    std::string filePath = (workingDirectory.path() / filename).string();
+    
+    LOG_DEBUG(logger, "(Server::handleNanoCommand) Resolved file path: " + filePath);
+    
+    // relative names resolve against the session's handle, an absolute one is taken as is
+    int file = openat(workingDirectory.fd(), filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (file == -1 && errno == ENOENT) {
+        file = openat(workingDirectory.fd(), filename.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+        if (file != -1) {
+            close(file);
+            LOG_DEBUG(logger, "(Server::handleNanoCommand) Created new file: " + filePath);
             return "NEW_FILE";
         }
+    }
+    if (file == -1) {
+        LOG_ERROR(logger, "(Server::handleNanoCommand) Failed to handle nano command: " + std::string(strerror(errno)));
+        return "Error: Cannot open file";
+    }
+    
+    struct stat info;
+    if (fstat(file, &info) == -1 || !S_ISREG(info.st_mode)) {
+        close(file);
+        LOG_ERROR(logger, "(Server::handleNanoCommand) Not a regular file: " + filePath);
+        return "Error: Cannot open file";
+    }
+    
+    // the size when it was opened is what the client gets, an empty file opens like a new one
+    size_t length = static_cast<size_t>(info.st_size);
+    if (length == 0) {
+        close(file);
+        return "NEW_FILE";
+    }
+    
+    if (paged) {
+        // no file has more lines than bytes, and one answer carries at most MAX_LINES of them
+        firstLine = std::min<size_t>(firstLine, length);
+        lineCount = std::min<size_t>(lineCount, FileIndex::MAX_LINES);
+        FileIndex::Range range;
+        bool indexed = fileIndex.lines(file, info, firstLine, lineCount, range);
+        close(file);
+        if (!indexed) {
+            return "Error: Cannot open file";
+        }
+        
+        // the header says which lines and bytes follow, the client cuts them into lines itself
+        std::string header = "LINES " + std::to_string(range.firstLine) + " " + std::to_string(range.lines) + " " +
+                             std::to_string(range.totalLines) + " " + std::to_string(range.offset) + " " +
+                             std::to_string(range.length) + " " + std::to_string(range.fileSize) + " " + range.version + "\n";
+        bool sent = emit(header);
+        if (sent && range.length > 0) {
+            std::string bytes;
+            sent = sendFile ? sendFile(range.fd, static_cast<off_t>(range.offset), range.length) : range.read(bytes) && emit(bytes);
+        }
+        if (!sent) {
+            LOG_WARN(logger, "(Server::handleNanoCommand) Stopped sending lines " + std::to_string(range.firstLine) + " to " +
+                             std::to_string(range.firstLine + range.lines) + " of " + filePath);
+        }
+        return "";
+    }
+    
+    // the content never sits in the server as a whole, the client puts the streamed pieces back together
+    bool sent = true;
+    if (sendFile) {
+        sent = sendFile(file, 0, length);
+    } else {
+        std::string piece;
+        for (size_t offset = 0; sent && offset < length; offset += protocol::STREAM_CHUNK) {
+            piece.clear();
+            size_t chunk = std::min<size_t>(length - offset, protocol::STREAM_CHUNK);
+            if (!ZeroCopy::read(file, static_cast<off_t>(offset), chunk, piece)) {
+                // nothing went out yet for the first piece, later ones end the response short
+                LOG_ERROR(logger, "(Server::handleNanoCommand) Failed to read " + filePath + ": " + std::string(strerror(errno)));
+                close(file);
+                return offset == 0 ? "Error: Cannot open file" : "";
+            }
+            sent = emit(piece);
+        }
+    }
+    close(file);
 
-        std::ifstream file(filePath);
-        std::string content(
-            (std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>()
-        );
+    LOG_INFO(logger, "(Server::handleNanoCommand) " + std::string(sent ? "Sent" : "Stopped sending") + " file: " + filePath +
+                     ", Content length: " + std::to_string(length) + " bytes");
+    return "";
+}
 
-        logger.log("[INFO](Server::handleNanoCommand) Successfully read file: " + filePath.string() +
-                   ", Content length: " + std::to_string(content.length()) + " bytes");
+std::string Server::handleNanoSave(const SessionKey& session, const std::string& arguments, const SessionDirectory& workingDirectory) {
+    // the numbers after the option, as many as it takes and ended by what follows them
+    size_t optionEnd = arguments.find('=');
+    if (optionEnd == std::string::npos) {
+        return "Error: usage: nano --save=<version>|new <file>";
+    }
+    std::string option = arguments.substr(0, optionEnd);
+    const char* cursor = arguments.c_str() + optionEnd + 1;
+    auto number = [&cursor](char separator, uint64_t& value) {
+        char* end = nullptr;
+        value = std::strtoull(cursor, &end, 10);
+        bool valid = end != cursor && *end == separator;
+        cursor = end + (valid && separator != '\0' ? 1 : 0);
+        return valid;
+    };
+    
+    uint64_t id = 0;
+    if (option == "--save") {
+        size_t space = arguments.find(' ', optionEnd);
+        if (space == std::string::npos || space + 1 == arguments.size()) {
+            return "Error: usage: nano --save=<version>|new <file>";
+        }
+        std::string base = arguments.substr(optionEnd + 1, space - optionEnd - 1);
+        std::string error = fileSaver.begin(session, workingDirectory, arguments.substr(space + 1), base == "new" ? "" : base, id);
+        return error.empty() ? "SAVING " + std::to_string(id) : error;
+    }
+    if (option == "--save-data") {
+        uint64_t at = 0;
+        if (!number(',', id) || !number('\n', at)) {
+            return "Error: usage: nano --save-data=<id>,<at> followed by the bytes";
+        }
+        size_t body = static_cast<size_t>(cursor - arguments.c_str());
+        std::string error = fileSaver.write(session, id, at, std::string_view(arguments).substr(body));
+        return error.empty() ? "OK" : error;
+    }
+    if (option == "--save-copy") {
+        uint64_t at = 0, from = 0, length = 0;
+        if (!number(',', id) || !number(',', at) || !number(',', from) || !number('\0', length)) {
+            return "Error: usage: nano --save-copy=<id>,<at>,<from>,<length>";
+        }
+        std::string error = fileSaver.copy(session, id, at, from, length);
+        return error.empty() ? "OK" : error;
+    }
+    if (option == "--save-commit") {
+        uint64_t size = 0;
+        if (!number(',', id) || !number('\0', size)) {
+            return "Error: usage: nano --save-commit=<id>,<size>";
+        }
+        std::string version;
+        std::string error = fileSaver.commit(session, id, size, version);
+        return error.empty() ? "SAVED " + version : error;
+    }
+    if (option == "--save-abort") {
+        if (!number('\0', id)) {
+            return "Error: usage: nano --save-abort=<id>";
+        }
+        fileSaver.abort(session, id);
+        return "OK";
+    }
+    return "Error: usage: nano --save=<version>|new <file>";
+}
+
+void Server::registerCommands() {
+    commandTable.add("cd", [this](const CommandCall& call, std::string& result) {
+        if (commands::isSimple(call.command)) {
+            result = handleChangeDirectory(call.command, call.arguments, call.session);
+            return true;
+        }
+        
+        // cd /tmp && make runs like any line with its output streamed, the answer ends in the directory it left behind
+        directoryCache.forgetMissing();
+        result = executeCommand(call.command, call.session, call.directory, call.emit);
+        std::shared_ptr<const SessionDirectory> directory = sessionDirectory(call.session);
+        if (result.rfind("Error:", 0) != 0) {
+            result = directory ? "\n" + directory -> path().string() : "Error: session closed";
+        }
+        return true;
+    });
+    commandTable.add("nano", [this](const CommandCall& call, std::string& result) {
+        if (call.arguments.rfind("--save", 0) == 0) {
+            result = handleNanoSave(call.session, std::string(call.arguments), call.directory);
+            return true;
+        }
+        result = handleNanoCommand(std::string(call.arguments), call.directory, call.emit, call.sendFile);
+        return true;
+    });
+    
+    // the hot commands answered in process, anything they cannot reproduce exactly goes on to the shell
+    auto builtin = [this](const CommandCall& call, std::string& result) {
+        return hasStockShell(call.session) && builtins.run(call.command, call.directory, call.emit, result);
+    };
+    for (std::string_view verb : {"ls", "pwd", "cat", "stat", "echo"}) {
+        commandTable.add(verb, builtin);
+    }
+    
+    commandTable.add("watch", [this](const CommandCall& call, std::string& result) {
+        return handleWatchCommand(call, result);
+    });
+    commandTable.add("unwatch", [this](const CommandCall& call, std::string& result) {
+        return handleUnwatchCommand(call, result);
+    });
+    
+    // the client's get and put, one chunk per request, and a directory in one streamed archive
+    commandTable.add("get", [this](const CommandCall& call, std::string& result) {
+        if (call.arguments.rfind("--tree ", 0) == 0) {
+            result = treeArchive.stream(std::string(call.arguments.substr(7)), call.directory, call.emit);
+            return true;
+        }
+        return fileTransfer.get(std::string(call.arguments), call.directory, call.emit, result);
+    });
+    commandTable.add("put", [this](const CommandCall& call, std::string& result) {
+        return fileTransfer.put(std::string(call.arguments), call.directory, result);
+    });
+}
 
-        return content.empty() ? "NEW_FILE" : content;
+bool Server::handleWatchCommand(const CommandCall &call, std::string &result) {
+    std::vector<std::string> words;
+    if (call.arguments.empty()) {
+        std::vector<std::string> paths = fileWatcher.watched(call.session);
+        result = "Watching:";
+        for (const std::string& path : paths) {
+            result += "\n" + path;
+        }
+        if (paths.empty()) {
+            result = "Not watching anything.";
+        }
+        return true;
+    }
+    
+    // watch -n 1 ls and the like are the watch program, so is a word that names no file
+    struct stat info;
+    if (fileWatcher.fd() == -1 || !DirectExec::split(std::string(call.arguments), words) || words.size() != 1 ||
+        words[0].empty() || words[0][0] == '-' || fstatat(call.directory.fd(), words[0].c_str(), &info, 0) == -1) {
+        return false;
+    }
+    
+    std::string path = (call.directory.path() / words[0]).lexically_normal().string();
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
+    }
+    std::string error = fileWatcher.watch(call.session, path);
+    result = error.empty() ? "Watching " + path : error;
+    LOG_DEBUG(logger, "(Server::handleWatchCommand) " + result);
+    return true;
+}
 
-    } catch (const std::exception& e) {
-        logger.log("[ERROR](Server::handleNanoCommand) Failed to handle nano command: " + std::string(e.what()));
-        return "Error: Cannot open file";
+bool Server::handleUnwatchCommand(const CommandCall &call, std::string &result) {
+    std::vector<std::string> words;
+    if (call.arguments.empty()) {
+        fileWatcher.dropSession(call.session);
+        result = "Stopped watching every path.";
+        return true;
+    }
+    if (!DirectExec::split(std::string(call.arguments), words) || words.size() != 1 || words[0].empty()) {
+        result = "Error: usage: unwatch [path]";
+        return true;
+    }
+    
+    // the path may be gone already, it is only matched by name
+    std::string path = (call.directory.path() / words[0]).lexically_normal().string();
+    while (path.size() > 1 && path.back() == '/') {
+        path.pop_back();
     }
+    result = fileWatcher.unwatch(call.session, path) ? "Stopped watching " + path : "Error: Not watching " + path;
+    return true;
 }
 
-void Server::processCommand(const std::string &command, int clientSocket, std::string &outputBuffer){
+void Server::processCommand(const std::string &command, const SessionKey &session, const Reactor::OutputSink &emit,
+                            const Reactor::FileSink &sendFile, std::string &outputBuffer){
     try {
 
-         // Get client's current path
-        auto& clientPath = clientPaths[clientSocket];
-        
-        // Change to client's directory before executing
-        current_path(clientPath);
-
-        // special command
-        if(command.substr(0,2) == "cd") {
-            handleChangeDirectory(command, clientSocket);
+         // Get client's current directory, held for the whole request even if a cd replaces it
+        std::shared_ptr<const SessionDirectory> clientDirectory = sessionDirectory(session);
+        if (!clientDirectory) {
+            outputBuffer = "Error: session closed";
             return;
         }
+
+        if (Builtins::mayCustomize(command)) {
+            std::lock_guard<std::mutex> lock(pathsMutex);
+            customizedShells.insert(session);
+        }
         
-        if(command.substr(0,4) == "nano") {
-            outputBuffer = handleNanoCommand(command);
-            return;
+        // special commands, by their verb; what they decline goes to the shell like any other line
+        commands::Parsed parsed = commands::parse(command);
+        if (const CommandHandler* handler = commandTable.find(parsed.verb)) {
+            if ((*handler)(CommandCall{command, parsed.arguments, session, *clientDirectory, emit, sendFile}, outputBuffer)) {
+                return;
+            }
         }
         
-        // execute standard commands
-        outputBuffer = executeCommand(command);
+        // execute standard commands, one of them may create a directory a cd just missed
+        directoryCache.forgetMissing();
+        outputBuffer = executeCached(command, session, *clientDirectory, emit);
     } catch (const std::exception& e) {
-        logger.log("[ERROR](Server::processCommand) Command processing error: " + std::string(e.what()));
+        LOG_ERROR(logger, "(Server::processCommand) Command processing error: " + std::string(e.what()));
         outputBuffer = "Error: " + std::string(e.what());
     }
 }
 
-Server::Server(unsigned short port) : port(port), logger("./server.log") {
-    logger.log("[DEBUG](Server::Server) Initializing server...");
+Server::Server(unsigned short port, ServerMode mode, unsigned ioThreads, bool cacheResults)
+: port(port), mode(mode), ioThreads(ioThreads), logger("./server.log"), runner(logger), shells(runner, logger, 2), builtins(logger), directExec(logger), fileWatcher(logger), directoryCache(logger), fileIndex(logger), fileSaver(logger), fileTransfer(logger), treeArchive(std::max(2u, std::thread::hardware_concurrency()), logger) {
+    LOG_DEBUG(logger, "(Server::Server) Initializing server...");
+    registerCommands();
+    if (cacheResults) {
+        resultCache = std::make_unique<ResultCache>(logger);
+    }
+    
+    // a session shell that died under a request shows up as EPIPE on its control pipe
+    signal(SIGPIPE, SIG_IGN);
+    
+    // the only time the process cwd is read, sessions work from their own handles after this
+    startDirectory = SessionDirectory::open(current_path());
+    if (!startDirectory) {
+        LOG_ERROR(logger, "(Server::Server) Cannot open the starting directory.");
+        exit(1);
+    }
+    
+    // the commands the server spawns must not hold the port open; on macOS POSIX_SPAWN_CLOEXEC_DEFAULT sees to it
+#ifdef __linux__
+    serverSocket = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+#else
     serverSocket = socket(AF_INET, SOCK_STREAM, 0);
+#endif
     if (serverSocket == -1) {
-        logger.log("[ERROR](Server::Server) Failed to create socket.");
+        LOG_ERROR(logger, "(Server::Server) Failed to create socket.");
         exit(1);
     }
     
+    // restarting in another mode must not wait for TIME_WAIT sockets
+    int reuse = 1;
+    setsockopt(serverSocket, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
     sockaddr_in serverAddr{};
     serverAddr.sin_family = AF_INET;
     serverAddr.sin_port = htons(this -> port);
     serverAddr.sin_addr.s_addr = INADDR_ANY;
     
     if (bind(serverSocket, (struct sockaddr*)&serverAddr, sizeof(serverAddr)) == -1) {
-        logger.log("[ERROR](Server::Server) Failed to bind socket.");
+        LOG_ERROR(logger, "(Server::Server) Failed to bind socket.");
         close(serverSocket);
         exit(1);
     }
     
-    if (listen(serverSocket, 10) == -1) {
-        logger.log("[ERROR](Server::Server) Failed to listen on socket.");
+    // hundreds of panes may connect at once
+    if (listen(serverSocket, SOMAXCONN) == -1) {
+        LOG_ERROR(logger, "(Server::Server) Failed to listen on socket.");
         close(serverSocket);
         exit(1);
     }
     
-    logger.log("[DEBUG](Server::Server) Server listening on port " + std::to_string(port) + ".");
+    LOG_DEBUG(logger, "(Server::Server) Server listening on port " + std::to_string(port) + ".");
 }
 
 Server::~Server() {
     close(serverSocket);
-    logger.log("[DEBUG](Server::~Server) Server socket closed.");
+    LOG_DEBUG(logger, "(Server::~Server) Server socket closed.");
 }
 
 void Server::run() {
-    logger.log("[DEBUG](Server::run) Starting server loop.");
+    if (this -> mode == ServerMode::EPOLL) {
+        if (Reactor::isSupported()) {
+            runReactor();
+            return;
+        }
+        LOG_WARN(logger, "(Server::run) epoll mode is not supported on this platform, falling back to threaded mode.");
+    }
+    
+    if (this -> mode == ServerMode::IO_URING) {
+        if (UringReactor::isSupported()) {
+            runUring();
+            return;
+        }
+        LOG_WARN(logger, "(Server::run) io_uring is not available on this kernel, falling back to threaded mode.");
+    }
+    
+    runThreaded();
+}
+
+void Server::runThreaded() {
+    LOG_DEBUG(logger, "(Server::runThreaded) Starting server loop.");
+    
+    // a thread per client reads, the requests of all of them share a pool that grows while they run
+    this -> requestWorkers = std::make_unique<ThreadPool>(std::max(2u, std::thread::hardware_concurrency()), Reactor::MAX_WORKERS);
+    
+    if (fileWatcher.fd() != -1) {
+        std::thread(&Server::serveWatches, this).detach();
+    }
    
     while (true) {
         sockaddr_in clientAddr{};
         socklen_t clientLen = sizeof(clientAddr);
+#ifdef __linux__
+        int clientSocket = accept4(serverSocket, (struct sockaddr*)&clientAddr, &clientLen, SOCK_CLOEXEC);
+#else
         int clientSocket = accept(serverSocket, (struct sockaddr*)&clientAddr, &clientLen);
+#endif
         if (clientSocket == -1) {
-            logger.log("[ERROR](Server::run) Failed to accept client connection.");
+            LOG_ERROR(logger, "(Server::runThreaded) Failed to accept client connection.");
             continue;
         }
         
-        logger.log("[DEBUG](Server::run) Client connected with id: " + std::to_string(clientSocket));
+        protocol::setNoDelay(clientSocket);
+        LOG_DEBUG(logger, "(Server::runThreaded) Client connected with id: " + std::to_string(clientSocket));
         std::thread(&Server::handleClient, this, clientSocket).detach();
     }
 }
 
+void Server::runReactor() {
+    LOG_DEBUG(logger, "(Server::runReactor) Starting epoll reactor with " + std::to_string(this -> ioThreads) + " I/O threads.");
+    
+    size_t workerThreads = std::max(2u, std::thread::hardware_concurrency());
+    
+    Reactor reactor(serverSocket, this -> ioThreads, workerThreads, logger,
+                    [this](int clientSocket, uint16_t channel, const std::string& request,
+                           const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile, bool& closeSession) {
+                        return handleRequest(clientSocket, channel, request, emit, sendFile, closeSession);
+                    },
+                    [this](const std::string& request) { return isOrderingBarrier(request); },
+                    [this](int clientSocket, uint16_t channel) { openSession(clientSocket, channel); },
+                    [this](int clientSocket, uint16_t channel) { closeSession(clientSocket, channel); },
+                    [this](int clientSocket, const protocol::Frame& frame) { handleTerminalFrame(clientSocket, frame); });
+    
+    if (fileWatcher.fd() != -1) {
+        reactor.addSource(fileWatcher.fd(), [this, &reactor]() {
+            fileWatcher.process([&reactor](const FileWatcher::Subscriber& session, std::string_view events) {
+                reactor.push(session.first, session.second, protocol::FrameType::WATCH_EVENT, events);
+            });
+        });
+    }
+    reactor.run();
+}
+
+void Server::runUring() {
+    LOG_DEBUG(logger, "(Server::runUring) Starting io_uring transport.");
+    
+    size_t workerThreads = std::max(2u, std::thread::hardware_concurrency());
+    
+    UringReactor reactor(serverSocket, workerThreads, logger,
+                         [this](int clientSocket, uint16_t channel, const std::string& request,
+                                const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile, bool& closeSession) {
+                             return handleRequest(clientSocket, channel, request, emit, sendFile, closeSession);
+                         },
+                         [this](const std::string& request) { return isOrderingBarrier(request); },
+                         [this](int clientSocket, uint16_t channel) { openSession(clientSocket, channel); },
+                         [this](int clientSocket, uint16_t channel) { closeSession(clientSocket, channel); },
+                         [this](int clientSocket, const protocol::Frame& frame) { handleTerminalFrame(clientSocket, frame); });
+    
+    if (fileWatcher.fd() != -1) {
+        reactor.addSource(fileWatcher.fd(), [this, &reactor]() {
+            fileWatcher.process([&reactor](const FileWatcher::Subscriber& session, std::string_view events) {
+                reactor.push(session.first, session.second, protocol::FrameType::WATCH_EVENT, events);
+            });
+        });
+    }
+    reactor.run();
+}
+
+void Server::serveWatches() {
+    pollfd watcher{fileWatcher.fd(), POLLIN, 0};
+    while (true) {
+        if (poll(&watcher, 1, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR(logger, "(Server::serveWatches) poll failed, watch events stop: " + std::string(strerror(errno)));
+            return;
+        }
+        
+        // the events are only queued, a worker sends them; a client that stops reading holds up nobody else's
+        fileWatcher.process([this](const FileWatcher::Subscriber& session, std::string_view events) {
+            std::shared_ptr<ThreadedConnection> connection;
+            {
+                std::lock_guard<std::mutex> lock(connectionsMutex);
+                auto it = threadedConnections.find(session.first);
+                if (it == threadedConnections.end()) {
+                    return;
+                }
+                connection = it -> second;
+            }
+            bool flushPending = false;
+            {
+                std::lock_guard<std::mutex> lock(connection -> mutex);
+                if (connection -> closed || !connection -> channels.isOpen(session.second)) {
+                    return;
+                }
+                flushPending = !connection -> events.empty();
+                protocol::appendMessage(connection -> events, protocol::FrameType::WATCH_EVENT, session.second, 0, events);
+            }
+            if (!flushPending) {
+                this -> requestWorkers -> submit([this, connection]() {
+                    flushConnection(*connection);
+                });
+            }
+        });
+    }
+}
+
 std::string Server::cleanedCommand(std::string& command){
     std::string cleanCommand;
     for(auto c : command)
@@ -280,62 +876,314 @@ std::string Server::cleanedCommand(std::string& command){
     return cleanCommand;
 }
 
-void Server::handleClient(int clientSocket) {
-    
+void Server::openSession(int clientSocket, uint16_t channel) {
     // initialize client path
+    std::lock_guard<std::mutex> lock(this -> pathsMutex);
+    this -> clientPaths[{clientSocket, channel}] = this -> startDirectory;
+}
+
+void Server::closeSession(int clientSocket, uint16_t channel) {
+    std::shared_ptr<Shell> shell;
+    std::shared_ptr<Terminal> terminal;
     {
         std::lock_guard<std::mutex> lock(this -> pathsMutex);
-        this -> clientPaths[clientSocket] = current_path();
+        this -> clientPaths.erase({clientSocket, channel});
+        this -> previousDirectories.erase({clientSocket, channel});
+        this -> terminalSizes.erase({clientSocket, channel});
+        this -> customizedShells.erase({clientSocket, channel});
+        
+        auto terminal_it = this -> runningTerminals.find({clientSocket, channel});
+        if (terminal_it != this -> runningTerminals.end()) {
+            terminal = std::move(terminal_it -> second);
+            this -> runningTerminals.erase(terminal_it);
+        }
+        
+        auto it = this -> sessionShells.find({clientSocket, channel});
+        if (it != this -> sessionShells.end()) {
+            shell = std::move(it -> second);
+            this -> sessionShells.erase(it);
+        }
+    }
+    fileWatcher.dropSession({clientSocket, channel});
+    fileSaver.dropSession({clientSocket, channel});
+    
+    // the shell is killed here, or by the request still running in it once that ends
+    if (terminal) {
+        terminal -> hangUp();
     }
+}
 
-    char buffer[1024] = {'\0'};
-    ssize_t bytesRead;
+std::string Server::handleRequest(int clientSocket, uint16_t channel, const std::string& request,
+                                  const Reactor::OutputSink& emit, const Reactor::FileSink& sendFile, bool& closeSession) {
+    // the pieces of a nano save and of a put carry raw bytes after their first line,
+    // anything else stops at an embedded NUL like the old C string buffer did
+    bool upload = request.rfind("nano --save-data=", 0) == 0 || request.rfind("put --data=", 0) == 0;
+    std::string command = upload ? request : std::string(request.c_str());
+    
+    LOG_DEBUG(logger, "(Server::handleRequest) Received command: " + (upload ? command.substr(0, command.find('\n')) : command));
+    
+    if (command == "exit") {
+        LOG_DEBUG(logger, "(Server::handleRequest) Exit command received. Closing client with id " + std::to_string(clientSocket) +
+                          (channel == 0 ? " connection." : " channel " + std::to_string(channel) + "."));
+        std::string response = "Goodbye!";
+        LOG_DEBUG(logger, "(Server::handleRequest) Sending exit response: " + response);
+        closeSession = true;
+        return response;
+    }
+    
+    std::string outputBuffer;
+    
+    // Specific handling for nano command
+    processCommand(command, {clientSocket, channel}, emit, sendFile, outputBuffer);
+    
+    LOG_DEBUG(logger, "(Server::handleRequest) Sending response of " + std::to_string(outputBuffer.size()) + " bytes.");
+    return outputBuffer;
+}
 
-    logger.log("[DEBUG](Server::handleClient) Handling new client with id " + std::to_string(clientSocket) + ".");
+bool Server::isOrderingBarrier(const std::string& request) const {
+    std::string command(request.c_str());
     
-    while ((bytesRead = recv(clientSocket, buffer, sizeof(buffer) - 1, 0)) > 0) {
-        buffer[bytesRead] = '\0';
-        std::string command(buffer);
+    // cd changes the session every later request runs in, exit ends it,
+    // the others change the session's shell for the commands after them
+    static const std::vector<std::string_view> shellState = {"export", "unset", "alias", "unalias", "source", ".", "pushd", "popd"};
+    std::string_view verb = commands::parse(command).verb;
+    
+    return verb == "cd" || verb == "exit" || std::find(shellState.begin(), shellState.end(), verb) != shellState.end();
+}
+
+void Server::handleClient(int clientSocket) {
+    
+    // sends of one client only wait for each other, a client that stops reading holds up nobody else
+    std::shared_ptr<ThreadedConnection> connection = std::make_shared<ThreadedConnection>(clientSocket);
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        threadedConnections[clientSocket] = connection;
+    }
+    openSession(clientSocket, 0);
 
-        logger.log("[DEBUG](Server::handleClient) Received command: " + command);
+    protocol::FrameParser parser;
+    protocol::Frame frame;
+    ssize_t bytesRead = 0;
+    bool malformed = false;
 
-        if (command == "exit") {
-            logger.log("[DEBUG](Server::handleClient) Exit command received. Closing client with id " + std::to_string(clientSocket) + " connection.");
-            std::string response = "Goodbye!";
-            logger.log("[DEBUG](Server::handleClient) Sending exit response: " + response);
-            send(clientSocket, response.c_str(), response.size(), 0);
-            std::this_thread::sleep_for(std::chrono::milliseconds(100));
-            return;
+    LOG_DEBUG(logger, "(Server::handleClient) Handling new client with id " + std::to_string(clientSocket) + ".");
+    
+    // this thread only reads: control frames apply at once, keystrokes go straight to a running terminal,
+    // requests run on the workers so one channel never waits behind another
+    while (!malformed) {
+        char* space = parser.prepare(4096);
+        if ((bytesRead = recv(clientSocket, space, parser.writable(), 0)) <= 0) {
+            if (bytesRead == -1 && errno == EINTR) {
+                continue;
+            }
+            break;
         }
+        parser.commit(bytesRead);
         
-        std::string outputBuffer;
+        protocol::FrameParser::Result result;
+        while ((result = parser.nextMessage(frame)) == protocol::FrameParser::Result::FRAME) {
+            bool barrier = frame.header.type == protocol::FrameType::REQUEST && isOrderingBarrier(std::string(frame.payload));
+            ChannelTable::Event event = ChannelTable::Event::NONE;
+            std::vector<Request> ready;
+            {
+                std::lock_guard<std::mutex> lock(connection -> mutex);
+                if (!connection -> closed) {
+                    event = connection -> channels.apply(frame);
+                }
+                if (event == ChannelTable::Event::REQUEST) {
+                    connection -> channels.enqueue(Request{frame.header.channel, frame.header.requestId,
+                                                           std::string(frame.payload), barrier});
+                    ready = connection -> channels.takeRunnable(Reactor::MAX_IN_FLIGHT);
+                }
+            }
+            
+            switch (event) {
+                case ChannelTable::Event::OPENED:
+                    openSession(clientSocket, frame.header.channel);
+                    break;
+                case ChannelTable::Event::CLOSED:
+                    connection -> drained.notify_all();
+                    closeSession(clientSocket, frame.header.channel);
+                    break;
+                case ChannelTable::Event::WINDOW:
+                    flushConnection(*connection);
+                    break;
+                case ChannelTable::Event::REQUEST:
+                    startRequests(connection, std::move(ready));
+                    break;
+                case ChannelTable::Event::TERMINAL:
+                    handleTerminalFrame(clientSocket, frame);
+                    break;
+                default:
+                    break;
+            }
+        }
         
-        // Specific handling for nano command
-        processCommand(command, clientSocket, outputBuffer);
+        if (result == protocol::FrameParser::Result::MALFORMED) {
+            LOG_ERROR(logger, "(Server::handleClient) Malformed frame from client with id " + std::to_string(clientSocket) + ".");
+            malformed = true;
+        }
+    }
+    
+    if (bytesRead == 0) {
+        LOG_DEBUG(logger, "(Server::handleClient) Client disconnected.");
+    } else if (bytesRead < 0) {
+        LOG_ERROR(logger, "(Server::handleClient) Failed to receive data from client.");
+    }
+    
+    std::vector<uint16_t> openChannels;
+    {
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        connection -> closed = true;
+        connection -> channels.clearPending();
+        openChannels = connection -> channels.openChannels();
+        // nobody reads what is still queued
+        for (uint16_t channel : openChannels) {
+            connection -> channels.close(channel, true);
+        }
+    }
+    connection -> drained.notify_all();
+    
+    // requests still sending give up, the descriptor is closed once the last of them let go of it
+    shutdown(clientSocket, SHUT_RDWR);
+    for (uint16_t channel : openChannels) {
+        closeSession(clientSocket, channel);
+    }
+    {
+        std::lock_guard<std::mutex> lock(connectionsMutex);
+        threadedConnections.erase(clientSocket);
+    }
+    LOG_DEBUG(logger, "(Server::handleClient) Client socket released.");
+}
 
-        // Send the output or error response back to the client
+void Server::startRequests(const std::shared_ptr<ThreadedConnection>& connection, std::vector<Request> ready) {
+    for (Request& request : ready) {
+        this -> requestWorkers -> submit([this, connection, request = std::move(request)]() {
+            runRequest(connection, request);
+        });
+    }
+}
+
+void Server::runRequest(const std::shared_ptr<ThreadedConnection>& connection, const Request& request) {
+    // under connection -> mutex
+    auto abandoned = [&]() {
+        return connection -> closed || !connection -> channels.isOpen(request.channel);
+    };
+    
+    // streamed output goes out as it comes, past the buffer limit the command waits for window updates
+    Reactor::OutputSink emit = [&](std::string_view chunk) {
         {
-            std::lock_guard<std::mutex> lock(clientMutex);
-            logger.log("[DEBUG](Server::handleClient) Sending response: " + outputBuffer);
+            std::unique_lock<std::mutex> lock(connection -> mutex);
+            connection -> drained.wait(lock, [&]() {
+                return abandoned() || connection -> channels.queuedBytes(request.channel) < ChannelTable::STREAM_BUFFER_LIMIT;
+            });
+            if (abandoned()) {
+                return false;
+            }
+            connection -> channels.queueResponse(request.channel, request.id, chunk, false);
+        }
+        return flushConnection(*connection);
+    };
+    
+    // a file frame goes out behind everything queued, header and then the file straight from the page cache
+    Reactor::FileSink sendFile = [&](int fd, off_t offset, size_t length) {
+        while (length > 0) {
+            size_t chunk = std::min<size_t>(length, protocol::STREAM_CHUNK);
+            {
+                // the channel's queued frames leave first, then the client has to grant room for this one
+                std::unique_lock<std::mutex> lock(connection -> mutex);
+                connection -> drained.wait(lock, [&]() {
+                    return abandoned() || connection -> channels.claimWindow(request.channel, chunk);
+                });
+                if (abandoned()) {
+                    return false;
+                }
+            }
+            
+            protocol::FrameHeader header;
+            header.type = protocol::FrameType::RESPONSE;
+            header.flags = protocol::FLAG_MORE;
+            header.channel = request.channel;
+            header.requestId = request.id;
+            header.length = static_cast<uint32_t>(chunk);
+            char encoded[protocol::HEADER_SIZE];
+            protocol::encodeHeader(header, encoded);
             
-            send(clientSocket, outputBuffer.c_str(), outputBuffer.size(), 0);
+            // frames drained before this one are on the wire once the send lock is free
+            std::lock_guard<std::mutex> sending(connection -> sendMutex);
+            if (!protocol::sendAll(connection -> socket, encoded, sizeof(encoded)) ||
+                !ZeroCopy::sendAll(connection -> socket, fd, offset, chunk)) {
+                LOG_ERROR(logger, "(Server::runRequest) Failed to send file to client: " + std::string(strerror(errno)));
+                shutdown(connection -> socket, SHUT_RDWR);
+                return false;
+            }
+            offset += chunk;
+            length -= chunk;
         }
+        return true;
+    };
     
-        memset(buffer, '\0', sizeof(buffer));
+    bool endSession = false;
+    std::string outputBuffer;
+    try {
+        outputBuffer = handleRequest(connection -> socket, request.channel, request.command, emit, sendFile, endSession);
+    } catch (const std::exception& e) {
+        LOG_ERROR(logger, "(Server::runRequest) Request failed: " + std::string(e.what()));
+        outputBuffer = "Error: " + std::string(e.what());
     }
-   
-    // mutex deconnecting
+    
+    std::vector<Request> ready;
+    bool channelClosed = false;
+    bool hangUp = false;
     {
-        std::lock_guard<std::mutex>lock(clientMutex);
-        if (bytesRead == 0) {
-            logger.log("[DEBUG](Server::handleClient) Client disconnected.");
-        } else if (bytesRead < 0) {
-            logger.log("[ERROR](Server::handleClient) Failed to receive data from client.");
+        std::lock_guard<std::mutex> lock(connection -> mutex);
+        connection -> channels.finished(request);
+        if (!connection -> closed) {
+            // responses leave in completion order, the client matches them by id
+            connection -> channels.queueResponse(request.channel, request.id, outputBuffer);
+            if (endSession && request.channel == 0) {
+                hangUp = true;
+                connection -> closed = true;
+                connection -> channels.clearPending();
+            } else {
+                channelClosed = endSession && connection -> channels.close(request.channel);
+                ready = connection -> channels.takeRunnable(Reactor::MAX_IN_FLIGHT);
+            }
         }
     }
-        
-    close(clientSocket);
-    logger.log("[DEBUG](Server::handleClient) Client socket closed.");
+    if (endSession) {
+        connection -> drained.notify_all();
+    }
+    if (channelClosed) {
+        closeSession(connection -> socket, request.channel);
+    }
+    
+    // Send the output or error response back to the client
+    flushConnection(*connection);
+    if (hangUp) {
+        // the client's thread sees the hang up and closes the sessions
+        shutdown(connection -> socket, SHUT_RDWR);
+    }
+    startRequests(connection, std::move(ready));
+}
+
+bool Server::flushConnection(ThreadedConnection& connection) {
+    // whoever drains frames sends them before anybody else drains more
+    std::lock_guard<std::mutex> sending(connection.sendMutex);
+    std::string outbound;
+    {
+        std::lock_guard<std::mutex> lock(connection.mutex);
+        outbound.swap(connection.events);
+        connection.channels.drainInto(outbound);
+    }
+    connection.drained.notify_all();
+    
+    if (!outbound.empty() && !protocol::sendAll(connection.socket, outbound.data(), outbound.size())) {
+        LOG_ERROR(logger, "(Server::flushConnection) Failed to send response to client: " + std::string(strerror(errno)));
+        shutdown(connection.socket, SHUT_RDWR);
+        return false;
+    }
+    return true;
 }
 
 }
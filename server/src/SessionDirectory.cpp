@@ -0,0 +1,67 @@
+//
+//  SessionDirectory.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/SessionDirectory.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#include <cerrno>
+
+namespace server {
+
+namespace {
+
+// O_PATH only needs search permission and is enough for openat and fchdir
+#ifdef O_PATH
+constexpr int DIRECTORY_FLAGS = O_PATH | O_DIRECTORY | O_CLOEXEC;
+#else
+constexpr int DIRECTORY_FLAGS = O_RDONLY | O_DIRECTORY | O_CLOEXEC;
+#endif
+
+}
+
+std::shared_ptr<const SessionDirectory> SessionDirectory::open(const std::filesystem::path& directory) {
+    int descriptor = ::open(directory.c_str(), DIRECTORY_FLAGS);
+    if (descriptor == -1) {
+        return nullptr;
+    }
+    return std::shared_ptr<const SessionDirectory>(new SessionDirectory(descriptor, directory));
+}
+
+std::shared_ptr<const SessionDirectory> SessionDirectory::openAt(const SessionDirectory& base, const std::string& name) {
+    int descriptor = ::openat(base.fd(), name.c_str(), DIRECTORY_FLAGS);
+    if (descriptor == -1) {
+        return nullptr;
+    }
+
+    char resolved[PATH_MAX];
+    ssize_t length = -1;
+#ifdef __linux__
+    std::string link = "/proc/self/fd/" + std::to_string(descriptor);
+    length = readlink(link.c_str(), resolved, sizeof(resolved) - 1);
+#endif
+    if (length > 0) {
+        resolved[length] = '\0';
+    } else if (realpath((name[0] == '/' ? std::filesystem::path(name) : base.path() / name).c_str(), resolved) == nullptr) {
+        int error = errno;
+        ::close(descriptor);
+        errno = error;
+        return nullptr;
+    }
+    return std::shared_ptr<const SessionDirectory>(new SessionDirectory(descriptor, resolved));
+}
+
+SessionDirectory::SessionDirectory(int descriptor, std::filesystem::path location)
+: descriptor(descriptor), location(std::move(location)) {}
+
+SessionDirectory::~SessionDirectory() {
+    close(this -> descriptor);
+}
+
+}
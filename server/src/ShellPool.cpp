@@ -0,0 +1,452 @@
+//
+//  ShellPool.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ShellPool.hpp"
+
+#include <poll.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <cerrno>
+#include <cstring>
+#include <cstdio>
+#include <cctype>
+#include <random>
+#include <chrono>
+#include <algorithm>
+#include <string_view>
+
+namespace server {
+
+namespace {
+
+const char* const SHELL = "/bin/bash";
+
+// single quotes for bash, an embedded quote becomes '\''
+std::string shellQuote(const std::string& text) {
+    std::string quoted = "'";
+    for (char c : text) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted.push_back(c);
+        }
+    }
+    quoted.push_back('\'');
+    return quoted;
+}
+
+std::string makeSentinel() {
+    std::random_device seed;
+    std::mt19937_64 generator((static_cast<uint64_t>(seed()) << 32) | seed());
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(generator()));
+    return "__remmux_" + std::string(hex) + "__";
+}
+
+// SIGPIPE is ignored by the server, a dead shell shows up as EPIPE here
+bool writeAll(int fd, const std::string& data) {
+    size_t offset = 0;
+    while (offset < data.size()) {
+        ssize_t written = write(fd, data.data() + offset, data.size() - offset);
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        offset += written;
+    }
+    return true;
+}
+
+size_t countLines(const std::string& text) {
+    return static_cast<size_t>(std::count(text.begin(), text.end(), '\n'));
+}
+
+// how much of word is at text[cursor], which moves past it when all of it is
+enum class Match { YES, NO, SHORT };
+
+Match expect(const std::string& text, size_t& cursor, std::string_view word) {
+    size_t available = std::min(word.size(), text.size() - cursor);
+    if (text.compare(cursor, available, word, 0, available) != 0) {
+        return Match::NO;
+    }
+    if (available < word.size()) {
+        return Match::SHORT;
+    }
+    cursor += word.size();
+    return Match::YES;
+}
+
+// bash numbers its errors by the lines it read from the pipe so far, eval from the line its command
+// ends on; "/bin/bash: [eval: ]line <n>: " for n in [first, last] becomes "/bin/bash: line <n - first + 1>: ",
+// what bash -c would print. Scans text from checked, a line start when lineStart, and returns how
+// far the text is final; a line that may still turn into such a prefix waits for more output
+size_t renumberErrors(std::string& text, size_t checked, bool lineStart, size_t first, size_t last) {
+    size_t position = checked;
+    if (!lineStart) {
+        position = text.find('\n', position);
+        if (position == std::string::npos) {
+            return text.size();
+        }
+        ++position;
+    }
+
+    while (position < text.size()) {
+        size_t cursor = position;
+        Match match = expect(text, cursor, SHELL);
+        if (match == Match::YES) {
+            match = expect(text, cursor, ": ");
+        }
+        size_t label = cursor;
+        if (match == Match::YES && expect(text, cursor, "eval: ") == Match::SHORT) {
+            match = Match::SHORT;
+        }
+        if (match == Match::YES) {
+            match = expect(text, cursor, "line ");
+        }
+        size_t digits = cursor;
+        while (match == Match::YES && cursor < text.size() && cursor - digits < 19 &&
+               std::isdigit(static_cast<unsigned char>(text[cursor]))) {
+            ++cursor;
+        }
+        if (match == Match::YES && cursor == text.size()) {
+            match = Match::SHORT;
+        } else if (match == Match::YES && (cursor == digits || text[cursor] != ':')) {
+            match = Match::NO;
+        }
+        if (match == Match::SHORT) {
+            return position;
+        }
+
+        if (match == Match::YES) {
+            size_t line = std::strtoull(text.c_str() + digits, nullptr, 10);
+            if (line >= first && line <= last) {
+                std::string renumbered = "line " + std::to_string(line - first + 1);
+                text.replace(label, cursor - label, renumbered);
+                cursor = label + renumbered.size();
+            }
+        }
+        position = text.find('\n', cursor);
+        if (position == std::string::npos) {
+            return text.size();
+        }
+        ++position;
+    }
+    return text.size();
+}
+
+}
+
+std::shared_ptr<Shell> Shell::start(ProcessRunner& runner, logs::Logger& logger) {
+    ProcessRunner::Child child;
+
+    // cd keeps symlinks in $PWD like in any terminal, the cd that needs no shell spells it the same;
+    // warm shells are not bound to a session yet, acquire moves them
+    if (!runner.start({SHELL, "--noprofile", "--norc"}, -1, true, child)) {
+        return nullptr;
+    }
+
+    std::shared_ptr<Shell> shell(new Shell(child, logger));
+
+    // aliases are off in a non-interactive shell; an interrupt is for the command, bash itself stays
+    std::string setup = "shopt -s expand_aliases\ntrap : INT\n";
+    if (!writeAll(child.input, setup)) {
+        LOG_ERROR(logger, "(Shell::start) Shell exited right after it was spawned.");
+        return nullptr;
+    }
+    shell -> linesRead = countLines(setup);
+    return shell;
+}
+
+Shell::Shell(const ProcessRunner::Child& child, logs::Logger& logger)
+: child(child), logger(logger), sentinel(makeSentinel()) {}
+
+Shell::~Shell() {
+    kill();
+}
+
+bool Shell::alive() {
+    // busy means it is running a command, so it is alive
+    std::unique_lock<std::mutex> lock(this -> mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return true;
+    }
+    if (!this -> dead) {
+        std::unique_lock<std::mutex> group(this -> groupMutex);
+        if (waitpid(this -> child.pid, nullptr, WNOHANG) == this -> child.pid) {
+            this -> child.pid = -1;
+            group.unlock();
+            kill();
+        }
+    }
+    return !this -> dead;
+}
+
+ExitStatus Shell::run(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    return runLocked(command, onOutput, directory);
+}
+
+std::optional<ExitStatus> Shell::tryRun(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory) {
+    std::unique_lock<std::mutex> lock(this -> mutex, std::try_to_lock);
+    if (!lock.owns_lock()) {
+        return std::nullopt;
+    }
+    return runLocked(command, onOutput, directory);
+}
+
+void Shell::interrupt() {
+    // the group id is only the shell's while it is unreaped
+    std::lock_guard<std::mutex> lock(this -> groupMutex);
+    if (this -> child.pid != -1) {
+        killpg(this -> child.pid, SIGINT);
+    }
+}
+
+void Shell::follow(const std::string& directory, const std::string& previous) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> pendingMove = "builtin cd -- " + shellQuote(directory) + " 2>/dev/null && OLDPWD=" + shellQuote(previous) + "\n";
+}
+
+ExitStatus Shell::runLocked(const std::string& command, const ProcessRunner::OutputHandler& onOutput, std::string& directory) {
+    ExitStatus exitStatus;
+    if (this -> dead) {
+        return exitStatus;
+    }
+
+    // eval keeps a syntax error in the command from swallowing the sentinel lines,
+    // and the command reads /dev/null instead of the control pipe
+    std::string script = this -> pendingMove + "eval " + shellQuote(command) + " </dev/null\n"
+                         "printf '%s %d %s\\n' " + this -> sentinel + " \"$?\" \"$PWD\"\n"
+                         "printf '%s\\n' " + this -> sentinel + " >&2\n";
+
+    // bash numbers the command's lines on from where its eval ends
+    size_t firstLine = this -> linesRead + countLines(this -> pendingMove) + countLines(command) + 1;
+    size_t lastLine = firstLine + countLines(command) + 1;   // a syntax error can name the line after the end
+
+    if (!writeAll(this -> child.input, script)) {
+        LOG_WARN(this -> logger, "(Shell::runLocked) Shell is gone: " + std::string(strerror(errno)));
+        kill();
+        return exitStatus;
+    }
+    exitStatus.started = true;
+    this -> linesRead += countLines(script);
+    this -> pendingMove.clear();
+
+    int fds[2] = {this -> child.output, this -> child.error};
+    std::string pending[2];
+    bool done[2] = {false, false};
+    size_t checked = 0;      // stderr before this is renumbered
+    bool lineStart = true;   // stderr handed on so far ended a line
+    bool abandoned = false;
+    bool exited = false;
+    std::vector<char> buffer(16384);
+
+    while (!(done[0] && done[1]) && !abandoned && !exited) {
+        pollfd watched[2];
+        nfds_t count = 0;
+        for (int i = 0; i < 2; ++i) {
+            if (!done[i]) {
+                watched[count++] = {fds[i], POLLIN, 0};
+            }
+        }
+
+        if (poll(watched, count, -1) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR(this -> logger, "(Shell::runLocked) poll failed: " + std::string(strerror(errno)));
+            abandoned = true;
+            break;
+        }
+
+        for (nfds_t w = 0; w < count && !abandoned && !exited; ++w) {
+            if (watched[w].revents == 0) {
+                continue;
+            }
+            int i = (watched[w].fd == fds[0]) ? 0 : 1;
+            ProcessRunner::Stream stream = (i == 0) ? ProcessRunner::Stream::STDOUT : ProcessRunner::Stream::STDERR;
+
+            ssize_t bytesRead = read(fds[i], buffer.data(), buffer.size());
+            if (bytesRead == -1 && errno == EINTR) {
+                continue;
+            }
+            if (bytesRead <= 0) {
+                // the command ended the shell itself (exit, exec, set -e ...)
+                if (!pending[i].empty()) {
+                    onOutput(stream, pending[i]);
+                }
+                exited = true;
+                break;
+            }
+            pending[i].append(buffer.data(), bytesRead);
+            if (i == 1) {
+                checked = renumberErrors(pending[1], checked, checked == 0 ? lineStart : pending[1][checked - 1] == '\n',
+                                         firstLine, lastLine);
+            }
+
+            // everything before the sentinel is output; without one, only a tail that
+            // could still grow into it is held back
+            size_t marker = pending[i].find(this -> sentinel);
+            size_t ready = marker;
+            if (marker == std::string::npos) {
+                ready = pending[i].size() - heldBack(pending[i]);
+            }
+            if (i == 1) {
+                ready = std::min(ready, checked);
+            }
+            if (ready > 0) {
+                if (!onOutput(stream, std::string_view(pending[i].data(), ready))) {
+                    abandoned = true;
+                }
+                if (i == 1) {
+                    lineStart = pending[1][ready - 1] == '\n';
+                    checked -= ready;
+                }
+                pending[i].erase(0, ready);
+            }
+            if (marker == std::string::npos) {
+                continue;
+            }
+
+            if (i == 1) {
+                done[1] = true;
+                continue;
+            }
+
+            // "<sentinel> <status> <cwd>\n"
+            size_t end = pending[0].find('\n');
+            if (end == std::string::npos) {
+                continue;
+            }
+            std::string record = pending[0].substr(this -> sentinel.size() + 1, end - this -> sentinel.size() - 1);
+            size_t space = record.find(' ');
+            exitStatus.code = std::atoi(record.substr(0, space).c_str());
+            directory = space == std::string::npos ? std::string() : record.substr(space + 1);
+            done[0] = true;
+        }
+    }
+
+    if (abandoned) {
+        kill();
+        exitStatus.code = -1;
+        exitStatus.signal = SIGKILL;
+    } else if (exited) {
+        int status = kill();
+        exitStatus.code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        exitStatus.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+    }
+    return exitStatus;
+}
+
+size_t Shell::heldBack(const std::string& pending) const {
+    size_t length = std::min(pending.size(), this -> sentinel.size() - 1);
+    for (; length > 0; --length) {
+        if (pending.compare(pending.size() - length, length, this -> sentinel, 0, length) == 0) {
+            break;
+        }
+    }
+    return length;
+}
+
+int Shell::kill() {
+    int status = 0;
+    std::unique_lock<std::mutex> group(this -> groupMutex);
+    if (this -> child.pid != -1) {
+        // still unreaped, so the group id is ours; takes background jobs along
+        killpg(this -> child.pid, SIGKILL);
+        while (waitpid(this -> child.pid, &status, 0) == -1 && errno == EINTR) {}
+        this -> child.pid = -1;
+    }
+    group.unlock();
+    for (int* fd : {&this -> child.input, &this -> child.output, &this -> child.error}) {
+        if (*fd != -1) {
+            close(*fd);
+            *fd = -1;
+        }
+    }
+    this -> dead = true;
+    return status;
+}
+
+ShellPool::ShellPool(ProcessRunner& runner, logs::Logger& logger, size_t warmShells)
+: runner(runner), logger(logger), warmShells(warmShells) {
+    this -> refiller = std::thread(&ShellPool::refillLoop, this);
+}
+
+ShellPool::~ShellPool() {
+    {
+        std::lock_guard<std::mutex> lock(this -> idleMutex);
+        this -> stopping = true;
+    }
+    this -> refillCondition.notify_all();
+    if (this -> refiller.joinable()) {
+        this -> refiller.join();
+    }
+}
+
+std::shared_ptr<Shell> ShellPool::acquire(const std::string& workingDirectory, const std::string& previousDirectory) {
+    std::shared_ptr<Shell> shell;
+    {
+        std::lock_guard<std::mutex> lock(this -> idleMutex);
+        while (!this -> idle.empty() && !shell) {
+            shell = std::move(this -> idle.front());
+            this -> idle.pop_front();
+            if (!shell -> alive()) {
+                shell.reset();
+            }
+        }
+    }
+    this -> refillCondition.notify_one();
+
+    // pool drained faster than it refills, start one on the spot
+    if (!shell) {
+        shell = Shell::start(this -> runner, this -> logger);
+        if (!shell) {
+            return nullptr;
+        }
+    }
+
+    // cd sets OLDPWD to where the shell started, cd - must go back to where the session was
+    std::string enter = "cd -- " + shellQuote(workingDirectory);
+    if (!previousDirectory.empty()) {
+        enter += " && OLDPWD=" + shellQuote(previousDirectory);
+    }
+    std::string directory;
+    ExitStatus status = shell -> run(enter,
+                                     [](ProcessRunner::Stream, std::string_view) { return true; }, directory);
+    if (!status.success()) {
+        LOG_WARN(this -> logger, "(ShellPool::acquire) Shell could not enter " + workingDirectory + ".");
+    }
+    return shell;
+}
+
+void ShellPool::refillLoop() {
+    std::unique_lock<std::mutex> lock(this -> idleMutex);
+
+    while (!this -> stopping) {
+        if (this -> idle.size() >= this -> warmShells) {
+            this -> refillCondition.wait(lock);
+            continue;
+        }
+
+        lock.unlock();
+        std::shared_ptr<Shell> shell = Shell::start(this -> runner, this -> logger);
+        lock.lock();
+
+        if (!shell) {
+            // no bash or out of processes, try again later instead of spinning
+            this -> refillCondition.wait_for(lock, std::chrono::seconds(1));
+            continue;
+        }
+        this -> idle.push_back(std::move(shell));
+    }
+}
+
+}
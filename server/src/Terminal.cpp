@@ -0,0 +1,266 @@
+//
+//  Terminal.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/Terminal.hpp"
+
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/ioctl.h>
+#include <termios.h>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <stdexcept>
+
+namespace server {
+
+namespace {
+
+void setNonBlocking(int fd) {
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+}
+
+}
+
+Terminal::Terminal(ProcessRunner& runner, logs::Logger& logger, const protocol::WindowSize& size)
+: runner(runner), logger(logger), size(size) {
+#ifdef __linux__
+    // close-on-exec from the start, a command spawned meanwhile on another thread must not get it
+    int made = pipe2(this -> wake, O_CLOEXEC);
+#else
+    int made = pipe(this -> wake);
+#endif
+    if (made == -1) {
+        LOG_ERROR(this -> logger, "(Terminal::Terminal) Failed to create wake pipe: " + std::string(strerror(errno)));
+        throw std::runtime_error("Failed to create terminal wake pipe.");
+    }
+    setNonBlocking(this -> wake[0]);
+    setNonBlocking(this -> wake[1]);
+}
+
+Terminal::~Terminal() {
+    close(this -> wake[0]);
+    close(this -> wake[1]);
+}
+
+ExitStatus Terminal::run(const std::string& command, int directoryFd, const OutputHandler& onOutput) {
+    ExitStatus exitStatus;
+
+    protocol::WindowSize startSize;
+    {
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        if (this -> hungUp) {
+            return exitStatus;
+        }
+        startSize = this -> size;
+    }
+
+    ProcessRunner::Child child;
+    if (!this -> runner.startTerminal({"/bin/bash", "-c", command}, directoryFd, startSize.rows, startSize.columns, child)) {
+        return exitStatus;
+    }
+    exitStatus.started = true;
+    setNonBlocking(child.output);
+
+    {
+        // a resize or keystrokes that came in while the command was being spawned
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        this -> master = child.output;
+        if (this -> size.rows != startSize.rows || this -> size.columns != startSize.columns) {
+            winsize current{};
+            current.ws_row = this -> size.rows;
+            current.ws_col = this -> size.columns;
+            ioctl(this -> master, TIOCSWINSZ, &current);
+        }
+        flushInputLocked();
+    }
+
+    bool abandoned = false;
+    std::vector<char> buffer(16384);
+
+    // screen mode: output only changes the screen, the loop sends what changed on a fixed beat
+    using Clock = std::chrono::steady_clock;
+    std::unique_ptr<Screen> screen;
+    if (startSize.screen) {
+        screen = std::make_unique<Screen>(startSize.rows, startSize.columns);
+    }
+    const auto updateInterval = std::chrono::milliseconds(1000 / protocol::SCREEN_UPDATE_RATE);
+    Clock::time_point nextUpdate = Clock::now();
+    auto sendUpdate = [&]() {
+        nextUpdate = Clock::now() + updateInterval;
+        return onOutput(protocol::encodeScreenUpdate(screen -> takeUpdate()));
+    };
+
+    while (!abandoned) {
+        pollfd watched[2];
+        nfds_t count = 0;
+        {
+            std::lock_guard<std::mutex> lock(this -> mutex);
+            abandoned = this -> hungUp;
+            watched[count++] = {child.output, static_cast<short>(POLLIN | (this -> pendingInput.empty() ? 0 : POLLOUT)), 0};
+            if (screen && this -> resized) {
+                screen -> resize(this -> size.rows, this -> size.columns);
+                this -> resized = false;
+            }
+        }
+        if (abandoned) {
+            break;
+        }
+        watched[count++] = {this -> wake[0], POLLIN, 0};
+
+        int timeout = -1;
+        if (screen && screen -> changed()) {
+            auto wait = std::chrono::duration_cast<std::chrono::milliseconds>(nextUpdate - Clock::now()).count();
+            if (wait <= 0) {
+                if (!sendUpdate()) {
+                    abandoned = true;
+                    break;
+                }
+                continue;
+            }
+            timeout = static_cast<int>(wait);
+        }
+
+        if (poll(watched, count, timeout) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            LOG_ERROR(this -> logger, "(Terminal::run) poll failed: " + std::string(strerror(errno)));
+            abandoned = true;
+            break;
+        }
+
+        if (watched[1].revents != 0) {
+            char drain[64];
+            while (read(this -> wake[0], drain, sizeof(drain)) > 0) {}
+        }
+        if (watched[0].revents & POLLOUT) {
+            std::lock_guard<std::mutex> lock(this -> mutex);
+            flushInputLocked();
+        }
+        if (watched[0].revents & (POLLIN | POLLHUP | POLLERR)) {
+            ssize_t bytesRead = read(child.output, buffer.data(), buffer.size());
+            if (bytesRead > 0) {
+                if (screen) {
+                    // checked again right before feeding, the redraw after SIGWINCH lands on the new size
+                    {
+                        std::lock_guard<std::mutex> lock(this -> mutex);
+                        if (this -> resized) {
+                            screen -> resize(this -> size.rows, this -> size.columns);
+                            this -> resized = false;
+                        }
+                    }
+                    screen -> feed(std::string_view(buffer.data(), bytesRead));
+                } else if (!onOutput(std::string_view(buffer.data(), bytesRead))) {
+                    abandoned = true;
+                }
+                continue;
+            }
+            if (bytesRead == -1 && (errno == EINTR || errno == EAGAIN)) {
+                continue;
+            }
+            // EIO (or EOF) once every process let go of the terminal
+            break;
+        }
+    }
+
+    // the last screen the program left behind
+    if (!abandoned && screen && screen -> changed()) {
+        sendUpdate();
+    }
+
+    // the session id is the leader's pid and stays ours until it is reaped
+    if (abandoned) {
+        killpg(child.pid, SIGKILL);
+    }
+    {
+        // closing the master hangs up whatever still holds the terminal
+        std::lock_guard<std::mutex> lock(this -> mutex);
+        close(this -> master);
+        this -> master = -1;
+        this -> pendingInput.clear();
+    }
+
+    int status = 0;
+    while (waitpid(child.pid, &status, 0) == -1 && errno == EINTR) {}
+
+    if (WIFEXITED(status)) {
+        exitStatus.code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+        exitStatus.signal = WTERMSIG(status);
+    }
+    return exitStatus;
+}
+
+void Terminal::write(std::string_view keys) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    if (this -> pendingInput.size() + keys.size() > INPUT_LIMIT) {
+        LOG_WARN(this -> logger, "(Terminal::write) Terminal input is full, dropping " + std::to_string(keys.size()) + " bytes.");
+        return;
+    }
+    bool wasEmpty = this -> pendingInput.empty();
+    this -> pendingInput.append(keys);
+    flushInputLocked();
+
+    // run() only watches for POLLOUT while something is pending
+    if (wasEmpty && !this -> pendingInput.empty()) {
+        poke();
+    }
+}
+
+void Terminal::resize(const protocol::WindowSize& size) {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    // the mode is fixed for the command that runs, only the size follows the client
+    this -> size.rows = size.rows;
+    this -> size.columns = size.columns;
+    this -> resized = true;
+    poke();
+    if (this -> master != -1) {
+        // the kernel sends SIGWINCH to the program in the foreground
+        winsize current{};
+        current.ws_row = size.rows;
+        current.ws_col = size.columns;
+        ioctl(this -> master, TIOCSWINSZ, &current);
+    }
+}
+
+void Terminal::hangUp() {
+    std::lock_guard<std::mutex> lock(this -> mutex);
+    this -> hungUp = true;
+    poke();
+}
+
+void Terminal::poke() {
+    char byte = 1;
+    ssize_t ignored = ::write(this -> wake[1], &byte, 1);
+    (void)ignored;
+}
+
+void Terminal::flushInputLocked() {
+    while (this -> master != -1 && !this -> pendingInput.empty()) {
+        ssize_t written = ::write(this -> master, this -> pendingInput.data(), this -> pendingInput.size());
+        if (written == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // EAGAIN: the program is not reading, the rest goes once the terminal drains
+            if (errno != EAGAIN) {
+                this -> pendingInput.clear();
+            }
+            return;
+        }
+        this -> pendingInput.erase(0, written);
+    }
+}
+
+}
@@ -0,0 +1,92 @@
+//
+//  ThreadPool.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ThreadPool.hpp"
+
+#include <algorithm>
+
+namespace server {
+
+ThreadPool::ThreadPool(size_t workerCount, size_t maxWorkers) {
+    if (workerCount == 0) {
+        workerCount = 1;
+    }
+    this -> maxWorkers = std::max(workerCount, maxWorkers);
+
+    this -> workers.reserve(workerCount);
+    for (size_t i = 0; i < workerCount; ++i) {
+        this -> workers.emplace_back(&ThreadPool::workerLoop, this, false);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    std::unique_lock<std::mutex> lock(this -> tasksMutex);
+    this -> stopping = true;
+    lock.unlock();
+    this -> tasksCondition.notify_all();
+
+    for (auto& worker : this -> workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+
+    lock.lock();
+    this -> extraFinished.wait(lock, [this] { return this -> extra == 0; });
+}
+
+void ThreadPool::submit(std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> lock(this -> tasksMutex);
+        this -> tasks.push(std::move(task));
+
+        // nobody free to take it: one more worker rather than a wait behind a task that may block for long
+        if (this -> idle < this -> tasks.size() && this -> workers.size() + this -> extra < this -> maxWorkers) {
+            ++this -> extra;
+            std::thread(&ThreadPool::workerLoop, this, true).detach();
+        }
+    }
+    this -> tasksCondition.notify_one();
+}
+
+size_t ThreadPool::size() const {
+    return this -> workers.size();
+}
+
+void ThreadPool::workerLoop(bool temporary) {
+    while (true) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(this -> tasksMutex);
+            auto ready = [this] { return this -> stopping || !this -> tasks.empty(); };
+            ++this -> idle;
+            bool woken = true;
+            if (temporary) {
+                woken = this -> tasksCondition.wait_for(lock, IDLE_TIMEOUT, ready);
+            } else {
+                this -> tasksCondition.wait(lock, ready);
+            }
+            --this -> idle;
+
+            // drain what is left before stopping, an extra worker also leaves when it had nothing to do for long
+            if (this -> tasks.empty() || !woken) {
+                if (temporary) {
+                    --this -> extra;
+                    this -> extraFinished.notify_all();
+                }
+                return;
+            }
+
+            task = std::move(this -> tasks.front());
+            this -> tasks.pop();
+        }
+
+        task();
+    }
+}
+
+}
@@ -0,0 +1,346 @@
+//
+//  TreeArchive.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/TreeArchive.hpp"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <zlib.h>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <vector>
+#include <algorithm>
+#include <filesystem>
+
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+
+namespace server {
+
+namespace {
+
+constexpr size_t TAR_BLOCK = 512;
+
+// octal with a NUL like tar writes it, GNU base-256 for what does not fit
+void number(char* field, size_t width, uint64_t value) {
+    if (value < (uint64_t(1) << (3 * (width - 1)))) {
+        char digits[32];
+        snprintf(digits, sizeof(digits), "%0*llo", static_cast<int>(width - 1), static_cast<unsigned long long>(value));
+        memcpy(field, digits, width);
+        return;
+    }
+    memset(field, 0, width);
+    field[0] = static_cast<char>(0x80);
+    for (size_t i = width - 1; i > 0 && value > 0; --i, value >>= 8) {
+        field[i] = static_cast<char>(value & 0xff);
+    }
+}
+
+// the names in one getdents64 batch, or readdir's where there is no such call
+template <typename Visit>
+bool readEntries(int directoryFd, std::vector<char>& buffer, Visit visit) {
+#ifdef __linux__
+    while (true) {
+        long got = syscall(SYS_getdents64, directoryFd, buffer.data(), buffer.size());
+        if (got <= 0) {
+            return got == 0;
+        }
+        for (long offset = 0; offset < got;) {
+            auto* entry = reinterpret_cast<struct dirent64*>(buffer.data() + offset);
+            offset += entry -> d_reclen;
+            if (strcmp(entry -> d_name, ".") != 0 && strcmp(entry -> d_name, "..") != 0 && !visit(entry -> d_name)) {
+                return true;
+            }
+        }
+    }
+#else
+    DIR* directory = fdopendir(dup(directoryFd));
+    if (directory == nullptr) {
+        return false;
+    }
+    while (struct dirent* entry = readdir(directory)) {
+        if (strcmp(entry -> d_name, ".") != 0 && strcmp(entry -> d_name, "..") != 0 && !visit(entry -> d_name)) {
+            break;
+        }
+    }
+    closedir(directory);
+    return true;
+#endif
+}
+
+}
+
+TreeArchive::TreeArchive(size_t workerCount, logs::Logger& logger) : workers(workerCount), logger(logger) {}
+
+std::string TreeArchive::stream(const std::string& directory, const SessionDirectory& workingDirectory,
+                                const Reactor::OutputSink& emit) {
+    int fd = openat(workingDirectory.fd(), directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    struct stat info;
+    if (fd == -1 || fstat(fd, &info) == -1) {
+        std::string error = "Error: Cannot read " + directory + ": " + strerror(errno);
+        if (fd != -1) {
+            close(fd);
+        }
+        return error;
+    }
+
+    // entries unpack into a directory of the tree's own name, "." and ".." take the one they stand for
+    std::filesystem::path absolute = directory[0] == '/' ? std::filesystem::path(directory) : workingDirectory.path() / directory;
+    std::string name = absolute.lexically_normal().filename().string();
+    if (name.empty() || name == "." || name == "..") {
+        name = std::filesystem::weakly_canonical(absolute).filename().string();
+    }
+    if (name.empty()) {
+        name = "root";
+    }
+
+    // gzip header: deflate, no name, no time, unix
+    static const char gzipHeader[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 3};
+    Output output{emit, {}, nullptr, {}};
+    output.block.reserve(BLOCK);
+    output.failed = !emit("TREE " + name + "\n" + std::string(gzipHeader, sizeof(gzipHeader)));
+
+    header(output, name + "/", info, '5', 0, "");
+    walk(fd, name + "/", output, 1);
+    close(fd);
+
+    // two empty blocks end the archive, the trailer the gzip stream
+    static const char end[2 * TAR_BLOCK] = {};
+    append(output, end, sizeof(end));
+    seal(output, true);
+    if (output.failed) {
+        LOG_WARN(this -> logger, "(TreeArchive::stream) Client stopped reading the archive of " + directory);
+        return "";
+    }
+    char trailer[8];
+    for (int i = 0; i < 4; ++i) {
+        trailer[i] = static_cast<char>((output.crc >> (8 * i)) & 0xff);
+        trailer[4 + i] = static_cast<char>((output.length >> (8 * i)) & 0xff);
+    }
+    emit(std::string_view(trailer, sizeof(trailer)));
+
+    // the client holds back the last RESULT_SIZE bytes, they are not part of the archive
+    char result[RESULT_SIZE + 1];
+    snprintf(result, sizeof(result), "SKIPPED %012llu\n", static_cast<unsigned long long>(output.skipped));
+    emit(std::string_view(result, RESULT_SIZE));
+
+    LOG_INFO(this -> logger, "(TreeArchive::stream) Sent " + directory + " as " + std::to_string(output.length) + " bytes of tar, " +
+                             std::to_string(output.skipped) + " entries left out");
+    return "";
+}
+
+void TreeArchive::walk(int directoryFd, const std::string& prefix, Output& output, size_t depth) {
+    // one buffer per level, a name is handled before the batch it came in is read again
+    std::vector<char> buffer(32 * 1024);
+    bool listed = readEntries(directoryFd, buffer, [&](const char* name) {
+        addEntry(directoryFd, name, prefix + name, output, depth);
+        return !output.failed;
+    });
+    if (!listed) {
+        LOG_WARN(this -> logger, "(TreeArchive::walk) Cannot list " + prefix + ": " + strerror(errno));
+        ++output.skipped;
+    }
+}
+
+void TreeArchive::addEntry(int directoryFd, const char* name, const std::string& path, Output& output, size_t depth) {
+    struct stat info;
+    // gone since it was listed is not an error, anything else the user hears about
+    auto leaveOut = [&](const std::string& what) {
+        if (errno != ENOENT) {
+            LOG_WARN(this -> logger, "(TreeArchive::addEntry) Leaving out " + what + ": " + strerror(errno));
+            ++output.skipped;
+        }
+    };
+    if (fstatat(directoryFd, name, &info, AT_SYMLINK_NOFOLLOW) == -1) {
+        leaveOut(path);
+        return;
+    }
+
+    if (S_ISDIR(info.st_mode)) {
+        header(output, path + "/", info, '5', 0, "");
+        if (depth >= MAX_DEPTH) {
+            errno = ELOOP;
+            leaveOut("the contents of " + path);
+            return;
+        }
+        int fd = openat(directoryFd, name, O_RDONLY | O_DIRECTORY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1) {
+            leaveOut("the contents of " + path);
+            return;
+        }
+        walk(fd, path + "/", output, depth + 1);
+        close(fd);
+    } else if (S_ISLNK(info.st_mode)) {
+        char target[PATH_MAX];
+        ssize_t length = readlinkat(directoryFd, name, target, sizeof(target));
+        if (length > 0) {
+            header(output, path, info, '2', 0, std::string(target, static_cast<size_t>(length)));
+        } else {
+            leaveOut(path);
+        }
+    } else if (S_ISREG(info.st_mode)) {
+        int fd = openat(directoryFd, name, O_RDONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd == -1 || fstat(fd, &info) == -1) {
+            leaveOut(path);
+            if (fd != -1) {
+                close(fd);
+            }
+            return;
+        }
+        uint64_t size = static_cast<uint64_t>(info.st_size);
+        header(output, path, info, '0', size, "");
+
+        // read straight into the block; a file that shrank meanwhile is padded with zeros to the size in its header
+        bool shrank = false;
+        for (uint64_t left = size; left > 0 && !output.failed;) {
+            size_t at = output.block.size();
+            size_t take = static_cast<size_t>(std::min<uint64_t>(left, BLOCK - at));
+            output.block.resize(at + take);
+            for (size_t got = 0; !shrank && got < take;) {
+                ssize_t count = read(fd, output.block.data() + at + got, take - got);
+                if (count > 0) {
+                    got += static_cast<size_t>(count);
+                } else if (count == 0 || errno != EINTR) {
+                    shrank = true;
+                }
+            }
+            left -= take;
+            if (output.block.size() == BLOCK) {
+                seal(output, false);
+            }
+        }
+        close(fd);
+        if (shrank) {
+            LOG_WARN(this -> logger, "(TreeArchive::addEntry) " + path + " shrank while it was archived");
+            ++output.skipped;
+        }
+        static const char padding[TAR_BLOCK] = {};
+        append(output, padding, (TAR_BLOCK - size % TAR_BLOCK) % TAR_BLOCK);
+    }
+    // sockets, fifos and devices have nothing to send
+}
+
+void TreeArchive::append(Output& output, const char* data, size_t length) {
+    while (length > 0 && !output.failed) {
+        size_t take = std::min(length, BLOCK - output.block.size());
+        output.block.append(data, take);
+        data += take;
+        length -= take;
+        if (output.block.size() == BLOCK) {
+            seal(output, false);
+        }
+    }
+}
+
+void TreeArchive::header(Output& output, const std::string& path, const struct stat& info, char type, uint64_t size,
+                         const std::string& link) {
+    // names and targets past the 100 bytes of the header go ahead of it in GNU long name entries
+    auto longName = [&](const std::string& name, char longType) {
+        static const char padding[TAR_BLOCK] = {};
+        struct stat none = {};
+        header(output, "././@LongLink", none, longType, name.size() + 1, "");
+        append(output, name.c_str(), name.size() + 1);
+        append(output, padding, (TAR_BLOCK - (name.size() + 1) % TAR_BLOCK) % TAR_BLOCK);
+    };
+    if (path.size() > 100) {
+        longName(path, 'L');
+    }
+    if (link.size() > 100) {
+        longName(link, 'K');
+    }
+
+    char block[TAR_BLOCK] = {};
+    memcpy(block, path.data(), std::min<size_t>(path.size(), 100));
+    number(block + 100, 8, info.st_mode & 07777);
+    number(block + 108, 8, info.st_uid);
+    number(block + 116, 8, info.st_gid);
+    number(block + 124, 12, size);
+    number(block + 136, 12, static_cast<uint64_t>(std::max<time_t>(info.st_mtime, 0)));
+    block[156] = type;
+    memcpy(block + 157, link.data(), std::min<size_t>(link.size(), 100));
+    memcpy(block + 257, "ustar  ", 8);
+
+    // the checksum is taken with its own field as spaces
+    memset(block + 148, ' ', 8);
+    unsigned sum = 0;
+    for (unsigned char byte : block) {
+        sum += byte;
+    }
+    snprintf(block + 148, 8, "%06o", sum);
+    append(output, block, sizeof(block));
+}
+
+void TreeArchive::seal(Output& output, bool last) {
+    if (!output.failed) {
+        auto block = std::make_shared<const std::string>(std::move(output.block));
+        auto task = std::make_shared<std::packaged_task<Compressed()>>([block, previous = output.previous, last] {
+            return deflateBlock(block, previous, last);
+        });
+        output.pending.push_back(task -> get_future());
+        this -> workers.submit([task] { (*task)(); });
+        output.previous = block;
+        output.block = std::string();
+        output.block.reserve(BLOCK);
+    }
+
+    // in order, the oldest as soon as it is done, and all of them at the end
+    size_t ahead = this -> workers.size() * AHEAD_PER_WORKER;
+    while (!output.pending.empty() &&
+           (last || output.pending.size() > ahead ||
+            output.pending.front().wait_for(std::chrono::seconds(0)) == std::future_status::ready)) {
+        sendFront(output);
+    }
+}
+
+void TreeArchive::sendFront(Output& output) {
+    Compressed compressed = output.pending.front().get();
+    output.pending.pop_front();
+    output.crc = static_cast<uint32_t>(crc32_combine(output.crc, compressed.crc, static_cast<z_off_t>(compressed.length)));
+    output.length += compressed.length;
+    if (!output.failed && !output.emit(compressed.bytes)) {
+        output.failed = true;
+    }
+}
+
+TreeArchive::Compressed TreeArchive::deflateBlock(std::shared_ptr<const std::string> block,
+                                                  std::shared_ptr<const std::string> previous, bool last) {
+    Compressed result;
+    result.length = block -> size();
+    result.crc = static_cast<uint32_t>(crc32(0, reinterpret_cast<const Bytef*>(block -> data()), static_cast<uInt>(block -> size())));
+
+    // raw deflate, the pieces join into one stream: every one but the last ends on a byte with a sync flush
+    z_stream stream = {};
+    deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (previous) {
+        size_t length = std::min(DICTIONARY, previous -> size());
+        deflateSetDictionary(&stream, reinterpret_cast<const Bytef*>(previous -> data() + previous -> size() - length),
+                             static_cast<uInt>(length));
+    }
+
+    result.bytes.resize(deflateBound(&stream, static_cast<uLong>(block -> size())) + 16);
+    stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(block -> data()));
+    stream.avail_in = static_cast<uInt>(block -> size());
+    int flush = last ? Z_FINISH : Z_SYNC_FLUSH;
+    while (true) {
+        stream.next_out = reinterpret_cast<Bytef*>(result.bytes.data() + stream.total_out);
+        stream.avail_out = static_cast<uInt>(result.bytes.size() - stream.total_out);
+        int status = deflate(&stream, flush);
+        if (stream.avail_out != 0 || status == Z_STREAM_END) {
+            break;
+        }
+        result.bytes.resize(result.bytes.size() * 2);
+    }
+    result.bytes.resize(stream.total_out);
+    deflateEnd(&stream);
+    return result;
+}
+
+}
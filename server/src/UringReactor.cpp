@@ -0,0 +1,827 @@
+//
+//  UringReactor.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/UringReactor.hpp"
+
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <map>
+#include <condition_variable>
+#include <sys/socket.h>
+#include <sys/mman.h>
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/syscall.h>
+#include <sys/eventfd.h>
+#include <poll.h>
+#endif
+
+namespace server {
+
+struct UringReactor::Connection {
+    int socket;
+    uint16_t generation;
+    std::vector<std::string> outbound;  // responses waiting for the next send chain
+    std::vector<std::string> sending;   // buffers owned by the chain in flight
+    std::vector<size_t> sent;           // bytes the kernel reported per chain entry
+    protocol::FrameParser parser;       // reassembles frames split over provided buffers
+    ChannelTable channels;              // pane sessions, their queued requests and windows
+    unsigned sendsInFlight = 0;
+    bool recvArmed = false;
+    bool closing = false;
+    bool closed = false;
+
+    // shared with streaming workers, the ring thread publishes how far each channel is behind
+    struct Backlog {
+        size_t posted = 0;   // chunks handed to the ring thread, not queued yet
+        size_t queued = 0;   // bytes waiting in the channel for window
+        bool open = true;
+    };
+    std::mutex streamMutex;
+    std::condition_variable streamDrained;
+    std::map<uint16_t, Backlog> backlog;
+    bool hungUp = false;
+
+    Connection(int socket, uint16_t generation) : socket(socket), generation(generation) {}
+};
+
+#ifdef __linux__
+
+namespace {
+
+// user_data layout: op (8 bits) | chain index (8) | generation (16) | socket (32)
+enum Op : uint64_t {
+    OP_ACCEPT = 1,
+    OP_RECV = 2,
+    OP_SEND = 3,
+    OP_WAKE = 4,
+    OP_SOURCE = 5
+};
+
+constexpr unsigned RING_ENTRIES = 256;
+constexpr unsigned BUFFER_COUNT = 1024;   // power of two, shared by every connection
+constexpr unsigned BUFFER_SIZE = 4096;
+constexpr uint16_t BUFFER_GROUP = 0;
+constexpr size_t MAX_CHAIN = 64;
+
+uint64_t encode(uint64_t op, uint64_t index, uint64_t generation, int fd) {
+    return (op << 56) | ((index & 0xff) << 48) | ((generation & 0xffff) << 32) | static_cast<uint32_t>(fd);
+}
+
+int uringSetup(unsigned entries, io_uring_params* params) {
+    return static_cast<int>(syscall(__NR_io_uring_setup, entries, params));
+}
+
+int uringEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags) {
+    return static_cast<int>(syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, nullptr, 0));
+}
+
+int uringRegister(int fd, unsigned opcode, void* arg, unsigned count) {
+    return static_cast<int>(syscall(__NR_io_uring_register, fd, opcode, arg, count));
+}
+
+}
+
+// minimal ring mapping, the same layout liburing sets up
+struct UringReactor::Ring {
+    int fd = -1;
+    unsigned entries = 0;
+
+    void* sqRing = MAP_FAILED;
+    size_t sqRingSize = 0;
+    void* cqRing = MAP_FAILED;
+    size_t cqRingSize = 0;
+    io_uring_sqe* sqes = static_cast<io_uring_sqe*>(MAP_FAILED);
+    size_t sqesSize = 0;
+
+    unsigned* sqHead = nullptr;
+    unsigned* sqTail = nullptr;
+    unsigned* sqMask = nullptr;
+    unsigned* sqArray = nullptr;
+    unsigned sqLocalTail = 0;
+
+    unsigned* cqHead = nullptr;
+    unsigned* cqTail = nullptr;
+    unsigned* cqMask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+
+    // provided buffers for multishot recv
+    io_uring_buf_ring* bufRing = static_cast<io_uring_buf_ring*>(MAP_FAILED);
+    size_t bufRingSize = 0;
+    char* bufBase = static_cast<char*>(MAP_FAILED);
+    uint16_t bufTail = 0;
+
+    ~Ring() {
+        if (bufBase != MAP_FAILED) munmap(bufBase, size_t(BUFFER_COUNT) * BUFFER_SIZE);
+        if (bufRing != MAP_FAILED) munmap(bufRing, bufRingSize);
+        if (sqes != MAP_FAILED) munmap(sqes, sqesSize);
+        if (cqRing != MAP_FAILED && cqRing != sqRing) munmap(cqRing, cqRingSize);
+        if (sqRing != MAP_FAILED) munmap(sqRing, sqRingSize);
+        if (fd != -1) close(fd);
+    }
+
+    bool setup(unsigned requested) {
+        io_uring_params params{};
+        this -> fd = uringSetup(requested, &params);
+        if (this -> fd < 0) {
+            return false;
+        }
+        this -> entries = params.sq_entries;
+
+        this -> sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        this -> cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        bool singleMap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (singleMap) {
+            this -> sqRingSize = this -> cqRingSize = std::max(this -> sqRingSize, this -> cqRingSize);
+        }
+
+        this -> sqRing = mmap(nullptr, this -> sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this -> fd, IORING_OFF_SQ_RING);
+        if (this -> sqRing == MAP_FAILED) {
+            return false;
+        }
+        this -> cqRing = singleMap ? this -> sqRing :
+            mmap(nullptr, this -> cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this -> fd, IORING_OFF_CQ_RING);
+        if (this -> cqRing == MAP_FAILED) {
+            return false;
+        }
+
+        this -> sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+        void* sqesMap = mmap(nullptr, this -> sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, this -> fd, IORING_OFF_SQES);
+        if (sqesMap == MAP_FAILED) {
+            return false;
+        }
+        this -> sqes = static_cast<io_uring_sqe*>(sqesMap);
+
+        char* sq = static_cast<char*>(this -> sqRing);
+        this -> sqHead = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        this -> sqTail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        this -> sqMask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        this -> sqArray = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        this -> sqLocalTail = *this -> sqTail;
+
+        char* cq = static_cast<char*>(this -> cqRing);
+        this -> cqHead = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        this -> cqTail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        this -> cqMask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        this -> cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+        return true;
+    }
+
+    // multishot accept/recv and the buffer ring arrived together with IORING_OP_SEND_ZC in 6.0
+    bool probeFeatures() {
+        const unsigned opsCount = 256;
+        std::vector<char> storage(sizeof(io_uring_probe) + opsCount * sizeof(io_uring_probe_op), 0);
+        auto* probe = reinterpret_cast<io_uring_probe*>(storage.data());
+        if (uringRegister(this -> fd, IORING_REGISTER_PROBE, probe, opsCount) < 0) {
+            return false;
+        }
+        return probe -> last_op >= IORING_OP_SEND_ZC &&
+               (probe -> ops[IORING_OP_SEND_ZC].flags & IO_URING_OP_SUPPORTED);
+    }
+
+    bool setupBuffers() {
+        this -> bufRingSize = BUFFER_COUNT * sizeof(io_uring_buf);
+        void* ringMap = mmap(nullptr, this -> bufRingSize, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (ringMap == MAP_FAILED) {
+            return false;
+        }
+        this -> bufRing = static_cast<io_uring_buf_ring*>(ringMap);
+
+        void* bufMap = mmap(nullptr, size_t(BUFFER_COUNT) * BUFFER_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (bufMap == MAP_FAILED) {
+            return false;
+        }
+        this -> bufBase = static_cast<char*>(bufMap);
+
+        io_uring_buf_reg reg{};
+        reg.ring_addr = reinterpret_cast<uint64_t>(this -> bufRing);
+        reg.ring_entries = BUFFER_COUNT;
+        reg.bgid = BUFFER_GROUP;
+        if (uringRegister(this -> fd, IORING_REGISTER_PBUF_RING, &reg, 1) < 0) {
+            return false;
+        }
+
+        for (uint16_t bid = 0; bid < BUFFER_COUNT; ++bid) {
+            recycleBuffer(bid);
+        }
+        return true;
+    }
+
+    void recycleBuffer(uint16_t bid) {
+        // index the ring as a plain array, the uapi flex array member sits one
+        // empty struct further in C++; the tail overlays bufs[0].resv
+        io_uring_buf* bufs = reinterpret_cast<io_uring_buf*>(this -> bufRing);
+        io_uring_buf* buf = &bufs[this -> bufTail & (BUFFER_COUNT - 1)];
+        buf -> addr = reinterpret_cast<uint64_t>(this -> bufBase + size_t(bid) * BUFFER_SIZE);
+        buf -> len = BUFFER_SIZE;
+        buf -> bid = bid;
+        ++this -> bufTail;
+        __atomic_store_n(&bufs[0].resv, this -> bufTail, __ATOMIC_RELEASE);
+    }
+
+    const char* bufferData(uint16_t bid) const {
+        return this -> bufBase + size_t(bid) * BUFFER_SIZE;
+    }
+
+    io_uring_sqe* nextSqe() {
+        // a full submission queue is pushed to the kernel before queueing more
+        if (this -> sqLocalTail - __atomic_load_n(this -> sqHead, __ATOMIC_ACQUIRE) >= this -> entries) {
+            submit(0);
+        }
+        unsigned index = this -> sqLocalTail & *this -> sqMask;
+        io_uring_sqe* sqe = &this -> sqes[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        this -> sqArray[index] = index;
+        ++this -> sqLocalTail;
+        return sqe;
+    }
+
+    int submit(unsigned waitFor) {
+        __atomic_store_n(this -> sqTail, this -> sqLocalTail, __ATOMIC_RELEASE);
+        unsigned toSubmit = this -> sqLocalTail - __atomic_load_n(this -> sqHead, __ATOMIC_ACQUIRE);
+
+        while (true) {
+            int result = uringEnter(this -> fd, toSubmit, waitFor, waitFor ? IORING_ENTER_GETEVENTS : 0);
+            if (result >= 0 || errno != EINTR) {
+                return result;
+            }
+        }
+    }
+};
+
+bool UringReactor::isSupported() {
+    Ring probeRing;
+    return probeRing.setup(4) && probeRing.probeFeatures();
+}
+
+UringReactor::UringReactor(int listenSocket, size_t workerThreads, logs::Logger& logger,
+                           Reactor::RequestHandler handler, Reactor::OrderingPredicate isBarrier,
+                           Reactor::SessionHook onOpen, Reactor::SessionHook onClose, Reactor::TerminalHook onTerminal)
+: listenSocket(listenSocket), logger(logger), handler(std::move(handler)), isBarrier(std::move(isBarrier)),
+onOpen(std::move(onOpen)), onClose(std::move(onClose)), onTerminal(std::move(onTerminal)), ring(std::make_unique<Ring>()) {
+
+    if (!this -> ring -> setup(RING_ENTRIES) || !this -> ring -> setupBuffers()) {
+        LOG_ERROR(this -> logger, "(UringReactor::UringReactor) Failed to set up io_uring: " + std::string(strerror(errno)));
+        throw std::runtime_error("Failed to set up io_uring.");
+    }
+
+    this -> wakeFd = eventfd(0, EFD_CLOEXEC);
+    if (this -> wakeFd == -1) {
+        LOG_ERROR(this -> logger, "(UringReactor::UringReactor) Failed to create eventfd: " + std::string(strerror(errno)));
+        throw std::runtime_error("Failed to create eventfd.");
+    }
+
+    this -> workers = std::make_unique<ThreadPool>(workerThreads, Reactor::MAX_WORKERS);
+
+    LOG_DEBUG(this -> logger, "(UringReactor::UringReactor) io_uring ready with " + std::to_string(this -> ring -> entries) +
+                              " entries and " + std::to_string(BUFFER_COUNT) + " provided buffers.");
+}
+
+UringReactor::~UringReactor() {
+    // workers must finish before the wake descriptor goes away
+    this -> workers.reset();
+    if (this -> wakeFd != -1) {
+        close(this -> wakeFd);
+    }
+}
+
+void UringReactor::run() {
+    LOG_DEBUG(this -> logger, "(UringReactor::run) Starting io_uring loop.");
+
+    armAccept();
+    armWake();
+    for (size_t i = 0; i < this -> sources.size(); ++i) {
+        armSource(i);
+    }
+
+    while (true) {
+        // one kernel crossing submits the whole batch and waits for the next completion
+        if (this -> ring -> submit(1) < 0 && errno != EAGAIN && errno != EBUSY) {
+            LOG_ERROR(this -> logger, "(UringReactor::run) io_uring_enter failed: " + std::string(strerror(errno)));
+            return;
+        }
+
+        unsigned head = *this -> ring -> cqHead;
+        unsigned tail = __atomic_load_n(this -> ring -> cqTail, __ATOMIC_ACQUIRE);
+
+        for (; head != tail; ++head) {
+            const io_uring_cqe& cqe = this -> ring -> cqes[head & *this -> ring -> cqMask];
+            uint64_t userData = cqe.user_data;
+            int result = cqe.res;
+            uint32_t flags = cqe.flags;
+
+            switch (userData >> 56) {
+                case OP_ACCEPT:
+                    onAccept(result, flags);
+                    break;
+                case OP_RECV:
+                    onRecv(userData, result, flags);
+                    break;
+                case OP_SEND:
+                    onSend(userData, result);
+                    break;
+                case OP_WAKE:
+                    onWake();
+                    break;
+                case OP_SOURCE:
+                    onSource(userData, result);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        __atomic_store_n(this -> ring -> cqHead, head, __ATOMIC_RELEASE);
+    }
+}
+
+void UringReactor::armAccept() {
+    io_uring_sqe* sqe = this -> ring -> nextSqe();
+    sqe -> opcode = IORING_OP_ACCEPT;
+    sqe -> fd = this -> listenSocket;
+    sqe -> accept_flags = SOCK_CLOEXEC;
+    sqe -> ioprio = IORING_ACCEPT_MULTISHOT;
+    sqe -> user_data = encode(OP_ACCEPT, 0, 0, this -> listenSocket);
+}
+
+void UringReactor::armRecv(Connection& connection) {
+    io_uring_sqe* sqe = this -> ring -> nextSqe();
+    sqe -> opcode = IORING_OP_RECV;
+    sqe -> fd = connection.socket;
+    sqe -> flags = IOSQE_BUFFER_SELECT;
+    sqe -> buf_group = BUFFER_GROUP;
+    sqe -> ioprio = IORING_RECV_MULTISHOT;
+    sqe -> user_data = encode(OP_RECV, 0, connection.generation, connection.socket);
+    connection.recvArmed = true;
+}
+
+void UringReactor::armWake() {
+    io_uring_sqe* sqe = this -> ring -> nextSqe();
+    sqe -> opcode = IORING_OP_READ;
+    sqe -> fd = this -> wakeFd;
+    sqe -> addr = reinterpret_cast<uint64_t>(&this -> wakeValue);
+    sqe -> len = sizeof(this -> wakeValue);
+    sqe -> user_data = encode(OP_WAKE, 0, 0, this -> wakeFd);
+}
+
+void UringReactor::addSource(int fd, std::function<void()> onReadable) {
+    this -> sources.emplace_back(fd, std::move(onReadable));
+}
+
+void UringReactor::armSource(size_t index) {
+    // one shot, armed again after the callback so a busy source cannot flood the completion queue
+    io_uring_sqe* sqe = this -> ring -> nextSqe();
+    sqe -> opcode = IORING_OP_POLL_ADD;
+    sqe -> fd = this -> sources[index].first;
+    sqe -> poll32_events = POLLIN;
+    sqe -> user_data = encode(OP_SOURCE, index, 0, this -> sources[index].first);
+}
+
+void UringReactor::push(int clientSocket, uint16_t channel, protocol::FrameType type, std::string_view payload) {
+    auto it = this -> connections.find(clientSocket);
+    if (it == this -> connections.end()) {
+        return;
+    }
+    Connection& connection = *it -> second;
+    if (connection.closed || connection.closing || !connection.channels.isOpen(channel)) {
+        return;
+    }
+    std::string framed;
+    protocol::appendMessage(framed, type, channel, 0, payload);
+    connection.outbound.push_back(std::move(framed));
+    flushSends(connection);
+}
+
+void UringReactor::flushSends(Connection& connection) {
+    if (connection.sendsInFlight > 0 || connection.closed) {
+        return;
+    }
+
+    if (connection.outbound.empty()) {
+        if (connection.closing) {
+            shutdown(connection.socket, SHUT_RDWR);
+        }
+        return;
+    }
+
+    // the kernel runs linked sends strictly in order, so responses never interleave
+    size_t count = std::min(connection.outbound.size(), MAX_CHAIN);
+    connection.sending.assign(std::make_move_iterator(connection.outbound.begin()),
+                              std::make_move_iterator(connection.outbound.begin() + count));
+    connection.outbound.erase(connection.outbound.begin(), connection.outbound.begin() + count);
+    connection.sent.assign(count, 0);
+
+    for (size_t i = 0; i < count; ++i) {
+        io_uring_sqe* sqe = this -> ring -> nextSqe();
+        sqe -> opcode = IORING_OP_SEND;
+        sqe -> fd = connection.socket;
+        sqe -> addr = reinterpret_cast<uint64_t>(connection.sending[i].data());
+        sqe -> len = static_cast<uint32_t>(connection.sending[i].size());
+        sqe -> msg_flags = MSG_NOSIGNAL | MSG_WAITALL;
+        sqe -> flags = (i + 1 < count) ? IOSQE_IO_LINK : 0;
+        sqe -> user_data = encode(OP_SEND, i, connection.generation, connection.socket);
+    }
+    connection.sendsInFlight = static_cast<unsigned>(count);
+}
+
+UringReactor::Connection* UringReactor::lookup(uint64_t userData) {
+    int fd = static_cast<int>(userData & 0xffffffff);
+    uint16_t generation = static_cast<uint16_t>((userData >> 32) & 0xffff);
+
+    auto it = this -> connections.find(fd);
+    if (it == this -> connections.end() || it -> second -> generation != generation) {
+        return nullptr;
+    }
+    return it -> second.get();
+}
+
+void UringReactor::onAccept(int result, uint32_t flags) {
+    if (result >= 0) {
+        int clientSocket = result;
+        protocol::setNoDelay(clientSocket);
+        this -> onOpen(clientSocket, 0);
+
+        auto connection = std::make_shared<Connection>(clientSocket, static_cast<uint16_t>(this -> nextGeneration++));
+        this -> connections[clientSocket] = connection;
+        armRecv(*connection);
+
+        LOG_DEBUG(this -> logger, "(UringReactor::onAccept) Client connected with id: " + std::to_string(clientSocket));
+    } else {
+        LOG_ERROR(this -> logger, "(UringReactor::onAccept) Failed to accept client connection: " + std::string(strerror(-result)));
+    }
+
+    // the multishot accept stays armed until the kernel says otherwise
+    if (!(flags & IORING_CQE_F_MORE)) {
+        armAccept();
+    }
+}
+
+void UringReactor::onRecv(uint64_t userData, int result, uint32_t flags) {
+    Connection* connection = lookup(userData);
+
+    if (flags & IORING_CQE_F_BUFFER) {
+        uint16_t bid = static_cast<uint16_t>(flags >> IORING_CQE_BUFFER_SHIFT);
+        if (result > 0 && connection != nullptr) {
+            connection -> parser.append(this -> ring -> bufferData(bid), result);
+        }
+        // the buffer goes straight back to the kernel, the bytes live in the parser now
+        this -> ring -> recycleBuffer(bid);
+    }
+
+    if (connection == nullptr) {
+        return;
+    }
+
+    if (!(flags & IORING_CQE_F_MORE)) {
+        connection -> recvArmed = false;
+    }
+
+    if (result > 0) {
+        protocol::Frame frame;
+        protocol::FrameParser::Result parsed;
+        while ((parsed = connection -> parser.nextMessage(frame)) == protocol::FrameParser::Result::FRAME) {
+            applyFrame(this -> connections[connection -> socket], frame);
+        }
+
+        if (parsed == protocol::FrameParser::Result::MALFORMED) {
+            LOG_ERROR(this -> logger, "(UringReactor::onRecv) Malformed frame from client " + std::to_string(connection -> socket) + ".");
+            closeConnection(*connection);
+        } else if (!connection -> recvArmed && !connection -> closed) {
+            armRecv(*connection);
+        }
+    } else if (result == -ENOBUFS) {
+        // every provided buffer was in use, they are back in the ring by now
+        if (!connection -> recvArmed && !connection -> closed) {
+            armRecv(*connection);
+        }
+    } else {
+        if (result == 0) {
+            LOG_DEBUG(this -> logger, "(UringReactor::onRecv) Client disconnected.");
+        } else {
+            LOG_ERROR(this -> logger, "(UringReactor::onRecv) Failed to receive data from client: " + std::string(strerror(-result)));
+        }
+        closeConnection(*connection);
+    }
+
+    maybeRelease(connection -> socket);
+}
+
+void UringReactor::onSend(uint64_t userData, int result) {
+    Connection* connection = lookup(userData);
+    if (connection == nullptr) {
+        return;
+    }
+
+    size_t index = (userData >> 48) & 0xff;
+    if (result > 0 && index < connection -> sent.size()) {
+        connection -> sent[index] = static_cast<size_t>(result);
+    } else if (result < 0 && result != -ECANCELED) {
+        LOG_ERROR(this -> logger, "(UringReactor::onSend) Failed to send data to client: " + std::string(strerror(-result)));
+        closeConnection(*connection);
+    }
+
+    if (--connection -> sendsInFlight > 0) {
+        return;
+    }
+
+    // a short send breaks the link, requeue what the kernel did not take
+    std::vector<std::string> leftover;
+    for (size_t i = 0; i < connection -> sending.size(); ++i) {
+        if (connection -> sent[i] < connection -> sending[i].size()) {
+            leftover.push_back(connection -> sending[i].substr(connection -> sent[i]));
+        }
+    }
+    connection -> sending.clear();
+    connection -> sent.clear();
+
+    if (!connection -> closed) {
+        connection -> outbound.insert(connection -> outbound.begin(),
+                                      std::make_move_iterator(leftover.begin()),
+                                      std::make_move_iterator(leftover.end()));
+        flushSends(*connection);
+    }
+
+    maybeRelease(connection -> socket);
+}
+
+void UringReactor::onWake() {
+    std::vector<Completion> finished;
+    {
+        std::lock_guard<std::mutex> lock(this -> completionsMutex);
+        finished.swap(this -> completions);
+    }
+
+    for (auto& completion : finished) {
+        Connection& connection = *completion.connection;
+        const Request& request = completion.request;
+
+        if (completion.partial) {
+            {
+                std::lock_guard<std::mutex> lock(connection.streamMutex);
+                connection.backlog[request.channel].posted -= completion.response.size();
+            }
+            if (!connection.closed && connection.channels.isOpen(request.channel)) {
+                connection.channels.queueResponse(request.channel, request.id, completion.response, false);
+                queueOutput(connection);
+            } else {
+                publishBacklog(connection);
+            }
+            continue;
+        }
+
+        connection.channels.finished(request);
+
+        if (!connection.closed) {
+            // responses leave in completion order, the client matches them by id
+            connection.channels.queueResponse(request.channel, request.id, completion.response);
+            if (completion.closeAfter && request.channel == 0) {
+                connection.closing = true;
+                connection.channels.clearPending();
+            } else if (completion.closeAfter && connection.channels.close(request.channel)) {
+                this -> onClose(connection.socket, request.channel);
+            }
+            queueOutput(connection);
+        }
+
+        startRunnable(completion.connection);
+        maybeRelease(connection.socket);
+    }
+
+    armWake();
+}
+
+void UringReactor::onSource(uint64_t userData, int result) {
+    size_t index = (userData >> 48) & 0xff;
+    if (index >= this -> sources.size()) {
+        return;
+    }
+    if (result < 0) {
+        LOG_ERROR(this -> logger, "(UringReactor::onSource) Polling descriptor " + std::to_string(this -> sources[index].first) +
+                                  " failed: " + std::string(strerror(-result)));
+        return;
+    }
+    this -> sources[index].second();
+    armSource(index);
+}
+
+void UringReactor::applyFrame(const std::shared_ptr<Connection>& connection, const protocol::Frame& frame) {
+    switch (connection -> channels.apply(frame)) {
+        case ChannelTable::Event::OPENED:
+            this -> onOpen(connection -> socket, frame.header.channel);
+            publishBacklog(*connection);
+            break;
+        case ChannelTable::Event::CLOSED:
+            this -> onClose(connection -> socket, frame.header.channel);
+            publishBacklog(*connection);
+            break;
+        case ChannelTable::Event::WINDOW:
+            queueOutput(*connection);
+            break;
+        case ChannelTable::Event::REQUEST:
+            dispatch(connection, Request{frame.header.channel, frame.header.requestId, std::string(frame.payload)});
+            break;
+        case ChannelTable::Event::TERMINAL:
+            this -> onTerminal(connection -> socket, frame);
+            break;
+        default:
+            break;
+    }
+}
+
+void UringReactor::queueOutput(Connection& connection) {
+    std::string framed;
+    connection.channels.drainInto(framed);
+    if (!framed.empty()) {
+        connection.outbound.push_back(std::move(framed));
+    }
+    flushSends(connection);
+    publishBacklog(connection);
+}
+
+void UringReactor::publishBacklog(Connection& connection) {
+    std::lock_guard<std::mutex> lock(connection.streamMutex);
+
+    connection.hungUp = connection.closed || connection.closing;
+    for (auto it = connection.backlog.begin(); it != connection.backlog.end(); ) {
+        it -> second.queued = connection.channels.queuedBytes(it -> first);
+        it -> second.open = connection.channels.isOpen(it -> first);
+        if (it -> second.open && it -> second.posted == 0 && it -> second.queued == 0) {
+            it = connection.backlog.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    connection.streamDrained.notify_all();
+}
+
+void UringReactor::dispatch(const std::shared_ptr<Connection>& connection, Request request) {
+    if (connection -> closed || connection -> closing) {
+        return;
+    }
+    request.barrier = this -> isBarrier(request.command);
+    connection -> channels.enqueue(std::move(request));
+    startRunnable(connection);
+}
+
+void UringReactor::startRunnable(const std::shared_ptr<Connection>& connection) {
+    if (connection -> closed || connection -> closing) {
+        return;
+    }
+    for (auto& request : connection -> channels.takeRunnable(Reactor::MAX_IN_FLIGHT)) {
+        execute(connection, std::move(request));
+    }
+}
+
+void UringReactor::execute(const std::shared_ptr<Connection>& connection, Request request) {
+    this -> workers -> submit([this, connection, request = std::move(request)]() mutable {
+        bool closeAfter = false;
+        std::string response;
+        Reactor::OutputSink emit = [this, &connection, &request](std::string_view chunk) {
+            return streamChunk(connection, request, chunk);
+        };
+        // the ring thread owns every send, files go out read through emit
+        Reactor::FileSink sendFile;
+        try {
+            response = this -> handler(connection -> socket, request.channel, request.command, emit, sendFile, closeAfter);
+        } catch (const std::exception& e) {
+            LOG_ERROR(this -> logger, "(UringReactor::execute) Request failed: " + std::string(e.what()));
+            response = "Error: " + std::string(e.what());
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(this -> completionsMutex);
+            request.command.clear();
+            this -> completions.push_back({connection, std::move(request), std::move(response), closeAfter});
+        }
+        wake();
+    });
+}
+
+bool UringReactor::streamChunk(const std::shared_ptr<Connection>& connection, const Request& request, std::string_view chunk) {
+    {
+        std::unique_lock<std::mutex> lock(connection -> streamMutex);
+
+        auto abandoned = [&]() {
+            auto it = connection -> backlog.find(request.channel);
+            return connection -> hungUp || (it != connection -> backlog.end() && !it -> second.open);
+        };
+
+        // bounded buffering: the command waits until the client made room for what is already queued
+        connection -> streamDrained.wait(lock, [&]() {
+            auto it = connection -> backlog.find(request.channel);
+            return abandoned() || it == connection -> backlog.end() ||
+                   it -> second.posted + it -> second.queued < ChannelTable::STREAM_BUFFER_LIMIT;
+        });
+        if (abandoned()) {
+            return false;
+        }
+        connection -> backlog[request.channel].posted += chunk.size();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(this -> completionsMutex);
+        Completion completion{connection, Request{request.channel, request.id, {}, request.barrier}, std::string(chunk), false};
+        completion.partial = true;
+        this -> completions.push_back(std::move(completion));
+    }
+    wake();
+    return true;
+}
+
+void UringReactor::wake() {
+    uint64_t one = 1;
+    if (write(this -> wakeFd, &one, sizeof(one)) == -1) {
+        LOG_ERROR(this -> logger, "(UringReactor::wake) Failed to wake the ring thread: " + std::string(strerror(errno)));
+    }
+}
+
+void UringReactor::closeConnection(Connection& connection) {
+    if (connection.closed) {
+        return;
+    }
+    connection.closed = true;
+    connection.channels.clearPending();
+    connection.outbound.clear();
+    publishBacklog(connection);
+
+    // ends the multishot recv and fails pending sends, the socket closes once they report back
+    shutdown(connection.socket, SHUT_RDWR);
+}
+
+void UringReactor::maybeRelease(int clientSocket) {
+    auto it = this -> connections.find(clientSocket);
+    if (it == this -> connections.end()) {
+        return;
+    }
+
+    Connection& connection = *it -> second;
+    // a hang up after "exit" shows up as a finished recv, treat it as closed
+    if (connection.closing && !connection.recvArmed) {
+        connection.closed = true;
+    }
+    if (!connection.closed || connection.recvArmed || connection.sendsInFlight > 0 || connection.channels.running() > 0) {
+        return;
+    }
+
+    for (uint16_t channel : connection.channels.openChannels()) {
+        this -> onClose(clientSocket, channel);
+    }
+    this -> connections.erase(it);
+    close(clientSocket);
+    LOG_DEBUG(this -> logger, "(UringReactor::maybeRelease) Client socket " + std::to_string(clientSocket) + " released.");
+}
+
+#else
+
+struct UringReactor::Ring {};
+
+bool UringReactor::isSupported() {
+    return false;
+}
+
+UringReactor::UringReactor(int listenSocket, size_t workerThreads, logs::Logger& logger,
+                           Reactor::RequestHandler handler, Reactor::OrderingPredicate isBarrier,
+                           Reactor::SessionHook onOpen, Reactor::SessionHook onClose, Reactor::TerminalHook onTerminal)
+: listenSocket(listenSocket), logger(logger), handler(std::move(handler)), isBarrier(std::move(isBarrier)),
+onOpen(std::move(onOpen)), onClose(std::move(onClose)), onTerminal(std::move(onTerminal)) {
+    LOG_ERROR(this -> logger, "(UringReactor::UringReactor) io_uring is not available on this platform.");
+    throw std::runtime_error("io_uring is not available on this platform.");
+}
+
+UringReactor::~UringReactor() = default;
+
+void UringReactor::run() {}
+void UringReactor::armAccept() {}
+void UringReactor::armRecv(Connection&) {}
+void UringReactor::armWake() {}
+void UringReactor::addSource(int, std::function<void()>) {}
+void UringReactor::armSource(size_t) {}
+void UringReactor::push(int, uint16_t, protocol::FrameType, std::string_view) {}
+void UringReactor::flushSends(Connection&) {}
+void UringReactor::onAccept(int, uint32_t) {}
+void UringReactor::onRecv(uint64_t, int, uint32_t) {}
+void UringReactor::onSend(uint64_t, int) {}
+void UringReactor::onWake() {}
+void UringReactor::onSource(uint64_t, int) {}
+void UringReactor::applyFrame(const std::shared_ptr<Connection>&, const protocol::Frame&) {}
+void UringReactor::dispatch(const std::shared_ptr<Connection>&, Request) {}
+void UringReactor::execute(const std::shared_ptr<Connection>&, Request) {}
+void UringReactor::startRunnable(const std::shared_ptr<Connection>&) {}
+void UringReactor::queueOutput(Connection&) {}
+bool UringReactor::streamChunk(const std::shared_ptr<Connection>&, const Request&, std::string_view) { return false; }
+void UringReactor::publishBacklog(Connection&) {}
+void UringReactor::wake() {}
+void UringReactor::closeConnection(Connection&) {}
+void UringReactor::maybeRelease(int) {}
+UringReactor::Connection* UringReactor::lookup(uint64_t) { return nullptr; }
+
+#endif
+
+}
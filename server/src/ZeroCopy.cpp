@@ -0,0 +1,81 @@
+//
+//  ZeroCopy.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../headers/ZeroCopy.hpp"
+#include "../../common/headers/Protocol.hpp"
+
+#include <unistd.h>
+#include <cerrno>
+#include <algorithm>
+#include <sys/socket.h>
+#ifdef __linux__
+#include <sys/sendfile.h>
+#endif
+
+namespace server {
+
+ssize_t ZeroCopy::send(int socket, int fd, off_t offset, size_t length) {
+#ifdef __linux__
+    ssize_t bytesSent;
+    do {
+        bytesSent = sendfile(socket, fd, &offset, length);
+    } while (bytesSent == -1 && errno == EINTR);
+    return bytesSent;
+#else
+    char buffer[16384];
+    ssize_t bytesRead;
+    do {
+        bytesRead = pread(fd, buffer, std::min(length, sizeof(buffer)), offset);
+    } while (bytesRead == -1 && errno == EINTR);
+    if (bytesRead <= 0) {
+        return bytesRead;
+    }
+    ssize_t bytesSent;
+    do {
+        bytesSent = ::send(socket, buffer, bytesRead, 0);
+    } while (bytesSent == -1 && errno == EINTR);
+    return bytesSent;
+#endif
+}
+
+bool ZeroCopy::sendAll(int socket, int fd, off_t offset, size_t length) {
+    while (length > 0) {
+        ssize_t bytesSent = send(socket, fd, offset, length);
+        if (bytesSent == -1) {
+            return false;
+        }
+        if (bytesSent == 0) {
+            std::string zeros(length, '\0');
+            return protocol::sendAll(socket, zeros.data(), zeros.size());
+        }
+        offset += bytesSent;
+        length -= bytesSent;
+    }
+    return true;
+}
+
+bool ZeroCopy::read(int fd, off_t offset, size_t length, std::string& out) {
+    size_t start = out.size();
+    out.resize(start + length, '\0');
+    for (size_t done = 0; done < length;) {
+        ssize_t bytesRead = pread(fd, out.data() + start + done, length - done, offset + done);
+        if (bytesRead == -1 && errno == EINTR) {
+            continue;
+        }
+        if (bytesRead == -1) {
+            out.resize(start);
+            return false;
+        }
+        if (bytesRead == 0) {
+            break;   // shrank, the rest stays zero
+        }
+        done += bytesRead;
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,399 @@
+//
+//  runner_tests.cpp
+//  RemMux
+//
+//  Created by Steve Warlock on 16.10.2026.
+//
+
+#include "../client/headers/ClientBackend.hpp"
+#include "../common/headers/Checksum.hpp"
+
+// std
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include <atomic>
+#include <csignal>
+#include <unistd.h>
+#include <sys/wait.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+
+// Starts the server binary it is given on a free port, once per case and mode,
+// and talks to it through the client backend. Run from the repository root:
+// runner_tests.out build/runner_server.out
+namespace {
+
+const std::vector<std::string> MODES = {"--mode=threaded", "--mode=epoll", "--mode=uring"};
+
+int failures = 0;
+
+void check(bool passed, const std::string& name, const std::string& detail) {
+    std::cout << (passed ? "[PASS] " : "[FAIL] ") << name;
+    if (!passed) {
+        std::cout << ": " << detail;
+        ++failures;
+    }
+    std::cout << '\n';
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+class TestServer {
+public:
+    TestServer(const std::string& binary, std::vector<std::string> options) {
+        this -> port = freePort();
+        options.insert(options.begin(), "--port=" + std::to_string(this -> port));
+        options.insert(options.begin(), binary);
+
+        this -> pid = fork();
+        if (this -> pid == 0) {
+            std::vector<char*> arguments;
+            for (auto& option : options) {
+                arguments.push_back(option.data());
+            }
+            arguments.push_back(nullptr);
+            execv(binary.c_str(), arguments.data());
+            _exit(127);
+        }
+        waitUntilListening();
+    }
+
+    ~TestServer() {
+        if (this -> pid > 0) {
+            kill(this -> pid, SIGTERM);
+            waitpid(this -> pid, nullptr, 0);
+        }
+    }
+
+    // deactivate copy operator overload
+    TestServer(const TestServer&) = delete;
+    TestServer& operator=(const TestServer&) = delete;
+
+    unsigned short port = 0;
+
+private:
+    pid_t pid = -1;
+
+    static unsigned short freePort() {
+        int probe = socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        bind(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        socklen_t length = sizeof(address);
+        getsockname(probe, reinterpret_cast<sockaddr*>(&address), &length);
+        close(probe);
+        return ntohs(address.sin_port);
+    }
+
+    void waitUntilListening() const {
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_port = htons(this -> port);
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        for (int attempt = 0; attempt < 100; ++attempt) {
+            int probe = socket(AF_INET, SOCK_STREAM, 0);
+            bool listening = connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            close(probe);
+            if (listening) {
+                return;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        }
+    }
+};
+
+// more slow commands than the server has workers, a quick one from another client must still answer at once
+void slowClientsDoNotBlockFastOne(const std::string& binary, const std::string& mode) {
+    TestServer server(binary, {mode});
+    size_t slowCount = 2 * std::max(2u, std::thread::hardware_concurrency()) + 1;
+
+    std::vector<std::thread> slow;
+    for (size_t i = 0; i < slowCount; ++i) {
+        slow.emplace_back([&server] {
+            backend::ClientBackend client("127.0.0.1", server.port);
+            client.sendCommand("sleep 3");
+        });
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(500));
+
+    backend::ClientBackend fast("127.0.0.1", server.port);
+    auto start = std::chrono::steady_clock::now();
+    std::string output = fast.sendCommand("echo fast");
+    double elapsed = secondsSince(start);
+
+    for (auto& client : slow) {
+        client.join();
+    }
+    check(output.find("fast") != std::string::npos && elapsed < 1.0, "slow clients do not block a fast one " + mode,
+          "echo answered '" + output + "' after " + std::to_string(elapsed) + " s");
+}
+
+// a slow command on one channel, a quick one on another channel of the same connection must not wait for it
+void slowChannelDoesNotBlockAnother(const std::string& binary, const std::string& mode) {
+    TestServer server(binary, {mode});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::unique_ptr<backend::ClientBackend> pane = client.openChannel();
+    uint32_t slow = client.submitCommand("sleep 3");
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    
+    auto start = std::chrono::steady_clock::now();
+    std::string output = pane -> sendCommand("echo quick");
+    double elapsed = secondsSince(start);
+    client.awaitResponse(slow);
+    check(output.find("quick") != std::string::npos && elapsed < 1.0, "slow channel does not block another " + mode,
+          "echo answered '" + output + "' after " + std::to_string(elapsed) + " s");
+}
+
+// two panes waiting on one connection at once, the quick reply must not queue behind the slow one's wait
+void waitingPanesDoNotQueue(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::unique_ptr<backend::ClientBackend> pane = client.openChannel();
+    std::thread slow([&client] {
+        client.sendCommand("sleep 3");
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    auto start = std::chrono::steady_clock::now();
+    std::string output = pane -> sendCommand("echo quick");
+    double elapsed = secondsSince(start);
+    slow.join();
+    check(output.find("quick") != std::string::npos && elapsed < 1.0, "waiting panes do not queue",
+          "echo answered '" + output + "' after " + std::to_string(elapsed) + " s");
+}
+
+// a watched file's change reaches the pane without a request of its own
+void watchEventsArrive(const std::string& binary, const std::string& mode) {
+    TestServer server(binary, {mode});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string file = "/tmp/remmux_watch_" + std::to_string(getpid());
+    client.sendCommand("touch " + file);
+    std::string watching = client.sendCommand("watch " + file);
+    client.sendCommand("echo changed > " + file);
+    
+    std::string events;
+    for (int attempt = 0; attempt < 40 && events.empty(); ++attempt) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        events = client.takeWatchEvents();
+    }
+    client.sendCommand("rm -f " + file);
+    check(events.find(file) != std::string::npos, "watch events arrive " + mode,
+          "watch answered '" + watching + "', events '" + events + "'");
+}
+
+// ^C on a line mode channel stops the command it runs, the session's shell lives on
+void interruptStopsLineCommand(const std::string& binary, const std::string& mode) {
+    TestServer server(binary, {mode});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    // a program run on its own, then one inside the shell
+    double slowest = 0;
+    for (std::string command : {"sleep 5", "X=1; sleep 5"}) {
+        uint32_t running = client.submitCommand(command);
+        std::this_thread::sleep_for(std::chrono::milliseconds(300));
+        auto start = std::chrono::steady_clock::now();
+        client.sendTerminalInput("\x03");
+        client.awaitResponse(running);
+        slowest = std::max(slowest, secondsSince(start));
+    }
+    std::string after = client.sendCommand("echo ${X}still");
+    check(slowest < 1.0 && after.find("1still") != std::string::npos, "interrupt stops a line command " + mode,
+          "slowest stop took " + std::to_string(slowest) + " s, then echo answered '" + after + "'");
+}
+
+// the listening socket and the clients' connections stay in the server, a command run directly or in the shell sees none
+void commandsInheritNoSockets(const std::string& binary, const std::string& mode) {
+#ifdef __linux__
+    TestServer server(binary, {mode});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    // /bin/ls, a plain ls is answered inside the server
+    std::string direct = client.sendCommand("/bin/ls -l /proc/self/fd/");
+    std::string inShell = client.sendCommand("/bin/ls -l /proc/$$/fd/ /proc/self/fd/");
+    check(direct.find("socket:") == std::string::npos && inShell.find("socket:") == std::string::npos,
+          "commands inherit no sockets " + mode, "ls answered '" + direct + "' and '" + inShell + "'");
+#endif
+}
+
+// /proc changes without an inotify event or a new mtime, its reads must never come from the cache
+void pseudoFilesAreNotCached(const std::string& binary) {
+#ifdef __linux__
+    TestServer server(binary, {"--mode=epoll", "--cache-results"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    for (std::string command : {"head /proc/uptime", "md5sum /proc/uptime"}) {
+        std::string first = client.sendCommand(command);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1100));
+        std::string second = client.sendCommand(command);
+        check(!first.empty() && first != second, "result cache skips " + command,
+              "answered '" + first + "' twice");
+    }
+#endif
+}
+
+// getopt takes ls --rec for ls --recursive, whose output a change deep in the tree alters unnoticed
+void abbreviatedOptionsAreNotCached(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll", "--cache-results"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string tree = "/tmp/remmux_tree_" + std::to_string(getpid());
+    client.sendCommand("mkdir -p " + tree + "/inner");
+    std::string before = client.sendCommand("ls --rec " + tree);
+    client.sendCommand("touch " + tree + "/inner/added");
+    std::string after = client.sendCommand("ls --rec " + tree);
+    client.sendCommand("rm -rf " + tree);
+    check(after.find("added") != std::string::npos, "result cache skips ls --rec", "answered '" + before + "', then '" + after + "'");
+}
+
+// cd to literal paths needs no shell, the one the session gets later must still know where cd - goes
+void cdDashAfterShelllessCd(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    client.sendCommand("cd /usr");
+    client.sendCommand("cd /");
+    std::string back = client.sendCommand("cd -");
+    std::string directory = client.sendCommand("pwd");
+    check(directory.substr(0, directory.find_last_not_of('\n') + 1) == "/usr", "cd - returns to the previous directory",
+          "cd - answered '" + back + "', pwd '" + directory + "'");
+}
+
+// cd keeps a symlink in the path and .. goes back over it, the way bash's cd does
+void cdKeepsLogicalPath(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string link = "/tmp/remmux-test-link-" + std::to_string(server.port);
+    symlink("/usr/share", link.c_str());
+    std::string into = client.sendCommand("cd " + link);
+    std::string inside = client.sendCommand("pwd");
+    std::string back = client.sendCommand("cd ..");
+    std::string shell = client.sendCommand("cd " + link + " && echo $PWD");
+    unlink(link.c_str());
+    check(into == "\n" + link && inside == link + "\n" && back == "\n/tmp" && shell == link + "\n\n" + link,
+          "cd keeps the logical path", "answered '" + into + "', '" + inside + "', '" + back + "', '" + shell + "'");
+}
+
+// a cd followed by more commands keeps their output, the answer still ends in the new directory
+void cdLineKeepsItsOutput(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string answer = client.sendCommand("cd /usr && echo hi");
+    std::string directory = client.sendCommand("pwd");
+    check(answer == "hi\n\n/usr" && directory.substr(0, directory.find_last_not_of('\n') + 1) == "/usr",
+          "cd line keeps its output", "cd answered '" + answer + "', pwd '" + directory + "'");
+}
+
+// an upload writes only inside the size its begin announced
+void putDataPastSizeIsRejected(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string path = "/tmp/remmux-test-put-" + std::to_string(server.port);
+    std::string bytes = "abcd";
+    std::string data = "," + protocol::formatChecksum(protocol::checksum(bytes)) + " " + path + "\n" + bytes;
+
+    std::string begun = client.sendCommand("put --begin=4 " + path);
+    std::string far = client.sendCommand("put --data=1099511627776" + data);
+    std::string over = client.sendCommand("put --data=1" + data);
+    std::string inside = client.sendCommand("put --data=0" + data);
+    std::string done = client.sendCommand("put --commit=4 " + path);
+    unlink(path.c_str());
+    check(begun == "PART 0" && far.rfind("Error", 0) == 0 && over.rfind("Error", 0) == 0 && inside == "OK" && done == "DONE",
+          "put data past the announced size is rejected",
+          "answered '" + begun + "', '" + far + "', '" + over + "', '" + inside + "', '" + done + "'");
+}
+
+// a file cut short while the editor pages through it ends the scan early, the server keeps answering
+void truncatedFileKeepsServerUp(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string path = "/tmp/remmux-test-cut-" + std::to_string(server.port);
+    std::atomic<bool> stop{false};
+    std::thread cutter([&] {
+        while (!stop) {
+            truncate(path.c_str(), 64 << 20);
+            truncate(path.c_str(), 0);
+        }
+    });
+    std::string answer;
+    try {
+        auto start = std::chrono::steady_clock::now();
+        while (secondsSince(start) < 2) {
+            client.sendCommand("nano --lines=1000000,10 " + path);
+        }
+        answer = client.sendCommand("echo alive");
+    } catch (...) {
+        answer = "nothing, the connection dropped";
+    }
+    stop = true;
+    cutter.join();
+    unlink(path.c_str());
+    check(answer == "alive\n", "truncated file keeps the server up", "echo answered '" + answer + "'");
+}
+
+// every command of a session's shell names its own lines like bash -c, however many ran before
+void shellErrorsNameTheirOwnLines(const std::string& binary) {
+    TestServer server(binary, {"--mode=epoll"});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::string first = client.sendCommand("remmux_missing_command");
+    client.sendCommand("cd /usr");
+    client.sendCommand("true; false");
+    std::string second = client.sendCommand("remmux_missing_command");
+    check(first.find("line 1: remmux_missing_command") != std::string::npos &&
+          second.find("line 1: remmux_missing_command") != std::string::npos,
+          "shell errors name the command's own line", "answered '" + first + "', then '" + second + "'");
+}
+
+// a terminal channel that was taken to the pane's directory runs its commands on a pseudo-terminal there,
+// and what is typed reaches the command while it runs
+void terminalChannelGetsATty(const std::string& binary, const std::string& mode) {
+    TestServer server(binary, {mode});
+    backend::ClientBackend client("127.0.0.1", server.port);
+    std::unique_ptr<backend::ClientBackend> terminal = client.openChannel();
+    terminal -> sendCommand("cd '/usr'");
+    terminal -> resizeTerminal(24, 80);
+    std::string device = terminal -> sendCommand("tty");
+    std::string directory = terminal -> sendCommand("/bin/pwd");
+    uint32_t reading = terminal -> submitCommand("read line; echo got $line");
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    terminal -> sendTerminalInput("typed\r");
+    std::string typed = terminal -> awaitResponse(reading);
+    check(device.find("/dev/") != std::string::npos && device.find("not a tty") == std::string::npos &&
+          directory.find("/usr") != std::string::npos && typed.find("got typed") != std::string::npos,
+          "terminal channel gets a tty " + mode, "tty answered '" + device + "', pwd '" + directory + "', read '" + typed + "'");
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <server binary>\n";
+        return 1;
+    }
+    std::string binary = argv[1];
+    signal(SIGPIPE, SIG_IGN);
+
+    for (const auto& mode : MODES) {
+        slowClientsDoNotBlockFastOne(binary, mode);
+        slowChannelDoesNotBlockAnother(binary, mode);
+        terminalChannelGetsATty(binary, mode);
+        watchEventsArrive(binary, mode);
+        interruptStopsLineCommand(binary, mode);
+        commandsInheritNoSockets(binary, mode);
+    }
+    waitingPanesDoNotQueue(binary);
+    pseudoFilesAreNotCached(binary);
+    abbreviatedOptionsAreNotCached(binary);
+    cdDashAfterShelllessCd(binary);
+    cdLineKeepsItsOutput(binary);
+    cdKeepsLogicalPath(binary);
+    putDataPastSizeIsRejected(binary);
+    truncatedFileKeepsServerUp(binary);
+    shellErrorsNameTheirOwnLines(binary);
+
+    std::cout << (failures == 0 ? "All tests passed.\n" : std::to_string(failures) + " test(s) failed.\n");
+    return failures == 0 ? 0 : 1;
+}